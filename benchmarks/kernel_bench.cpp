@@ -0,0 +1,448 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <vector>
+#include "kernel/assembly.h"
+#include "kernel/face_intersection.h"
+#include "kernel/geometry.h"
+#include "kernel/kernel_file.h"
+#include "kernel/winged_edge.h"
+#include "model_generators.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::Bench;
+
+namespace {
+
+using Generator = std::vector<std::shared_ptr<Face>> (*)(WingedEdgeKernel&, size_t);
+
+constexpr int64_t kMinElements = 1000;
+constexpr int64_t kMaxElements = 10000000;
+
+// Decades from 10^3 to 10^7
+void decades(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(kMinElements, kMaxElements)->Unit(benchmark::kMillisecond);
+}
+
+// ==================== EULER OPERATORS ====================
+
+// A chain of n edges grown from one vertex
+void BM_Mev(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        WingedEdgeKernel kernel;
+        auto v = kernel.mvsf(Point3D(0, 0, 0));
+        auto face = kernel.getFaces()[0];
+        state.ResumeTiming();
+
+        for (size_t i = 1; i <= n; i++) {
+            v = kernel.mev(v, Point3D(static_cast<double>(i), 0, 0), face)->v2;
+        }
+        benchmark::DoNotOptimize(v);
+
+        state.PauseTiming();
+        kernel = WingedEdgeKernel(); // Teardown stays out of the timing
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mev)->Apply(decades);
+
+// Split every quad of a grid along a diagonal
+void BM_Mef(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        WingedEdgeKernel kernel;
+        auto quads = buildGrid(kernel, n);
+        std::vector<std::shared_ptr<Vertex>> corners;
+        corners.reserve(quads.size() * 2);
+        for (const auto& f : quads) {
+            auto loop = kernel.getFaceVertices(f);
+            corners.push_back(loop[0]);
+            corners.push_back(loop[2]);
+        }
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < quads.size(); i++) {
+            benchmark::DoNotOptimize(kernel.mef(corners[2 * i], corners[2 * i + 1], quads[i]));
+        }
+
+        state.PauseTiming();
+        kernel = WingedEdgeKernel();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mef)->Apply(decades);
+
+// Merge the split quads back together
+void BM_Kef(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        WingedEdgeKernel kernel;
+        auto quads = buildGrid(kernel, n);
+        std::vector<std::shared_ptr<Edge>> diagonals;
+        diagonals.reserve(quads.size());
+        for (const auto& f : quads) {
+            auto loop = kernel.getFaceVertices(f);
+            diagonals.push_back(kernel.mef(loop[0], loop[2], f));
+        }
+        state.ResumeTiming();
+
+        for (const auto& e : diagonals) {
+            benchmark::DoNotOptimize(kernel.kef(e));
+        }
+
+        state.PauseTiming();
+        kernel = WingedEdgeKernel();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Kef)->Apply(decades);
+
+// ==================== NAVIGATION ====================
+
+void BM_FaceBoundary(benchmark::State& state, Generator generate) {
+    WingedEdgeKernel kernel;
+    generate(kernel, static_cast<size_t>(state.range(0)));
+    size_t edges = 0;
+    for (auto _ : state) {
+        for (const auto& f : kernel.getFaces()) {
+            auto boundary = kernel.getFaceBoundary(f);
+            edges += boundary.size();
+            benchmark::DoNotOptimize(boundary.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(edges));
+    state.counters["faces"] = static_cast<double>(kernel.getFaceCount());
+}
+BENCHMARK_CAPTURE(BM_FaceBoundary, grid, &buildGrid)->Apply(decades);
+BENCHMARK_CAPTURE(BM_FaceBoundary, cubes, &buildCubes)->Apply(decades);
+
+// The same loops walked on the compressed form of a frozen kernel
+void BM_FrozenFaceBoundary(benchmark::State& state, Generator generate) {
+    WingedEdgeKernel kernel;
+    generate(kernel, static_cast<size_t>(state.range(0)));
+    kernel.freeze();
+    const FrozenTopology& frozen = *kernel.getFrozen();
+    size_t edges = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < frozen.getFaceCount(); i++) {
+            auto boundary = frozen.faceEdges(frozen.faceAt(i).id);
+            edges += boundary.size();
+            benchmark::DoNotOptimize(boundary.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(edges));
+    state.counters["bytes_per_edge"] =
+        static_cast<double>(frozen.byteSize()) / static_cast<double>(std::max<size_t>(1, frozen.getEdgeCount()));
+}
+BENCHMARK_CAPTURE(BM_FrozenFaceBoundary, grid, &buildGrid)->Apply(decades);
+
+// The allocation-free loop range over the same faces
+void BM_FaceEdgeRange(benchmark::State& state, Generator generate) {
+    WingedEdgeKernel kernel;
+    generate(kernel, static_cast<size_t>(state.range(0)));
+    size_t edges = 0;
+    for (auto _ : state) {
+        for (const auto& f : kernel.getFaces()) {
+            for (const auto& e : kernel.faceEdges(f)) {
+                benchmark::DoNotOptimize(e.get());
+                edges++;
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(edges));
+}
+BENCHMARK_CAPTURE(BM_FaceEdgeRange, grid, &buildGrid)->Apply(decades);
+
+void BM_IncidentEdges(benchmark::State& state, Generator generate) {
+    WingedEdgeKernel kernel;
+    generate(kernel, static_cast<size_t>(state.range(0)));
+    size_t edges = 0;
+    for (auto _ : state) {
+        for (const auto& v : kernel.getVertices()) {
+            auto incident = kernel.getIncidentEdges(v);
+            edges += incident.size();
+            benchmark::DoNotOptimize(incident.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(edges));
+}
+BENCHMARK_CAPTURE(BM_IncidentEdges, grid, &buildGrid)->Apply(decades);
+BENCHMARK_CAPTURE(BM_IncidentEdges, cubes, &buildCubes)->Apply(decades);
+
+// One hub of valence n, walked repeatedly
+void BM_IncidentEdgesHighValence(benchmark::State& state) {
+    WingedEdgeKernel kernel;
+    buildFan(kernel, static_cast<size_t>(state.range(0)));
+    const auto hub = kernel.getVertices()[0];
+    for (auto _ : state) {
+        auto incident = kernel.getIncidentEdges(hub);
+        benchmark::DoNotOptimize(incident.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IncidentEdgesHighValence)->RangeMultiplier(10)->Range(10, 1000000);
+
+// Incident faces of the hub, walked and deduplicated or read from the cache
+void BM_IncidentFacesHighValence(benchmark::State& state, bool cached) {
+    WingedEdgeKernel kernel;
+    buildFan(kernel, static_cast<size_t>(state.range(0)));
+    kernel.setAdjacencyCache(cached);
+    const auto hub = kernel.getVertices()[0];
+    for (auto _ : state) {
+        auto incident = kernel.getIncidentFaces(hub);
+        benchmark::DoNotOptimize(incident.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_IncidentFacesHighValence, walk, false)->RangeMultiplier(10)->Range(10, 1000000);
+BENCHMARK_CAPTURE(BM_IncidentFacesHighValence, cached, true)->RangeMultiplier(10)->Range(10, 1000000);
+
+// ==================== VALIDATION ====================
+
+void BM_Validate(benchmark::State& state, Generator generate, ValidationLevel level) {
+    WingedEdgeKernel kernel;
+    generate(kernel, static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernel.validate(level));
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<int64_t>(kernel.getVertexCount() + kernel.getEdgeCount() +
+                                                 kernel.getFaceCount()));
+}
+BENCHMARK_CAPTURE(BM_Validate, grid_basic, &buildGrid, ValidationLevel::Basic)->Apply(decades);
+BENCHMARK_CAPTURE(BM_Validate, grid_full, &buildGrid, ValidationLevel::Full)->Apply(decades);
+BENCHMARK_CAPTURE(BM_Validate, cubes_full, &buildCubes, ValidationLevel::Full)->Apply(decades);
+
+// Validation of many small solids: one kernel for all of them, or one per
+// solid in an Assembly. Second argument: worker threads, 0 = hardware threads.
+void BM_ValidateAssembly(benchmark::State& state, bool sharded) {
+    WingedEdgeKernel model;
+    buildCubes(model, static_cast<size_t>(state.range(0)));
+    model.setThreadCount(static_cast<size_t>(state.range(1)));
+    Assembly assembly = Assembly::fromComponents(model);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sharded ? assembly.validate(ValidationLevel::Full)
+                                         : model.validate(ValidationLevel::Full));
+    }
+    state.counters["solids"] = static_cast<double>(assembly.getSolidCount());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(model.getFaceCount()));
+}
+BENCHMARK_CAPTURE(BM_ValidateAssembly, one_kernel, false)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ValidateAssembly, per_solid, true)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->Unit(benchmark::kMillisecond);
+
+// ==================== FILES ====================
+
+// Whole-model load of an n-face grid: load() on the calling thread, or the
+// loadAsync() pipeline. Second argument: worker threads, 0 = hardware threads.
+void BM_LoadKernelFile(benchmark::State& state, bool background) {
+    const std::string path = (std::filesystem::temp_directory_path() / "sketchy_bench_load.skk").string();
+    {
+        WingedEdgeKernel model;
+        buildGrid(model, static_cast<size_t>(state.range(0)));
+        KernelFile::save(model, path);
+    }
+    FileTaskOptions options;
+    options.thread_count = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        WingedEdgeKernel loaded = background ? KernelFile::loadAsync(path, options).get() : KernelFile::load(path);
+        benchmark::DoNotOptimize(loaded.getEdgeCount());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+BENCHMARK_CAPTURE(BM_LoadKernelFile, sync, false)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadKernelFile, async, true)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Time the editing thread is held by saveAsync() (snapshot only) against
+// the full save
+void BM_SaveKernelFile(benchmark::State& state, bool background) {
+    const std::string path = (std::filesystem::temp_directory_path() / "sketchy_bench_save.skk").string();
+    WingedEdgeKernel model;
+    buildGrid(model, static_cast<size_t>(state.range(0)));
+    FileTask<void> pending;
+    bool started = false;
+    for (auto _ : state) {
+        if (background) {
+            // Finish the previous save and make one edit, off the clock
+            state.PauseTiming();
+            if (started) pending.get();
+            model.getVertices()[0]->coords.z += 1.0;
+            model.markDirty(model.getVertices()[0]);
+            state.ResumeTiming();
+
+            pending = KernelFile::saveAsync(model, path);
+            started = true;
+        } else {
+            KernelFile::save(model, path);
+        }
+    }
+    if (started) pending.get();
+    std::remove(path.c_str());
+}
+BENCHMARK_CAPTURE(BM_SaveKernelFile, sync, false)
+    ->RangeMultiplier(10)->Range(kMinElements, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveKernelFile, async_caller, true)
+    ->RangeMultiplier(10)->Range(kMinElements, 1000000)->Unit(benchmark::kMillisecond);
+
+// ==================== LOOKUPS ====================
+
+// Random IDs, so the lookups do not walk the slot table in order
+template <typename Lookup>
+void lookupById(benchmark::State& state, size_t id_count, Lookup lookup) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, static_cast<int>(id_count));
+    std::vector<int> ids(1 << 16);
+    for (auto& id : ids) id = pick(rng);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lookup(ids[i++ & (ids.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_GetVertexById(benchmark::State& state) {
+    WingedEdgeKernel kernel;
+    buildGrid(kernel, static_cast<size_t>(state.range(0)));
+    lookupById(state, kernel.getVertexCount(), [&](int id) { return kernel.getVertexById(id).get(); });
+}
+BENCHMARK(BM_GetVertexById)->Apply(decades)->Unit(benchmark::kNanosecond);
+
+void BM_GetEdgeById(benchmark::State& state) {
+    WingedEdgeKernel kernel;
+    buildGrid(kernel, static_cast<size_t>(state.range(0)));
+    lookupById(state, kernel.getEdgeCount(), [&](int id) { return kernel.getEdgeById(id).get(); });
+}
+BENCHMARK(BM_GetEdgeById)->Apply(decades)->Unit(benchmark::kNanosecond);
+
+void BM_GetFaceById(benchmark::State& state) {
+    WingedEdgeKernel kernel;
+    buildGrid(kernel, static_cast<size_t>(state.range(0)));
+    lookupById(state, kernel.getFaceCount(), [&](int id) { return kernel.getFaceById(id).get(); });
+}
+BENCHMARK(BM_GetFaceById)->Apply(decades)->Unit(benchmark::kNanosecond);
+
+// ==================== EXTRUSION ====================
+
+// Push-pull a whole grid; the model is rebuilt outside the timed region.
+// Second argument: worker threads, 0 = hardware threads.
+void BM_ExtrudeFaces(benchmark::State& state, ExtrudeMode mode) {
+    const auto faces = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        WingedEdgeKernel kernel;
+        kernel.setThreadCount(static_cast<size_t>(state.range(1)));
+        auto selection = buildGrid(kernel, faces);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(kernel.extrudeFaces(selection, Vec3(0, 0, 1), mode));
+        state.PauseTiming();
+        kernel = WingedEdgeKernel(); // Teardown is not part of the extrusion
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(faces));
+}
+BENCHMARK_CAPTURE(BM_ExtrudeFaces, region, ExtrudeMode::Region)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ExtrudeFaces, individual, ExtrudeMode::Individual)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->Unit(benchmark::kMillisecond);
+
+// ==================== INTERSECTION ====================
+
+// Two cube lattices offset by half a cube, so every cube of A cuts one of B.
+// The tree over B is built on the first call and only checked after that.
+// Second argument: worker threads, 0 = hardware threads.
+void BM_IntersectFaces(benchmark::State& state) {
+    const auto faces = static_cast<size_t>(state.range(0));
+    WingedEdgeKernel a, b;
+    buildCubes(a, faces);
+    buildCubes(b, faces);
+    b.transformVertices(b.getVertices(), Mat4::translation(0.5, 0.5, 0.5));
+    FaceIntersector intersector;
+    intersector.setThreadCount(static_cast<size_t>(state.range(1)));
+    intersector.intersect(a, b);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(intersector.intersect(a, b));
+    }
+    state.counters["segments"] = static_cast<double>(intersector.getLastStats().segments);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(a.getFaceCount()));
+}
+BENCHMARK(BM_IntersectFaces)
+    ->ArgsProduct({benchmark::CreateRange(kMinElements, 1000000, 10), {1, 0}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ==================== TRANSFORMS ====================
+
+std::vector<Point3D> randomPoints(size_t n) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> coord(-100, 100);
+    std::vector<Point3D> points(n);
+    for (auto& p : points) p = Point3D(coord(rng), coord(rng), coord(rng));
+    return points;
+}
+
+Mat4 benchTransform() {
+    return Mat4::translation(1, 2, 3) * Mat4::rotation(Vec3(1, 1, 0).normalized(), 0.3);
+}
+
+// Baseline: one Mat4::transform call per point
+void BM_Mat4Transform(benchmark::State& state) {
+    auto points = randomPoints(static_cast<size_t>(state.range(0)));
+    std::vector<Point3D> out(points.size());
+    const Mat4 m = benchTransform();
+    for (auto _ : state) {
+        for (size_t i = 0; i < points.size(); i++) out[i] = m.transform(points[i]);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(Point3D)));
+}
+BENCHMARK(BM_Mat4Transform)->Apply(decades);
+
+void BM_Mat4TransformPoints(benchmark::State& state) {
+    auto points = randomPoints(static_cast<size_t>(state.range(0)));
+    std::vector<Point3D> out(points.size());
+    const Mat4 m = benchTransform();
+    for (auto _ : state) {
+        m.transformPoints(points.data(), out.data(), points.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(Point3D)));
+}
+BENCHMARK(BM_Mat4TransformPoints)->Apply(decades);
+
+void BM_TransformVertices(benchmark::State& state) {
+    WingedEdgeKernel kernel;
+    buildGrid(kernel, static_cast<size_t>(state.range(0)));
+    const auto& selection = kernel.getVertices();
+    const Mat4 m = Mat4::translation(0, 0, 1e-9);
+    for (auto _ : state) {
+        kernel.transformVertices(selection, m);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(selection.size()));
+}
+BENCHMARK(BM_TransformVertices)->Apply(decades);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+#ifndef SKETCHY_BENCHMARKS_MODEL_GENERATORS_H
+#define SKETCHY_BENCHMARKS_MODEL_GENERATORS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "kernel/winged_edge.h"
+
+namespace SketchyKernel {
+namespace Bench {
+
+/**
+ * Synthetic models for the benchmarks, sized by the number of input faces.
+ * All of them go through buildFromIndexedMesh, so setup stays cheap next to
+ * the measured work even at ten million elements.
+ */
+
+/**
+ * side x side quads in the z = 0 plane, side = ceil(sqrt(faces)). Every
+ * interior vertex has valence 4; the boundary is closed by one large face.
+ * @return The grid quads, row by row
+ */
+inline std::vector<std::shared_ptr<Face>> buildGrid(WingedEdgeKernel& kernel, size_t faces) {
+    const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(faces))));
+    std::vector<Point3D> positions;
+    positions.reserve(static_cast<size_t>(side + 1) * (side + 1));
+    for (uint32_t y = 0; y <= side; y++) {
+        for (uint32_t x = 0; x <= side; x++) positions.emplace_back(x, y, 0);
+    }
+    std::vector<uint32_t> loops;
+    loops.reserve(static_cast<size_t>(side) * side * 4);
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            uint32_t a = y * (side + 1) + x;
+            loops.insert(loops.end(), {a, a + 1, a + side + 2, a + side + 1});
+        }
+    }
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(loops.size() / 4, 4));
+}
+
+/**
+ * k x k x k disjoint unit cubes on a lattice, six quads each, with
+ * k = ceil(cbrt(faces / 6)). Exercises many small solids instead of one
+ * large one.
+ */
+inline std::vector<std::shared_ptr<Face>> buildCubes(WingedEdgeKernel& kernel, size_t faces) {
+    const auto k = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(faces) / 6.0)));
+    static const uint32_t cube[24] = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4,
+                                      1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    std::vector<Point3D> positions;
+    std::vector<uint32_t> loops;
+    positions.reserve(static_cast<size_t>(k) * k * k * 8);
+    loops.reserve(static_cast<size_t>(k) * k * k * 24);
+    for (uint32_t i = 0; i < k * k * k; i++) {
+        double ox = 2.0 * (i % k), oy = 2.0 * ((i / k) % k), oz = 2.0 * (i / (k * k));
+        auto base = static_cast<uint32_t>(positions.size());
+        for (int c = 0; c < 8; c++) {
+            positions.emplace_back(ox + (c == 1 || c == 2 || c == 5 || c == 6),
+                                   oy + (c == 2 || c == 3 || c == 6 || c == 7), oz + (c >= 4));
+        }
+        for (uint32_t index : cube) loops.push_back(base + index);
+    }
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(loops.size() / 4, 4));
+}
+
+/**
+ * faces triangles around one hub vertex, so the hub's valence equals the
+ * face count; the rim is closed by a single faces-gon.
+ */
+inline std::vector<std::shared_ptr<Face>> buildFan(WingedEdgeKernel& kernel, size_t faces) {
+    const double pi = std::acos(-1.0);
+    std::vector<Point3D> positions{{0, 0, 1}};
+    positions.reserve(faces + 1);
+    for (size_t i = 0; i < faces; i++) {
+        double angle = 2 * pi * static_cast<double>(i) / static_cast<double>(faces);
+        positions.emplace_back(std::cos(angle), std::sin(angle), 0);
+    }
+    std::vector<uint32_t> loops;
+    loops.reserve(faces * 3);
+    for (uint32_t i = 0; i < faces; i++) {
+        loops.insert(loops.end(), {0, 1 + i, 1 + (i + 1) % static_cast<uint32_t>(faces)});
+    }
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(faces, 3));
+}
+
+} // namespace Bench
+} // namespace SketchyKernel
+
+#endif // SKETCHY_BENCHMARKS_MODEL_GENERATORS_H
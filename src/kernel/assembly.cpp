@@ -0,0 +1,194 @@
+#include "assembly.h"
+#include "kernel_file.h"
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace SketchyKernel {
+
+namespace {
+
+constexpr const char* kManifestName = "assembly.txt";
+constexpr const char* kManifestHeader = "SKETCHY_ASSEMBLY 1";
+
+std::string solidPath(const std::filesystem::path& directory, int id) {
+    return (directory / ("solid_" + std::to_string(id) + ".skk")).string();
+}
+
+std::string partPath(const std::string& path) {
+    return path + ".part";
+}
+
+// Move a finished <path>.part over <path>
+void replaceWithPart(const std::string& path) {
+    std::error_code error;
+    std::filesystem::rename(partPath(path), path, error);
+    if (error) {
+        std::remove(partPath(path).c_str());
+        throw std::runtime_error("Assembly::save: cannot replace " + path + ": " + error.message());
+    }
+}
+
+} // namespace
+
+Assembly Assembly::fromComponents(const WingedEdgeKernel& model) {
+    Assembly assembly;
+    assembly.thread_count = model.getThreadCount();
+    auto parts = model.splitComponents();
+    assembly.solids.reserve(parts.size());
+    for (auto& part : parts) assembly.addSolid(std::move(part));
+    return assembly;
+}
+
+// ==================== SOLIDS ====================
+
+Solid& Assembly::addSolid(std::string name) {
+    return addSolid(WingedEdgeKernel(), std::move(name));
+}
+
+Solid& Assembly::addSolid(WingedEdgeKernel kernel, std::string name) {
+    if (name.find_first_of("\r\n") != std::string::npos) {
+        throw std::invalid_argument("Assembly::addSolid: names must fit on one line");
+    }
+    if (next_id > kMaxSolidId) throw std::logic_error("Assembly::addSolid: out of solid IDs");
+    return insertSolid(next_id++, std::move(kernel), std::move(name));
+}
+
+Solid& Assembly::insertSolid(int id, WingedEdgeKernel kernel, std::string name) {
+    auto solid = std::make_unique<Solid>(id, std::move(name));
+    solid->kernel = std::move(kernel);
+    solid->kernel.setThreadCount(1);
+
+    if (id >= static_cast<int>(solid_slots.size())) solid_slots.resize(id + 1, -1);
+    solid_slots[id] = static_cast<int>(solids.size());
+    solids.push_back(std::move(solid));
+    return *solids.back();
+}
+
+bool Assembly::removeSolid(int id) {
+    if (!getSolid(id)) return false;
+
+    size_t slot = static_cast<size_t>(solid_slots[id]);
+    if (slot + 1 != solids.size()) {
+        solids[slot] = std::move(solids.back());
+        solid_slots[solids[slot]->id] = static_cast<int>(slot);
+    }
+    solids.pop_back();
+    solid_slots[id] = -1;
+    return true;
+}
+
+Solid* Assembly::getSolid(int id) {
+    if (id < 0 || id >= static_cast<int>(solid_slots.size()) || solid_slots[id] < 0) return nullptr;
+    return solids[solid_slots[id]].get();
+}
+
+const Solid* Assembly::getSolid(int id) const {
+    return const_cast<Assembly*>(this)->getSolid(id);
+}
+
+size_t Assembly::getVertexCount() const {
+    size_t total = 0;
+    for (const auto& s : solids) total += s->kernel.getVertexCount();
+    return total;
+}
+
+size_t Assembly::getEdgeCount() const {
+    size_t total = 0;
+    for (const auto& s : solids) total += s->kernel.getEdgeCount();
+    return total;
+}
+
+size_t Assembly::getFaceCount() const {
+    size_t total = 0;
+    for (const auto& s : solids) total += s->kernel.getFaceCount();
+    return total;
+}
+
+// ==================== PARALLEL PASSES ====================
+
+bool Assembly::validate(ValidationLevel level) const {
+    std::atomic<bool> ok{true};
+    forEachSolid([&](const Solid& solid) {
+        if (ok.load(std::memory_order_relaxed) && !solid.kernel.validate(level)) {
+            ok.store(false, std::memory_order_relaxed);
+        }
+    });
+    return ok.load();
+}
+
+void Assembly::save(const std::string& directory) const {
+    const std::filesystem::path dir(directory);
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        throw std::runtime_error("Assembly::save: cannot create " + directory + ": " + error.message());
+    }
+
+    try {
+        forEachSolid([&](const Solid& solid) { KernelFile::save(solid.kernel, partPath(solidPath(dir, solid.id))); });
+    } catch (...) {
+        for (const auto& solid : solids) std::remove(partPath(solidPath(dir, solid->id)).c_str());
+        throw;
+    }
+    for (const auto& solid : solids) replaceWithPart(solidPath(dir, solid->id));
+
+    // Replaced last, so a manifest only ever lists complete solids
+    const std::string manifest_path = (dir / kManifestName).string();
+    {
+        std::ofstream manifest(partPath(manifest_path));
+        if (!manifest) throw std::runtime_error("Assembly::save: cannot open manifest in " + directory);
+        manifest << kManifestHeader << '\n';
+        for (const auto& solid : solids) manifest << solid->id << '\t' << solid->name << '\n';
+        manifest.close();
+        if (!manifest) {
+            std::remove(partPath(manifest_path).c_str());
+            throw std::runtime_error("Assembly::save: manifest write failed");
+        }
+    }
+    replaceWithPart(manifest_path);
+}
+
+Assembly Assembly::load(const std::string& directory, size_t thread_count) {
+    const std::filesystem::path dir(directory);
+    std::ifstream manifest(dir / kManifestName);
+    if (!manifest) throw std::runtime_error("Assembly::load: no manifest in " + directory);
+
+    std::string line;
+    if (!std::getline(manifest, line) || line != kManifestHeader) {
+        throw std::runtime_error("Assembly::load: not an assembly manifest");
+    }
+
+    std::vector<int> ids;
+    std::vector<std::string> names;
+    while (std::getline(manifest, line)) {
+        if (line.empty()) continue;
+        size_t tab = line.find('\t');
+        int id = 0;
+        std::istringstream field(line.substr(0, tab));
+        if (tab == std::string::npos || !(field >> id) || !(field >> std::ws).eof()) {
+            throw std::runtime_error("Assembly::load: malformed manifest line");
+        }
+        if (id <= 0 || id > kMaxSolidId) throw std::runtime_error("Assembly::load: solid ID out of range");
+        ids.push_back(id);
+        names.push_back(line.substr(tab + 1));
+    }
+
+    std::vector<WingedEdgeKernel> kernels(ids.size());
+    forEachIndex(ids.size(), thread_count, [&](size_t i) { kernels[i] = KernelFile::load(solidPath(dir, ids[i])); });
+
+    Assembly assembly;
+    assembly.thread_count = thread_count;
+    assembly.solids.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (assembly.getSolid(ids[i])) throw std::runtime_error("Assembly::load: duplicate solid ID");
+        assembly.insertSolid(ids[i], std::move(kernels[i]), std::move(names[i]));
+        assembly.next_id = std::max(assembly.next_id, ids[i] + 1);
+    }
+    return assembly;
+}
+
+} // namespace SketchyKernel
@@ -0,0 +1,153 @@
+#ifndef SKETCHY_KERNEL_ASSEMBLY_H
+#define SKETCHY_KERNEL_ASSEMBLY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "parallel.h"
+#include "winged_edge.h"
+
+namespace SketchyKernel {
+
+/**
+ * One part of an assembly. Its kernel owns the elements, arena, IDs and
+ * undo history, so editing one solid never touches another's storage.
+ */
+struct Solid {
+    int id;
+    std::string name;
+    WingedEdgeKernel kernel;
+
+    Solid(int id, std::string name) : id(id), name(std::move(name)) {}
+};
+
+/**
+ * A set of independent solids, each in a kernel of its own.
+ *
+ * A single WingedEdgeKernel keeps every solid in one set of element lists,
+ * so checking or saving one part means walking all of them. An Assembly
+ * gives each part its own kernel instead: per-solid work is O(solid), and
+ * the passes below hand whole solids to worker threads, which never share
+ * a kernel. Like a kernel, the assembly itself is not thread-safe; add and
+ * remove solids from one thread.
+ */
+class Assembly {
+public:
+    // Solid IDs run from 1 to here; they index a slot table, so a loaded
+    // manifest cannot make it arbitrarily large
+    static constexpr int kMaxSolidId = 1 << 24;
+
+    Assembly() = default;
+    Assembly(Assembly&&) noexcept = default;
+    Assembly& operator=(Assembly&&) noexcept = default;
+
+    /**
+     * Shard a model into one solid per connected component, in the order of
+     * WingedEdgeKernel::splitComponents()
+     * @throws std::logic_error if the model is frozen
+     */
+    static Assembly fromComponents(const WingedEdgeKernel& model);
+
+    // ==================== SOLIDS ====================
+
+    /**
+     * Add an empty solid, or one holding an existing kernel. A solid's
+     * kernel starts with one worker thread, since the assembly's own passes
+     * already run one solid per worker.
+     * @throws std::invalid_argument if the name contains a line break
+     * @throws std::logic_error once kMaxSolidId IDs have been handed out
+     */
+    Solid& addSolid(std::string name = "");
+    Solid& addSolid(WingedEdgeKernel kernel, std::string name = "");
+
+    /**
+     * @return false if no solid has this ID
+     */
+    bool removeSolid(int id);
+
+    /**
+     * Get a solid by ID in O(1); nullptr for unknown or removed IDs
+     */
+    Solid* getSolid(int id);
+    const Solid* getSolid(int id) const;
+
+    // Removing a solid moves the last one into its place
+    const std::vector<std::unique_ptr<Solid>>& getSolids() const { return solids; }
+    size_t getSolidCount() const { return solids.size(); }
+
+    // Totals over every solid
+    size_t getVertexCount() const;
+    size_t getEdgeCount() const;
+    size_t getFaceCount() const;
+
+    // ==================== PARALLEL PASSES ====================
+
+    /**
+     * Workers for the passes below; 0 = hardware threads
+     */
+    void setThreadCount(size_t count) { thread_count = count; }
+    size_t getThreadCount() const { return thread_count; }
+
+    /**
+     * Run body(solid) on every solid, spread across the workers. Bodies for
+     * different solids run concurrently, so they must not share mutable
+     * state. Once a body throws, solids not yet started are skipped and the
+     * first exception is rethrown after every worker has stopped.
+     */
+    template <typename Body>
+    void forEachSolid(const Body& body) {
+        forEachIndex(solids.size(), thread_count, [&](size_t i) { body(*solids[i]); });
+    }
+
+    template <typename Body>
+    void forEachSolid(const Body& body) const {
+        forEachIndex(solids.size(), thread_count, [&](size_t i) { body(static_cast<const Solid&>(*solids[i])); });
+    }
+
+    /**
+     * validate(level) on every solid in parallel; false if any fails
+     * @throws std::logic_error if a solid's kernel is frozen
+     */
+    bool validate(ValidationLevel level = ValidationLevel::Basic) const;
+
+    /**
+     * Write every solid to <directory>/solid_<id>.skk (see KernelFile) in
+     * parallel, plus an assembly.txt manifest of IDs and names. The
+     * directory is created if needed. Every file is written next to its
+     * target as <name>.part and then moved over it, the manifest last, so
+     * an interrupted save leaves each file either old or complete.
+     * @throws std::runtime_error if a file cannot be written
+     */
+    void save(const std::string& directory) const;
+
+    /**
+     * Read an assembly written by save(), loading the solids in parallel.
+     * Solid IDs and names are kept.
+     * @throws std::runtime_error on a missing or malformed manifest, a
+     *         solid ID outside [1, kMaxSolidId], or any error
+     *         KernelFile::load() reports
+     */
+    static Assembly load(const std::string& directory, size_t thread_count = 0);
+
+private:
+    std::vector<std::unique_ptr<Solid>> solids;
+    std::vector<int> solid_slots; // ID -> index into solids, -1 once removed
+    int next_id = 1;
+    size_t thread_count = 0;
+
+    Solid& insertSolid(int id, WingedEdgeKernel kernel, std::string name);
+
+    // Calls body(i) for i in [0, n) on up to `threads` workers, one index at
+    // a time since solids vary widely in size
+    template <typename IndexBody>
+    static void forEachIndex(size_t n, size_t threads, const IndexBody& body) {
+        parallelFor(n, resolveThreadCount(threads), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) body(i);
+        }, 1);
+    }
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_ASSEMBLY_H
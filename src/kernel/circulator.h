@@ -0,0 +1,149 @@
+#ifndef SKETCHY_KERNEL_CIRCULATOR_H
+#define SKETCHY_KERNEL_CIRCULATOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "kernel_stats.h"
+
+namespace SketchyKernel {
+
+/**
+ * Lazy, allocation-free range over one wing-pointer loop.
+ *
+ * A Policy describes how to walk the loop:
+ *   using Cursor = ...;                        // position in the loop
+ *   bool valid(Cursor c) const;                // false once the walk breaks off
+ *   bool same(Cursor a, Cursor b) const;       // cursors address the same edge
+ *   Cursor next(Cursor c) const;               // step along the loop
+ *   reference deref(Cursor c) const;           // element yielded for c
+ *
+ * The range yields exactly the elements the visited-set walks used to
+ * collect: it stops when the loop returns to its first edge, when it breaks
+ * off, or just before the first repeated edge of a loop that never closes.
+ * The length is fixed on construction with Brent's cycle detection, which
+ * needs no memory and costs a single walk for a closed or open loop.
+ */
+template <typename Policy>
+class LoopRange {
+public:
+    using Cursor = typename Policy::Cursor;
+    using element_reference = decltype(std::declval<const Policy&>().deref(std::declval<Cursor>()));
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::decay_t<element_reference>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = element_reference;
+
+        iterator() = default;
+        iterator(const Policy* policy, Cursor cursor, size_t remaining)
+            : policy(policy), cursor(cursor), remaining(remaining) {}
+
+        reference operator*() const { return policy->deref(cursor); }
+
+        iterator& operator++() {
+            if (--remaining > 0) cursor = policy->next(cursor);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const iterator& other) const { return remaining == other.remaining; }
+        bool operator!=(const iterator& other) const { return remaining != other.remaining; }
+
+    private:
+        const Policy* policy = nullptr;
+        Cursor cursor{};
+        size_t remaining = 0;
+    };
+
+    /**
+     * @param limit Upper bound on the number of elements yielded
+     */
+    LoopRange(Policy policy, Cursor first, size_t limit)
+        : policy(std::move(policy)), first(first), count(measure(limit)) {
+#if SKETCHY_KERNEL_STATS
+        noteLoopRange(count);
+#endif
+    }
+
+    iterator begin() const { return iterator(&policy, first, count); }
+    iterator end() const { return iterator(&policy, first, 0); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    Policy policy;
+    Cursor first;
+    size_t count;
+
+    size_t measure(size_t limit) const {
+        if (limit == 0 || !policy.valid(first)) return 0;
+
+        Cursor tortoise = first;
+        Cursor hare = first;
+        size_t power = 1;
+        size_t lambda = 0;
+        size_t steps = 0;
+
+        while (true) {
+            hare = policy.next(hare);
+            steps++;
+            lambda++;
+
+            if (!policy.valid(hare) || policy.same(hare, first)) {
+                return steps < limit ? steps : limit;
+            }
+            if (policy.same(hare, tortoise)) break;
+
+            if (power == lambda) {
+                tortoise = hare;
+                power *= 2;
+                lambda = 0;
+            }
+        }
+
+        // The walk ran into a cycle that does not contain the first edge:
+        // find where the cycle starts (mu) so the repeat is not yielded
+        tortoise = first;
+        hare = first;
+        for (size_t i = 0; i < lambda; i++) hare = policy.next(hare);
+
+        size_t mu = 0;
+        while (!policy.same(tortoise, hare)) {
+            tortoise = policy.next(tortoise);
+            hare = policy.next(hare);
+            mu++;
+        }
+
+        size_t total = mu + lambda;
+        return total < limit ? total : limit;
+    }
+};
+
+/**
+ * Materialize a loop range into a vector with a single allocation
+ */
+template <typename Range>
+auto collect(const Range& range) {
+    std::vector<typename Range::iterator::value_type> result;
+    result.reserve(range.size());
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_CIRCULATOR_H
@@ -0,0 +1,65 @@
+#ifndef SKETCHY_KERNEL_ELEMENT_ARENA_H
+#define SKETCHY_KERNEL_ELEMENT_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace SketchyKernel {
+
+/**
+ * Memory resource that topology elements are carved from.
+ *
+ * The default arena is an unsynchronized pool: Vertex, Edge and Face objects
+ * (together with their shared_ptr control blocks) come from contiguous
+ * chunks, killed elements return their block to the pool for reuse, and the
+ * chunks are released in bulk when the last element goes away. Pass a
+ * different resource to WingedEdgeKernel to plug in another strategy.
+ *
+ * Not thread-safe: elements of one kernel must not be allocated or released
+ * concurrently.
+ */
+using ElementArena = std::shared_ptr<std::pmr::memory_resource>;
+
+inline ElementArena makeDefaultArena() {
+    return std::make_shared<std::pmr::unsynchronized_pool_resource>();
+}
+
+/**
+ * Allocator handed to std::allocate_shared.
+ * Each control block keeps a reference to the arena, so an element that
+ * outlives its kernel still releases into live memory.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(ElementArena arena) : arena(std::move(arena)) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        arena->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    ElementArena arena;
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_ELEMENT_ARENA_H
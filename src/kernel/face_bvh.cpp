@@ -0,0 +1,705 @@
+#include "face_bvh.h"
+#include "winged_edge.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace SketchyKernel {
+
+namespace {
+
+constexpr uint32_t kLeafSize = 4;         // Faces per leaf when built
+constexpr uint32_t kLeafSlack = 2;        // Spare slots per leaf for insertions
+constexpr size_t kBins = 16;
+constexpr uint32_t kMaxSahDepth = 48;     // Median splits below, bounding the depth
+constexpr uint32_t kParallelGrain = 4096; // Smallest range split before the workers start
+
+double component(const Vec3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// Min / max as arrays for the build passes, which pick coordinates by a
+// runtime axis index (centroid[axis], lo[axis]) rather than x / y / z
+struct Extent {
+    double lo[3] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity()};
+    double hi[3] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                    -std::numeric_limits<double>::infinity()};
+
+    void expand(const double* p) {
+        for (int axis = 0; axis < 3; axis++) {
+            lo[axis] = p[axis] < lo[axis] ? p[axis] : lo[axis];
+            hi[axis] = p[axis] > hi[axis] ? p[axis] : hi[axis];
+        }
+    }
+
+    void expand(const Extent& other) {
+        for (int axis = 0; axis < 3; axis++) {
+            lo[axis] = other.lo[axis] < lo[axis] ? other.lo[axis] : lo[axis];
+            hi[axis] = other.hi[axis] > hi[axis] ? other.hi[axis] : hi[axis];
+        }
+    }
+
+    double area() const {
+        if (lo[0] > hi[0] || lo[1] > hi[1] || lo[2] > hi[2]) return 0;
+        double dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+        return 2 * (dx * dy + dy * dz + dz * dx);
+    }
+
+    BoundingBox box() const {
+        BoundingBox b;
+        b.min = Vec3(lo[0], lo[1], lo[2]);
+        b.max = Vec3(hi[0], hi[1], hi[2]);
+        return b;
+    }
+};
+
+double surfaceArea(const BoundingBox& b) {
+    if (b.empty()) return 0;
+    Vec3 d = b.max - b.min;
+    return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+Point3D center(const BoundingBox& b) {
+    return (b.min + b.max) * 0.5;
+}
+
+bool overlaps(const BoundingBox& a, const BoundingBox& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y &&
+           a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+double distanceSquared(const BoundingBox& b, const Point3D& p) {
+    double dx = std::fmax(std::fmax(b.min.x - p.x, 0.0), p.x - b.max.x);
+    double dy = std::fmax(std::fmax(b.min.y - p.y, 0.0), p.y - b.max.y);
+    double dz = std::fmax(std::fmax(b.min.z - p.z, 0.0), p.z - b.max.z);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Slab test; fmin / fmax drop the NaN of an origin on a slab plane
+bool slab(const BoundingBox& b, const Ray& ray, const Vec3& inverse, double t_max, double& t_enter) {
+    if (b.empty()) return false;
+
+    double t0 = 0, t1 = t_max;
+    for (int axis = 0; axis < 3; axis++) {
+        double o = component(ray.origin, axis), inv = component(inverse, axis);
+        double lo = (component(b.min, axis) - o) * inv;
+        double hi = (component(b.max, axis) - o) * inv;
+        if (lo > hi) std::swap(lo, hi);
+        t0 = std::fmax(t0, lo);
+        t1 = std::fmin(t1, hi);
+    }
+    t_enter = t0;
+    return t0 <= t1;
+}
+
+void gatherLoop(const Face& face, size_t limit, std::vector<Point3D>& loop) {
+    loop.clear();
+    for (const auto& v : FaceVertexRange(FaceVertexPolicy{{&face}}, &face.edge, limit)) {
+        loop.push_back(v->coords);
+    }
+}
+
+// Axes of the coordinate plane the normal is closest to
+void projectionAxes(const Vec3& n, int& u, int& v) {
+    double ax = std::abs(n.x), ay = std::abs(n.y), az = std::abs(n.z);
+    if (ax >= ay && ax >= az) {
+        u = 1;
+        v = 2;
+    } else if (ay >= az) {
+        u = 2;
+        v = 0;
+    } else {
+        u = 0;
+        v = 1;
+    }
+}
+
+// Crossing-number test in the projection plane; either winding works
+bool insideLoop(const std::vector<Point3D>& loop, int u, int v, const Point3D& q) {
+    const double qu = component(q, u), qv = component(q, v);
+    bool inside = false;
+    for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        double ui = component(loop[i], u), vi = component(loop[i], v);
+        double uj = component(loop[j], u), vj = component(loop[j], v);
+        if ((vi > qv) != (vj > qv) && qu < (uj - ui) * (qv - vi) / (vj - vi) + ui) inside = !inside;
+    }
+    return inside;
+}
+
+bool intersectFace(const std::vector<Point3D>& loop, const Ray& ray, double t_max, double& t) {
+    if (loop.size() < 3) return false;
+
+    Vec3 n = polygonNormal(loop.data(), loop.size());
+    double denom = n.dot(ray.direction);
+    if (denom == 0) return false; // Parallel, or a degenerate loop
+
+    double hit = n.dot(loop[0] - ray.origin) / denom;
+    if (!(hit >= 0 && hit < t_max)) return false;
+
+    int u, v;
+    projectionAxes(n, u, v);
+    if (!insideLoop(loop, u, v, ray.origin + ray.direction * hit)) return false;
+    t = hit;
+    return true;
+}
+
+Point3D closestOnSegment(const Point3D& a, const Point3D& b, const Point3D& p) {
+    Vec3 ab = b - a;
+    double length2 = ab.dot(ab);
+    double s = length2 > 0 ? std::clamp((p - a).dot(ab) / length2, 0.0, 1.0) : 0.0;
+    return a + ab * s;
+}
+
+double closestOnFace(const std::vector<Point3D>& loop, const Point3D& p, Point3D& closest) {
+    if (loop.empty()) return std::numeric_limits<double>::infinity();
+
+    Vec3 n = polygonNormal(loop.data(), loop.size());
+    if (loop.size() >= 3 && n.dot(n) > 0) {
+        double height = n.dot(p - loop[0]);
+        Point3D q = p - n * height;
+        int u, v;
+        projectionAxes(n, u, v);
+        if (insideLoop(loop, u, v, q)) {
+            closest = q;
+            return std::abs(height);
+        }
+    }
+
+    // Outside the loop the closest point is on its boundary
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < loop.size(); i++) {
+        Point3D c = closestOnSegment(loop[i], loop[(i + 1) % loop.size()], p);
+        double d = (p - c).length();
+        if (d < best) {
+            best = d;
+            closest = c;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+// ==================== CONSTRUCTION ====================
+
+// Faces being sorted into the tree, kept contiguous for the split passes
+struct FaceBvh::BuildItem {
+    Extent extent;
+    double centroid[3];
+    int id;
+};
+
+BoundingBox FaceBvh::faceBox(const Face& face) const {
+    BoundingBox box;
+    for (const auto& v : FaceVertexRange(FaceVertexPolicy{{&face}}, &face.edge, loop_limit)) box.expand(v->coords);
+    return box;
+}
+
+bool FaceBvh::split(std::vector<BuildItem>& order, uint32_t node, uint32_t begin, uint32_t end, uint32_t depth,
+                    uint32_t& mid, std::atomic<uint32_t>& next_node) {
+    Extent bounds, centroids;
+    for (uint32_t i = begin; i < end; i++) {
+        bounds.expand(order[i].extent);
+        centroids.expand(order[i].centroid);
+    }
+    Node& n = nodes[node];
+    n.box = bounds.box();
+
+    if (end - begin <= kLeafSize) {
+        n.leaf = true;
+        n.first = begin;
+        n.count = end - begin;
+        return false;
+    }
+
+    double scale[3];
+    for (int axis = 0; axis < 3; axis++) {
+        double width = centroids.hi[axis] - centroids.lo[axis];
+        scale[axis] = width > 0 ? kBins / width : 0;
+    }
+    auto bin = [&](const BuildItem& item, int axis) {
+        double offset = (item.centroid[axis] - centroids.lo[axis]) * scale[axis];
+        return std::min(kBins - 1, static_cast<size_t>(offset));
+    };
+
+    // Binned SAH, all three axes in one pass: cost = count * area per side
+    int best_axis = -1;
+    size_t best_bin = 0;
+    if (depth < kMaxSahDepth) {
+        Extent bin_extent[3][kBins];
+        uint32_t bin_count[3][kBins] = {};
+        for (uint32_t i = begin; i < end; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                size_t k = bin(order[i], axis);
+                bin_count[axis][k]++;
+                bin_extent[axis][k].expand(order[i].extent);
+            }
+        }
+
+        double best_cost = std::numeric_limits<double>::infinity();
+        for (int axis = 0; axis < 3; axis++) {
+            if (scale[axis] == 0) continue;
+
+            double right_area[kBins];
+            uint32_t right_count[kBins];
+            Extent sweep;
+            uint32_t count = 0;
+            for (size_t k = kBins - 1; k > 0; k--) {
+                sweep.expand(bin_extent[axis][k]);
+                count += bin_count[axis][k];
+                right_area[k] = sweep.area();
+                right_count[k] = count;
+            }
+
+            sweep = Extent();
+            count = 0;
+            for (size_t k = 1; k < kBins; k++) {
+                sweep.expand(bin_extent[axis][k - 1]);
+                count += bin_count[axis][k - 1];
+                double cost = count * sweep.area() + right_count[k] * right_area[k];
+                if (count > 0 && right_count[k] > 0 && cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = k;
+                }
+            }
+        }
+    }
+
+    if (best_axis >= 0) {
+        auto it = std::partition(order.begin() + begin, order.begin() + end,
+                                 [&](const BuildItem& item) { return bin(item, best_axis) < best_bin; });
+        mid = static_cast<uint32_t>(it - order.begin());
+    } else {
+        // Too deep or all centroids coincide: median on the widest axis
+        int axis = 0;
+        for (int a = 1; a < 3; a++) {
+            if (centroids.hi[a] - centroids.lo[a] > centroids.hi[axis] - centroids.lo[axis]) axis = a;
+        }
+        mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [&](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+    }
+
+    n.leaf = false;
+    n.first = next_node.fetch_add(2);
+    n.count = 0;
+    return true;
+}
+
+void FaceBvh::subdivide(std::vector<BuildItem>& order, uint32_t node, uint32_t begin, uint32_t end, uint32_t depth,
+                        std::atomic<uint32_t>& next_node) {
+    uint32_t mid;
+    if (!split(order, node, begin, end, depth, mid, next_node)) return;
+
+    uint32_t child = nodes[node].first;
+    subdivide(order, child, begin, mid, depth + 1, next_node);
+    subdivide(order, child + 1, mid, end, depth + 1, next_node);
+}
+
+void FaceBvh::build(const WingedEdgeKernel& kernel) {
+    if (kernel.isFrozen()) throw std::logic_error("FaceBvh::build: kernel is frozen");
+    source = &kernel;
+    loop_limit = kernel.getEdgeCount() + 1;
+    seen_stamp = kernel.getChangeStamp();
+    epoch++;
+
+    const auto& faces = kernel.getFaces();
+    int max_id = -1;
+    for (const auto& f : faces) max_id = std::max(max_id, f->id);
+    entries.assign(static_cast<size_t>(max_id + 1), FaceEntry());
+
+    const size_t threads = resolveThreadCount(thread_count);
+    std::vector<BuildItem> order(faces.size());
+    parallelFor(faces.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Face& f = *faces[i];
+            FaceEntry& entry = entries[f.id];
+            entry.face = &f;
+            entry.box = faceBox(f);
+            entry.epoch = epoch;
+
+            BuildItem& item = order[i];
+            const Point3D c = center(entry.box);
+            item.extent.lo[0] = entry.box.min.x;
+            item.extent.lo[1] = entry.box.min.y;
+            item.extent.lo[2] = entry.box.min.z;
+            item.extent.hi[0] = entry.box.max.x;
+            item.extent.hi[1] = entry.box.max.y;
+            item.extent.hi[2] = entry.box.max.z;
+            item.centroid[0] = c.x;
+            item.centroid[1] = c.y;
+            item.centroid[2] = c.z;
+            item.id = f.id;
+        }
+    }, 1024);
+
+    // A binary tree over n faces never needs more than 2n - 1 nodes
+    nodes.assign(std::max<size_t>(1, 2 * faces.size()), Node());
+    std::atomic<uint32_t> next_node{1};
+
+    // Split the top levels here until every worker has a subtree
+    struct Task {
+        uint32_t node, begin, end, depth;
+    };
+    std::vector<Task> tasks{{0, 0, static_cast<uint32_t>(order.size()), 0}};
+    bool progress = threads > 1;
+    while (progress && tasks.size() < 4 * threads) {
+        progress = false;
+        std::vector<Task> next;
+        for (const Task& t : tasks) {
+            uint32_t mid;
+            if (t.end - t.begin >= 2 * kParallelGrain &&
+                split(order, t.node, t.begin, t.end, t.depth, mid, next_node)) {
+                uint32_t child = nodes[t.node].first;
+                next.push_back({child, t.begin, mid, t.depth + 1});
+                next.push_back({child + 1, mid, t.end, t.depth + 1});
+                progress = true;
+            } else {
+                next.push_back(t);
+            }
+        }
+        tasks.swap(next);
+    }
+
+    parallelFor(tasks.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            subdivide(order, tasks[i].node, tasks[i].begin, tasks[i].end, tasks[i].depth, next_node);
+        }
+    }, 1);
+    nodes.resize(next_node.load());
+
+    // Lay the leaves out with spare slots so refit() can insert in place
+    items.clear();
+    items.reserve(faces.size() + kLeafSlack * nodes.size());
+    for (uint32_t n = 0; n < nodes.size(); n++) {
+        Node& node = nodes[n];
+        if (!node.leaf) continue;
+
+        const uint32_t begin = node.first;
+        node.first = static_cast<uint32_t>(items.size());
+        node.capacity = node.count + kLeafSlack;
+        for (uint32_t k = 0; k < node.count; k++) {
+            const int id = order[begin + k].id;
+            entries[id].leaf = n;
+            entries[id].item = node.first + k;
+            items.push_back(id);
+        }
+        items.resize(items.size() + kLeafSlack, -1);
+    }
+
+    node_dirty.assign(nodes.size(), 0);
+    live_count = built_count = faces.size();
+    inserted_since_build = 0;
+}
+
+// ==================== REFIT ====================
+
+bool FaceBvh::insert(int id) {
+    FaceEntry& entry = entries[id];
+
+    // Descend towards the child whose surface area grows least
+    uint32_t n = 0;
+    while (!nodes[n].leaf) {
+        nodes[n].box.expand(entry.box);
+        const uint32_t child = nodes[n].first;
+        auto growth = [&](uint32_t c) {
+            BoundingBox grown = nodes[c].box;
+            grown.expand(entry.box);
+            return surfaceArea(grown) - surfaceArea(nodes[c].box);
+        };
+        n = growth(child) <= growth(child + 1) ? child : child + 1;
+    }
+
+    Node& leaf = nodes[n];
+    if (leaf.count == leaf.capacity) return false;
+
+    entry.leaf = n;
+    entry.item = leaf.first + leaf.count++;
+    items[entry.item] = id;
+    node_dirty[n] = 1;
+    live_count++;
+    return true;
+}
+
+void FaceBvh::remove(FaceEntry& entry) {
+    Node& leaf = nodes[entry.leaf];
+    const uint32_t last = leaf.first + --leaf.count;
+    const int moved = items[last];
+
+    items[entry.item] = moved;
+    entries[moved].item = entry.item;
+    items[last] = -1;
+    node_dirty[entry.leaf] = 1;
+
+    entry.leaf = entry.item = kNone;
+    live_count--;
+}
+
+void FaceBvh::refitNodes() {
+    // Children follow their parent, so one backwards pass sees them first
+    for (size_t n = nodes.size(); n-- > 0;) {
+        Node& node = nodes[n];
+        if (node.leaf) {
+            if (!node_dirty[n]) continue;
+            node.box = BoundingBox();
+            for (uint32_t k = 0; k < node.count; k++) node.box.expand(entries[items[node.first + k]].box);
+        } else {
+            if (!node_dirty[node.first] && !node_dirty[node.first + 1]) continue;
+            node_dirty[n] = 1;
+            node.box = nodes[node.first].box;
+            node.box.expand(nodes[node.first + 1].box);
+        }
+    }
+    std::fill(node_dirty.begin(), node_dirty.end(), 0);
+}
+
+FaceBvh::RefitStats FaceBvh::refit(const WingedEdgeKernel& kernel) {
+    if (kernel.isFrozen()) throw std::logic_error("FaceBvh::refit: kernel is frozen");
+    RefitStats stats;
+    if (source != &kernel || nodes.empty()) {
+        build(kernel);
+        stats.rebuilt = true;
+        return stats;
+    }
+
+    // Every edit hands out a stamp, killing faces included
+    const uint64_t since = seen_stamp;
+    if (kernel.getChangeStamp() == since) return stats;
+    seen_stamp = kernel.getChangeStamp();
+    loop_limit = kernel.getEdgeCount() + 1;
+    epoch++;
+
+    const auto& faces = kernel.getFaces();
+    int max_id = -1;
+    for (const auto& f : faces) max_id = std::max(max_id, f->id);
+    if (entries.size() < static_cast<size_t>(max_id + 1)) entries.resize(static_cast<size_t>(max_id + 1));
+
+    // Faces own distinct entries; what changed is gathered per chunk
+    const size_t threads = resolveThreadCount(thread_count);
+    std::vector<int> changed, added;
+    std::mutex merge;
+    auto gather = [&](std::vector<int>& local_changed, std::vector<int>& local_added) {
+        if (local_changed.empty() && local_added.empty()) return;
+        std::lock_guard<std::mutex> lock(merge);
+        changed.insert(changed.end(), local_changed.begin(), local_changed.end());
+        added.insert(added.end(), local_added.begin(), local_added.end());
+    };
+
+    parallelFor(faces.size(), threads, [&](size_t begin, size_t end) {
+        std::vector<int> local_changed, local_added;
+        for (size_t i = begin; i < end; i++) {
+            const Face& f = *faces[i];
+            FaceEntry& entry = entries[f.id];
+            entry.epoch = epoch;
+            if (entry.face == &f && entry.leaf != kNone) {
+                if (kernel.getFaceStamp(f.id) > since) local_changed.push_back(f.id);
+            } else {
+                entry.face = &f; // A reused ID keeps its old slot until removed below
+                local_added.push_back(f.id);
+            }
+        }
+        gather(local_changed, local_added);
+    }, 4096);
+
+    // A moved vertex dirties the faces around it
+    const auto& vertices = kernel.getVertices();
+    parallelFor(vertices.size(), threads, [&](size_t begin, size_t end) {
+        std::vector<int> local_changed, none;
+        for (size_t i = begin; i < end; i++) {
+            if (kernel.getVertexStamp(vertices[i]->id) <= since) continue;
+            for (const auto& e : kernel.vertexEdges(vertices[i])) {
+                if (e->f1) local_changed.push_back(e->f1->id);
+                if (e->f2) local_changed.push_back(e->f2->id);
+            }
+        }
+        gather(local_changed, none);
+    }, 4096);
+
+    for (int id : added) {
+        if (entries[id].leaf == kNone) continue;
+        remove(entries[id]);
+        stats.removed++;
+    }
+
+    // More faces in the tree than alive and not yet inserted: some were killed
+    if (live_count > faces.size() - added.size()) {
+        for (uint32_t n = 0; n < nodes.size(); n++) {
+            const Node& node = nodes[n];
+            if (!node.leaf) continue;
+            for (uint32_t k = node.count; k-- > 0;) {
+                FaceEntry& entry = entries[items[node.first + k]];
+                if (entry.epoch == epoch) continue;
+                remove(entry);
+                entry.face = nullptr;
+                stats.removed++;
+            }
+        }
+    }
+
+    // Only faces still in place are refit; added ones get their box below
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    changed.erase(std::remove_if(changed.begin(), changed.end(), [&](int id) {
+        return entries[id].leaf == kNone || entries[id].epoch != epoch;
+    }), changed.end());
+    changed.insert(changed.end(), added.begin(), added.end());
+
+    parallelFor(changed.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            FaceEntry& entry = entries[changed[i]];
+            entry.box = faceBox(*entry.face);
+        }
+    }, 1024);
+    stats.refit = changed.size() - added.size();
+
+    for (size_t i = 0; i < stats.refit; i++) node_dirty[entries[changed[i]].leaf] = 1;
+
+    inserted_since_build += added.size();
+    if (inserted_since_build > std::max<size_t>(kLeafSize, built_count / 4)) {
+        build(kernel);
+        stats.rebuilt = true;
+        return stats;
+    }
+    for (int id : added) {
+        if (!insert(id)) {
+            build(kernel);
+            stats.rebuilt = true;
+            return stats;
+        }
+        stats.inserted++;
+    }
+
+    refitNodes();
+    return stats;
+}
+
+// ==================== QUERIES ====================
+
+bool FaceBvh::raycast(const Ray& ray, FaceHit& hit, double max_distance) const {
+    if (nodes.empty()) return false;
+
+    const Vec3 inverse(1.0 / ray.direction.x, 1.0 / ray.direction.y, 1.0 / ray.direction.z);
+    double best = max_distance;
+    int best_id = -1;
+
+    std::vector<std::pair<uint32_t, double>> stack;
+    std::vector<Point3D> loop;
+    double enter;
+    if (slab(nodes[0].box, ray, inverse, best, enter)) stack.emplace_back(0, enter);
+
+    while (!stack.empty()) {
+        auto [n, t] = stack.back();
+        stack.pop_back();
+        if (t > best) continue;
+
+        const Node& node = nodes[n];
+        if (node.leaf) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const int id = items[node.first + k];
+                gatherLoop(*entries[id].face, loop_limit, loop);
+                double t_hit;
+                if (intersectFace(loop, ray, best, t_hit)) {
+                    best = t_hit;
+                    best_id = id;
+                }
+            }
+            continue;
+        }
+
+        // Push the nearer child last so it is visited first
+        double t_left, t_right;
+        bool left = slab(nodes[node.first].box, ray, inverse, best, t_left);
+        bool right = slab(nodes[node.first + 1].box, ray, inverse, best, t_right);
+        if (left && right && t_left < t_right) {
+            stack.emplace_back(node.first + 1, t_right);
+            stack.emplace_back(node.first, t_left);
+        } else {
+            if (left) stack.emplace_back(node.first, t_left);
+            if (right) stack.emplace_back(node.first + 1, t_right);
+        }
+    }
+
+    if (best_id < 0) return false;
+    hit.face_id = best_id;
+    hit.distance = best;
+    hit.point = ray.origin + ray.direction * best;
+    return true;
+}
+
+void FaceBvh::queryBox(const BoundingBox& box, std::vector<int>& face_ids) const {
+    if (nodes.empty() || box.empty()) return;
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps(node.box, box)) continue;
+
+        if (node.leaf) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const int id = items[node.first + k];
+                if (overlaps(entries[id].box, box)) face_ids.push_back(id);
+            }
+        } else {
+            stack.push_back(node.first + 1);
+            stack.push_back(node.first);
+        }
+    }
+}
+
+bool FaceBvh::nearest(const Point3D& p, FaceHit& hit, double max_distance) const {
+    if (nodes.empty()) return false;
+
+    double best = max_distance;
+    int best_id = -1;
+    Point3D best_point;
+
+    std::vector<std::pair<uint32_t, double>> stack{{0, std::sqrt(distanceSquared(nodes[0].box, p))}};
+    std::vector<Point3D> loop;
+    while (!stack.empty()) {
+        auto [n, d] = stack.back();
+        stack.pop_back();
+        if (d >= best) continue;
+
+        const Node& node = nodes[n];
+        if (node.leaf) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const int id = items[node.first + k];
+                if (std::sqrt(distanceSquared(entries[id].box, p)) >= best) continue;
+                gatherLoop(*entries[id].face, loop_limit, loop);
+                Point3D closest;
+                double distance = closestOnFace(loop, p, closest);
+                if (distance < best) {
+                    best = distance;
+                    best_id = id;
+                    best_point = closest;
+                }
+            }
+            continue;
+        }
+
+        double d_left = std::sqrt(distanceSquared(nodes[node.first].box, p));
+        double d_right = std::sqrt(distanceSquared(nodes[node.first + 1].box, p));
+        if (d_left < d_right) {
+            stack.emplace_back(node.first + 1, d_right);
+            stack.emplace_back(node.first, d_left);
+        } else {
+            stack.emplace_back(node.first, d_left);
+            stack.emplace_back(node.first + 1, d_right);
+        }
+    }
+
+    if (best_id < 0) return false;
+    hit.face_id = best_id;
+    hit.distance = best;
+    hit.point = best_point;
+    return true;
+}
+
+} // namespace SketchyKernel
@@ -0,0 +1,144 @@
+#ifndef SKETCHY_KERNEL_FACE_BVH_H
+#define SKETCHY_KERNEL_FACE_BVH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "geometry.h"
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+struct Face;
+
+/**
+ * Half-line origin + t * direction, t >= 0. The direction need not be unit
+ * length; hit distances are then in units of t.
+ */
+struct Ray {
+    Point3D origin;
+    Vec3 direction;
+};
+
+struct FaceHit {
+    int face_id = -1;
+    double distance = std::numeric_limits<double>::infinity();
+    Point3D point;
+};
+
+/**
+ * Bounding volume hierarchy over the faces of a kernel, for picking,
+ * snapping and ray casts.
+ *
+ * build() sorts face bounding boxes into a binary tree with binned SAH
+ * splits; the upper levels are split serially and the subtrees below them
+ * built in parallel. refit() brings the tree up to date after edits without
+ * rebuilding. Faces whose change stamp, or a vertex's, is newer than the
+ * last pass get a new box; the stamps find them without walking every
+ * loop. New faces are inserted into the leaf their box grows least, killed
+ * faces leave their leaf, and only the touched paths to the root are refit.
+ * When insertions outgrow the spare leaf slots, or exceed a quarter of the
+ * faces since the last build, refit() rebuilds instead.
+ *
+ * Faces are treated as planar polygons. Queries read the face loops
+ * directly, so call refit() after editing the kernel and before querying.
+ * Concurrent queries are safe.
+ */
+class FaceBvh {
+public:
+    struct RefitStats {
+        size_t refit = 0;     // existing faces given a new box
+        size_t inserted = 0;
+        size_t removed = 0;
+        bool rebuilt = false;
+    };
+
+    /**
+     * Build from scratch over every face of the kernel
+     * @throws std::logic_error if the kernel is frozen
+     */
+    void build(const WingedEdgeKernel& kernel);
+
+    /**
+     * Catch up with the kernel's edits since the last build() or refit().
+     * Builds when the hierarchy follows another kernel, or none yet.
+     * @throws std::logic_error if the kernel is frozen
+     */
+    RefitStats refit(const WingedEdgeKernel& kernel);
+
+    /**
+     * Closest face hit by the ray within max_distance
+     */
+    bool raycast(const Ray& ray, FaceHit& hit,
+                 double max_distance = std::numeric_limits<double>::infinity()) const;
+
+    /**
+     * Append the IDs of faces whose bounding box overlaps the box
+     */
+    void queryBox(const BoundingBox& box, std::vector<int>& face_ids) const;
+
+    /**
+     * Closest point on any face to p within max_distance
+     */
+    bool nearest(const Point3D& p, FaceHit& hit,
+                 double max_distance = std::numeric_limits<double>::infinity()) const;
+
+    size_t getFaceCount() const { return live_count; }
+    size_t getNodeCount() const { return nodes.size(); }
+    BoundingBox getBounds() const { return nodes.empty() ? BoundingBox() : nodes[0].box; }
+
+    /**
+     * @see WingedEdgeKernel::setThreadCount
+     */
+    void setThreadCount(size_t count) { thread_count = count; }
+
+private:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        BoundingBox box;
+        uint32_t first = 0;    // leaf: first item slot; interior: left child, right is first + 1
+        uint32_t count = 0;    // leaf: items in use
+        uint32_t capacity = 0; // leaf: item slots owned
+        bool leaf = false;
+    };
+
+    struct FaceEntry {
+        const Face* face = nullptr;
+        uint64_t epoch = 0;    // last refit that saw the face alive
+        uint32_t leaf = kNone;
+        uint32_t item = kNone;
+        BoundingBox box;
+    };
+
+    const WingedEdgeKernel* source = nullptr;
+    std::vector<FaceEntry> entries; // by face ID
+    std::vector<Node> nodes;        // children always follow their parent
+    std::vector<int> items;         // face IDs by leaf slot, -1 when free
+    std::vector<uint8_t> node_dirty;
+
+    size_t loop_limit = 0;          // bound for face loop walks
+    uint64_t seen_stamp = 0;        // kernel change stamp at the last build / refit
+    uint64_t epoch = 0;
+    size_t live_count = 0;
+    size_t built_count = 0;
+    size_t inserted_since_build = 0;
+    size_t thread_count = 0;
+
+    struct BuildItem;
+
+    BoundingBox faceBox(const Face& face) const;
+    bool split(std::vector<BuildItem>& order, uint32_t node, uint32_t begin, uint32_t end, uint32_t depth,
+               uint32_t& mid, std::atomic<uint32_t>& next_node);
+    void subdivide(std::vector<BuildItem>& order, uint32_t node, uint32_t begin, uint32_t end, uint32_t depth,
+                   std::atomic<uint32_t>& next_node);
+    bool insert(int id);
+    void remove(FaceEntry& entry);
+    void refitNodes();
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_FACE_BVH_H
@@ -0,0 +1,348 @@
+#include "face_intersection.h"
+#include "winged_edge.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SKETCHY_HAVE_AVX2_KERNEL 1
+#endif
+
+namespace SketchyKernel {
+
+namespace {
+
+constexpr size_t kFaceGrain = 256;        // Faces of A per claimed chunk, at least
+constexpr double kParallelSine = 1e-12;   // |n_a x n_b| below this: planes treated as parallel
+
+// Above / below bits returned by classify()
+constexpr unsigned kAbove = 1;
+constexpr unsigned kBelow = 2;
+
+/**
+ * Face loops as coordinate columns, so the narrow phase reads them without
+ * chasing element pointers. Loop position k holds the vertex the k-th edge
+ * starts at, as in WingedEdgeKernel::faceVertices().
+ */
+struct PolygonSet {
+    std::vector<size_t> offsets;  // loop i: [offsets[i], offsets[i + 1])
+    std::vector<double> x, y, z;
+    std::vector<int> edge_ids;
+    std::vector<int> face_ids;
+    std::vector<double> planes;   // 4 per loop: unit normal, then w with n . p = w
+    std::vector<int> index_of;    // face ID -> loop, -1 for none
+
+    size_t size() const { return face_ids.size(); }
+    size_t loopSize(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    BoundingBox box(size_t i, double margin) const {
+        double lo[3] = {x[offsets[i]], y[offsets[i]], z[offsets[i]]};
+        double hi[3] = {lo[0], lo[1], lo[2]};
+        for (size_t k = offsets[i] + 1; k < offsets[i + 1]; k++) {
+            const double p[3] = {x[k], y[k], z[k]};
+            for (int axis = 0; axis < 3; axis++) {
+                lo[axis] = p[axis] < lo[axis] ? p[axis] : lo[axis];
+                hi[axis] = p[axis] > hi[axis] ? p[axis] : hi[axis];
+            }
+        }
+        BoundingBox b;
+        b.min = Vec3(lo[0] - margin, lo[1] - margin, lo[2] - margin);
+        b.max = Vec3(hi[0] + margin, hi[1] + margin, hi[2] + margin);
+        return b;
+    }
+};
+
+PolygonSet gatherPolygons(const WingedEdgeKernel& kernel, size_t threads) {
+    const auto& faces = kernel.getFaces();
+    PolygonSet set;
+    set.face_ids.resize(faces.size());
+    set.offsets.assign(faces.size() + 1, 0);
+    set.planes.assign(4 * faces.size(), 0.0);
+
+    // Loop sizes, then a prefix sum for the column offsets
+    parallelFor(faces.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            size_t n = 0;
+            for ([[maybe_unused]] const auto& e : kernel.faceEdges(faces[i])) n++;
+            set.offsets[i + 1] = n;
+            set.face_ids[i] = faces[i]->id;
+        }
+    });
+    for (size_t i = 0; i < faces.size(); i++) set.offsets[i + 1] += set.offsets[i];
+
+    const size_t corners = set.offsets.back();
+    set.x.resize(corners);
+    set.y.resize(corners);
+    set.z.resize(corners);
+    set.edge_ids.resize(corners);
+
+    parallelFor(faces.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const size_t first = set.offsets[i], n = set.offsets[i + 1] - first;
+            size_t k = first;
+            for (const auto& v : kernel.faceVertices(faces[i])) {
+                set.x[k] = v->coords.x;
+                set.y[k] = v->coords.y;
+                set.z[k] = v->coords.z;
+                k++;
+            }
+
+            // The circulator pairs edge k with the corner it shares with
+            // edge k + 1, so the side from corner k to corner k + 1 is edge k + 1
+            size_t side = n - 1;
+            for (const auto& e : kernel.faceEdges(faces[i])) {
+                set.edge_ids[first + side] = e->id;
+                side = (side + 1) % n;
+            }
+
+            // Newell normal and mean corner, in plain doubles for the inner loop
+            double nx = 0, ny = 0, nz = 0, cx = 0, cy = 0, cz = 0;
+            for (size_t c = 0; c < n; c++) {
+                const size_t p = first + c, q = first + (c + 1) % n;
+                nx += (set.y[p] - set.y[q]) * (set.z[p] + set.z[q]);
+                ny += (set.z[p] - set.z[q]) * (set.x[p] + set.x[q]);
+                nz += (set.x[p] - set.x[q]) * (set.y[p] + set.y[q]);
+                cx += set.x[p];
+                cy += set.y[p];
+                cz += set.z[p];
+            }
+            const double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+            if (n < 3 || length == 0) continue; // Degenerate: the zero plane rejects every pair
+            double* plane = &set.planes[4 * i];
+            plane[0] = nx / length;
+            plane[1] = ny / length;
+            plane[2] = nz / length;
+            plane[3] = (plane[0] * cx + plane[1] * cy + plane[2] * cz) / static_cast<double>(n);
+        }
+    });
+
+    int max_id = 0;
+    for (int id : set.face_ids) max_id = std::max(max_id, id);
+    set.index_of.assign(static_cast<size_t>(max_id) + 1, -1);
+    for (size_t i = 0; i < set.size(); i++) set.index_of[set.face_ids[i]] = static_cast<int>(i);
+    return set;
+}
+
+/**
+ * Signed distances of n loop corners to a plane, with distances within eps
+ * snapped to exactly 0. Returns kAbove / kBelow for corners beyond eps.
+ */
+unsigned classifyScalar(const double* x, const double* y, const double* z, size_t n, const double* plane,
+                        double eps, double* d) {
+    unsigned sides = 0;
+    for (size_t k = 0; k < n; k++) {
+        const double distance = plane[0] * x[k] + plane[1] * y[k] + plane[2] * z[k] - plane[3];
+        const bool above = distance > eps, below = distance < -eps;
+        d[k] = above || below ? distance : 0.0;
+        sides |= (above ? kAbove : 0) | (below ? kBelow : 0);
+    }
+    return sides;
+}
+
+#if defined(SKETCHY_HAVE_AVX2_KERNEL)
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+
+// Four corners per step; the tail goes through the scalar loop
+__attribute__((target("avx2,fma")))
+unsigned classifyAvx2(const double* x, const double* y, const double* z, size_t n, const double* plane,
+                      double eps, double* d) {
+    const __m256d nx = _mm256_set1_pd(plane[0]);
+    const __m256d ny = _mm256_set1_pd(plane[1]);
+    const __m256d nz = _mm256_set1_pd(plane[2]);
+    const __m256d w = _mm256_set1_pd(plane[3]);
+    const __m256d hi = _mm256_set1_pd(eps);
+    const __m256d lo = _mm256_set1_pd(-eps);
+
+    int above = 0, below = 0;
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d distance = _mm256_fmsub_pd(nx, _mm256_loadu_pd(x + k), w);
+        distance = _mm256_fmadd_pd(ny, _mm256_loadu_pd(y + k), distance);
+        distance = _mm256_fmadd_pd(nz, _mm256_loadu_pd(z + k), distance);
+
+        const __m256d is_above = _mm256_cmp_pd(distance, hi, _CMP_GT_OQ);
+        const __m256d is_below = _mm256_cmp_pd(distance, lo, _CMP_LT_OQ);
+        _mm256_storeu_pd(d + k, _mm256_and_pd(distance, _mm256_or_pd(is_above, is_below)));
+        above |= _mm256_movemask_pd(is_above);
+        below |= _mm256_movemask_pd(is_below);
+    }
+    unsigned sides = (above ? kAbove : 0) | (below ? kBelow : 0);
+    return sides | classifyScalar(x + k, y + k, z + k, n - k, plane, eps, d + k);
+}
+
+#endif
+
+unsigned classify(const PolygonSet& set, size_t i, const double* plane, double eps, double* d) {
+    const size_t first = set.offsets[i], n = set.loopSize(i);
+#if defined(SKETCHY_HAVE_AVX2_KERNEL)
+    if (n >= 4 && cpuHasAvx2()) {
+        return classifyAvx2(&set.x[first], &set.y[first], &set.z[first], n, plane, eps, d);
+    }
+#endif
+    return classifyScalar(&set.x[first], &set.y[first], &set.z[first], n, plane, eps, d);
+}
+
+// Where a loop edge crosses the other face's plane, at t along the line
+struct Crossing {
+    double t;
+    double p[3];
+    int edge_id;
+};
+
+/**
+ * Crossings of loop i with the plane its distances d were taken to, sorted
+ * along dir. A corner at distance 0 counts as above, so every crossing is a
+ * change between below and not below and they pair up into the intervals
+ * where the loop's inside meets the line.
+ */
+void crossings(const PolygonSet& set, size_t i, const double* d, const double* dir, std::vector<Crossing>& out) {
+    out.clear();
+    const size_t first = set.offsets[i], n = set.loopSize(i);
+    for (size_t k = 0; k < n; k++) {
+        const size_t j = k + 1 == n ? 0 : k + 1;
+        if ((d[k] < 0) == (d[j] < 0)) continue;
+
+        const double s = d[k] / (d[k] - d[j]);
+        const size_t p = first + k, q = first + j;
+        Crossing c;
+        c.p[0] = set.x[p] + s * (set.x[q] - set.x[p]);
+        c.p[1] = set.y[p] + s * (set.y[q] - set.y[p]);
+        c.p[2] = set.z[p] + s * (set.z[q] - set.z[p]);
+        c.t = dir[0] * c.p[0] + dir[1] * c.p[1] + dir[2] * c.p[2];
+        c.edge_id = set.edge_ids[p];
+        out.push_back(c);
+    }
+    std::sort(out.begin(), out.end(), [](const Crossing& a, const Crossing& b) { return a.t < b.t; });
+}
+
+SegmentEnd endAt(const Crossing& c, Operand edge_of) {
+    SegmentEnd end;
+    end.point = Point3D(c.p[0], c.p[1], c.p[2]);
+    end.edge_id = c.edge_id;
+    end.edge_of = edge_of;
+    return end;
+}
+
+// Reused across the pairs of one chunk
+struct Scratch {
+    std::vector<double> da, db;
+    std::vector<Crossing> ca, cb;
+    std::vector<int> candidates;
+};
+
+/**
+ * Narrow phase for loop ia of A against loop ib of B
+ * @return false when a plane test rejected the pair
+ */
+bool intersectPair(const PolygonSet& a, size_t ia, const PolygonSet& b, size_t ib, double eps, Scratch& scratch,
+                   std::vector<IntersectionSegment>& out) {
+    const double* plane_a = &a.planes[4 * ia];
+    const double* plane_b = &b.planes[4 * ib];
+
+    scratch.da.resize(a.loopSize(ia));
+    scratch.db.resize(b.loopSize(ib));
+    if (classify(a, ia, plane_b, eps, scratch.da.data()) != (kAbove | kBelow)) return false;
+    if (classify(b, ib, plane_a, eps, scratch.db.data()) != (kAbove | kBelow)) return false;
+
+    double dir[3] = {plane_a[1] * plane_b[2] - plane_a[2] * plane_b[1],
+                     plane_a[2] * plane_b[0] - plane_a[0] * plane_b[2],
+                     plane_a[0] * plane_b[1] - plane_a[1] * plane_b[0]};
+    const double sine = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    if (sine < kParallelSine) return true; // Straddling but parallel: only within the tolerance
+    for (double& c : dir) c /= sine;
+
+    crossings(a, ia, scratch.da.data(), dir, scratch.ca);
+    crossings(b, ib, scratch.db.data(), dir, scratch.cb);
+
+    // Overlaps of A's intervals with B's, both sorted along the line
+    const auto& ca = scratch.ca;
+    const auto& cb = scratch.cb;
+    for (size_t i = 0, j = 0; i + 1 < ca.size() && j + 1 < cb.size();) {
+        const Crossing& a_lo = ca[i];
+        const Crossing& a_hi = ca[i + 1];
+        const Crossing& b_lo = cb[j];
+        const Crossing& b_hi = cb[j + 1];
+
+        const double lo = std::max(a_lo.t, b_lo.t);
+        const double hi = std::min(a_hi.t, b_hi.t);
+        if (hi - lo > eps) {
+            IntersectionSegment segment;
+            segment.face_a = a.face_ids[ia];
+            segment.face_b = b.face_ids[ib];
+            segment.start = a_lo.t >= b_lo.t ? endAt(a_lo, Operand::A) : endAt(b_lo, Operand::B);
+            segment.end = a_hi.t <= b_hi.t ? endAt(a_hi, Operand::A) : endAt(b_hi, Operand::B);
+            out.push_back(segment);
+        }
+        if (a_hi.t < b_hi.t) {
+            i += 2;
+        } else {
+            j += 2;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void FaceIntersector::setTolerance(double distance) {
+    if (!(distance >= 0)) throw std::invalid_argument("FaceIntersector::setTolerance: distance must be >= 0");
+    tolerance = distance;
+}
+
+std::vector<IntersectionSegment> FaceIntersector::intersect(const WingedEdgeKernel& a, const WingedEdgeKernel& b) {
+    if (&a == &b) throw std::invalid_argument("FaceIntersector::intersect: a and b must be different kernels");
+    if (a.isFrozen() || b.isFrozen()) throw std::logic_error("FaceIntersector::intersect: kernel is frozen");
+
+    const size_t threads = resolveThreadCount(thread_count);
+    tree.refit(b);
+    const PolygonSet polygons_a = gatherPolygons(a, threads);
+    const PolygonSet polygons_b = gatherPolygons(b, threads);
+
+    std::vector<IntersectionSegment> result;
+    Stats totals;
+    std::mutex result_mutex;
+    const double eps = tolerance;
+
+    parallelFor(polygons_a.size(), threads, [&](size_t begin, size_t end) {
+        Scratch scratch;
+        Stats local;
+        std::vector<IntersectionSegment> found;
+
+        for (size_t ia = begin; ia < end; ia++) {
+            scratch.candidates.clear();
+            tree.queryBox(polygons_a.box(ia, eps), scratch.candidates);
+            for (int id : scratch.candidates) {
+                const int ib = id >= 0 && static_cast<size_t>(id) < polygons_b.index_of.size()
+                                   ? polygons_b.index_of[id] : -1;
+                if (ib < 0) continue;
+                local.candidate_pairs++;
+                if (!intersectPair(polygons_a, ia, polygons_b, static_cast<size_t>(ib), eps, scratch, found)) {
+                    local.plane_rejects++;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result.insert(result.end(), found.begin(), found.end());
+        totals.candidate_pairs += local.candidate_pairs;
+        totals.plane_rejects += local.plane_rejects;
+    }, kFaceGrain);
+
+    // Chunks finish in any order; segments of one pair are already in line order
+    std::stable_sort(result.begin(), result.end(), [](const IntersectionSegment& x, const IntersectionSegment& y) {
+        return x.face_a != y.face_a ? x.face_a < y.face_a : x.face_b < y.face_b;
+    });
+
+    totals.segments = result.size();
+    stats = totals;
+    return result;
+}
+
+} // namespace SketchyKernel
@@ -0,0 +1,113 @@
+#ifndef SKETCHY_KERNEL_FACE_INTERSECTION_H
+#define SKETCHY_KERNEL_FACE_INTERSECTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "face_bvh.h"
+#include "geometry.h"
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+
+// The two solids handed to FaceIntersector::intersect()
+enum class Operand : uint8_t {
+    A,
+    B
+};
+
+/**
+ * One end of an intersection segment: where an edge of one operand crosses
+ * the face of the other
+ */
+struct SegmentEnd {
+    Point3D point;
+    int edge_id = -1;
+    Operand edge_of = Operand::A;
+};
+
+/**
+ * Stretch of the line where face_a (of A) and face_b (of B) meet that lies
+ * inside both faces. It runs from start to end along
+ * normal(face_a) x normal(face_b).
+ */
+struct IntersectionSegment {
+    int face_a = -1;
+    int face_b = -1;
+    SegmentEnd start;
+    SegmentEnd end;
+};
+
+/**
+ * Face-face intersection between two solids; the first stage of Booleans
+ * and clash detection.
+ *
+ * Broad phase: the box of every face of A is looked up in a FaceBvh over B.
+ * The tree is kept between calls and refit, so checking against a B that is
+ * being edited only redoes what changed.
+ *
+ * Narrow phase, per candidate pair: each loop is classified against the
+ * other face's plane (Newell normal), four vertices at a time with AVX2
+ * where the CPU has it. A pair is rejected when either loop lies entirely
+ * on one side. Otherwise both loops are cut by the line where the planes
+ * meet; each loop crosses it in a set of intervals, so non-convex faces
+ * work, and the segments are where A's intervals overlap B's.
+ *
+ * Faces of A are split into chunks that idle workers claim as they finish,
+ * which keeps them busy when the candidates bunch up in one region. The
+ * result is sorted by (face_a, face_b) and then along the line, so it does
+ * not depend on the thread count.
+ *
+ * Limits: faces are treated as planar, and only each face's own loop
+ * (Face::edge) is used. Coplanar and parallel pairs give no segments;
+ * Booleans need a 2D overlap test for those. A vertex within the tolerance
+ * of a plane counts as above it, so contacts that touch without crossing
+ * give nothing; neither do overlaps shorter than the tolerance.
+ * A and B must be different kernels and must not be edited during a call.
+ */
+class FaceIntersector {
+public:
+    struct Stats {
+        size_t candidate_pairs = 0; // face pairs whose boxes overlap
+        size_t plane_rejects = 0;   // candidates with a loop on one side of the other plane
+        size_t segments = 0;
+    };
+
+    /**
+     * Every segment where a face of A meets a face of B
+     * @throws std::invalid_argument if a and b are the same kernel
+     * @throws std::logic_error if either kernel is frozen
+     */
+    std::vector<IntersectionSegment> intersect(const WingedEdgeKernel& a, const WingedEdgeKernel& b);
+
+    /**
+     * Counts from the last intersect()
+     */
+    const Stats& getLastStats() const { return stats; }
+
+    /**
+     * Distance within which a vertex counts as on a plane, in model units
+     * @throws std::invalid_argument if negative or not a number
+     */
+    void setTolerance(double distance);
+    double getTolerance() const { return tolerance; }
+
+    /**
+     * @see WingedEdgeKernel::setThreadCount
+     */
+    void setThreadCount(size_t count) {
+        thread_count = count;
+        tree.setThreadCount(count);
+    }
+
+private:
+    FaceBvh tree; // over B
+    Stats stats;
+    double tolerance = 1e-9;
+    size_t thread_count = 0;
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_FACE_INTERSECTION_H
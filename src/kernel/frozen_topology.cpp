@@ -0,0 +1,296 @@
+#include "frozen_topology.h"
+#include "winged_edge.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace SketchyKernel {
+
+namespace {
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+uint64_t readVarint(const uint8_t*& p) {
+    uint64_t v = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        v |= static_cast<uint64_t>(*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return v | (static_cast<uint64_t>(*p++) << shift);
+}
+
+// References are stored as ID + 1 so that "none" is 0
+template <typename T>
+int64_t storedRef(const std::shared_ptr<T>& element) {
+    return element ? static_cast<int64_t>(element->id) + 1 : 0;
+}
+
+int fromStoredRef(int64_t stored) {
+    return static_cast<int>(stored - 1);
+}
+
+} // namespace
+
+// ==================== PACKED RECORDS ====================
+
+void FrozenTopology::PackedRecords::append(const int64_t* record) {
+    if (count % kBlockRecords == 0) {
+        block_offsets.push_back(bytes.size());
+        block_ids.push_back(record[0]);
+        previous.assign(arity, 0);
+    }
+    for (size_t j = 0; j < arity; j++) {
+        int64_t prediction = (self_relative >> j) & 1 ? record[0] : previous[j];
+        writeVarint(bytes, zigzag(record[j] - prediction));
+    }
+    previous.assign(record, record + arity);
+    count++;
+}
+
+void FrozenTopology::PackedRecords::read(size_t index, int64_t* out) const {
+    const size_t block = index / kBlockRecords;
+    const uint8_t* p = bytes.data() + block_offsets[block];
+    std::fill(out, out + arity, 0);
+
+    // out holds the previous record while the next one is decoded in place
+    for (size_t r = block * kBlockRecords; r <= index; r++) {
+        for (size_t j = 0; j < arity; j++) {
+            int64_t prediction = (self_relative >> j) & 1 ? out[0] : out[j];
+            out[j] = prediction + unzigzag(readVarint(p));
+        }
+    }
+}
+
+long FrozenTopology::PackedRecords::find(int64_t id, int64_t* out) const {
+    auto head = std::upper_bound(block_ids.begin(), block_ids.end(), id);
+    if (head == block_ids.begin()) return -1;
+    const size_t block = static_cast<size_t>(head - block_ids.begin()) - 1;
+
+    const uint8_t* p = bytes.data() + block_offsets[block];
+    const size_t end = std::min(count, (block + 1) * kBlockRecords);
+    int64_t current[16] = {};
+    for (size_t r = block * kBlockRecords; r < end; r++) {
+        for (size_t j = 0; j < arity; j++) {
+            int64_t prediction = (self_relative >> j) & 1 ? current[0] : current[j];
+            current[j] = prediction + unzigzag(readVarint(p));
+        }
+        if (current[0] == id) {
+            if (out) std::copy(current, current + arity, out);
+            return static_cast<long>(r);
+        }
+        if (current[0] > id) break;
+    }
+    return -1;
+}
+
+void FrozenTopology::PackedRecords::finish() {
+    bytes.shrink_to_fit();
+    block_offsets.shrink_to_fit();
+    block_ids.shrink_to_fit();
+    previous = std::vector<int64_t>();
+}
+
+size_t FrozenTopology::PackedRecords::byteSize() const {
+    return bytes.capacity() + block_offsets.capacity() * sizeof(uint64_t) + block_ids.capacity() * sizeof(int64_t);
+}
+
+// ==================== ENCODING ====================
+
+FrozenTopology FrozenTopology::encode(const WingedEdgeKernel& kernel, const FreezeOptions& options) {
+    if (options.coordinate_bits < 8 || options.coordinate_bits > 32) {
+        throw std::invalid_argument("FrozenTopology::encode: coordinate_bits must be in [8, 32]");
+    }
+
+    // Records go out in ID order, so IDs and nearby references are small deltas
+    auto by_id = [](const auto& list) {
+        std::vector<uint32_t> order(list.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return list[a]->id < list[b]->id; });
+        return order;
+    };
+
+    FrozenTopology frozen;
+    const auto& vertices = kernel.getVertices();
+    const auto& edges = kernel.getEdges();
+    const auto& faces = kernel.getFaces();
+
+    // Quantization grid over the bounding box
+    Point3D low(0, 0, 0), high(0, 0, 0);
+    if (!vertices.empty()) {
+        low = high = vertices[0]->coords;
+        for (const auto& v : vertices) {
+            low = Point3D(std::min(low.x, v->coords.x), std::min(low.y, v->coords.y), std::min(low.z, v->coords.z));
+            high = Point3D(std::max(high.x, v->coords.x), std::max(high.y, v->coords.y), std::max(high.z, v->coords.z));
+        }
+    }
+    const double levels = static_cast<double>((uint64_t(1) << options.coordinate_bits) - 1);
+    frozen.origin = low;
+    frozen.step = Vec3((high.x - low.x) / levels, (high.y - low.y) / levels, (high.z - low.z) / levels);
+    auto quantize = [&](double value, double origin, double step) -> int64_t {
+        if (step <= 0) return 0;
+        return std::llround(std::min(std::max((value - origin) / step, 0.0), levels));
+    };
+
+    for (uint32_t i : by_id(vertices)) {
+        const Vertex& v = *vertices[i];
+        const int64_t record[5] = {v.id, quantize(v.coords.x, low.x, frozen.step.x),
+                                   quantize(v.coords.y, low.y, frozen.step.y),
+                                   quantize(v.coords.z, low.z, frozen.step.z), storedRef(v.edge)};
+        frozen.vertex_records.append(record);
+    }
+    for (uint32_t i : by_id(edges)) {
+        const Edge& e = *edges[i];
+        const int64_t record[9] = {e.id, storedRef(e.v1), storedRef(e.v2), storedRef(e.f1), storedRef(e.f2),
+                                   storedRef(e.p1_f1), storedRef(e.n1_f1), storedRef(e.p2_f2), storedRef(e.n2_f2)};
+        frozen.edge_records.append(record);
+    }
+    for (uint32_t i : by_id(faces)) {
+        const int64_t record[2] = {faces[i]->id, storedRef(faces[i]->edge)};
+        frozen.face_records.append(record);
+    }
+
+    frozen.vertex_records.finish();
+    frozen.edge_records.finish();
+    frozen.face_records.finish();
+    return frozen;
+}
+
+size_t FrozenTopology::byteSize() const {
+    return sizeof(*this) + vertex_records.byteSize() + edge_records.byteSize() + face_records.byteSize();
+}
+
+double FrozenTopology::getCoordinateStep() const {
+    return std::max(step.x, std::max(step.y, step.z));
+}
+
+// ==================== ELEMENTS ====================
+
+FrozenVertex FrozenTopology::vertexAt(size_t index) const {
+    int64_t r[5];
+    vertex_records.read(index, r);
+    FrozenVertex v;
+    v.id = static_cast<int>(r[0]);
+    v.coords = Point3D(origin.x + static_cast<double>(r[1]) * step.x, origin.y + static_cast<double>(r[2]) * step.y,
+                       origin.z + static_cast<double>(r[3]) * step.z);
+    v.edge = fromStoredRef(r[4]);
+    return v;
+}
+
+FrozenEdge FrozenTopology::edgeAt(size_t index) const {
+    int64_t r[9];
+    edge_records.read(index, r);
+    FrozenEdge e;
+    e.id = static_cast<int>(r[0]);
+    e.v1 = fromStoredRef(r[1]);
+    e.v2 = fromStoredRef(r[2]);
+    e.f1 = fromStoredRef(r[3]);
+    e.f2 = fromStoredRef(r[4]);
+    e.p1_f1 = fromStoredRef(r[5]);
+    e.n1_f1 = fromStoredRef(r[6]);
+    e.p2_f2 = fromStoredRef(r[7]);
+    e.n2_f2 = fromStoredRef(r[8]);
+    return e;
+}
+
+FrozenFace FrozenTopology::faceAt(size_t index) const {
+    int64_t r[2];
+    face_records.read(index, r);
+    return FrozenFace{static_cast<int>(r[0]), fromStoredRef(r[1])};
+}
+
+FrozenVertex FrozenTopology::getVertex(int id) const {
+    long index = vertexIndex(id);
+    if (index < 0) throw std::invalid_argument("FrozenTopology: unknown vertex " + std::to_string(id));
+    return vertexAt(static_cast<size_t>(index));
+}
+
+FrozenEdge FrozenTopology::getEdge(int id) const {
+    long index = edgeIndex(id);
+    if (index < 0) throw std::invalid_argument("FrozenTopology: unknown edge " + std::to_string(id));
+    return edgeAt(static_cast<size_t>(index));
+}
+
+FrozenFace FrozenTopology::getFace(int id) const {
+    long index = faceIndex(id);
+    if (index < 0) throw std::invalid_argument("FrozenTopology: unknown face " + std::to_string(id));
+    return faceAt(static_cast<size_t>(index));
+}
+
+// ==================== NAVIGATION ====================
+
+std::vector<int> FrozenTopology::walk(int start_edge, bool around_vertex, int element_id) const {
+    // Loops are short, so repeats are found with a linear scan until one
+    // gets long enough for a set to pay off
+    constexpr size_t kLinearRepeatLimit = 32;
+    std::vector<int> loop;
+    std::unordered_set<int> seen;
+
+    int current = start_edge;
+    int64_t r[9];
+    while (current >= 0 && edge_records.find(current, r) >= 0) {
+        if (loop.size() < kLinearRepeatLimit) {
+            if (std::find(loop.begin(), loop.end(), current) != loop.end()) break;
+        } else {
+            if (seen.empty()) seen.insert(loop.begin(), loop.end());
+            if (!seen.insert(current).second) break;
+        }
+        loop.push_back(current);
+
+        // r: id, v1, v2, f1, f2, p1_f1, n1_f1, p2_f2, n2_f2 as stored references
+        const int64_t self = static_cast<int64_t>(element_id) + 1;
+        const int64_t first = around_vertex ? r[1] : r[3];
+        const int64_t second = around_vertex ? r[2] : r[4];
+        current = first == self ? fromStoredRef(r[6]) : second == self ? fromStoredRef(r[8]) : -1;
+    }
+    return loop;
+}
+
+std::vector<int> FrozenTopology::faceEdges(int face_id) const {
+    return walk(getFace(face_id).edge, false, face_id);
+}
+
+std::vector<int> FrozenTopology::faceVertices(int face_id) const {
+    std::vector<int> result;
+    for (int edge_id : faceEdges(face_id)) {
+        const FrozenEdge e = getEdge(edge_id);
+        result.push_back(e.f1 == face_id ? e.v1 : e.v2);
+    }
+    return result;
+}
+
+std::vector<int> FrozenTopology::vertexEdges(int vertex_id) const {
+    return walk(getVertex(vertex_id).edge, true, vertex_id);
+}
+
+std::vector<int> FrozenTopology::incidentFaces(int vertex_id) const {
+    std::vector<int> result;
+    auto add = [&](int f) {
+        if (f >= 0 && std::find(result.begin(), result.end(), f) == result.end()) result.push_back(f);
+    };
+    for (int edge_id : vertexEdges(vertex_id)) {
+        const FrozenEdge e = getEdge(edge_id);
+        add(e.f1);
+        add(e.f2);
+    }
+    return result;
+}
+
+} // namespace SketchyKernel
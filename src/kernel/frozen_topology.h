@@ -0,0 +1,151 @@
+#ifndef SKETCHY_KERNEL_FROZEN_TOPOLOGY_H
+#define SKETCHY_KERNEL_FROZEN_TOPOLOGY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "geometry.h"
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+
+/**
+ * Settings for WingedEdgeKernel::freeze()
+ */
+struct FreezeOptions {
+    // Bits per coordinate axis, 8 to 32. Positions snap to a grid over the
+    // model's bounding box, so each axis is off by at most half of
+    // getCoordinateStep() after a round trip.
+    unsigned coordinate_bits = 32;
+};
+
+// Element references in the frozen form are IDs; -1 is "none"
+struct FrozenVertex {
+    int id = -1;
+    Point3D coords;
+    int edge = -1;
+};
+
+struct FrozenEdge {
+    int id = -1;
+    int v1 = -1, v2 = -1;
+    int f1 = -1, f2 = -1;
+    int p1_f1 = -1, n1_f1 = -1, p2_f2 = -1, n2_f2 = -1;
+};
+
+struct FrozenFace {
+    int id = -1;
+    int edge = -1;
+};
+
+/**
+ * Read-only, compressed copy of a kernel's topology and geometry.
+ *
+ * Elements are kept in ID order as fixed-arity records of zigzag varints.
+ * IDs, positions and most references are stored as deltas from the
+ * previous record, and edge wings as deltas from the edge's own ID, so
+ * neighboring elements cost a byte or two per field. Records are grouped
+ * in blocks of kBlockRecords that decode on their own; finding an element
+ * by ID is a binary search over the block heads plus one block scan.
+ *
+ * Navigation mirrors the kernel's circulators: loops stop before the first
+ * repeated edge or at a missing wing.
+ */
+class FrozenTopology {
+public:
+    static constexpr size_t kBlockRecords = 16;
+
+    /**
+     * Encode the kernel's current elements
+     * @throws std::invalid_argument if coordinate_bits is outside [8, 32]
+     */
+    static FrozenTopology encode(const WingedEdgeKernel& kernel, const FreezeOptions& options = {});
+
+    size_t getVertexCount() const { return vertex_records.size(); }
+    size_t getEdgeCount() const { return edge_records.size(); }
+    size_t getFaceCount() const { return face_records.size(); }
+
+    /**
+     * Bytes held by the encoded records and their block tables
+     */
+    size_t byteSize() const;
+
+    /**
+     * Largest quantization step over the three axes
+     */
+    double getCoordinateStep() const;
+
+    // Elements by position in ID order, 0 <= index < count
+    FrozenVertex vertexAt(size_t index) const;
+    FrozenEdge edgeAt(size_t index) const;
+    FrozenFace faceAt(size_t index) const;
+
+    /**
+     * Position in ID order; -1 for unknown IDs
+     */
+    long vertexIndex(int id) const { return vertex_records.find(id); }
+    long edgeIndex(int id) const { return edge_records.find(id); }
+    long faceIndex(int id) const { return face_records.find(id); }
+
+    /**
+     * Elements by ID
+     * @throws std::invalid_argument for unknown IDs
+     */
+    FrozenVertex getVertex(int id) const;
+    FrozenEdge getEdge(int id) const;
+    FrozenFace getFace(int id) const;
+
+    // ==================== NAVIGATION ====================
+    // Same walks as faceEdges(), faceVertices(), vertexEdges() and
+    // getIncidentFaces() on the kernel, by ID
+
+    std::vector<int> faceEdges(int face_id) const;
+    std::vector<int> faceVertices(int face_id) const;
+    std::vector<int> vertexEdges(int vertex_id) const;
+    std::vector<int> incidentFaces(int vertex_id) const;
+
+private:
+    // Records of `arity` signed fields in independently decodable blocks.
+    // Field 0 is the element ID, ascending. Each field is stored as the
+    // zigzag varint of its distance from a prediction: the same field of
+    // the previous record in the block, or, for fields flagged in
+    // self_relative, the record's own ID. References are ID + 1, 0 = none.
+    class PackedRecords {
+    public:
+        PackedRecords() = default;
+        PackedRecords(size_t arity, uint32_t self_relative) : arity(arity), self_relative(self_relative) {}
+
+        void append(const int64_t* record);
+        void read(size_t index, int64_t* out) const;
+        // Index of the record with this ID, or -1; copies it to out if given
+        long find(int64_t id, int64_t* out = nullptr) const;
+        void finish(); // Drop encoder state and spare capacity
+
+        size_t size() const { return count; }
+        size_t byteSize() const;
+
+    private:
+        size_t arity = 0;
+        uint32_t self_relative = 0;
+        size_t count = 0;
+        std::vector<uint8_t> bytes;
+        std::vector<uint64_t> block_offsets;
+        std::vector<int64_t> block_ids;  // ID of each block's first record
+        std::vector<int64_t> previous;   // Encoder state: last record appended
+    };
+
+    PackedRecords vertex_records{5, 0};      // id, qx, qy, qz, edge
+    PackedRecords edge_records{9, 0x1E0};    // id, v1, v2, f1, f2, p1_f1, n1_f1, p2_f2, n2_f2
+    PackedRecords face_records{2, 0};        // id, edge
+
+    // Position = origin + q * step, per axis
+    Point3D origin;
+    Vec3 step;
+
+    std::vector<int> walk(int start_edge, bool around_vertex, int element_id) const;
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_FROZEN_TOPOLOGY_H
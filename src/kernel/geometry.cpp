@@ -1,21 +1,32 @@
 #include "geometry.h"
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SKETCHY_HAVE_AVX2_KERNEL 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SKETCHY_HAVE_NEON_KERNEL 1
+#endif
 
 namespace SketchyKernel {
 
-Mat4 Mat4::translation(double x, double y, double z) {
-    Mat4 result;
+template <typename T>
+Mat4T<T> Mat4T<T>::translation(T x, T y, T z) {
+    Mat4T result;
     result.m[0][3] = x;
     result.m[1][3] = y;
     result.m[2][3] = z;
     return result;
 }
 
-Mat4 Mat4::rotation(const Vec3& axis, double angle) {
-    Mat4 result;
-    Vec3 a = axis.normalized();
-    double c = std::cos(angle);
-    double s = std::sin(angle);
-    double t = 1.0 - c;
+template <typename T>
+Mat4T<T> Mat4T<T>::rotation(const Vec3T<T>& axis, T angle) {
+    Mat4T result;
+    Vec3T<T> a = axis.normalized();
+    T c = std::cos(angle);
+    T s = std::sin(angle);
+    T t = T(1) - c;
 
     result.m[0][0] = t * a.x * a.x + c;
     result.m[0][1] = t * a.x * a.y - s * a.z;
@@ -32,37 +43,310 @@ Mat4 Mat4::rotation(const Vec3& axis, double angle) {
     return result;
 }
 
-Mat4 Mat4::scale(double sx, double sy, double sz) {
-    Mat4 result;
+template <typename T>
+Mat4T<T> Mat4T<T>::scale(T sx, T sy, T sz) {
+    Mat4T result;
     result.m[0][0] = sx;
     result.m[1][1] = sy;
     result.m[2][2] = sz;
     return result;
 }
 
-Mat4 Mat4::operator*(const Mat4& other) const {
-    Mat4 result;
+template <typename T>
+Mat4T<T> Mat4T<T>::operator*(const Mat4T& other) const {
+    // Both bottom rows are (0, 0, 0, 1) in nearly every modeling transform
+    if (isAffine() && other.isAffine()) {
+        return (Affine3T<T>(*this) * Affine3T<T>(other)).toMat4();
+    }
+
+    Mat4T result;
+    const auto& b = other.m;
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            result.m[i][j] = 0;
-            for (int k = 0; k < 4; k++) {
-                result.m[i][j] += m[i][k] * other.m[k][j];
-            }
+            result.m[i][j] = m[i][0] * b[0][j] + m[i][1] * b[1][j] + m[i][2] * b[2][j] + m[i][3] * b[3][j];
         }
     }
     return result;
 }
 
-Vec3 Mat4::transform(const Vec3& v) const {
-    double x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3];
-    double y = m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3];
-    double z = m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3];
-    double w = m[3][0] * v.x + m[3][1] * v.y + m[3][2] * v.z + m[3][3];
+template <typename T>
+Vec3T<T> Mat4T<T>::transform(const Vec3T<T>& v) const {
+    T x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3];
+    T y = m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3];
+    T z = m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3];
+    T w = m[3][0] * v.x + m[3][1] * v.y + m[3][2] * v.z + m[3][3];
+
+    if (w != T(1) && w != T(0)) {
+        return Vec3T<T>(x / w, y / w, z / w);
+    }
+    return Vec3T<T>(x, y, z);
+}
+
+// ==================== BATCH TRANSFORM ====================
+
+namespace {
+
+// Matrix columns, so that M * (x, y, z, 1) = c0 * x + c1 * y + c2 * z + c3
+struct Columns {
+    alignas(32) double c[4][4];
+
+    explicit Columns(const Mat4& mat) {
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) c[col][row] = mat.m[row][col];
+        }
+    }
+};
+
+template <bool Affine, typename T>
+void transformPointsScalar(const Mat4T<T>& mat, const Vec3T<T>* in, Vec3T<T>* out, size_t n) {
+    const auto& m = mat.m;
+    for (size_t i = 0; i < n; i++) {
+        const T px = in[i].x, py = in[i].y, pz = in[i].z;
+        T x = m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3];
+        T y = m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3];
+        T z = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+
+        if (!Affine) {
+            T w = m[3][0] * px + m[3][1] * py + m[3][2] * pz + m[3][3];
+            if (w != T(1) && w != T(0)) {
+                x /= w;
+                y /= w;
+                z /= w;
+            }
+        }
+        out[i] = Vec3T<T>(x, y, z);
+    }
+}
+
+#if defined(SKETCHY_HAVE_AVX2_KERNEL)
+
+// One point per 256-bit register: lanes hold (x', y', z', w)
+template <bool Affine>
+__attribute__((target("avx2,fma")))
+void transformPointsAvx2(const Mat4& mat, const Vec3* in, Vec3* out, size_t n) {
+    Columns cols(mat);
+    const __m256d c0 = _mm256_load_pd(cols.c[0]);
+    const __m256d c1 = _mm256_load_pd(cols.c[1]);
+    const __m256d c2 = _mm256_load_pd(cols.c[2]);
+    const __m256d c3 = _mm256_load_pd(cols.c[3]);
+    const __m256i xyz_mask = _mm256_set_epi64x(0, -1, -1, -1);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    for (size_t i = 0; i < n; i++) {
+        __m256d r = _mm256_fmadd_pd(c0, _mm256_broadcast_sd(&in[i].x), c3);
+        r = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(&in[i].y), r);
+        r = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(&in[i].z), r);
+
+        if (!Affine) {
+            // Divide by w unless it is 0; dividing by w == 1 is exact
+            __m256d w = _mm256_permute4x64_pd(r, 0xFF);
+            w = _mm256_blendv_pd(w, one, _mm256_cmp_pd(w, zero, _CMP_EQ_OQ));
+            r = _mm256_div_pd(r, w);
+        }
+        _mm256_maskstore_pd(&out[i].x, xyz_mask, r);
+    }
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+
+// Four points per step straight from the coordinate columns
+template <bool Affine>
+__attribute__((target("avx2,fma")))
+void transformColumnsAvx2(const Mat4& mat, const double* x, const double* y, const double* z,
+                          double* out_x, double* out_y, double* out_z, size_t n) {
+    const auto& m = mat.m;
+    __m256d r[4][4];
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) r[row][col] = _mm256_set1_pd(m[row][col]);
+    }
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d px = _mm256_loadu_pd(x + i);
+        __m256d py = _mm256_loadu_pd(y + i);
+        __m256d pz = _mm256_loadu_pd(z + i);
+
+        __m256d out[4];
+        for (int row = 0; row < (Affine ? 3 : 4); row++) {
+            __m256d acc = _mm256_fmadd_pd(r[row][0], px, r[row][3]);
+            acc = _mm256_fmadd_pd(r[row][1], py, acc);
+            out[row] = _mm256_fmadd_pd(r[row][2], pz, acc);
+        }
+
+        if (!Affine) {
+            __m256d w = _mm256_blendv_pd(out[3], one, _mm256_cmp_pd(out[3], zero, _CMP_EQ_OQ));
+            for (int row = 0; row < 3; row++) out[row] = _mm256_div_pd(out[row], w);
+        }
+
+        _mm256_storeu_pd(out_x + i, out[0]);
+        _mm256_storeu_pd(out_y + i, out[1]);
+        _mm256_storeu_pd(out_z + i, out[2]);
+    }
+
+    // Tail through the AoS kernel
+    for (; i < n; i++) {
+        Vec3 p(x[i], y[i], z[i]);
+        transformPointsAvx2<Affine>(mat, &p, &p, 1);
+        out_x[i] = p.x;
+        out_y[i] = p.y;
+        out_z[i] = p.z;
+    }
+}
+
+// Eight float points per step from the coordinate columns
+template <bool Affine>
+__attribute__((target("avx2,fma")))
+void transformColumnsAvx2(const Mat4f& mat, const float* x, const float* y, const float* z,
+                          float* out_x, float* out_y, float* out_z, size_t n) {
+    const auto& m = mat.m;
+    __m256 r[4][4];
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) r[row][col] = _mm256_set1_ps(m[row][col]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pz = _mm256_loadu_ps(z + i);
+
+        __m256 out[4];
+        for (int row = 0; row < (Affine ? 3 : 4); row++) {
+            __m256 acc = _mm256_fmadd_ps(r[row][0], px, r[row][3]);
+            acc = _mm256_fmadd_ps(r[row][1], py, acc);
+            out[row] = _mm256_fmadd_ps(r[row][2], pz, acc);
+        }
+
+        if (!Affine) {
+            __m256 w = _mm256_blendv_ps(out[3], one, _mm256_cmp_ps(out[3], zero, _CMP_EQ_OQ));
+            for (int row = 0; row < 3; row++) out[row] = _mm256_div_ps(out[row], w);
+        }
+
+        _mm256_storeu_ps(out_x + i, out[0]);
+        _mm256_storeu_ps(out_y + i, out[1]);
+        _mm256_storeu_ps(out_z + i, out[2]);
+    }
+
+    for (; i < n; i++) {
+        Vec3f p(x[i], y[i], z[i]);
+        transformPointsScalar<Affine>(mat, &p, &p, 1);
+        out_x[i] = p.x;
+        out_y[i] = p.y;
+        out_z[i] = p.z;
+    }
+}
+
+#elif defined(SKETCHY_HAVE_NEON_KERNEL)
+
+// One point per register pair: (x', y') and (z', w)
+template <bool Affine>
+void transformPointsNeon(const Mat4& mat, const Vec3* in, Vec3* out, size_t n) {
+    Columns cols(mat);
+    float64x2_t lo[4], hi[4];
+    for (int col = 0; col < 4; col++) {
+        lo[col] = vld1q_f64(&cols.c[col][0]);
+        hi[col] = vld1q_f64(&cols.c[col][2]);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const double px = in[i].x, py = in[i].y, pz = in[i].z;
+        float64x2_t xy = vfmaq_n_f64(vfmaq_n_f64(vfmaq_n_f64(lo[3], lo[0], px), lo[1], py), lo[2], pz);
+        float64x2_t zw = vfmaq_n_f64(vfmaq_n_f64(vfmaq_n_f64(hi[3], hi[0], px), hi[1], py), hi[2], pz);
+
+        double w = vgetq_lane_f64(zw, 1);
+        if (!Affine && w != 0.0) {
+            float64x2_t wv = vdupq_n_f64(w);
+            xy = vdivq_f64(xy, wv);
+            zw = vdivq_f64(zw, wv);
+        }
+        vst1q_f64(&out[i].x, xy);
+        out[i].z = vgetq_lane_f64(zw, 0);
+    }
+}
+
+#endif
+
+} // namespace
+
+template <typename T>
+void Mat4T<T>::transformPoints(const Vec3T<T>* in, Vec3T<T>* out, size_t n) const {
+    const bool affine = isAffine();
+
+    // Float AoS has a 12-byte stride that does not fit a register; it takes
+    // the scalar loop, which the compiler vectorizes as far as it can
+    if constexpr (std::is_same_v<T, double>) {
+#if defined(SKETCHY_HAVE_AVX2_KERNEL)
+        if (cpuHasAvx2()) {
+            affine ? transformPointsAvx2<true>(*this, in, out, n) : transformPointsAvx2<false>(*this, in, out, n);
+            return;
+        }
+#elif defined(SKETCHY_HAVE_NEON_KERNEL)
+        affine ? transformPointsNeon<true>(*this, in, out, n) : transformPointsNeon<false>(*this, in, out, n);
+        return;
+#endif
+    }
+
+    affine ? transformPointsScalar<true>(*this, in, out, n) : transformPointsScalar<false>(*this, in, out, n);
+}
+
+template <typename T>
+void Mat4T<T>::transformPoints(const T* x, const T* y, const T* z,
+                               T* out_x, T* out_y, T* out_z, size_t n) const {
+#if defined(SKETCHY_HAVE_AVX2_KERNEL)
+    if (cpuHasAvx2()) {
+        if (isAffine()) {
+            transformColumnsAvx2<true>(*this, x, y, z, out_x, out_y, out_z, n);
+        } else {
+            transformColumnsAvx2<false>(*this, x, y, z, out_x, out_y, out_z, n);
+        }
+        return;
+    }
+#endif
+
+    // Columns are processed in blocks through the AoS kernels
+    constexpr size_t kBlock = 256;
+    Vec3T<T> block[kBlock];
+    for (size_t start = 0; start < n; start += kBlock) {
+        size_t count = n - start < kBlock ? n - start : kBlock;
+        for (size_t i = 0; i < count; i++) block[i] = Vec3T<T>(x[start + i], y[start + i], z[start + i]);
+
+        transformPoints(block, block, count);
+
+        for (size_t i = 0; i < count; i++) {
+            out_x[start + i] = block[i].x;
+            out_y[start + i] = block[i].y;
+            out_z[start + i] = block[i].z;
+        }
+    }
+}
+
+template class Vec3T<double>;
+template class Vec3T<float>;
+template class Mat4T<double>;
+template class Mat4T<float>;
 
-    if (w != 1.0 && w != 0.0) {
-        return Vec3(x / w, y / w, z / w);
+Vec3 polygonAreaVector(const Point3D* loop, size_t n) {
+    Vec3 sum(0, 0, 0);
+    for (size_t i = 0; i < n; i++) {
+        const Point3D& a = loop[i];
+        const Point3D& b = loop[(i + 1) % n];
+        sum.x += (a.y - b.y) * (a.z + b.z);
+        sum.y += (a.z - b.z) * (a.x + b.x);
+        sum.z += (a.x - b.x) * (a.y + b.y);
     }
-    return Vec3(x, y, z);
+    return sum * 0.5;
+}
+
+Vec3 polygonNormal(const Point3D* loop, size_t n) {
+    return polygonAreaVector(loop, n).normalized();
 }
 
 } // namespace SketchyKernel
@@ -3,88 +3,308 @@
 
 #include <cmath>
 #include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
 
 namespace SketchyKernel {
 
 /**
- * 3D Vector with full mathematical operations
+ * 3D Vector with full mathematical operations.
+ * Instantiated for double (Vec3, the exact modeling path) and float (Vec3f,
+ * display-side data). Converting between precisions is always explicit.
  */
-class Vec3 {
+template <typename T>
+class Vec3T {
 public:
-    double x, y, z;
+    T x, y, z;
 
-    Vec3() : x(0), y(0), z(0) {}
-    Vec3(double x, double y, double z) : x(x), y(y), z(z) {}
+    constexpr Vec3T() : x(0), y(0), z(0) {}
+    constexpr Vec3T(T x, T y, T z) : x(x), y(y), z(z) {}
+
+    template <typename U>
+    constexpr explicit Vec3T(const Vec3T<U>& other)
+        : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)), z(static_cast<T>(other.z)) {}
 
     // Vector operations
-    Vec3 operator+(const Vec3& other) const {
-        return Vec3(x + other.x, y + other.y, z + other.z);
+    constexpr Vec3T operator+(const Vec3T& other) const {
+        return Vec3T(x + other.x, y + other.y, z + other.z);
     }
 
-    Vec3 operator-(const Vec3& other) const {
-        return Vec3(x - other.x, y - other.y, z - other.z);
+    constexpr Vec3T operator-(const Vec3T& other) const {
+        return Vec3T(x - other.x, y - other.y, z - other.z);
     }
 
-    Vec3 operator*(double scalar) const {
-        return Vec3(x * scalar, y * scalar, z * scalar);
+    constexpr Vec3T operator*(T scalar) const {
+        return Vec3T(x * scalar, y * scalar, z * scalar);
     }
 
-    Vec3 operator/(double scalar) const {
-        return Vec3(x / scalar, y / scalar, z / scalar);
+    constexpr Vec3T operator/(T scalar) const {
+        return Vec3T(x / scalar, y / scalar, z / scalar);
     }
 
-    double dot(const Vec3& other) const {
+    constexpr T dot(const Vec3T& other) const {
         return x * other.x + y * other.y + z * other.z;
     }
 
-    Vec3 cross(const Vec3& other) const {
-        return Vec3(
+    constexpr Vec3T cross(const Vec3T& other) const {
+        return Vec3T(
             y * other.z - z * other.y,
             z * other.x - x * other.z,
             x * other.y - y * other.x
         );
     }
 
-    double length() const {
+    T length() const {
         return std::sqrt(x * x + y * y + z * z);
     }
 
-    Vec3 normalized() const {
-        double len = length();
+    Vec3T normalized() const {
+        T len = length();
         if (len > 0) {
             return *this / len;
         }
-        return Vec3(0, 0, 0);
+        return Vec3T(0, 0, 0);
     }
 };
 
 /**
  * 4x4 Transformation Matrix
  */
-class Mat4 {
+template <typename T>
+class Mat4T {
 public:
-    std::array<std::array<double, 4>, 4> m;
+    std::array<std::array<T, 4>, 4> m{};
 
-    Mat4() {
+    constexpr Mat4T() {
         // Identity matrix
         for (int i = 0; i < 4; i++) {
             for (int j = 0; j < 4; j++) {
-                m[i][j] = (i == j) ? 1.0 : 0.0;
+                m[i][j] = (i == j) ? T(1) : T(0);
+            }
+        }
+    }
+
+    template <typename U>
+    explicit Mat4T(const Mat4T<U>& other) {
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                m[i][j] = static_cast<T>(other.m[i][j]);
             }
         }
     }
 
-    static Mat4 translation(double x, double y, double z);
-    static Mat4 rotation(const Vec3& axis, double angle);
-    static Mat4 scale(double sx, double sy, double sz);
+    static Mat4T translation(T x, T y, T z);
+    static Mat4T rotation(const Vec3T<T>& axis, T angle);
+    static Mat4T scale(T sx, T sy, T sz);
+
+    Mat4T operator*(const Mat4T& other) const;
+    Vec3T<T> transform(const Vec3T<T>& v) const;
+
+    /**
+     * True when the bottom row is (0, 0, 0, 1), i.e. no perspective divide
+     */
+    constexpr bool isAffine() const {
+        return m[3][0] == T(0) && m[3][1] == T(0) && m[3][2] == T(0) && m[3][3] == T(1);
+    }
+
+    /**
+     * Transform n points in one batch; matches transform() up to FMA rounding.
+     * The affine/projective path and the SIMD kernel (AVX2 where the CPU
+     * supports it, NEON on AArch64) are picked once per call rather than per
+     * point. in and out may be the same array.
+     */
+    void transformPoints(const Vec3T<T>* in, Vec3T<T>* out, size_t n) const;
 
-    Mat4 operator*(const Mat4& other) const;
-    Vec3 transform(const Vec3& v) const;
+    /**
+     * Structure-of-arrays overload: transforms (x[i], y[i], z[i]) into
+     * (out_x[i], out_y[i], out_z[i]), four doubles or eight floats per AVX2
+     * step. Outputs may alias the matching inputs.
+     */
+    void transformPoints(const T* x, const T* y, const T* z,
+                         T* out_x, T* out_y, T* out_z, size_t n) const;
+};
+
+/**
+ * Affine transform: a 3x3 linear part plus a translation, p' = L * p + t.
+ * Composition costs 36 multiplies instead of Mat4's 64, and there is no
+ * perspective divide. Everything except rotation() is constexpr, so fixed
+ * transforms fold at compile time.
+ */
+template <typename T>
+class Affine3T {
+public:
+    std::array<std::array<T, 3>, 3> linear{};
+    Vec3T<T> translation;
+
+    constexpr Affine3T() {
+        linear[0][0] = linear[1][1] = linear[2][2] = T(1);
+    }
+
+    /**
+     * Take the upper 3x4 block of an affine Mat4
+     * @throws std::invalid_argument if the matrix has a projective row
+     */
+    constexpr explicit Affine3T(const Mat4T<T>& mat) {
+        if (!mat.isAffine()) {
+            throw std::invalid_argument("Affine3: matrix is not affine");
+        }
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) linear[i][j] = mat.m[i][j];
+        }
+        translation = Vec3T<T>(mat.m[0][3], mat.m[1][3], mat.m[2][3]);
+    }
+
+    static constexpr Affine3T translate(T x, T y, T z) {
+        Affine3T result;
+        result.translation = Vec3T<T>(x, y, z);
+        return result;
+    }
+
+    static constexpr Affine3T scale(T sx, T sy, T sz) {
+        Affine3T result;
+        result.linear[0][0] = sx;
+        result.linear[1][1] = sy;
+        result.linear[2][2] = sz;
+        return result;
+    }
+
+    static Affine3T rotation(const Vec3T<T>& axis, T angle) {
+        return Affine3T(Mat4T<T>::rotation(axis, angle));
+    }
+
+    constexpr Mat4T<T> toMat4() const {
+        Mat4T<T> result;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) result.m[i][j] = linear[i][j];
+        }
+        result.m[0][3] = translation.x;
+        result.m[1][3] = translation.y;
+        result.m[2][3] = translation.z;
+        return result;
+    }
+
+    // A 3x3 product plus one point transform: 36 multiplies, against 64 for
+    // a Mat4 product. Each row's three dot products are written out, and a
+    // plain loop runs over the rows.
+    constexpr Affine3T operator*(const Affine3T& o) const {
+        Affine3T r;
+        const auto& a = linear;
+        const auto& b = o.linear;
+        for (int i = 0; i < 3; i++) {
+            r.linear[i][0] = a[i][0] * b[0][0] + a[i][1] * b[1][0] + a[i][2] * b[2][0];
+            r.linear[i][1] = a[i][0] * b[0][1] + a[i][1] * b[1][1] + a[i][2] * b[2][1];
+            r.linear[i][2] = a[i][0] * b[0][2] + a[i][1] * b[1][2] + a[i][2] * b[2][2];
+        }
+        r.translation = transform(o.translation);
+        return r;
+    }
+
+    constexpr Vec3T<T> transform(const Vec3T<T>& p) const {
+        return transformVector(p) + translation;
+    }
+
+    /**
+     * Apply only the linear part (directions, offsets)
+     */
+    constexpr Vec3T<T> transformVector(const Vec3T<T>& v) const {
+        return Vec3T<T>(linear[0][0] * v.x + linear[0][1] * v.y + linear[0][2] * v.z,
+                        linear[1][0] * v.x + linear[1][1] * v.y + linear[1][2] * v.z,
+                        linear[2][0] * v.x + linear[2][1] * v.y + linear[2][2] * v.z);
+    }
+
+    constexpr T determinant() const {
+        const auto& a = linear;
+        return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+               a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+               a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    }
+
+    /**
+     * Inverse via the 3x3 adjugate: L^-1 and -L^-1 * t
+     * @throws std::invalid_argument if the linear part is singular
+     */
+    constexpr Affine3T inverse() const {
+        const auto& a = linear;
+        T det = determinant();
+        if (det == T(0)) {
+            throw std::invalid_argument("Affine3: transform is not invertible");
+        }
+        T inv_det = T(1) / det;
+
+        Affine3T r;
+        r.linear[0][0] = (a[1][1] * a[2][2] - a[1][2] * a[2][1]) * inv_det;
+        r.linear[0][1] = (a[0][2] * a[2][1] - a[0][1] * a[2][2]) * inv_det;
+        r.linear[0][2] = (a[0][1] * a[1][2] - a[0][2] * a[1][1]) * inv_det;
+        r.linear[1][0] = (a[1][2] * a[2][0] - a[1][0] * a[2][2]) * inv_det;
+        r.linear[1][1] = (a[0][0] * a[2][2] - a[0][2] * a[2][0]) * inv_det;
+        r.linear[1][2] = (a[0][2] * a[1][0] - a[0][0] * a[1][2]) * inv_det;
+        r.linear[2][0] = (a[1][0] * a[2][1] - a[1][1] * a[2][0]) * inv_det;
+        r.linear[2][1] = (a[0][1] * a[2][0] - a[0][0] * a[2][1]) * inv_det;
+        r.linear[2][2] = (a[0][0] * a[1][1] - a[0][1] * a[1][0]) * inv_det;
+        r.translation = r.transformVector(translation) * T(-1);
+        return r;
+    }
+
+    /**
+     * Batch transform through the affine SIMD path of Mat4T::transformPoints
+     */
+    void transformPoints(const Vec3T<T>* in, Vec3T<T>* out, size_t n) const {
+        toMat4().transformPoints(in, out, n);
+    }
+};
+
+using Vec3 = Vec3T<double>;
+using Vec3f = Vec3T<float>;
+using Mat4 = Mat4T<double>;
+using Mat4f = Mat4T<float>;
+using Affine3 = Affine3T<double>;
+using Affine3f = Affine3T<float>;
+
+// Both precisions are instantiated once, in geometry.cpp
+extern template class Vec3T<double>;
+extern template class Vec3T<float>;
+extern template class Mat4T<double>;
+extern template class Mat4T<float>;
+
+/**
+ * Axis-aligned bounding box; starts empty (min above max)
+ */
+struct BoundingBox {
+    Vec3 min{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+             std::numeric_limits<double>::infinity()};
+    Vec3 max{-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+             -std::numeric_limits<double>::infinity()};
+
+    bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+    void expand(const Vec3& p) {
+        min = Vec3(std::fmin(min.x, p.x), std::fmin(min.y, p.y), std::fmin(min.z, p.z));
+        max = Vec3(std::fmax(max.x, p.x), std::fmax(max.y, p.y), std::fmax(max.z, p.z));
+    }
+
+    void expand(const BoundingBox& other) {
+        if (other.empty()) return;
+        expand(other.min);
+        expand(other.max);
+    }
 };
 
 // Alias Point3D to Vec3 for compatibility
 using Point3D = Vec3;
 
+/**
+ * Vector area of a polygon loop by Newell's method: along the normal, with
+ * the loop's area as length. Stays stable for concave and slightly
+ * non-planar loops.
+ */
+Vec3 polygonAreaVector(const Point3D* loop, size_t n);
+
+/**
+ * Unit normal of a polygon loop; zero for degenerate ones
+ */
+Vec3 polygonNormal(const Point3D* loop, size_t n);
+
 } // namespace SketchyKernel
 
 #endif // SKETCHY_KERNEL_GEOMETRY_H
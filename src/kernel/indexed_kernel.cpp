@@ -0,0 +1,725 @@
+#include "indexed_kernel.h"
+#include "winged_edge.h"
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SketchyKernel {
+
+// ==================== POOL MANAGEMENT ====================
+
+uint32_t IndexedKernel::SlotPool::acquire(bool& appended) {
+    live++;
+
+    if (!free_slots.empty()) {
+        uint32_t index = free_slots.back();
+        free_slots.pop_back();
+        alive[index] = 1;
+        appended = false;
+        return index;
+    }
+
+    uint32_t index = static_cast<uint32_t>(alive.size());
+    alive.push_back(1);
+    generation.push_back(generation_floor);
+    appended = true;
+    return index;
+}
+
+void IndexedKernel::SlotPool::release(uint32_t index) {
+    alive[index] = 0;
+    generation[index]++;
+    free_slots.push_back(index);
+    live--;
+}
+
+void IndexedKernel::SlotPool::reserve(size_t count) {
+    alive.reserve(count);
+    generation.reserve(count);
+}
+
+uint32_t IndexedKernel::allocVertex(const Point3D& coords) {
+    bool appended;
+    uint32_t index = vertex_pool.acquire(appended);
+    display_stale = true;
+    if (appended) {
+        v_x.push_back(coords.x);
+        v_y.push_back(coords.y);
+        v_z.push_back(coords.z);
+        v_edge.push_back(kNone);
+    } else {
+        setCoords(VertexId(index), coords);
+        v_edge[index] = kNone;
+    }
+    return index;
+}
+
+uint32_t IndexedKernel::allocEdge() {
+    bool appended;
+    uint32_t index = edge_pool.acquire(appended);
+    for (auto* column : {&e_v1, &e_v2, &e_f1, &e_f2, &e_p1_f1, &e_n1_f1, &e_p2_f2, &e_n2_f2}) {
+        if (appended) {
+            column->push_back(kNone);
+        } else {
+            (*column)[index] = kNone;
+        }
+    }
+    return index;
+}
+
+uint32_t IndexedKernel::allocFace() {
+    bool appended;
+    uint32_t index = face_pool.acquire(appended);
+    if (appended) {
+        f_edge.push_back(kNone);
+    } else {
+        f_edge[index] = kNone;
+    }
+    return index;
+}
+
+void IndexedKernel::reserve(size_t vertex_count, size_t edge_count, size_t face_count) {
+    vertex_pool.reserve(vertex_count);
+    for (auto* column : {&v_x, &v_y, &v_z}) {
+        column->reserve(vertex_count);
+    }
+    v_edge.reserve(vertex_count);
+
+    edge_pool.reserve(edge_count);
+    for (auto* column : {&e_v1, &e_v2, &e_f1, &e_f2, &e_p1_f1, &e_n1_f1, &e_p2_f2, &e_n2_f2}) {
+        column->reserve(edge_count);
+    }
+
+    face_pool.reserve(face_count);
+    f_edge.reserve(face_count);
+}
+
+namespace {
+
+// Build the old -> new slot table for one pool and reset it to a dense,
+// fully live state whose generations are above every earlier handle
+template <typename HandleT, typename Pool>
+SlotRemap<HandleT> compactPool(Pool& pool, std::vector<uint32_t>& new_index) {
+    SlotRemap<HandleT> remap;
+    remap.old_generation = pool.generation;
+    remap.target.assign(pool.size(), HandleT());
+    new_index.assign(pool.size(), HandleT::kInvalidIndex);
+
+    uint32_t floor = pool.generation_floor;
+    for (uint32_t gen : pool.generation) {
+        if (gen >= floor) floor = gen + 1;
+    }
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < pool.size(); i++) {
+        if (!pool.alive[i]) continue;
+        new_index[i] = next;
+        remap.target[i] = HandleT(next, floor);
+        next++;
+    }
+
+    pool.alive.assign(next, 1);
+    pool.alive.shrink_to_fit();
+    pool.generation.assign(next, floor);
+    pool.generation.shrink_to_fit();
+    pool.free_slots.clear();
+    pool.free_slots.shrink_to_fit();
+    pool.generation_floor = floor;
+    pool.live = next;
+
+    return remap;
+}
+
+// Move the surviving rows of a value column down
+void compactValues(AlignedVector<double>& column, const std::vector<uint32_t>& row_index, size_t live_rows) {
+    AlignedVector<double> result(live_rows);
+    for (size_t i = 0; i < column.size(); i++) {
+        if (row_index[i] != VertexId::kInvalidIndex) result[row_index[i]] = column[i];
+    }
+    column.swap(result);
+}
+
+// Move the surviving rows of a column down and remap the handles it stores
+void compactColumn(std::vector<uint32_t>& column, const std::vector<uint32_t>& row_index,
+                   size_t live_rows, const std::vector<uint32_t>* value_index) {
+    std::vector<uint32_t> result(live_rows);
+    for (size_t i = 0; i < column.size(); i++) {
+        if (row_index[i] == VertexId::kInvalidIndex) continue;
+
+        uint32_t value = column[i];
+        if (value_index && value != VertexId::kInvalidIndex) {
+            value = value < value_index->size() ? (*value_index)[value] : VertexId::kInvalidIndex;
+        }
+        result[row_index[i]] = value;
+    }
+    column.swap(result);
+}
+
+} // namespace
+
+IndexedKernel::CompactionMap IndexedKernel::compact() {
+    std::vector<uint32_t> vertex_index, edge_index, face_index;
+
+    CompactionMap map;
+    map.vertices = compactPool<VertexId>(vertex_pool, vertex_index);
+    map.edges = compactPool<EdgeId>(edge_pool, edge_index);
+    map.faces = compactPool<FaceId>(face_pool, face_index);
+
+    for (auto* column : {&v_x, &v_y, &v_z}) {
+        compactValues(*column, vertex_index, vertex_pool.live);
+    }
+    display_stale = true;
+    compactColumn(v_edge, vertex_index, vertex_pool.live, &edge_index);
+
+    compactColumn(e_v1, edge_index, edge_pool.live, &vertex_index);
+    compactColumn(e_v2, edge_index, edge_pool.live, &vertex_index);
+    compactColumn(e_f1, edge_index, edge_pool.live, &face_index);
+    compactColumn(e_f2, edge_index, edge_pool.live, &face_index);
+    for (auto* column : {&e_p1_f1, &e_n1_f1, &e_p2_f2, &e_n2_f2}) {
+        compactColumn(*column, edge_index, edge_pool.live, &edge_index);
+    }
+
+    compactColumn(f_edge, face_index, face_pool.live, &edge_index);
+
+    return map;
+}
+
+IndexedKernel IndexedKernel::fromKernel(const WingedEdgeKernel& source) {
+    if (source.isFrozen()) throw std::logic_error("IndexedKernel::fromKernel: kernel is frozen");
+    IndexedKernel result;
+    result.reserve(source.getVertexCount(), source.getEdgeCount(), source.getFaceCount());
+
+    std::unordered_map<const Vertex*, uint32_t> vertex_index;
+    std::unordered_map<const Edge*, uint32_t> edge_index;
+    std::unordered_map<const Face*, uint32_t> face_index;
+
+    for (const auto& v : source.getVertices()) {
+        vertex_index[v.get()] = result.allocVertex(v->coords);
+    }
+    for (const auto& e : source.getEdges()) {
+        edge_index[e.get()] = result.allocEdge();
+    }
+    for (const auto& f : source.getFaces()) {
+        face_index[f.get()] = result.allocFace();
+    }
+
+    // Elements that were killed but are still referenced map to kNone
+    auto lookup = [](const auto& map, const auto& ptr) {
+        auto it = map.find(ptr.get());
+        return it == map.end() ? kNone : it->second;
+    };
+
+    for (const auto& v : source.getVertices()) {
+        result.v_edge[vertex_index[v.get()]] = lookup(edge_index, v->edge);
+    }
+    for (const auto& e : source.getEdges()) {
+        uint32_t i = edge_index[e.get()];
+        result.e_v1[i] = lookup(vertex_index, e->v1);
+        result.e_v2[i] = lookup(vertex_index, e->v2);
+        result.e_f1[i] = lookup(face_index, e->f1);
+        result.e_f2[i] = lookup(face_index, e->f2);
+        result.e_p1_f1[i] = lookup(edge_index, e->p1_f1);
+        result.e_n1_f1[i] = lookup(edge_index, e->n1_f1);
+        result.e_p2_f2[i] = lookup(edge_index, e->p2_f2);
+        result.e_n2_f2[i] = lookup(edge_index, e->n2_f2);
+    }
+    for (const auto& f : source.getFaces()) {
+        result.f_edge[face_index[f.get()]] = lookup(edge_index, f->edge);
+    }
+    result.solid_count = source.getSolidCount();
+    result.ring_count = source.getRingCount();
+
+    return result;
+}
+
+// ==================== EULER OPERATORS ====================
+
+VertexId IndexedKernel::mvsf(const Point3D& coords) {
+    uint32_t vertex = allocVertex(coords);
+
+    // The initial face has no boundary until edges are added via MEV
+    allocFace();
+    solid_count++;
+
+    return vertexHandle(vertex);
+}
+
+EdgeId IndexedKernel::mev(VertexId from_vertex, const Point3D& to_coords, FaceId on_face) {
+    if (!isAlive(from_vertex)) {
+        throw std::invalid_argument("MEV: from_vertex is not a valid vertex");
+    }
+    if (!isAlive(on_face)) {
+        throw std::invalid_argument("MEV: on_face is not a valid face");
+    }
+
+    uint32_t from = from_vertex.index;
+    uint32_t face = on_face.index;
+    uint32_t new_vertex = allocVertex(to_coords);
+    uint32_t new_edge = allocEdge();
+
+    e_v1[new_edge] = from;
+    e_v2[new_edge] = new_vertex;
+    e_f1[new_edge] = face;
+    e_f2[new_edge] = face; // Initially, both sides are the same face
+
+    if (v_edge[from] == kNone) {
+        v_edge[from] = new_edge;
+    }
+    v_edge[new_vertex] = new_edge;
+
+    if (f_edge[face] == kNone) {
+        f_edge[face] = new_edge;
+    }
+
+    if (v_edge[from] == new_edge) {
+        // First edge from this vertex on this face loops back to itself
+        e_p1_f1[new_edge] = new_edge;
+        e_n1_f1[new_edge] = new_edge;
+        e_p2_f2[new_edge] = new_edge;
+        e_n2_f2[new_edge] = new_edge;
+    } else {
+        uint32_t prev_edge = v_edge[from];
+
+        e_p1_f1[new_edge] = prev_edge;
+        e_n1_f1[new_edge] = e_n1_f1[prev_edge];
+
+        if (e_v2[prev_edge] == from) {
+            e_n2_f2[prev_edge] = new_edge;
+        } else {
+            e_n1_f1[prev_edge] = new_edge;
+        }
+
+        e_p2_f2[new_edge] = new_edge;
+        e_n2_f2[new_edge] = new_edge;
+    }
+
+    return edgeHandle(new_edge);
+}
+
+EdgeId IndexedKernel::mef(VertexId v1, VertexId v2, FaceId face) {
+    if (!isAlive(v1) || !isAlive(v2) || !isAlive(face)) {
+        throw std::invalid_argument("MEF: vertices and face must be valid");
+    }
+    if (v1 == v2) {
+        throw std::invalid_argument("MEF: cannot create edge between same vertex");
+    }
+
+    uint32_t new_edge = allocEdge();
+    uint32_t new_face = allocFace();
+
+    e_v1[new_edge] = v1.index;
+    e_v2[new_edge] = v2.index;
+    e_f1[new_edge] = face.index;
+    e_f2[new_edge] = new_face;
+
+    f_edge[new_face] = new_edge;
+
+    uint32_t v1_edge = v_edge[v1.index];
+    if (v1_edge != kNone) {
+        e_p1_f1[new_edge] = v1_edge;
+        e_n1_f1[new_edge] = v1_edge;
+    }
+
+    uint32_t v2_edge = v_edge[v2.index];
+    if (v2_edge != kNone) {
+        e_p2_f2[new_edge] = v2_edge;
+        e_n2_f2[new_edge] = v2_edge;
+    }
+
+    return edgeHandle(new_edge);
+}
+
+FaceId IndexedKernel::kef(EdgeId edge) {
+    if (!isAlive(edge)) {
+        throw std::invalid_argument("KEF: edge is not a valid edge");
+    }
+
+    uint32_t e = edge.index;
+    if (e_f1[e] != kNone && e_f1[e] == e_f2[e]) {
+        throw std::invalid_argument("KEF: edge has the same face on both sides");
+    }
+
+    // Case 1: Boundary edge (only one face) - Kill edge and face
+    if (e_f1[e] == kNone || e_f2[e] == kNone) {
+        uint32_t face_to_kill = e_f1[e] != kNone ? e_f1[e] : e_f2[e];
+
+        if (face_to_kill == kNone) {
+            throw std::invalid_argument("KEF: edge has no adjacent faces");
+        }
+
+        auto boundary_edges = getFaceBoundary(faceHandle(face_to_kill));
+
+        edge_pool.release(e);
+        unlinkEdge(e);
+
+        for (EdgeId b : boundary_edges) {
+            if (b.index == e) continue;
+
+            if (e_f1[b.index] == face_to_kill) e_f1[b.index] = kNone;
+            if (e_f2[b.index] == face_to_kill) e_f2[b.index] = kNone;
+        }
+
+        FaceId killed = faceHandle(face_to_kill);
+        face_pool.release(face_to_kill);
+
+        return killed;
+    }
+
+    // Case 2: Internal edge (two faces) - Merge f2 into f1
+    uint32_t f1 = e_f1[e];
+    uint32_t f2 = e_f2[e];
+
+    // Walk f2's loop while the killed edge is still wired into it
+    auto f2_boundary = getFaceBoundary(faceHandle(f2));
+
+    edge_pool.release(e);
+    unlinkEdge(e);
+
+    // Only edges on f2's boundary can reference f2, so the merge is O(|f2|)
+    for (EdgeId b : f2_boundary) {
+        if (b.index == e) continue;
+        if (e_f1[b.index] == f2) e_f1[b.index] = f1;
+        if (e_f2[b.index] == f2) e_f2[b.index] = f1;
+    }
+
+    if (f_edge[f1] == e) {
+        f_edge[f1] = kNone;
+        for (uint32_t candidate : {e_n1_f1[e], e_n2_f2[e], e_p1_f1[e], e_p2_f2[e]}) {
+            if (candidate != kNone && candidate != e &&
+                (e_f1[candidate] == f1 || e_f2[candidate] == f1)) {
+                f_edge[f1] = candidate;
+                break;
+            }
+        }
+    }
+
+    face_pool.release(f2);
+
+    return faceHandle(f1);
+}
+
+void IndexedKernel::unlinkEdge(uint32_t e) {
+    // Same splice as WingedEdgeKernel::unlinkEdge: X -> e -> Y on the f1 side
+    // and X' -> e -> Y' on the f2 side become X -> Y' ... X' -> Y
+    uint32_t x = e_p1_f1[e];
+    uint32_t x2 = e_p2_f2[e];
+    uint32_t y = e_n1_f1[e];
+    uint32_t y2 = e_n2_f2[e];
+
+    auto other = [e](uint32_t preferred, uint32_t fallback) {
+        if (preferred != kNone && preferred != e) return preferred;
+        return fallback != e ? fallback : kNone;
+    };
+
+    auto redirect = [e](uint32_t n, std::vector<uint32_t>& a, std::vector<uint32_t>& b,
+                              uint32_t to) {
+        if (n == kNone || n == e) return;
+        if (a[n] == e) a[n] = to;
+        if (b[n] == e) b[n] = to;
+    };
+
+    redirect(x, e_n1_f1, e_n2_f2, other(y2, y));
+    redirect(x2, e_n1_f1, e_n2_f2, other(y, y2));
+    redirect(y, e_p1_f1, e_p2_f2, other(x2, x));
+    redirect(y2, e_p1_f1, e_p2_f2, other(x, x2));
+
+    for (uint32_t v : {e_v1[e], e_v2[e]}) {
+        if (v == kNone || v_edge[v] != e) continue;
+
+        v_edge[v] = kNone;
+        for (uint32_t candidate : {x, y, x2, y2}) {
+            if (candidate != kNone && candidate != e &&
+                (e_v1[candidate] == v || e_v2[candidate] == v)) {
+                v_edge[v] = candidate;
+                break;
+            }
+        }
+    }
+}
+
+void IndexedKernel::kfmrh(FaceId hole_face, FaceId outer_face) {
+    if (!isAlive(hole_face) || !isAlive(outer_face)) {
+        throw std::invalid_argument("KFMRH: faces must be valid");
+    }
+    if (hole_face == outer_face) {
+        throw std::invalid_argument("KFMRH: hole and outer face must differ");
+    }
+
+    auto boundary = getFaceBoundary(hole_face);
+    face_pool.release(hole_face.index);
+    ring_count++;
+
+    for (EdgeId e : boundary) {
+        if (e_f1[e.index] == hole_face.index) e_f1[e.index] = outer_face.index;
+        if (e_f2[e.index] == hole_face.index) e_f2[e.index] = outer_face.index;
+    }
+}
+
+void IndexedKernel::setEdgeFaces(EdgeId e, FaceId f1, FaceId f2) {
+    e_f1[e.index] = f1.index;
+    e_f2[e.index] = f2.index;
+}
+
+// ==================== NAVIGATION & QUERY ====================
+
+std::vector<EdgeId> IndexedKernel::getIncidentEdges(VertexId v) const {
+    return collect(vertexEdges(v));
+}
+
+std::vector<FaceId> IndexedKernel::getIncidentFaces(VertexId v) const {
+    std::vector<FaceId> result;
+
+    // Typical valences are small enough that a linear scan beats hashing;
+    // switch to a set once the fan gets large
+    constexpr size_t kLinearDedupLimit = 16;
+    std::unordered_set<uint32_t> seen;
+
+    auto add = [&](uint32_t f) {
+        if (f == kNone) return;
+        if (seen.empty()) {
+            for (FaceId existing : result) {
+                if (existing.index == f) return;
+            }
+            result.push_back(faceHandle(f));
+            if (result.size() > kLinearDedupLimit) {
+                for (FaceId existing : result) seen.insert(existing.index);
+            }
+        } else if (seen.insert(f).second) {
+            result.push_back(faceHandle(f));
+        }
+    };
+
+    for (EdgeId e : vertexEdges(v)) {
+        add(e_f1[e.index]);
+        add(e_f2[e.index]);
+    }
+
+    return result;
+}
+
+std::vector<EdgeId> IndexedKernel::getFaceBoundary(FaceId f) const {
+    return collect(faceEdges(f));
+}
+
+std::vector<VertexId> IndexedKernel::getFaceVertices(FaceId f) const {
+    return collect(faceVertices(f));
+}
+
+bool IndexedKernel::validate(ValidationLevel level) const {
+    // Euler-Poincare: V - E + F - R = 2(S - H) with integer H >= 0
+    long long chi = static_cast<long long>(vertex_pool.live) - static_cast<long long>(edge_pool.live) +
+                    static_cast<long long>(face_pool.live) - static_cast<long long>(ring_count);
+    long long twice_genus = 2 * static_cast<long long>(solid_count) - chi;
+    if (twice_genus < 0 || twice_genus % 2 != 0) return false;
+
+    const bool full = level == ValidationLevel::Full;
+    const bool closed = level != ValidationLevel::References;
+    const size_t threads = resolveThreadCount(thread_count);
+
+    // Slot liveness makes every membership check O(1)
+    auto live = [](const SlotPool& pool, uint32_t index) {
+        return index < pool.size() && pool.alive[index];
+    };
+
+    auto vertices_ok = [&](size_t begin, size_t end) {
+        for (uint32_t v = static_cast<uint32_t>(begin); v < end; v++) {
+            if (!vertex_pool.alive[v] || v_edge[v] == kNone) continue;
+
+            uint32_t e = v_edge[v];
+            if (!live(edge_pool, e)) return false;
+            if (e_v1[e] != v && e_v2[e] != v) return false;
+        }
+        return true;
+    };
+
+    auto edges_ok = [&](size_t begin, size_t end) {
+        for (uint32_t e = static_cast<uint32_t>(begin); e < end; e++) {
+            if (!edge_pool.alive[e]) continue;
+            if (!live(vertex_pool, e_v1[e]) || !live(vertex_pool, e_v2[e])) return false;
+            if (!full) continue;
+
+            // No reference may point at a killed slot
+            if ((e_f1[e] != kNone && !live(face_pool, e_f1[e])) ||
+                (e_f2[e] != kNone && !live(face_pool, e_f2[e]))) {
+                return false;
+            }
+            for (uint32_t wing : {e_p1_f1[e], e_n1_f1[e], e_p2_f2[e], e_n2_f2[e]}) {
+                if (wing != kNone && !live(edge_pool, wing)) return false;
+            }
+        }
+        return true;
+    };
+
+    // Every face loop must return to its anchor edge; the walks of one chunk
+    // share a 2E budget
+    auto faces_ok = [&](size_t begin, size_t end) {
+        size_t budget = 2 * edge_pool.live;
+        for (uint32_t f = static_cast<uint32_t>(begin); f < end; f++) {
+            if (!face_pool.alive[f] || f_edge[f] == kNone) continue;
+
+            uint32_t e = f_edge[f];
+            if (!live(edge_pool, e)) return false;
+            if (e_f1[e] != f && e_f2[e] != f) return false;
+            if (!closed) continue;
+
+            uint32_t current = e;
+            do {
+                if (budget-- == 0) return false;
+
+                if (e_f1[current] == f) {
+                    current = e_n1_f1[current];
+                } else if (e_f2[current] == f) {
+                    current = e_n2_f2[current];
+                } else {
+                    return false;
+                }
+                if (current == kNone) return false;
+            } while (current != e);
+        }
+        return true;
+    };
+
+    return parallelAll(vertex_pool.size(), threads, vertices_ok) &&
+           parallelAll(edge_pool.size(), threads, edges_ok) &&
+           parallelAll(face_pool.size(), threads, faces_ok);
+}
+
+bool IndexedKernel::isManifold() const {
+    std::vector<uint32_t> degrees(vertex_pool.size(), 0);
+    for (uint32_t e = 0; e < edge_pool.size(); e++) {
+        if (!edge_pool.alive[e]) continue;
+        if (e_v1[e] < degrees.size()) degrees[e_v1[e]]++;
+        if (e_v2[e] < degrees.size() && e_v2[e] != e_v1[e]) degrees[e_v2[e]]++;
+    }
+
+    // Each vertex's edges must form a single disk fan: the walk around the
+    // vertex returns to its anchor edge after visiting every incident edge once
+    auto fans_ok = [&](size_t begin, size_t end) {
+        for (uint32_t v = static_cast<uint32_t>(begin); v < end; v++) {
+            if (!vertex_pool.alive[v] || v_edge[v] == kNone) continue;
+
+            uint32_t current = v_edge[v];
+            uint32_t steps = 0;
+            do {
+                if (++steps > degrees[v]) return false;
+
+                if (e_v1[current] == v) {
+                    current = e_n1_f1[current];
+                } else if (e_v2[current] == v) {
+                    current = e_n2_f2[current];
+                } else {
+                    return false;
+                }
+                if (current == kNone) return false;
+            } while (current != v_edge[v]);
+
+            if (steps != degrees[v]) return false;
+        }
+        return true;
+    };
+
+    return parallelAll(vertex_pool.size(), resolveThreadCount(thread_count), fans_ok);
+}
+
+// ==================== GEOMETRY ====================
+
+void IndexedKernel::transformVertices(const std::vector<VertexId>& selection, const Mat4& transform) {
+    constexpr size_t kBlock = 256;
+    std::array<double, kBlock> x, y, z;
+    std::array<uint32_t, kBlock> slots;
+
+    for (size_t start = 0; start < selection.size();) {
+        // Gather the next block of live vertices
+        size_t count = 0;
+        for (; start < selection.size() && count < kBlock; start++) {
+            if (!isAlive(selection[start])) continue;
+            uint32_t v = selection[start].index;
+            slots[count] = v;
+            x[count] = v_x[v];
+            y[count] = v_y[v];
+            z[count] = v_z[v];
+            count++;
+        }
+
+        transform.transformPoints(x.data(), y.data(), z.data(), x.data(), y.data(), z.data(), count);
+        display_stale = true;
+
+        for (size_t i = 0; i < count; i++) {
+            v_x[slots[i]] = x[i];
+            v_y[slots[i]] = y[i];
+            v_z[slots[i]] = z[i];
+        }
+    }
+}
+
+void IndexedKernel::transformAll(const Mat4& transform) {
+    // Tombstoned slots are transformed too; that is cheaper than skipping them
+    transform.transformPoints(v_x.data(), v_y.data(), v_z.data(), v_x.data(), v_y.data(), v_z.data(), v_x.size());
+    display_stale = true;
+}
+
+const Vec3f* IndexedKernel::displayPositions() const {
+    if (display_stale) {
+        v_display.resize(v_x.size());
+        for (size_t i = 0; i < v_x.size(); i++) {
+            v_display[i] = Vec3f(static_cast<float>(v_x[i]), static_cast<float>(v_y[i]),
+                                 static_cast<float>(v_z[i]));
+        }
+        display_stale = false;
+    }
+    return v_display.data();
+}
+
+BoundingBox IndexedKernel::boundingBox() const {
+    BoundingBox box;
+    const size_t n = v_x.size();
+    double min_x = box.min.x, min_y = box.min.y, min_z = box.min.z;
+    double max_x = box.max.x, max_y = box.max.y, max_z = box.max.z;
+
+    // Branch-free over the columns so the loop vectorizes
+    for (size_t i = 0; i < n; i++) {
+        const bool live = vertex_pool.alive[i];
+        const double x = v_x[i], y = v_y[i], z = v_z[i];
+        min_x = live && x < min_x ? x : min_x;
+        min_y = live && y < min_y ? y : min_y;
+        min_z = live && z < min_z ? z : min_z;
+        max_x = live && x > max_x ? x : max_x;
+        max_y = live && y > max_y ? y : max_y;
+        max_z = live && z > max_z ? z : max_z;
+    }
+
+    box.min = Point3D(min_x, min_y, min_z);
+    box.max = Point3D(max_x, max_y, max_z);
+    return box;
+}
+
+// ==================== ACCESSORS ====================
+
+std::vector<VertexId> IndexedKernel::getVertices() const {
+    std::vector<VertexId> result;
+    result.reserve(vertex_pool.live);
+    for (uint32_t i = 0; i < vertex_pool.size(); i++) {
+        if (vertex_pool.alive[i]) result.push_back(vertexHandle(i));
+    }
+    return result;
+}
+
+std::vector<EdgeId> IndexedKernel::getEdges() const {
+    std::vector<EdgeId> result;
+    result.reserve(edge_pool.live);
+    for (uint32_t i = 0; i < edge_pool.size(); i++) {
+        if (edge_pool.alive[i]) result.push_back(edgeHandle(i));
+    }
+    return result;
+}
+
+std::vector<FaceId> IndexedKernel::getFaces() const {
+    std::vector<FaceId> result;
+    result.reserve(face_pool.live);
+    for (uint32_t i = 0; i < face_pool.size(); i++) {
+        if (face_pool.alive[i]) result.push_back(faceHandle(i));
+    }
+    return result;
+}
+
+} // namespace SketchyKernel
@@ -0,0 +1,385 @@
+#ifndef SKETCHY_KERNEL_INDEXED_KERNEL_H
+#define SKETCHY_KERNEL_INDEXED_KERNEL_H
+
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "geometry.h"
+#include "aligned_allocator.h"
+#include "circulator.h"
+#include "winged_edge.h"
+
+namespace SketchyKernel {
+
+/**
+ * Handle into one of the IndexedKernel element pools.
+ * The Tag parameter keeps vertex, edge and face handles from being mixed up.
+ *
+ * The 32-bit index addresses the slot; the generation is bumped every time
+ * the slot is killed, so a handle to a killed element never matches the
+ * element that later reuses its slot.
+ */
+template <typename Tag>
+struct Handle {
+    static constexpr uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    constexpr Handle() = default;
+    constexpr explicit Handle(uint32_t index, uint32_t generation = 0)
+        : index(index), generation(generation) {}
+
+    constexpr bool valid() const { return index != kInvalidIndex; }
+    constexpr explicit operator bool() const { return valid(); }
+
+    constexpr bool operator==(const Handle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    constexpr bool operator!=(const Handle& other) const { return !(*this == other); }
+    constexpr bool operator<(const Handle& other) const {
+        return index < other.index || (index == other.index && generation < other.generation);
+    }
+};
+
+using VertexId = Handle<struct VertexTag>;
+using EdgeId = Handle<struct EdgeTag>;
+using FaceId = Handle<struct FaceTag>;
+
+/**
+ * Old-slot -> new-handle table produced by IndexedKernel::compact()
+ */
+template <typename HandleT>
+struct SlotRemap {
+    std::vector<uint32_t> old_generation;
+    std::vector<HandleT> target;
+
+    /**
+     * Translate a pre-compaction handle; stale handles map to an invalid one
+     */
+    HandleT operator[](HandleT old) const {
+        if (old.index >= target.size() || old_generation[old.index] != old.generation) {
+            return HandleT();
+        }
+        return target[old.index];
+    }
+};
+
+/**
+ * Winged-edge kernel backed by contiguous struct-of-arrays pools.
+ *
+ * This is the index-based storage mode of the kernel: every vertex, edge and
+ * face is a slot in a flat column array and all connectivity is stored as
+ * 32-bit handles instead of shared_ptrs. The Euler operators and navigation
+ * queries mirror WingedEdgeKernel one-to-one, so callers only swap pointers
+ * for handles.
+ *
+ * Killed elements are tombstoned in O(1): the slot is marked dead, its
+ * generation is bumped and it goes on a free list for reuse. Handles of all
+ * other elements stay stable across every operator; compact() reclaims the
+ * tombstones when the caller is ready to translate handles.
+ */
+class IndexedKernel {
+public:
+    struct CompactionMap {
+        SlotRemap<VertexId> vertices;
+        SlotRemap<EdgeId> edges;
+        SlotRemap<FaceId> faces;
+    };
+
+    // Circulator policies over the edge columns (see circulator.h)
+    struct FaceLoopPolicy {
+        using Cursor = uint32_t;
+
+        const IndexedKernel* kernel;
+        uint32_t face;
+
+        bool valid(Cursor c) const { return c != kNone; }
+        bool same(Cursor a, Cursor b) const { return a == b; }
+        Cursor next(Cursor c) const {
+            if (kernel->e_f1[c] == face) return kernel->e_n1_f1[c];
+            if (kernel->e_f2[c] == face) return kernel->e_n2_f2[c];
+            return kNone;
+        }
+        EdgeId deref(Cursor c) const { return kernel->edgeHandle(c); }
+    };
+
+    struct FaceVertexPolicy : FaceLoopPolicy {
+        VertexId deref(Cursor c) const {
+            return kernel->vertexHandle(kernel->e_f1[c] == face ? kernel->e_v1[c] : kernel->e_v2[c]);
+        }
+    };
+
+    struct VertexLoopPolicy {
+        using Cursor = uint32_t;
+
+        const IndexedKernel* kernel;
+        uint32_t vertex;
+
+        bool valid(Cursor c) const { return c != kNone; }
+        bool same(Cursor a, Cursor b) const { return a == b; }
+        Cursor next(Cursor c) const {
+            if (kernel->e_v1[c] == vertex) return kernel->e_n1_f1[c];
+            if (kernel->e_v2[c] == vertex) return kernel->e_n2_f2[c];
+            return kNone;
+        }
+        EdgeId deref(Cursor c) const { return kernel->edgeHandle(c); }
+    };
+
+    using FaceEdgeRange = LoopRange<FaceLoopPolicy>;
+    using FaceVertexRange = LoopRange<FaceVertexPolicy>;
+    using VertexEdgeRange = LoopRange<VertexLoopPolicy>;
+
+private:
+    static constexpr uint32_t kNone = VertexId::kInvalidIndex;
+
+    // Liveness, generations and free list shared by one pool's columns
+    struct SlotPool {
+        std::vector<uint8_t> alive;
+        std::vector<uint32_t> generation;
+        std::vector<uint32_t> free_slots;
+        uint32_t generation_floor = 0;
+        size_t live = 0;
+
+        size_t size() const { return alive.size(); }
+        bool contains(uint32_t index, uint32_t gen) const {
+            return index < alive.size() && alive[index] && generation[index] == gen;
+        }
+
+        // Returns the slot to fill; appended is true when it is a new slot
+        uint32_t acquire(bool& appended);
+        void release(uint32_t index);
+        void reserve(size_t count);
+    };
+
+    // Vertex pool
+    SlotPool vertex_pool;
+    // Positions as separate x/y/z columns, so geometric passes stream
+    AlignedVector<double> v_x, v_y, v_z;
+
+    // Display-side float copy of the positions, rebuilt lazily
+    mutable AlignedVector<Vec3f> v_display;
+    mutable bool display_stale = true;
+    std::vector<uint32_t> v_edge;
+
+    // Edge pool (same column layout as Edge in winged_edge.h)
+    std::vector<uint32_t> e_v1, e_v2;
+    std::vector<uint32_t> e_f1, e_f2;
+    std::vector<uint32_t> e_p1_f1, e_n1_f1, e_p2_f2, e_n2_f2;
+    SlotPool edge_pool;
+
+    // Face pool
+    SlotPool face_pool;
+    std::vector<uint32_t> f_edge;
+
+    // Euler-Poincare bookkeeping (@see WingedEdgeKernel)
+    size_t solid_count = 0;
+    size_t ring_count = 0;
+
+    // Workers used by validate() and isManifold(); 0 = hardware threads
+    size_t thread_count = 0;
+
+    uint32_t allocVertex(const Point3D& coords);
+    uint32_t allocEdge();
+    uint32_t allocFace();
+
+    uint32_t loopStart(FaceId f) const { return isAlive(f) ? f_edge[f.index] : kNone; }
+    uint32_t loopStart(VertexId v) const { return isAlive(v) ? v_edge[v.index] : kNone; }
+
+    // @see WingedEdgeKernel::unlinkEdge
+    void unlinkEdge(uint32_t e);
+
+    VertexId vertexHandle(uint32_t index) const {
+        return index == kNone ? VertexId() : VertexId(index, vertex_pool.generation[index]);
+    }
+    EdgeId edgeHandle(uint32_t index) const {
+        return index == kNone ? EdgeId() : EdgeId(index, edge_pool.generation[index]);
+    }
+    FaceId faceHandle(uint32_t index) const {
+        return index == kNone ? FaceId() : FaceId(index, face_pool.generation[index]);
+    }
+
+public:
+    IndexedKernel() = default;
+
+    /**
+     * Build an indexed copy of a pointer-based kernel.
+     * Handles are assigned in the order of getVertices()/getEdges()/getFaces().
+     * @throws std::logic_error if source is frozen
+     */
+    static IndexedKernel fromKernel(const WingedEdgeKernel& source);
+
+    /**
+     * Reserve pool capacity up front for bulk construction
+     */
+    void reserve(size_t vertex_count, size_t edge_count, size_t face_count);
+
+    /**
+     * Drop all tombstoned slots and shrink the pools.
+     * Every handle issued before the call becomes stale; use the returned
+     * map to translate the ones the caller still holds.
+     */
+    CompactionMap compact();
+
+    /**
+     * Number of slots in each pool, live or tombstoned
+     */
+    size_t vertexSlotCount() const { return vertex_pool.size(); }
+    size_t edgeSlotCount() const { return edge_pool.size(); }
+    size_t faceSlotCount() const { return face_pool.size(); }
+
+    // ==================== EULER OPERATORS ====================
+
+    /**
+     * MVSF: Make Vertex, Solid, Face
+     * @see WingedEdgeKernel::mvsf
+     */
+    VertexId mvsf(const Point3D& coords);
+
+    /**
+     * MEV: Make Edge, Vertex
+     * @see WingedEdgeKernel::mev
+     */
+    EdgeId mev(VertexId from_vertex, const Point3D& to_coords, FaceId on_face);
+
+    /**
+     * MEF: Make Edge, Face
+     * @see WingedEdgeKernel::mef
+     */
+    EdgeId mef(VertexId v1, VertexId v2, FaceId face);
+
+    /**
+     * KEF: Kill Edge, Face
+     * @see WingedEdgeKernel::kef
+     */
+    FaceId kef(EdgeId edge);
+
+    /**
+     * KFMRH: Kill Face, Make Ring Hole
+     * @see WingedEdgeKernel::kfmrh
+     */
+    void kfmrh(FaceId hole_face, FaceId outer_face);
+
+    // ==================== NAVIGATION & QUERY ====================
+
+    /**
+     * Lazy circulators over the wing columns; no allocation
+     */
+    FaceEdgeRange faceEdges(FaceId f) const {
+        return FaceEdgeRange(FaceLoopPolicy{this, f.index}, loopStart(f), edge_pool.live + 1);
+    }
+
+    FaceVertexRange faceVertices(FaceId f) const {
+        return FaceVertexRange(FaceVertexPolicy{{this, f.index}}, loopStart(f), edge_pool.live + 1);
+    }
+
+    VertexEdgeRange vertexEdges(VertexId v) const {
+        return VertexEdgeRange(VertexLoopPolicy{this, v.index}, loopStart(v), edge_pool.live + 1);
+    }
+
+    std::vector<EdgeId> getIncidentEdges(VertexId v) const;
+    std::vector<FaceId> getIncidentFaces(VertexId v) const;
+    std::vector<EdgeId> getFaceBoundary(FaceId f) const;
+    std::vector<VertexId> getFaceVertices(FaceId f) const;
+
+    /**
+     * Validate the topological consistency of the pools
+     * @see WingedEdgeKernel::validate
+     */
+    bool validate(ValidationLevel level = ValidationLevel::Basic) const;
+
+    /**
+     * @see WingedEdgeKernel::isManifold
+     */
+    bool isManifold() const;
+
+    /**
+     * @see WingedEdgeKernel::setThreadCount
+     */
+    void setThreadCount(size_t count) { thread_count = count; }
+    size_t getThreadCount() const { return thread_count; }
+
+    // ==================== GEOMETRY ====================
+
+    /**
+     * Batch transform of the selected vertices; stale handles are skipped
+     * @see WingedEdgeKernel::transformVertices
+     */
+    void transformVertices(const std::vector<VertexId>& selection, const Mat4& transform);
+
+    /**
+     * Transform every vertex straight through the position columns
+     */
+    void transformAll(const Mat4& transform);
+
+    /**
+     * Bounds of all live vertices; empty when there are none
+     */
+    BoundingBox boundingBox() const;
+
+    /**
+     * Position columns, one entry per vertex slot (tombstoned slots included),
+     * 64-byte aligned. For SIMD passes and GPU uploads; valid until the next
+     * vertex is made or the kernel is compacted.
+     */
+    const double* positionsX() const { return v_x.data(); }
+    const double* positionsY() const { return v_y.data(); }
+    const double* positionsZ() const { return v_z.data(); }
+
+    /**
+     * Single-precision copy of the positions for the viewport, one packed
+     * Vec3f per vertex slot. Rebuilt on the first call after any position
+     * change; topology and modeling geometry stay in double.
+     */
+    const Vec3f* displayPositions() const;
+
+    // ==================== ACCESSORS ====================
+
+    size_t getVertexCount() const { return vertex_pool.live; }
+    size_t getEdgeCount() const { return edge_pool.live; }
+    size_t getFaceCount() const { return face_pool.live; }
+    size_t getSolidCount() const { return solid_count; }
+    size_t getRingCount() const { return ring_count; }
+
+    /**
+     * Live element handles, in slot order
+     */
+    std::vector<VertexId> getVertices() const;
+    std::vector<EdgeId> getEdges() const;
+    std::vector<FaceId> getFaces() const;
+
+    /**
+     * False for killed elements and for stale handles to a reused slot
+     */
+    bool isAlive(VertexId v) const { return vertex_pool.contains(v.index, v.generation); }
+    bool isAlive(EdgeId e) const { return edge_pool.contains(e.index, e.generation); }
+    bool isAlive(FaceId f) const { return face_pool.contains(f.index, f.generation); }
+
+    Point3D coords(VertexId v) const { return Point3D(v_x[v.index], v_y[v.index], v_z[v.index]); }
+    void setCoords(VertexId v, const Point3D& p) {
+        display_stale = true;
+        v_x[v.index] = p.x;
+        v_y[v.index] = p.y;
+        v_z[v.index] = p.z;
+    }
+    EdgeId vertexEdge(VertexId v) const { return edgeHandle(v_edge[v.index]); }
+    EdgeId faceEdge(FaceId f) const { return edgeHandle(f_edge[f.index]); }
+
+    VertexId v1(EdgeId e) const { return vertexHandle(e_v1[e.index]); }
+    VertexId v2(EdgeId e) const { return vertexHandle(e_v2[e.index]); }
+    FaceId f1(EdgeId e) const { return faceHandle(e_f1[e.index]); }
+    FaceId f2(EdgeId e) const { return faceHandle(e_f2[e.index]); }
+    EdgeId p1_f1(EdgeId e) const { return edgeHandle(e_p1_f1[e.index]); }
+    EdgeId n1_f1(EdgeId e) const { return edgeHandle(e_n1_f1[e.index]); }
+    EdgeId p2_f2(EdgeId e) const { return edgeHandle(e_p2_f2[e.index]); }
+    EdgeId n2_f2(EdgeId e) const { return edgeHandle(e_n2_f2[e.index]); }
+
+    /**
+     * Reassign the faces on either side of an edge (e.g. to open a boundary)
+     */
+    void setEdgeFaces(EdgeId e, FaceId f1, FaceId f2);
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_INDEXED_KERNEL_H
@@ -0,0 +1,995 @@
+#include "kernel_file.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "winged_edge.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SKETCHY_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SketchyKernel {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'K', 'E', 'T', 'C', 'H', 'Y', 'K'};
+constexpr uint32_t kEndianTag = 0x01020304u;
+constexpr uint64_t kSectionAlignment = 64;
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * Four independent multiply-rotate lanes over 32-byte blocks, combined at
+ * the end; the lanes keep the pass bandwidth-bound. Payload sizes are
+ * multiples of 64 bytes, so no partial block is left at the end.
+ */
+class Checksum {
+public:
+    void update(const unsigned char* bytes, size_t size) {
+        length += size;
+
+        // Top up a block left over from the previous call
+        if (pending > 0) {
+            size_t take = std::min(size, sizeof(block) - pending);
+            std::memcpy(block + pending, bytes, take);
+            pending += take;
+            bytes += take;
+            size -= take;
+            if (pending < sizeof(block)) return;
+            mix(block);
+            pending = 0;
+        }
+
+        for (; size >= sizeof(block); bytes += sizeof(block), size -= sizeof(block)) mix(bytes);
+
+        std::memcpy(block, bytes, size);
+        pending = size;
+    }
+
+    uint64_t value() const {
+        uint64_t h = length;
+        for (uint64_t lane : lanes) h = rotl(h ^ lane, 27) * 0x94D049BB133111EBull;
+        return h ^ (h >> 31);
+    }
+
+private:
+    void mix(const unsigned char* bytes) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            std::memcpy(&word, bytes + 8 * lane, sizeof(word));
+            lanes[lane] = rotl(lanes[lane] ^ (word * 0x9E3779B97F4A7C15ull), 29) * 0xBF58476D1CE4E5B9ull;
+        }
+    }
+
+    unsigned char block[32];
+    size_t pending = 0;
+    uint64_t lanes[4] = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull,
+                         0x082EFA98EC4E6C89ull};
+    uint64_t length = 0;
+};
+
+// Streams sections to disk, padding each one and hashing what it writes
+class SectionWriter {
+public:
+    explicit SectionWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {
+        if (!out) throw std::runtime_error("KernelFile: cannot open " + path + " for writing");
+    }
+
+    void write(const void* bytes, size_t size) {
+        out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+
+        // Only the part past the header is hashed, even when a write spans both
+        if (offset + size > sizeof(KernelFileHeader)) {
+            const size_t skip = offset < sizeof(KernelFileHeader) ? sizeof(KernelFileHeader) - offset : 0;
+            checksum.update(static_cast<const unsigned char*>(bytes) + skip, size - skip);
+        }
+        offset += size;
+    }
+
+    void pad() {
+        static const unsigned char zeros[kSectionAlignment] = {};
+        write(zeros, alignUp(offset) - offset);
+    }
+
+    template <typename T>
+    void writeSection(const std::vector<T>& values) {
+        write(values.data(), values.size() * sizeof(T));
+        pad();
+    }
+
+    void finish(KernelFileHeader& header) {
+        header.file_size = offset;
+        header.checksum = checksum.value();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.flush();
+        if (!out) throw std::runtime_error("KernelFile: write failed");
+    }
+
+    uint64_t position() const { return offset; }
+
+private:
+    std::ofstream out;
+    uint64_t offset = 0;
+    Checksum checksum;
+};
+
+// Magic, version and section bounds agree with a file of `size` bytes
+bool headerMatches(const KernelFileHeader& h, uint64_t size) {
+    bool ok = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kKernelFileVersion &&
+              h.endian_tag == kEndianTag && h.file_size == size;
+
+    // Every section must lie inside the file, in order, aligned
+    auto fits = [&](uint64_t offset, uint64_t bytes, uint64_t next) {
+        return offset % kSectionAlignment == 0 && offset <= size && bytes <= size - offset && offset + bytes <= next;
+    };
+    return ok && h.vertex_count < kFileNone && h.edge_count < kFileNone && h.face_count < kFileNone &&
+           fits(h.positions_offset, 24 * h.vertex_count, h.vertex_edges_offset) &&
+           fits(h.vertex_edges_offset, 4 * h.vertex_count, h.edges_offset) &&
+           fits(h.edges_offset, sizeof(KernelFileEdge) * h.edge_count, h.face_edges_offset) &&
+           fits(h.face_edges_offset, 4 * h.face_count, size) && h.positions_offset >= sizeof(KernelFileHeader);
+}
+
+} // namespace
+
+// ==================== MAPPED FILE ====================
+
+MappedKernelFile::MappedKernelFile(const std::string& path) {
+#if SKETCHY_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("KernelFile: cannot open " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(KernelFileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("KernelFile: " + path + " is too small to be a kernel file");
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) throw std::runtime_error("KernelFile: cannot map " + path);
+
+    data = static_cast<const unsigned char*>(address);
+    mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("KernelFile: cannot open " + path);
+
+    buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (buffer.size() < sizeof(KernelFileHeader)) {
+        throw std::runtime_error("KernelFile: " + path + " is too small to be a kernel file");
+    }
+    data = buffer.data();
+    size = buffer.size();
+#endif
+
+    const bool ok = headerMatches(header(), size);
+    if (!ok) {
+        release();
+        throw std::runtime_error("KernelFile: " + path + " is not a version 1 kernel file");
+    }
+}
+
+MappedKernelFile::~MappedKernelFile() {
+    release();
+}
+
+MappedKernelFile::MappedKernelFile(MappedKernelFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedKernelFile& MappedKernelFile::operator=(MappedKernelFile&& other) noexcept {
+    if (this == &other) return *this;
+
+    release();
+    mapped = other.mapped;
+    size = other.size;
+    buffer = std::move(other.buffer);
+    data = mapped ? other.data : buffer.data();
+
+    other.data = nullptr;
+    other.size = 0;
+    other.mapped = false;
+    return *this;
+}
+
+void MappedKernelFile::release() {
+#if SKETCHY_HAVE_MMAP
+    if (mapped && data) ::munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+}
+
+bool MappedKernelFile::verifyChecksum() const {
+    Checksum checksum;
+    checksum.update(data + sizeof(KernelFileHeader), size - sizeof(KernelFileHeader));
+    return checksum.value() == header().checksum;
+}
+
+
+// ==================== SAVE / LOAD ====================
+
+namespace {
+
+using PositionRecord = std::array<double, 3>;
+
+constexpr size_t kBatchRecords = size_t(1) << 14; // Records encoded or decoded per step
+constexpr size_t kChunkBytes = size_t(4) << 20;   // Unit of background reads and writes
+constexpr size_t kQueuedChunks = 4;               // Encoded chunks waiting for the writer
+constexpr std::chrono::milliseconds kCancelPoll(20);
+
+// Wait on `changed` until ready(); false if the task is cancelled first.
+// Nothing notifies a cancel, so the timed waits recheck it.
+template <typename Ready>
+bool waitUnlessCancelled(std::condition_variable& changed, std::unique_lock<std::mutex>& lock,
+                         const FileTaskState& state, const Ready& ready) {
+    while (!ready()) {
+        if (state.cancelled.load()) return false;
+        changed.wait_for(lock, kCancelPoll);
+    }
+    return true;
+}
+
+// Records in file order, from the live element lists
+class KernelSource {
+public:
+    explicit KernelSource(const WingedEdgeKernel& kernel)
+        : kernel(kernel), vertex_index(indexTable(kernel.getVertices())),
+          edge_index(indexTable(kernel.getEdges())), face_index(indexTable(kernel.getFaces())) {}
+
+    size_t vertexCount() const { return kernel.getVertices().size(); }
+    size_t edgeCount() const { return kernel.getEdges().size(); }
+    size_t faceCount() const { return kernel.getFaces().size(); }
+    size_t solidCount() const { return kernel.getSolidCount(); }
+    size_t ringCount() const { return kernel.getRingCount(); }
+
+    PositionRecord position(size_t i) const {
+        const Point3D& p = kernel.getVertices()[i]->coords;
+        return {p.x, p.y, p.z};
+    }
+    uint32_t vertexEdge(size_t i) const { return lookup(edge_index, kernel.getVertices()[i]->edge); }
+    uint32_t faceEdge(size_t i) const { return lookup(edge_index, kernel.getFaces()[i]->edge); }
+    KernelFileEdge edge(size_t i) const {
+        const Edge& e = *kernel.getEdges()[i];
+        return {lookup(vertex_index, e.v1), lookup(vertex_index, e.v2),
+                lookup(face_index, e.f1), lookup(face_index, e.f2),
+                lookup(edge_index, e.p1_f1), lookup(edge_index, e.n1_f1),
+                lookup(edge_index, e.p2_f2), lookup(edge_index, e.n2_f2)};
+    }
+
+private:
+    const WingedEdgeKernel& kernel;
+    std::vector<uint32_t> vertex_index, edge_index, face_index;
+
+    // Element IDs -> file indices, by position in the element lists
+    template <typename List>
+    static std::vector<uint32_t> indexTable(const List& list) {
+        int max_id = 0;
+        for (const auto& element : list) max_id = std::max(max_id, element->id);
+
+        std::vector<uint32_t> index(static_cast<size_t>(max_id) + 1, kFileNone);
+        for (size_t i = 0; i < list.size(); i++) index[list[i]->id] = static_cast<uint32_t>(i);
+        return index;
+    }
+
+    // References to elements outside the kernel are written as "none"
+    template <typename Element>
+    static uint32_t lookup(const std::vector<uint32_t>& index, const std::shared_ptr<Element>& element) {
+        if (!element || element->id < 0 || static_cast<size_t>(element->id) >= index.size()) return kFileNone;
+        return index[element->id];
+    }
+};
+
+// Records in ID order, from the frozen form, without thawing
+class FrozenSource {
+public:
+    FrozenSource(const FrozenTopology& model, size_t solids, size_t rings)
+        : model(model), solids(solids), rings(rings) {}
+
+    size_t vertexCount() const { return model.getVertexCount(); }
+    size_t edgeCount() const { return model.getEdgeCount(); }
+    size_t faceCount() const { return model.getFaceCount(); }
+    size_t solidCount() const { return solids; }
+    size_t ringCount() const { return rings; }
+
+    PositionRecord position(size_t i) const {
+        const Point3D p = model.vertexAt(i).coords;
+        return {p.x, p.y, p.z};
+    }
+    uint32_t vertexEdge(size_t i) const { return edge(model.vertexAt(i).edge); }
+    uint32_t faceEdge(size_t i) const { return edge(model.faceAt(i).edge); }
+    KernelFileEdge edge(size_t i) const {
+        const FrozenEdge e = model.edgeAt(i);
+        return {vertex(e.v1), vertex(e.v2), face(e.f1), face(e.f2),
+                edge(e.p1_f1), edge(e.n1_f1), edge(e.p2_f2), edge(e.n2_f2)};
+    }
+
+private:
+    const FrozenTopology& model;
+    size_t solids, rings;
+
+    static uint32_t index(long i) { return i < 0 ? kFileNone : static_cast<uint32_t>(i); }
+    uint32_t vertex(int id) const { return id < 0 ? kFileNone : index(model.vertexIndex(id)); }
+    uint32_t edge(int id) const { return id < 0 ? kFileNone : index(model.edgeIndex(id)); }
+    uint32_t face(int id) const { return id < 0 ? kFileNone : index(model.faceIndex(id)); }
+};
+
+// Records in ID order, from a published snapshot
+class SnapshotSource {
+public:
+    explicit SnapshotSource(const KernelSnapshot& snapshot) : snapshot(snapshot) {
+        collect(snapshot.vertexColumn(), vertex_order, vertex_index);
+        collect(snapshot.edgeColumn(), edge_order, edge_index);
+        collect(snapshot.faceColumn(), face_order, face_index);
+    }
+
+    size_t vertexCount() const { return vertex_order.size(); }
+    size_t edgeCount() const { return edge_order.size(); }
+    size_t faceCount() const { return face_order.size(); }
+    size_t solidCount() const { return snapshot.getSolidCount(); }
+    size_t ringCount() const { return snapshot.getRingCount(); }
+
+    PositionRecord position(size_t i) const {
+        const Point3D& p = vertex_order[i]->coords;
+        return {p.x, p.y, p.z};
+    }
+    uint32_t vertexEdge(size_t i) const { return lookup(edge_index, vertex_order[i]->edge); }
+    uint32_t faceEdge(size_t i) const { return lookup(edge_index, face_order[i]->edge); }
+    KernelFileEdge edge(size_t i) const {
+        const SnapshotEdge& e = *edge_order[i];
+        return {lookup(vertex_index, e.v1), lookup(vertex_index, e.v2),
+                lookup(face_index, e.f1), lookup(face_index, e.f2),
+                lookup(edge_index, e.p1_f1), lookup(edge_index, e.n1_f1),
+                lookup(edge_index, e.p2_f2), lookup(edge_index, e.n2_f2)};
+    }
+
+private:
+    const KernelSnapshot& snapshot;
+    std::vector<const SnapshotVertex*> vertex_order;
+    std::vector<const SnapshotEdge*> edge_order;
+    std::vector<const SnapshotFace*> face_order;
+    std::vector<uint32_t> vertex_index, edge_index, face_index;
+
+    template <typename Record>
+    static void collect(const PagedColumn<Record>& column, std::vector<const Record*>& order,
+                        std::vector<uint32_t>& index) {
+        index.assign(column.pageCount() * PagedColumn<Record>::kPageSize, kFileNone);
+        column.forEach([&](const Record& record) {
+            index[record.id] = static_cast<uint32_t>(order.size());
+            order.push_back(&record);
+        });
+    }
+
+    // Snapshot references are IDs, 0 = none
+    static uint32_t lookup(const std::vector<uint32_t>& index, int id) {
+        return id > 0 && static_cast<size_t>(id) < index.size() ? index[id] : kFileNone;
+    }
+};
+
+// Header with every count and section offset filled in; file_size is final,
+// the checksum is left to the writer
+template <typename Source>
+KernelFileHeader layoutHeader(const Source& model) {
+    KernelFileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kKernelFileVersion;
+    header.endian_tag = kEndianTag;
+    header.vertex_count = model.vertexCount();
+    header.edge_count = model.edgeCount();
+    header.face_count = model.faceCount();
+    header.solid_count = model.solidCount();
+    header.ring_count = model.ringCount();
+
+    header.positions_offset = alignUp(sizeof(KernelFileHeader));
+    header.vertex_edges_offset = alignUp(header.positions_offset + sizeof(PositionRecord) * header.vertex_count);
+    header.edges_offset = alignUp(header.vertex_edges_offset + sizeof(uint32_t) * header.vertex_count);
+    header.face_edges_offset = alignUp(header.edges_offset + sizeof(KernelFileEdge) * header.edge_count);
+    header.file_size = alignUp(header.face_edges_offset + sizeof(uint32_t) * header.face_count);
+    return header;
+}
+
+template <typename Record, typename Sink, typename RecordAt>
+void writeSection(Sink& out, size_t count, const RecordAt& record_at) {
+    std::vector<Record> batch;
+    batch.reserve(std::min(count, kBatchRecords));
+    for (size_t begin = 0; begin < count; begin += kBatchRecords) {
+        const size_t end = std::min(count, begin + kBatchRecords);
+        batch.clear();
+        for (size_t i = begin; i < end; i++) batch.push_back(record_at(i));
+        out.write(batch.data(), batch.size() * sizeof(Record));
+    }
+    out.pad();
+}
+
+// Header and sections in file order; the sink supplies write(), pad() and
+// position()
+template <typename Source, typename Sink>
+void writeKernelFile(const Source& model, const KernelFileHeader& header, Sink& out) {
+    out.write(&header, sizeof(header));
+    out.pad();
+    writeSection<PositionRecord>(out, model.vertexCount(), [&](size_t i) { return model.position(i); });
+    writeSection<uint32_t>(out, model.vertexCount(), [&](size_t i) { return model.vertexEdge(i); });
+    writeSection<KernelFileEdge>(out, model.edgeCount(), [&](size_t i) { return model.edge(i); });
+    writeSection<uint32_t>(out, model.faceCount(), [&](size_t i) { return model.faceEdge(i); });
+    if (out.position() != header.file_size) throw std::logic_error("KernelFile: sections do not match the layout");
+}
+
+// Move a finished <path>.part over <path>; the part is removed if that fails
+void replaceWithPart(const std::string& part, const std::string& path) {
+    std::error_code error;
+    std::filesystem::rename(part, path, error);
+    if (error) {
+        std::remove(part.c_str());
+        throw std::runtime_error("KernelFile: cannot replace " + path + ": " + error.message());
+    }
+}
+
+template <typename Source>
+void saveFrom(const Source& model, const std::string& path) {
+    KernelFileHeader header = layoutHeader(model);
+    const std::string part = path + ".part";
+    try {
+        SectionWriter writer(part);
+        writeKernelFile(model, header, writer);
+        writer.finish(header);
+    } catch (...) {
+        std::remove(part.c_str());
+        throw;
+    }
+    replaceWithPart(part, path);
+}
+
+// Bounded hand-off of byte chunks from one producer thread to one consumer
+class ChunkQueue {
+public:
+    ChunkQueue(size_t capacity, const FileTaskState& state) : capacity(capacity), state(state) {}
+
+    // Producer: blocks while the queue is full; false once the consumer
+    // stopped or the task was cancelled
+    bool push(std::vector<unsigned char> chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!waitUnlessCancelled(changed, lock, state, [&] { return chunks.size() < capacity || stopped; })) {
+            return false;
+        }
+        if (stopped) return false;
+        chunks.push_back(std::move(chunk));
+        changed.notify_all();
+        return true;
+    }
+
+    // Producer: no more chunks; `complete` is false when the stream was cut short
+    void close(bool complete) {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        completed = complete;
+        changed.notify_all();
+    }
+
+    // Consumer: false once the queue is closed and drained, or cancelled
+    bool pop(std::vector<unsigned char>& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!waitUnlessCancelled(changed, lock, state, [&] { return !chunks.empty() || closed; })) return false;
+        if (chunks.empty()) return false;
+        chunk = std::move(chunks.front());
+        chunks.pop_front();
+        changed.notify_all();
+        return true;
+    }
+
+    // Consumer: refuse any further chunks
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        chunks.clear();
+        changed.notify_all();
+    }
+
+    bool isComplete() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return completed;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<unsigned char>> chunks;
+    size_t capacity;
+    const FileTaskState& state;
+    bool closed = false;
+    bool completed = false;
+    bool stopped = false;
+};
+
+// Sink for writeKernelFile() that gathers bytes into chunks for a writer
+// thread; cancellation is checked at every chunk
+class QueuedSink {
+public:
+    QueuedSink(ChunkQueue& queue, const FileTaskState& state) : queue(queue), state(state) {
+        chunk.reserve(kChunkBytes);
+    }
+
+    void write(const void* bytes, size_t size) {
+        const auto* data = static_cast<const unsigned char*>(bytes);
+        chunk.insert(chunk.end(), data, data + size);
+        offset += size;
+        if (chunk.size() >= kChunkBytes) flush();
+    }
+
+    void pad() {
+        static const unsigned char zeros[kSectionAlignment] = {};
+        write(zeros, alignUp(offset) - offset);
+    }
+
+    uint64_t position() const { return offset; }
+
+    void flush() {
+        if (state.cancelled.load()) throw FileTaskCancelled("KernelFile: save cancelled");
+        if (chunk.empty()) return;
+        if (!queue.push(std::move(chunk))) {
+            if (state.cancelled.load()) throw FileTaskCancelled("KernelFile: save cancelled");
+            throw std::runtime_error("KernelFile: writer stopped");
+        }
+        chunk = std::vector<unsigned char>();
+        chunk.reserve(kChunkBytes);
+        state.report();
+    }
+
+private:
+    ChunkQueue& queue;
+    const FileTaskState& state;
+    std::vector<unsigned char> chunk;
+    uint64_t offset = 0;
+};
+
+// Encode on this thread while a writer thread hashes and writes the chunks
+// to <path>.part, then move the finished file over <path>
+template <typename Source>
+void streamToFile(const Source& model, const std::string& path, FileTaskState& state) {
+    const KernelFileHeader header = layoutHeader(model);
+    state.total.store(header.file_size);
+    const std::string part = path + ".part";
+
+    ChunkQueue queue(kQueuedChunks, state);
+    std::exception_ptr write_error;
+    std::thread writer([&] {
+        try {
+            SectionWriter file(part);
+            std::vector<unsigned char> chunk;
+            while (queue.pop(chunk)) {
+                file.write(chunk.data(), chunk.size());
+                state.advance(chunk.size());
+            }
+            KernelFileHeader final_header = header;
+            if (queue.isComplete()) file.finish(final_header);
+        } catch (...) {
+            write_error = std::current_exception();
+            queue.stop();
+        }
+    });
+
+    auto discard = [&] {
+        std::remove(part.c_str());
+        if (write_error) std::rethrow_exception(write_error);
+    };
+    try {
+        QueuedSink sink(queue, state);
+        writeKernelFile(model, header, sink);
+        sink.flush();
+        queue.close(true);
+    } catch (...) {
+        queue.close(false);
+        writer.join();
+        discard();
+        throw;
+    }
+    writer.join();
+    if (write_error) discard();
+
+    replaceWithPart(part, path);
+    state.report();
+}
+
+// A file's bytes as a reader thread brings them in. Other stages wait for
+// the prefix they need; the reader stops early once the file is abandoned.
+class ArrivingFile {
+public:
+    ArrivingFile(size_t size, const FileTaskState& state) : bytes(new unsigned char[size]), size(size), state(state) {}
+
+    unsigned char* data() { return bytes.get(); }
+    size_t getSize() const { return size; }
+
+    // Wait until [0, end) has arrived; false if the reader stopped or the
+    // task was cancelled first
+    bool waitFor(size_t end) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return waitUnlessCancelled(arrived, lock, state, [&] { return available >= end || stopped; }) &&
+               available >= end;
+    }
+
+    void publish(size_t end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        available = end;
+        arrived.notify_all();
+    }
+
+    // The reader is done; error is empty unless reading failed
+    void stop(std::string message = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        error = std::move(message);
+        arrived.notify_all();
+    }
+
+    std::string getError() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return error;
+    }
+
+    void abandon() { abandoned.store(true); }
+    bool isAbandoned() const { return abandoned.load(); }
+
+private:
+    std::unique_ptr<unsigned char[]> bytes;
+    size_t size;
+    const FileTaskState& state;
+    mutable std::mutex mutex;
+    std::condition_variable arrived;
+    size_t available = 0;
+    bool stopped = false;
+    std::string error;
+    std::atomic<bool> abandoned{false};
+};
+
+void readChunks(const std::string& path, size_t offset, ArrivingFile& file, FileTaskState& state) {
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(offset));
+    while (offset < file.getSize()) {
+        if (state.cancelled.load() || file.isAbandoned()) return file.stop();
+
+        const size_t size = std::min(kChunkBytes, file.getSize() - offset);
+        in.read(reinterpret_cast<char*>(file.data() + offset), static_cast<std::streamsize>(size));
+        if (!in) return file.stop("KernelFile: read failed on " + path);
+
+        offset += size;
+        state.advance(size);
+        file.publish(offset);
+    }
+    file.stop();
+}
+
+void checkIndex(uint32_t index, size_t count) {
+    if (index != kFileNone && index >= count) {
+        throw std::runtime_error("KernelFile: element index out of range");
+    }
+}
+
+void checkEdgeRecords(const KernelFileEdge* edges, size_t begin, size_t end, const KernelFileHeader& h) {
+    for (size_t i = begin; i < end; i++) {
+        const KernelFileEdge& r = edges[i];
+        checkIndex(r.v1, h.vertex_count);
+        checkIndex(r.v2, h.vertex_count);
+        checkIndex(r.f1, h.face_count);
+        checkIndex(r.f2, h.face_count);
+        for (uint32_t wing : {r.p1_f1, r.n1_f1, r.p2_f2, r.n2_f2}) checkIndex(wing, h.edge_count);
+    }
+}
+
+} // namespace
+
+/**
+ * Allocates a kernel's elements for file records, in file order, and wires
+ * them once every record is in. File index i becomes ID i + 1, so the slot
+ * tables are the identity.
+ */
+class KernelFile::Loader {
+public:
+    Loader(size_t vertex_count, size_t edge_count, size_t face_count) {
+        auto fill_slots = [](std::vector<int>& slots, size_t count) {
+            slots.assign(count + 1, -1);
+            for (size_t i = 0; i < count; i++) slots[i + 1] = static_cast<int>(i);
+        };
+        fill_slots(kernel.vertex_slots, vertex_count);
+        fill_slots(kernel.edge_slots, edge_count);
+        fill_slots(kernel.face_slots, face_count);
+
+        kernel.vertices.reserve(vertex_count);
+        kernel.edges.reserve(edge_count);
+        kernel.faces.reserve(face_count);
+    }
+
+    // Elements up to (not including) file index `end`
+    void addVertices(const double* positions, size_t end) {
+        for (size_t i = kernel.vertices.size(); i < end; i++) {
+            const double* p = positions + 3 * i;
+            kernel.vertices.push_back(kernel.makeElement<Vertex>(static_cast<int>(i + 1), Point3D(p[0], p[1], p[2])));
+        }
+    }
+    void addEdges(size_t end) {
+        for (size_t i = kernel.edges.size(); i < end; i++) {
+            kernel.edges.push_back(kernel.makeElement<Edge>(static_cast<int>(i + 1)));
+        }
+    }
+    void addFaces(size_t end) {
+        for (size_t i = kernel.faces.size(); i < end; i++) {
+            kernel.faces.push_back(kernel.makeElement<Face>(static_cast<int>(i + 1)));
+        }
+    }
+
+    /**
+     * Set every reference from checked records. Each worker writes its own
+     * elements, so this runs on `threads` workers; one unit of progress is
+     * added per element.
+     */
+    void link(const uint32_t* vertex_edges, const KernelFileEdge* records, const uint32_t* face_edges,
+              size_t threads, FileTaskState* state = nullptr) {
+        const auto& vertices = kernel.vertices;
+        const auto& edges = kernel.edges;
+        const auto& faces = kernel.faces;
+        auto at = [](const auto& list, uint32_t index) {
+            return index == kFileNone ? nullptr : list[index];
+        };
+        auto done = [&](size_t units) {
+            if (state) state->advance(units);
+        };
+
+        parallelFor(vertices.size(), threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) vertices[i]->edge = at(edges, vertex_edges[i]);
+            done(end - begin);
+        });
+        parallelFor(faces.size(), threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) faces[i]->edge = at(edges, face_edges[i]);
+            done(end - begin);
+        });
+        parallelFor(edges.size(), threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const KernelFileEdge& r = records[i];
+                Edge& e = *edges[i];
+                e.v1 = at(vertices, r.v1);
+                e.v2 = at(vertices, r.v2);
+                e.f1 = at(faces, r.f1);
+                e.f2 = at(faces, r.f2);
+                e.p1_f1 = at(edges, r.p1_f1);
+                e.n1_f1 = at(edges, r.n1_f1);
+                e.p2_f2 = at(edges, r.p2_f2);
+                e.n2_f2 = at(edges, r.n2_f2);
+            }
+            done(end - begin);
+        });
+    }
+
+    WingedEdgeKernel finish(size_t solid_count, size_t ring_count) {
+        kernel.next_v_id = static_cast<int>(kernel.vertices.size() + 1);
+        kernel.next_e_id = static_cast<int>(kernel.edges.size() + 1);
+        kernel.next_f_id = static_cast<int>(kernel.faces.size() + 1);
+        kernel.solid_count = solid_count;
+        kernel.ring_count = ring_count;
+        return std::move(kernel);
+    }
+
+private:
+    WingedEdgeKernel kernel;
+};
+
+void KernelFile::save(const WingedEdgeKernel& kernel, const std::string& path) {
+    if (kernel.isFrozen()) {
+        saveFrom(FrozenSource(*kernel.getFrozen(), kernel.getSolidCount(), kernel.getRingCount()), path);
+    } else {
+        saveFrom(KernelSource(kernel), path);
+    }
+}
+
+WingedEdgeKernel KernelFile::load(const std::string& path) {
+    return load(MappedKernelFile(path));
+}
+
+WingedEdgeKernel KernelFile::load(const MappedKernelFile& file) {
+    if (!file.verifyChecksum()) {
+        throw std::runtime_error("KernelFile: checksum mismatch");
+    }
+
+    KernelFileHeader counts = {};
+    counts.vertex_count = file.getVertexCount();
+    counts.edge_count = file.getEdgeCount();
+    counts.face_count = file.getFaceCount();
+
+    for (size_t i = 0; i < counts.vertex_count; i++) checkIndex(file.vertexEdges()[i], counts.edge_count);
+    for (size_t i = 0; i < counts.face_count; i++) checkIndex(file.faceEdges()[i], counts.edge_count);
+    checkEdgeRecords(file.edges(), 0, counts.edge_count, counts);
+
+    Loader loader(counts.vertex_count, counts.edge_count, counts.face_count);
+    loader.addVertices(file.positions(), counts.vertex_count);
+    loader.addEdges(counts.edge_count);
+    loader.addFaces(counts.face_count);
+    loader.link(file.vertexEdges(), file.edges(), file.faceEdges(), 1);
+    return loader.finish(file.getSolidCount(), file.getRingCount());
+}
+
+// ==================== BACKGROUND I/O ====================
+
+template <typename Result, typename Body>
+FileTask<Result> KernelFile::startTask(FileTaskOptions options, Body body) {
+    FileTask<Result> task;
+    task.state = std::make_shared<FileTaskState>();
+    task.state->on_progress = std::move(options.on_progress);
+
+    std::promise<Result> promise;
+    task.result = promise.get_future();
+    task.worker = std::thread([state = task.state, promise = std::move(promise), body = std::move(body)]() mutable {
+        try {
+            if constexpr (std::is_void<Result>::value) {
+                body(*state);
+                promise.set_value();
+            } else {
+                promise.set_value(body(*state));
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    });
+    return task;
+}
+
+FileTask<WingedEdgeKernel> KernelFile::loadAsync(const std::string& path, FileTaskOptions options) {
+    const size_t threads = resolveThreadCount(options.thread_count);
+    return startTask<WingedEdgeKernel>(std::move(options), [path, threads](FileTaskState& state) {
+        // The header sizes the work before the pipeline starts
+        KernelFileHeader header = {};
+        uint64_t size = 0;
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) throw std::runtime_error("KernelFile: cannot open " + path);
+            size = static_cast<uint64_t>(in.tellg());
+            in.seekg(0);
+            if (size < sizeof(header) || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                throw std::runtime_error("KernelFile: " + path + " is too small to be a kernel file");
+            }
+        }
+        if (!headerMatches(header, size)) {
+            throw std::runtime_error("KernelFile: " + path + " is not a version 1 kernel file");
+        }
+        const size_t vertex_count = header.vertex_count;
+        const size_t edge_count = header.edge_count;
+        const size_t face_count = header.face_count;
+
+        // Units: bytes read, record bytes decoded, elements linked
+        const uint64_t record_bytes = 28 * header.vertex_count + sizeof(KernelFileEdge) * header.edge_count +
+                                      4 * header.face_count;
+        state.total.store(size + record_bytes + vertex_count + edge_count + face_count);
+        state.advance(sizeof(header));
+
+        ArrivingFile file(size, state);
+        std::memcpy(file.data(), &header, sizeof(header));
+        file.publish(sizeof(header));
+
+        uint64_t digest = 0;
+        bool hashed = false;
+        std::thread reader([&] { readChunks(path, sizeof(header), file, state); });
+        std::thread hasher([&] {
+            Checksum checksum;
+            for (size_t offset = sizeof(header); offset < size;) {
+                const size_t end = std::min<size_t>(size, offset + kChunkBytes);
+                if (!file.waitFor(end)) return;
+                checksum.update(file.data() + offset, end - offset);
+                offset = end;
+            }
+            digest = checksum.value();
+            hashed = true;
+        });
+
+        // Stops and joins both stages however the task ends
+        struct Pipeline {
+            ArrivingFile& file;
+            std::thread& reader;
+            std::thread& hasher;
+            void join() {
+                file.abandon();
+                if (reader.joinable()) reader.join();
+                if (hasher.joinable()) hasher.join();
+            }
+            ~Pipeline() { join(); }
+        } pipeline{file, reader, hasher};
+
+        auto fail = [&]() {
+            if (state.cancelled.load()) throw FileTaskCancelled("KernelFile: load cancelled");
+            const std::string error = file.getError();
+            throw std::runtime_error(error.empty() ? "KernelFile: " + path + " ended early" : error);
+        };
+
+        // Decode each section in batches as soon as its bytes are in
+        auto consume = [&](uint64_t offset, size_t count, size_t bytes_per_record, const auto& take) {
+            for (size_t begin = 0; begin < count; begin += kBatchRecords) {
+                const size_t end = std::min(count, begin + kBatchRecords);
+                if (state.cancelled.load()) throw FileTaskCancelled("KernelFile: load cancelled");
+                if (!file.waitFor(offset + end * bytes_per_record)) fail();
+                take(begin, end);
+                state.advance((end - begin) * bytes_per_record);
+                state.report();
+            }
+        };
+
+        const unsigned char* data = file.data();
+        const auto* positions = reinterpret_cast<const double*>(data + header.positions_offset);
+        const auto* vertex_edges = reinterpret_cast<const uint32_t*>(data + header.vertex_edges_offset);
+        const auto* records = reinterpret_cast<const KernelFileEdge*>(data + header.edges_offset);
+        const auto* face_edges = reinterpret_cast<const uint32_t*>(data + header.face_edges_offset);
+
+        Loader loader(vertex_count, edge_count, face_count);
+        consume(header.positions_offset, vertex_count, sizeof(PositionRecord),
+                [&](size_t, size_t end) { loader.addVertices(positions, end); });
+        consume(header.vertex_edges_offset, vertex_count, sizeof(uint32_t), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) checkIndex(vertex_edges[i], edge_count);
+        });
+        consume(header.edges_offset, edge_count, sizeof(KernelFileEdge), [&](size_t begin, size_t end) {
+            checkEdgeRecords(records, begin, end, header);
+            loader.addEdges(end);
+        });
+        consume(header.face_edges_offset, face_count, sizeof(uint32_t), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) checkIndex(face_edges[i], edge_count);
+            loader.addFaces(end);
+        });
+
+        if (!file.waitFor(size)) fail();
+        pipeline.join();
+        if (!hashed) fail();
+        if (digest != header.checksum) throw std::runtime_error("KernelFile: checksum mismatch");
+        if (state.cancelled.load()) throw FileTaskCancelled("KernelFile: load cancelled");
+
+        loader.link(vertex_edges, records, face_edges, threads, &state);
+        WingedEdgeKernel kernel = loader.finish(header.solid_count, header.ring_count);
+        state.report();
+        return kernel;
+    });
+}
+
+FileTask<void> KernelFile::saveAsync(WingedEdgeKernel& kernel, const std::string& path, FileTaskOptions options) {
+    if (kernel.isFrozen()) {
+        // The frozen form is compact; a copy lets the kernel thaw and edit meanwhile
+        auto frozen = std::make_shared<const FrozenTopology>(*kernel.getFrozen());
+        const size_t solids = kernel.getSolidCount();
+        const size_t rings = kernel.getRingCount();
+        return startTask<void>(std::move(options), [frozen, solids, rings, path](FileTaskState& state) {
+            streamToFile(FrozenSource(*frozen, solids, rings), path, state);
+        });
+    }
+
+    auto snapshot = kernel.snapshot();
+    if (!snapshot) throw std::logic_error("KernelFile::saveAsync: no snapshot exists while a batch is open");
+    return saveAsync(std::move(snapshot), path, std::move(options));
+}
+
+FileTask<void> KernelFile::saveAsync(std::shared_ptr<const KernelSnapshot> snapshot, const std::string& path,
+                                     FileTaskOptions options) {
+    if (!snapshot) throw std::invalid_argument("KernelFile::saveAsync: snapshot is null");
+    return startTask<void>(std::move(options), [snapshot, path](FileTaskState& state) {
+        streamToFile(SnapshotSource(*snapshot), path, state);
+    });
+}
+
+} // namespace SketchyKernel
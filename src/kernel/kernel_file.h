@@ -0,0 +1,300 @@
+#ifndef SKETCHY_KERNEL_KERNEL_FILE_H
+#define SKETCHY_KERNEL_KERNEL_FILE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "geometry.h"
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+class KernelSnapshot;
+
+/**
+ * On-disk layout, version 1 (all little-endian):
+ *
+ *   KernelFileHeader
+ *   positions     double[3 * V]   x, y, z per vertex
+ *   vertex_edges  uint32[V]       one incident edge per vertex
+ *   edges         KernelFileEdge[E]
+ *   face_edges    uint32[F]       one boundary edge per face
+ *
+ * Elements are referenced by their index in the file; kFileNone is "none".
+ * Every section starts on a 64-byte boundary, so a mapped file can be read
+ * in place. The checksum covers every byte after the header.
+ */
+constexpr uint32_t kFileNone = 0xFFFFFFFFu;
+constexpr uint32_t kKernelFileVersion = 1;
+
+struct KernelFileHeader {
+    char magic[8];              // "SKETCHYK"
+    uint32_t version;
+    uint32_t endian_tag;        // 0x01020304 as written by the producer
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    uint64_t face_count;
+    uint64_t solid_count;
+    uint64_t ring_count;
+    uint64_t positions_offset;
+    uint64_t vertex_edges_offset;
+    uint64_t edges_offset;
+    uint64_t face_edges_offset;
+    uint64_t file_size;
+    uint64_t checksum;
+    uint64_t reserved[3];
+};
+static_assert(sizeof(KernelFileHeader) == 128, "header layout is part of the format");
+
+// Same fields and sides as Edge, as file indices
+struct KernelFileEdge {
+    uint32_t v1, v2;
+    uint32_t f1, f2;
+    uint32_t p1_f1, n1_f1, p2_f2, n2_f2;
+};
+static_assert(sizeof(KernelFileEdge) == 32, "edge layout is part of the format");
+
+/**
+ * Read-only view of a kernel file mapped into memory.
+ *
+ * Opening checks the header and section bounds only; nothing is parsed or
+ * allocated per element, so the cost does not depend on the model size.
+ * Pages are shared read-only with every other process mapping the file.
+ * Call verifyChecksum() to check the payload (one linear pass).
+ */
+class MappedKernelFile {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be mapped or is not a
+     *         version 1 kernel file with consistent sections
+     */
+    explicit MappedKernelFile(const std::string& path);
+    ~MappedKernelFile();
+
+    MappedKernelFile(const MappedKernelFile&) = delete;
+    MappedKernelFile& operator=(const MappedKernelFile&) = delete;
+    MappedKernelFile(MappedKernelFile&& other) noexcept;
+    MappedKernelFile& operator=(MappedKernelFile&& other) noexcept;
+
+    bool verifyChecksum() const;
+
+    size_t getVertexCount() const { return static_cast<size_t>(header().vertex_count); }
+    size_t getEdgeCount() const { return static_cast<size_t>(header().edge_count); }
+    size_t getFaceCount() const { return static_cast<size_t>(header().face_count); }
+    size_t getSolidCount() const { return static_cast<size_t>(header().solid_count); }
+    size_t getRingCount() const { return static_cast<size_t>(header().ring_count); }
+
+    Point3D position(uint32_t v) const {
+        const double* p = positions() + 3 * static_cast<size_t>(v);
+        return Point3D(p[0], p[1], p[2]);
+    }
+
+    const double* positions() const { return section<double>(header().positions_offset); }
+    const uint32_t* vertexEdges() const { return section<uint32_t>(header().vertex_edges_offset); }
+    const KernelFileEdge* edges() const { return section<KernelFileEdge>(header().edges_offset); }
+    const uint32_t* faceEdges() const { return section<uint32_t>(header().face_edges_offset); }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;               // false: data is owned heap memory
+    std::vector<unsigned char> buffer; // fallback where mmap is unavailable
+
+    const KernelFileHeader& header() const { return *reinterpret_cast<const KernelFileHeader*>(data); }
+
+    template <typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(data + offset);
+    }
+
+    void release();
+};
+
+// ==================== BACKGROUND I/O ====================
+
+/**
+ * Settings for KernelFile::loadAsync() and KernelFile::saveAsync()
+ */
+struct FileTaskOptions {
+    // Workers for rebuilding topology after a load; 0 = hardware threads
+    size_t thread_count = 0;
+
+    // Called with the fraction done, in [0, 1], from the task's own thread.
+    // An exception thrown here fails the task.
+    std::function<void(double)> on_progress;
+};
+
+/**
+ * Thrown through FileTask::get() when a task was cancelled before it
+ * finished
+ */
+class FileTaskCancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Progress and cancellation shared by a FileTask and its worker threads
+struct FileTaskState {
+    std::atomic<bool> cancelled{false};
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{1}; // Units of work, known once the task has sized it
+    std::function<void(double)> on_progress;
+
+    void advance(uint64_t units) { done.fetch_add(units, std::memory_order_relaxed); }
+    double fraction() const {
+        const double units = static_cast<double>(total.load(std::memory_order_relaxed));
+        return std::min(1.0, static_cast<double>(done.load(std::memory_order_relaxed)) / units);
+    }
+    void report() const {
+        if (on_progress) on_progress(fraction());
+    }
+};
+
+/**
+ * Handle on a load or save running in the background.
+ *
+ * The result is delivered through a std::future: get() waits for it and
+ * rethrows whatever the task threw. Destroying or reassigning a running
+ * task cancels it and waits for its threads, so a handle never outlives
+ * the work it started.
+ */
+template <typename Result>
+class FileTask {
+public:
+    FileTask() = default;
+    FileTask(FileTask&&) noexcept = default;
+    FileTask& operator=(FileTask&& other) noexcept {
+        if (this != &other) {
+            stop();
+            state = std::move(other.state);
+            worker = std::move(other.worker);
+            result = std::move(other.result);
+        }
+        return *this;
+    }
+    ~FileTask() { stop(); }
+
+    /**
+     * Ask the task to stop at its next chunk boundary. get() then throws
+     * FileTaskCancelled, unless the task had already finished.
+     */
+    void cancel() {
+        if (state) state->cancelled.store(true);
+    }
+
+    /**
+     * Fraction of the work done so far, in [0, 1]
+     */
+    double progress() const { return state ? state->fraction() : 0.0; }
+
+    bool isReady() const {
+        return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    void wait() const {
+        if (result.valid()) result.wait();
+    }
+
+    /**
+     * Wait for the task and take its result
+     * @throws std::logic_error if the result was already taken
+     * @throws FileTaskCancelled, or whatever the task failed with
+     */
+    Result get() {
+        if (!result.valid()) throw std::logic_error("FileTask::get: no result to take");
+        result.wait();
+        if (worker.joinable()) worker.join();
+        return result.get();
+    }
+
+private:
+    friend class KernelFile;
+
+    std::shared_ptr<FileTaskState> state;
+    std::thread worker;
+    std::future<Result> result;
+
+    void stop() {
+        cancel();
+        if (worker.joinable()) worker.join();
+    }
+};
+
+/**
+ * Save and load whole WingedEdgeKernel models
+ */
+class KernelFile {
+public:
+    /**
+     * Write the model in the layout above. Elements are numbered by their
+     * position in getVertices()/getEdges()/getFaces(); a frozen kernel is
+     * written from its frozen form, in ID order, without thawing. The file
+     * is written to <path>.part and renamed over <path> once complete, so
+     * a failed save leaves any earlier file in place.
+     * @throws std::runtime_error if the file cannot be written
+     */
+    static void save(const WingedEdgeKernel& kernel, const std::string& path);
+
+    /**
+     * Rebuild an editable kernel from a file. Unlike MappedKernelFile this
+     * allocates every element; IDs are renumbered from 1 in file order.
+     * @throws std::runtime_error on I/O errors, checksum mismatch or
+     *         out-of-range element indices
+     */
+    static WingedEdgeKernel load(const std::string& path);
+
+    /**
+     * Same as load(), from a file that is already mapped
+     */
+    static WingedEdgeKernel load(const MappedKernelFile& file);
+
+    /**
+     * load() on background threads. One thread reads the file in chunks,
+     * one checksums what has arrived and the task thread allocates
+     * elements section by section as their bytes come in, so reading,
+     * hashing and decoding overlap. Once the whole file is in and verified,
+     * the references are wired on options.thread_count workers. The future
+     * receives the same kernel load() would return.
+     */
+    static FileTask<WingedEdgeKernel> loadAsync(const std::string& path, FileTaskOptions options = {});
+
+    /**
+     * Save a snapshot of the kernel in the background. The kernel's
+     * snapshot() (or, for a frozen kernel, a copy of its frozen form) is
+     * taken on the calling thread, which then carries on editing while the
+     * task encodes it and a writer thread streams the chunks to disk. The
+     * file is written to <path>.part and renamed over <path> once complete,
+     * so an interrupted save leaves any earlier file intact. Elements are
+     * written in ID order.
+     * @throws std::logic_error if a batch is open and no earlier snapshot
+     *         exists (snapshot() never exposes half of a batch)
+     */
+    static FileTask<void> saveAsync(WingedEdgeKernel& kernel, const std::string& path, FileTaskOptions options = {});
+
+    /**
+     * Same, from a snapshot the caller already holds
+     * @throws std::invalid_argument if snapshot is null
+     */
+    static FileTask<void> saveAsync(std::shared_ptr<const KernelSnapshot> snapshot, const std::string& path,
+                                    FileTaskOptions options = {});
+
+private:
+    class Loader; // Builds a kernel from file records; shared by load() and loadAsync()
+
+    // Run body(state) on a new task thread and deliver what it returns
+    template <typename Result, typename Body>
+    static FileTask<Result> startTask(FileTaskOptions options, Body body);
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_KERNEL_FILE_H
@@ -0,0 +1,197 @@
+#include "kernel_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+namespace SketchyKernel {
+
+const char* kernelOpName(KernelOp op) {
+    switch (op) {
+        case KernelOp::Mvsf: return "mvsf";
+        case KernelOp::Mev: return "mev";
+        case KernelOp::Mef: return "mef";
+        case KernelOp::Kef: return "kef";
+        case KernelOp::Kfmrh: return "kfmrh";
+    }
+    return "unknown";
+}
+
+uint64_t OpStats::quantileNs(double q) const {
+    if (calls == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(calls - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kLatencyBuckets; b++) {
+        seen += latency[b];
+        if (seen >= rank) return std::min(uint64_t(2) << b, max_ns);
+    }
+    return max_ns;
+}
+
+// ==================== CHROME TRACE ====================
+
+void writeChromeTrace(const KernelStats& stats, std::ostream& out) {
+    // Trace timestamps are microseconds; keep nanosecond resolution
+    auto micros = [&](uint64_t ns) -> std::ostream& {
+        return out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000;
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SketchyKernel\"}}";
+    for (const auto& e : stats.trace) {
+        out << ",\n{\"name\":\"" << kernelOpName(e.op) << "\",\"cat\":\"euler\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":";
+        micros(e.start_ns) << ",\"dur\":";
+        micros(e.duration_ns) << '}';
+    }
+    out << "\n],\"otherData\":{\"trace_dropped\":" << stats.trace_dropped
+        << ",\"loop_ranges\":" << stats.loop_ranges << ",\"loop_steps\":" << stats.loop_steps;
+    for (size_t i = 0; i < kKernelOpCount; i++) {
+        const OpStats& op = stats.ops[i];
+        const char* name = kernelOpName(static_cast<KernelOp>(i));
+        out << ",\"" << name << "_calls\":" << op.calls << ",\"" << name << "_total_ns\":" << op.total_ns
+            << ",\"" << name << "_max_ns\":" << op.max_ns;
+    }
+    out << ",\"bytes_vertices\":" << stats.bytes_allocated.vertices
+        << ",\"bytes_edges\":" << stats.bytes_allocated.edges
+        << ",\"bytes_faces\":" << stats.bytes_allocated.faces
+        << ",\"peak_vertices\":" << stats.peak.vertices << ",\"peak_edges\":" << stats.peak.edges
+        << ",\"peak_faces\":" << stats.peak.faces << "}}\n";
+}
+
+void writeChromeTrace(const KernelStats& stats, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("writeChromeTrace: cannot open " + path + " for writing");
+    writeChromeTrace(stats, out);
+    if (!out) throw std::runtime_error("writeChromeTrace: write failed");
+}
+
+#if SKETCHY_KERNEL_STATS
+
+// ==================== LOOP COUNTERS ====================
+
+namespace {
+
+// Written only by the owning thread, read by loopTotals()
+struct ThreadLoopCounters {
+    std::atomic<uint64_t> ranges{0};
+    std::atomic<uint64_t> steps{0};
+};
+
+struct LoopRegistry {
+    std::mutex mutex;
+    std::vector<ThreadLoopCounters*> live;
+    uint64_t retired_ranges = 0;
+    uint64_t retired_steps = 0;
+};
+
+// Never destroyed, so threads exiting during shutdown can still retire
+LoopRegistry& loopRegistry() {
+    static LoopRegistry* registry = new LoopRegistry();
+    return *registry;
+}
+
+struct ThreadLoopSlot {
+    ThreadLoopCounters counters;
+
+    ThreadLoopSlot() {
+        LoopRegistry& registry = loopRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.live.push_back(&counters);
+    }
+
+    ~ThreadLoopSlot() {
+        LoopRegistry& registry = loopRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired_ranges += counters.ranges.load(std::memory_order_relaxed);
+        registry.retired_steps += counters.steps.load(std::memory_order_relaxed);
+        registry.live.erase(std::find(registry.live.begin(), registry.live.end(), &counters));
+    }
+};
+
+} // namespace
+
+void noteLoopRange(size_t steps) {
+    thread_local ThreadLoopSlot slot;
+    // Plain load + store: no other thread writes these
+    auto& c = slot.counters;
+    c.ranges.store(c.ranges.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    c.steps.store(c.steps.load(std::memory_order_relaxed) + steps, std::memory_order_relaxed);
+}
+
+void loopTotals(uint64_t& ranges, uint64_t& steps) {
+    LoopRegistry& registry = loopRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ranges = registry.retired_ranges;
+    steps = registry.retired_steps;
+    for (const auto* c : registry.live) {
+        ranges += c->ranges.load(std::memory_order_relaxed);
+        steps += c->steps.load(std::memory_order_relaxed);
+    }
+}
+
+// ==================== RECORDER ====================
+
+void StatsRecorder::record(KernelOp op, uint64_t start_ns, uint64_t end_ns) {
+    const uint64_t duration = end_ns - start_ns;
+    OpStats& s = ops[static_cast<size_t>(op)];
+    s.calls++;
+    s.total_ns += duration;
+    s.max_ns = std::max(s.max_ns, duration);
+
+    size_t bucket = 0;
+    for (uint64_t d = duration; d > 1 && bucket + 1 < OpStats::kLatencyBuckets; d >>= 1) bucket++;
+    s.latency[bucket]++;
+
+    if (trace.size() < kTraceCapacity) {
+        trace.push_back(TraceEvent{op, start_ns - epoch_ns, duration});
+    } else {
+        trace[trace_next % kTraceCapacity] = TraceEvent{op, start_ns - epoch_ns, duration};
+    }
+    trace_next++;
+}
+
+void StatsRecorder::notePeak(size_t vertices, size_t edges, size_t faces) {
+    peak.vertices = std::max<uint64_t>(peak.vertices, vertices);
+    peak.edges = std::max<uint64_t>(peak.edges, edges);
+    peak.faces = std::max<uint64_t>(peak.faces, faces);
+}
+
+KernelStats StatsRecorder::snapshot() const {
+    KernelStats result;
+    result.enabled = true;
+    result.ops = ops;
+    loopTotals(result.loop_ranges, result.loop_steps);
+    result.loop_ranges -= std::min(result.loop_ranges, loop_ranges_base);
+    result.loop_steps -= std::min(result.loop_steps, loop_steps_base);
+    result.bytes_allocated = bytes;
+    result.peak = peak;
+
+    result.trace.reserve(trace.size());
+    if (trace.size() < kTraceCapacity) {
+        result.trace = trace;
+    } else {
+        size_t oldest = trace_next % kTraceCapacity;
+        result.trace.insert(result.trace.end(), trace.begin() + oldest, trace.end());
+        result.trace.insert(result.trace.end(), trace.begin(), trace.begin() + oldest);
+    }
+    result.trace_dropped = trace_next - trace.size();
+    return result;
+}
+
+void StatsRecorder::reset() {
+    ops = {};
+    bytes = ElementCounts();
+    peak = ElementCounts();
+    trace.clear();
+    trace_next = 0;
+    epoch_ns = now();
+    loopTotals(loop_ranges_base, loop_steps_base);
+}
+
+#endif // SKETCHY_KERNEL_STATS
+
+} // namespace SketchyKernel
@@ -0,0 +1,196 @@
+#ifndef SKETCHY_KERNEL_KERNEL_STATS_H
+#define SKETCHY_KERNEL_KERNEL_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "element_arena.h"
+
+// Instrumentation is compiled in only when the build defines
+// SKETCHY_KERNEL_STATS=1 (CMake option SKETCHY_KERNEL_STATS). Otherwise the
+// hooks expand to nothing and stats() returns an empty snapshot.
+#ifndef SKETCHY_KERNEL_STATS
+#define SKETCHY_KERNEL_STATS 0
+#endif
+
+namespace SketchyKernel {
+
+/**
+ * Euler operators with their own counters
+ */
+enum class KernelOp : uint8_t {
+    Mvsf,
+    Mev,
+    Mef,
+    Kef,
+    Kfmrh
+};
+
+constexpr size_t kKernelOpCount = 5;
+
+/**
+ * Lower-case operator name, as used in traces
+ */
+const char* kernelOpName(KernelOp op);
+
+/**
+ * Call count and latency distribution of one operator
+ */
+struct OpStats {
+    // Bucket b counts calls that took [2^b, 2^(b+1)) ns; bucket 0 also
+    // takes anything under a nanosecond and the last anything longer
+    static constexpr size_t kLatencyBuckets = 32;
+
+    uint64_t calls = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, kLatencyBuckets> latency{};
+
+    double meanNs() const { return calls ? static_cast<double>(total_ns) / static_cast<double>(calls) : 0.0; }
+
+    /**
+     * Upper edge of the bucket holding the q-quantile, 0 <= q <= 1
+     */
+    uint64_t quantileNs(double q) const;
+};
+
+/**
+ * Per element type, in Vertex / Edge / Face order
+ */
+struct ElementCounts {
+    uint64_t vertices = 0;
+    uint64_t edges = 0;
+    uint64_t faces = 0;
+};
+
+/**
+ * One timed operator call, relative to when recording started
+ */
+struct TraceEvent {
+    KernelOp op = KernelOp::Mvsf;
+    uint64_t start_ns = 0;
+    uint64_t duration_ns = 0;
+};
+
+// Operator calls kept in the trace ring of each kernel
+constexpr size_t kTraceCapacity = size_t(1) << 16;
+
+/**
+ * Snapshot returned by WingedEdgeKernel::stats()
+ */
+struct KernelStats {
+    bool enabled = false; // false when built without SKETCHY_KERNEL_STATS
+    std::array<OpStats, kKernelOpCount> ops{};
+
+    // Loop ranges built by the circulators, and the elements they yield,
+    // since the last reset. Counted for every thread in the process, since
+    // the circulators do not know which kernel they walk.
+    uint64_t loop_ranges = 0;
+    uint64_t loop_steps = 0;
+
+    // Bytes requested from the element arena, control blocks included
+    ElementCounts bytes_allocated;
+    // Largest element counts seen at the end of an operator or stats() call
+    ElementCounts peak;
+
+    // The most recent operator calls, oldest first; older ones are dropped
+    std::vector<TraceEvent> trace;
+    uint64_t trace_dropped = 0;
+
+    const OpStats& op(KernelOp o) const { return ops[static_cast<size_t>(o)]; }
+};
+
+/**
+ * Write the trace as Chrome trace event JSON, which chrome://tracing and
+ * the Perfetto UI both open. Operator totals are added as metadata.
+ */
+void writeChromeTrace(const KernelStats& stats, std::ostream& out);
+
+/**
+ * @throws std::runtime_error if the file cannot be written
+ */
+void writeChromeTrace(const KernelStats& stats, const std::string& path);
+
+#if SKETCHY_KERNEL_STATS
+
+/**
+ * Count one loop range of the given length on the calling thread. Each
+ * thread bumps its own counters, so parallel walks do not contend.
+ */
+void noteLoopRange(size_t steps);
+
+/**
+ * Process-wide totals of noteLoopRange()
+ */
+void loopTotals(uint64_t& ranges, uint64_t& steps);
+
+/**
+ * Operator counters and trace ring owned by one kernel. Like the kernel,
+ * not thread-safe.
+ */
+class StatsRecorder {
+public:
+    StatsRecorder() { reset(); }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record(KernelOp op, uint64_t start_ns, uint64_t end_ns);
+    void notePeak(size_t vertices, size_t edges, size_t faces);
+
+    uint64_t& allocated(int kind) { return kind == 0 ? bytes.vertices : kind == 1 ? bytes.edges : bytes.faces; }
+
+    KernelStats snapshot() const;
+    void reset();
+
+private:
+    std::array<OpStats, kKernelOpCount> ops{};
+    ElementCounts bytes;
+    ElementCounts peak;
+    std::vector<TraceEvent> trace;  // ring, trace_next % kTraceCapacity is the oldest once full
+    uint64_t trace_next = 0;
+    uint64_t epoch_ns = 0;
+    uint64_t loop_ranges_base = 0;
+    uint64_t loop_steps_base = 0;
+};
+
+/**
+ * Arena allocator that adds every allocation to a byte counter. Only
+ * allocate() touches the counter, so control blocks that outlive their
+ * kernel still release safely.
+ */
+template <typename T>
+class CountingArenaAllocator : public ArenaAllocator<T> {
+public:
+    using value_type = T;
+
+    CountingArenaAllocator(ElementArena arena, uint64_t* counter)
+        : ArenaAllocator<T>(std::move(arena)), counter(counter) {}
+
+    template <typename U>
+    CountingArenaAllocator(const CountingArenaAllocator<U>& other)
+        : ArenaAllocator<T>(other), counter(other.counter) {}
+
+    T* allocate(std::size_t n) {
+        *counter += n * sizeof(T);
+        return ArenaAllocator<T>::allocate(n);
+    }
+
+private:
+    template <typename U>
+    friend class CountingArenaAllocator;
+
+    uint64_t* counter;
+};
+
+#endif // SKETCHY_KERNEL_STATS
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_KERNEL_STATS_H
@@ -0,0 +1,244 @@
+#include "mesh_export.h"
+#include "winged_edge.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace SketchyKernel {
+
+namespace {
+
+// Longest token written in one piece: a shortest round-trip double
+constexpr size_t kMaxToken = 32;
+
+// Fixed-size staging area between the formatter and the sink
+class ChunkBuffer {
+public:
+    ChunkBuffer(const ExportSink& sink, size_t capacity)
+        : sink(sink), storage(std::max(capacity, 8 * kMaxToken)) {}
+
+    // Room for n more bytes (n <= kMaxToken), flushing first if needed
+    char* reserve(size_t n) {
+        if (used + n > storage.size()) flush();
+        return storage.data() + used;
+    }
+
+    void commit(const char* end) { used = static_cast<size_t>(end - storage.data()); }
+
+    void append(const void* bytes, size_t n) {
+        if (used + n > storage.size()) flush();
+        if (n > storage.size()) {
+            sink(static_cast<const char*>(bytes), n);
+            written += n;
+            return;
+        }
+        std::memcpy(storage.data() + used, bytes, n);
+        used += n;
+    }
+
+    void append(const std::string& text) { append(text.data(), text.size()); }
+
+    void put(char c) {
+        *reserve(1) = c;
+        used++;
+    }
+
+    template <typename T>
+    void putNumber(T value) {
+        char* begin = reserve(kMaxToken);
+        commit(std::to_chars(begin, begin + kMaxToken, value).ptr);
+    }
+
+    // Raw little-endian bytes of a scalar
+    template <typename T>
+    void putBinary(T value) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        std::reverse(bytes, bytes + sizeof(T));
+#endif
+        append(bytes, sizeof(T));
+    }
+
+    void flush() {
+        if (used == 0) return;
+        sink(storage.data(), used);
+        written += used;
+        used = 0;
+    }
+
+    size_t bytesWritten() const { return written + used; }
+
+private:
+    const ExportSink& sink;
+    std::vector<char> storage;
+    size_t used = 0;
+    size_t written = 0;
+};
+
+bool exportable(const FaceVertexRange& loop) {
+    return loop.size() >= 3;
+}
+
+void putObjVertex(ChunkBuffer& out, const Point3D& p) {
+    out.append("v ", 2);
+    out.putNumber(p.x);
+    out.put(' ');
+    out.putNumber(p.y);
+    out.put(' ');
+    out.putNumber(p.z);
+    out.put('\n');
+}
+
+void putPlyVertex(ChunkBuffer& out, const Point3D& p) {
+    out.putBinary(p.x);
+    out.putBinary(p.y);
+    out.putBinary(p.z);
+}
+
+// A frozen kernel has no element lists: its vertices go out in ID order,
+// and body(indices) gets each exportable loop as positions in that order
+template <typename LoopBody>
+void forEachFrozenLoop(const FrozenTopology& model, const LoopBody& body) {
+    std::vector<int32_t> indices;
+    for (size_t i = 0; i < model.getFaceCount(); i++) {
+        indices.clear();
+        for (int id : model.faceVertices(model.faceAt(i).id)) {
+            indices.push_back(static_cast<int32_t>(model.vertexIndex(id)));
+        }
+        body(indices);
+    }
+}
+
+} // namespace
+
+ExportSink makeFileDescriptorSink(int fd) {
+    return [fd](const char* data, size_t size) {
+#if defined(__unix__) || defined(__APPLE__)
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error(std::string("export: write failed: ") + std::strerror(errno));
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+#else
+        (void)data;
+        (void)size;
+        throw std::runtime_error("export: file descriptor sinks need a POSIX platform");
+#endif
+    };
+}
+
+ExportStats exportObj(const WingedEdgeKernel& kernel, const ExportSink& sink, size_t buffer_size) {
+    ChunkBuffer out(sink, buffer_size);
+    ExportStats stats;
+
+    out.append(std::string("# Sketchy kernel export\n"));
+    stats.vertices = kernel.getVertexCount();
+
+    if (const FrozenTopology* model = kernel.getFrozen()) {
+        for (size_t i = 0; i < model->getVertexCount(); i++) putObjVertex(out, model->vertexAt(i).coords);
+        forEachFrozenLoop(*model, [&](const std::vector<int32_t>& loop) {
+            if (loop.size() < 3) {
+                stats.skipped_faces++;
+                return;
+            }
+            out.put('f');
+            for (int32_t index : loop) {
+                out.put(' ');
+                out.putNumber(index + 1);
+            }
+            out.put('\n');
+            stats.faces++;
+        });
+    } else {
+        for (const auto& v : kernel.getVertices()) putObjVertex(out, v->coords);
+
+        for (const auto& f : kernel.getFaces()) {
+            auto loop = kernel.faceVertices(f);
+            if (!exportable(loop)) {
+                stats.skipped_faces++;
+                continue;
+            }
+
+            out.put('f');
+            for (const auto& v : loop) {
+                out.put(' ');
+                out.putNumber(kernel.getVertexSlot(v->id) + 1); // OBJ indices start at 1
+            }
+            out.put('\n');
+            stats.faces++;
+        }
+    }
+
+    out.flush();
+    stats.bytes = out.bytesWritten();
+    return stats;
+}
+
+ExportStats exportPly(const WingedEdgeKernel& kernel, const ExportSink& sink, size_t buffer_size) {
+    ChunkBuffer out(sink, buffer_size);
+    ExportStats stats;
+    const FrozenTopology* model = kernel.getFrozen();
+
+    // The header needs the face count up front
+    auto count = [&](bool exportable_loop) {
+        if (exportable_loop) {
+            stats.faces++;
+        } else {
+            stats.skipped_faces++;
+        }
+    };
+    if (model) {
+        forEachFrozenLoop(*model, [&](const std::vector<int32_t>& loop) { count(loop.size() >= 3); });
+    } else {
+        for (const auto& f : kernel.getFaces()) count(exportable(kernel.faceVertices(f)));
+    }
+    stats.vertices = kernel.getVertexCount();
+
+    out.append("ply\n"
+               "format binary_little_endian 1.0\n"
+               "comment Sketchy kernel export\n"
+               "element vertex " + std::to_string(stats.vertices) + "\n"
+               "property double x\n"
+               "property double y\n"
+               "property double z\n"
+               "element face " + std::to_string(stats.faces) + "\n"
+               "property list uint int vertex_indices\n"
+               "end_header\n");
+
+    if (model) {
+        for (size_t i = 0; i < model->getVertexCount(); i++) putPlyVertex(out, model->vertexAt(i).coords);
+        forEachFrozenLoop(*model, [&](const std::vector<int32_t>& loop) {
+            if (loop.size() < 3) return;
+            out.putBinary(static_cast<uint32_t>(loop.size()));
+            for (int32_t index : loop) out.putBinary(index);
+        });
+    } else {
+        for (const auto& v : kernel.getVertices()) putPlyVertex(out, v->coords);
+
+        for (const auto& f : kernel.getFaces()) {
+            auto loop = kernel.faceVertices(f);
+            if (!exportable(loop)) continue;
+
+            out.putBinary(static_cast<uint32_t>(loop.size()));
+            for (const auto& v : loop) out.putBinary(static_cast<int32_t>(kernel.getVertexSlot(v->id)));
+        }
+    }
+
+    out.flush();
+    stats.bytes = out.bytesWritten();
+    return stats;
+}
+
+} // namespace SketchyKernel
@@ -0,0 +1,58 @@
+#ifndef SKETCHY_KERNEL_MESH_EXPORT_H
+#define SKETCHY_KERNEL_MESH_EXPORT_H
+
+#include <cstddef>
+#include <functional>
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+
+/**
+ * Receives exported bytes in large sequential chunks
+ */
+using ExportSink = std::function<void(const char* data, size_t size)>;
+
+/**
+ * Sink writing to an open file descriptor (file, pipe or socket). The
+ * descriptor stays open.
+ * @throws std::runtime_error from the sink when a write fails
+ */
+ExportSink makeFileDescriptorSink(int fd);
+
+constexpr size_t kDefaultExportBuffer = size_t(1) << 20;
+
+struct ExportStats {
+    size_t vertices = 0;
+    size_t faces = 0;
+    size_t skipped_faces = 0; // Loops with fewer than three vertices
+    size_t bytes = 0;
+};
+
+/**
+ * Stream the model as Wavefront OBJ: one `v` line per vertex in
+ * getVertices() order, one `f` line per face loop.
+ *
+ * Face loops are walked with the circulators and formatted straight into a
+ * buffer of buffer_size bytes, which goes to the sink whenever it fills.
+ * Nothing is materialized per face, so memory stays at buffer_size however
+ * large the model is.
+ *
+ * A frozen kernel is exported from its frozen form without thawing; its
+ * vertices then go out in ID order.
+ */
+ExportStats exportObj(const WingedEdgeKernel& kernel, const ExportSink& sink,
+                      size_t buffer_size = kDefaultExportBuffer);
+
+/**
+ * Stream the model as binary little-endian PLY: double x/y/z per vertex and
+ * a uint-counted int index list per face. Face loops are walked twice, once
+ * to count the faces for the header; memory stays at buffer_size. Frozen
+ * kernels are read as in exportObj().
+ */
+ExportStats exportPly(const WingedEdgeKernel& kernel, const ExportSink& sink,
+                      size_t buffer_size = kDefaultExportBuffer);
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_MESH_EXPORT_H
@@ -0,0 +1,87 @@
+#ifndef SKETCHY_KERNEL_PARALLEL_H
+#define SKETCHY_KERNEL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SketchyKernel {
+
+/**
+ * Worker count for a requested setting; 0 means one per hardware thread
+ */
+inline size_t resolveThreadCount(size_t requested) {
+    if (requested > 0) return requested;
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+/**
+ * Run a read-only check over [0, n) split into contiguous chunks.
+ * pred(begin, end) returns false when it finds a violation; the result is
+ * true only if every chunk passes. Workers stop taking new chunks as soon
+ * as one fails. Ranges shorter than two chunks run on the calling thread.
+ * If pred throws, the others stop the same way and the first exception is
+ * rethrown on the calling thread once every worker has joined.
+ */
+template <typename ChunkPredicate>
+bool parallelAll(size_t n, size_t threads, const ChunkPredicate& pred, size_t min_chunk = 8192) {
+    if (threads <= 1 || n < 2 * min_chunk) return pred(size_t(0), n);
+
+    // A few chunks per worker keeps the load balanced when cost varies
+    const size_t chunk = std::max(min_chunk, n / (threads * 4) + 1);
+    const size_t chunk_count = (n + chunk - 1) / chunk;
+    threads = std::min(threads, chunk_count);
+
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> ok{true};
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+
+    auto worker = [&]() {
+        while (ok.load(std::memory_order_relaxed)) {
+            size_t c = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunk_count) return;
+
+            size_t begin = c * chunk;
+            size_t end = std::min(n, begin + chunk);
+            try {
+                if (!pred(begin, end)) ok.store(false, std::memory_order_relaxed);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure) failure = std::current_exception();
+                ok.store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+
+    if (failure) std::rethrow_exception(failure);
+    return ok.load();
+}
+
+/**
+ * Run body(begin, end) over contiguous chunks of [0, n) on up to `threads`
+ * workers; chunks must write to disjoint data. An exception from body
+ * stops the remaining chunks and is rethrown, as in parallelAll().
+ */
+template <typename ChunkBody>
+void parallelFor(size_t n, size_t threads, const ChunkBody& body, size_t min_chunk = 8192) {
+    parallelAll(n, threads, [&](size_t begin, size_t end) {
+        body(begin, end);
+        return true;
+    }, min_chunk);
+}
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_PARALLEL_H
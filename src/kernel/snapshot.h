@@ -0,0 +1,226 @@
+#ifndef SKETCHY_KERNEL_SNAPSHOT_H
+#define SKETCHY_KERNEL_SNAPSHOT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "geometry.h"
+#include "circulator.h"
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+
+// Flat copies of the elements; references are element IDs, 0 = none
+struct SnapshotVertex {
+    int id = 0;
+    Point3D coords;
+    int edge = 0;
+};
+
+struct SnapshotEdge {
+    int id = 0;
+    int v1 = 0, v2 = 0;
+    int f1 = 0, f2 = 0;
+    int p1_f1 = 0, n1_f1 = 0, p2_f2 = 0, n2_f2 = 0;
+};
+
+struct SnapshotFace {
+    int id = 0;
+    int edge = 0;
+};
+
+/**
+ * Records addressed by element ID, stored in fixed-size pages.
+ * A snapshot shares every page it did not change with the one before it;
+ * a page is copied the first time an update writes to it.
+ */
+template <typename Record>
+class PagedColumn {
+public:
+    static constexpr size_t kPageBits = 8;
+    static constexpr size_t kPageSize = size_t(1) << kPageBits;
+    using Page = std::array<Record, kPageSize>;
+
+    /**
+     * The record for a live element, or nullptr for unknown and killed IDs
+     */
+    const Record* find(int id) const {
+        if (id <= 0) return nullptr;
+
+        size_t page = static_cast<size_t>(id) >> kPageBits;
+        if (page >= pages.size()) return nullptr;
+
+        const Record& record = (*pages[page])[static_cast<size_t>(id) & (kPageSize - 1)];
+        return record.id == id ? &record : nullptr;
+    }
+
+    /**
+     * Visit every live record in ID order
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (const auto& page : pages) {
+            for (const Record& record : *page) {
+                if (record.id != 0) visit(record);
+            }
+        }
+    }
+
+    size_t pageCount() const { return pages.size(); }
+
+    /**
+     * Writer side: store the record for an ID (Record{} drops it). `owned`
+     * flags the pages this update already copied; any other page may be
+     * shared with a published snapshot and is copied before the write.
+     */
+    void store(int id, const Record& record, std::vector<bool>& owned) {
+        size_t page = static_cast<size_t>(id) >> kPageBits;
+        if (page >= pages.size()) pages.resize(page + 1);
+        if (owned.size() < pages.size()) owned.resize(pages.size(), false);
+
+        if (!owned[page]) {
+            pages[page] = pages[page] ? std::make_shared<Page>(*pages[page]) : std::make_shared<Page>();
+            owned[page] = true;
+        }
+        (*pages[page])[static_cast<size_t>(id) & (kPageSize - 1)] = record;
+    }
+
+    /**
+     * True when both columns hold the very same page (no copy was made)
+     */
+    bool sharesPage(const PagedColumn& other, size_t page) const {
+        return page < pages.size() && page < other.pages.size() && pages[page] == other.pages[page];
+    }
+
+private:
+    std::vector<std::shared_ptr<Page>> pages;
+};
+
+class KernelSnapshot;
+
+// Face loop over snapshot records: n1_f1 on the f1 side, n2_f2 on the f2 side
+struct SnapshotFaceLoopPolicy {
+    using Cursor = const SnapshotEdge*;
+
+    const KernelSnapshot* snapshot;
+    int face;
+
+    bool valid(Cursor c) const { return c != nullptr; }
+    bool same(Cursor a, Cursor b) const { return a == b; }
+    Cursor next(Cursor c) const;
+    const SnapshotEdge& deref(Cursor c) const { return *c; }
+};
+
+// Same walk, yielding for each edge the ID of the vertex it shares with the
+// next edge of the walk
+struct SnapshotFaceVertexPolicy : SnapshotFaceLoopPolicy {
+    int deref(Cursor c) const { return c->f1 == face ? c->v1 : c->v2; }
+};
+
+// Edges around a vertex: n1_f1 at v1, n2_f2 at v2
+struct SnapshotVertexLoopPolicy {
+    using Cursor = const SnapshotEdge*;
+
+    const KernelSnapshot* snapshot;
+    int vertex;
+
+    bool valid(Cursor c) const { return c != nullptr; }
+    bool same(Cursor a, Cursor b) const { return a == b; }
+    Cursor next(Cursor c) const;
+    const SnapshotEdge& deref(Cursor c) const { return *c; }
+};
+
+using SnapshotFaceEdgeRange = LoopRange<SnapshotFaceLoopPolicy>;
+using SnapshotFaceVertexRange = LoopRange<SnapshotFaceVertexPolicy>;
+using SnapshotVertexEdgeRange = LoopRange<SnapshotVertexLoopPolicy>;
+
+/**
+ * Immutable view of a WingedEdgeKernel at one point in time.
+ *
+ * Obtained from WingedEdgeKernel::snapshot() and shared by
+ * std::shared_ptr<const KernelSnapshot>. Nothing in a published snapshot is
+ * ever written again, so any number of threads may read it without locking
+ * while the kernel keeps editing. Elements are addressed by their kernel ID.
+ */
+class KernelSnapshot {
+public:
+    const SnapshotVertex* vertex(int id) const { return vertices.find(id); }
+    const SnapshotEdge* edge(int id) const { return edges.find(id); }
+    const SnapshotFace* face(int id) const { return faces.find(id); }
+
+    template <typename Visitor>
+    void forEachVertex(Visitor&& visit) const { vertices.forEach(visit); }
+    template <typename Visitor>
+    void forEachEdge(Visitor&& visit) const { edges.forEach(visit); }
+    template <typename Visitor>
+    void forEachFace(Visitor&& visit) const { faces.forEach(visit); }
+
+    SnapshotFaceEdgeRange faceEdges(int face_id) const {
+        const SnapshotFace* f = face(face_id);
+        return SnapshotFaceEdgeRange(SnapshotFaceLoopPolicy{this, face_id}, f ? edge(f->edge) : nullptr,
+                                     edge_count + 1);
+    }
+
+    SnapshotFaceVertexRange faceVertices(int face_id) const {
+        const SnapshotFace* f = face(face_id);
+        return SnapshotFaceVertexRange(SnapshotFaceVertexPolicy{{this, face_id}}, f ? edge(f->edge) : nullptr,
+                                       edge_count + 1);
+    }
+
+    SnapshotVertexEdgeRange vertexEdges(int vertex_id) const {
+        const SnapshotVertex* v = vertex(vertex_id);
+        return SnapshotVertexEdgeRange(SnapshotVertexLoopPolicy{this, vertex_id}, v ? edge(v->edge) : nullptr,
+                                       edge_count + 1);
+    }
+
+    size_t getVertexCount() const { return vertex_count; }
+    size_t getEdgeCount() const { return edge_count; }
+    size_t getFaceCount() const { return face_count; }
+    size_t getSolidCount() const { return solid_count; }
+    size_t getRingCount() const { return ring_count; }
+
+    /**
+     * Increases by one with every snapshot the kernel publishes
+     */
+    uint64_t getVersion() const { return version; }
+
+    /**
+     * Page-level sharing with another snapshot, for diagnostics and tests
+     */
+    const PagedColumn<SnapshotVertex>& vertexColumn() const { return vertices; }
+    const PagedColumn<SnapshotEdge>& edgeColumn() const { return edges; }
+    const PagedColumn<SnapshotFace>& faceColumn() const { return faces; }
+
+private:
+    friend class WingedEdgeKernel;
+
+    PagedColumn<SnapshotVertex> vertices;
+    PagedColumn<SnapshotEdge> edges;
+    PagedColumn<SnapshotFace> faces;
+
+    size_t vertex_count = 0;
+    size_t edge_count = 0;
+    size_t face_count = 0;
+    size_t solid_count = 0;
+    size_t ring_count = 0;
+    uint64_t version = 0;
+};
+
+inline const SnapshotEdge* SnapshotFaceLoopPolicy::next(Cursor c) const {
+    if (c->f1 == face) return snapshot->edge(c->n1_f1);
+    if (c->f2 == face) return snapshot->edge(c->n2_f2);
+    return nullptr;
+}
+
+inline const SnapshotEdge* SnapshotVertexLoopPolicy::next(Cursor c) const {
+    if (c->v1 == vertex) return snapshot->edge(c->n1_f1);
+    if (c->v2 == vertex) return snapshot->edge(c->n2_f2);
+    return nullptr;
+}
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_SNAPSHOT_H
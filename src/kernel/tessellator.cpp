@@ -0,0 +1,231 @@
+#include "tessellator.h"
+#include "winged_edge.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace SketchyKernel {
+
+namespace {
+
+// Polygon flattened onto the coordinate plane its normal is closest to
+struct ProjectedLoop {
+    std::vector<double> u, v;
+    double orientation = 1.0; // Keeps the loop counter-clockwise in 2D
+
+    double cross(uint32_t a, uint32_t b, uint32_t c) const {
+        return orientation * ((u[b] - u[a]) * (v[c] - v[a]) - (v[b] - v[a]) * (u[c] - u[a]));
+    }
+};
+
+void project(const std::vector<Point3D>& loop, const Vec3& normal, ProjectedLoop& out) {
+    double ax = std::abs(normal.x), ay = std::abs(normal.y), az = std::abs(normal.z);
+    out.u.resize(loop.size());
+    out.v.resize(loop.size());
+
+    // (u, v) x (u, v) points along +axis, so the sign of that component
+    // tells whether the projection flipped the loop
+    for (size_t i = 0; i < loop.size(); i++) {
+        if (ax >= ay && ax >= az) {
+            out.u[i] = loop[i].y;
+            out.v[i] = loop[i].z;
+        } else if (ay >= az) {
+            out.u[i] = loop[i].z;
+            out.v[i] = loop[i].x;
+        } else {
+            out.u[i] = loop[i].x;
+            out.v[i] = loop[i].y;
+        }
+    }
+    double dominant = ax >= ay && ax >= az ? normal.x : (ay >= az ? normal.y : normal.z);
+    out.orientation = dominant < 0 ? -1.0 : 1.0;
+}
+
+bool isConvex(const ProjectedLoop& p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        auto a = static_cast<uint32_t>((i + n - 1) % n);
+        auto c = static_cast<uint32_t>((i + 1) % n);
+        if (p.cross(a, static_cast<uint32_t>(i), c) < 0) return false;
+    }
+    return true;
+}
+
+// Ear clipping; emits exactly n - 2 triangles, falling back to a fan if
+// the remaining polygon has no ear (degenerate or self-intersecting input)
+void earClip(const ProjectedLoop& p, size_t n, std::vector<uint32_t>& remaining, std::vector<uint32_t>& out) {
+    remaining.resize(n);
+    for (size_t i = 0; i < n; i++) remaining[i] = static_cast<uint32_t>(i);
+    out.clear();
+    out.reserve(3 * (n - 2));
+
+    // Points on the boundary count: a reflex vertex lying on the diagonal
+    // would otherwise let the ear cut outside the polygon
+    auto inside = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t q) {
+        return p.cross(a, b, q) >= 0 && p.cross(b, c, q) >= 0 && p.cross(c, a, q) >= 0;
+    };
+
+    while (remaining.size() > 3) {
+        const size_t m = remaining.size();
+        bool clipped = false;
+
+        for (size_t k = 0; k < m && !clipped; k++) {
+            uint32_t a = remaining[(k + m - 1) % m];
+            uint32_t b = remaining[k];
+            uint32_t c = remaining[(k + 1) % m];
+            if (p.cross(a, b, c) <= 0) continue; // Reflex or collinear
+
+            bool ear = true;
+            for (uint32_t q : remaining) {
+                if (q != a && q != b && q != c && inside(a, b, c, q)) {
+                    ear = false;
+                    break;
+                }
+            }
+            if (!ear) continue;
+
+            out.insert(out.end(), {a, b, c});
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(k));
+            clipped = true;
+        }
+        if (!clipped) break;
+    }
+
+    for (size_t k = 1; k + 1 < remaining.size(); k++) {
+        out.insert(out.end(), {remaining[0], remaining[k], remaining[k + 1]});
+    }
+}
+
+size_t emittedVertices(uint32_t loop_size) {
+    return loop_size >= 3 ? loop_size : 0;
+}
+
+size_t emittedIndices(uint32_t loop_size) {
+    return loop_size >= 3 ? 3 * (static_cast<size_t>(loop_size) - 2) : 0;
+}
+
+} // namespace
+
+Tessellator::BufferSizes Tessellator::update(const WingedEdgeKernel& kernel) {
+    if (kernel.isFrozen()) throw std::logic_error("Tessellator::update: kernel is frozen");
+    if (source != &kernel) {
+        entries.clear();
+        source = &kernel;
+    }
+
+    const auto& faces = kernel.getFaces();
+    int max_id = 0;
+    for (const auto& f : faces) max_id = std::max(max_id, f->id);
+    if (entries.size() <= static_cast<size_t>(max_id)) entries.resize(static_cast<size_t>(max_id) + 1);
+
+    // Faces own distinct entries, so chunks never write to the same one
+    std::atomic<size_t> redone{0};
+    parallelFor(faces.size(), resolveThreadCount(thread_count), [&](size_t begin, size_t end) {
+        std::vector<Point3D> loop;
+        std::vector<uint32_t> remaining;
+        ProjectedLoop projected;
+        size_t local = 0;
+
+        for (size_t i = begin; i < end; i++) {
+            const auto& f = faces[i];
+            FaceEntry& entry = entries[f->id];
+
+            // A face is stale when it or any of its vertices was stamped
+            uint64_t stamp = kernel.getFaceStamp(f->id);
+            loop.clear();
+            for (const auto& v : kernel.faceVertices(f)) {
+                stamp = std::max(stamp, kernel.getVertexStamp(v->id));
+                loop.push_back(v->coords);
+            }
+            if (entry.face == f.get() && entry.stamp == stamp) continue;
+
+            entry.face = f.get();
+            entry.stamp = stamp;
+            entry.loop_size = static_cast<uint32_t>(loop.size());
+            entry.fan = true;
+            entry.triangles.clear();
+            local++;
+
+            Vec3 normal = polygonNormal(loop.data(), loop.size());
+            entry.normal[0] = static_cast<float>(normal.x);
+            entry.normal[1] = static_cast<float>(normal.y);
+            entry.normal[2] = static_cast<float>(normal.z);
+            if (loop.size() <= 3) continue;
+
+            project(loop, normal, projected);
+            if (!isConvex(projected, loop.size())) {
+                entry.fan = false;
+                earClip(projected, loop.size(), remaining, entry.triangles);
+            }
+        }
+        redone += local;
+    }, 1024);
+    retessellated = redone.load();
+
+    // Exclusive prefix sums give every face its place in the output
+    face_ids.resize(faces.size());
+    vertex_offsets.resize(faces.size() + 1);
+    index_offsets.resize(faces.size() + 1);
+    vertex_offsets[0] = index_offsets[0] = 0;
+    for (size_t i = 0; i < faces.size(); i++) {
+        face_ids[i] = faces[i]->id;
+        uint32_t n = entries[faces[i]->id].loop_size;
+        vertex_offsets[i + 1] = vertex_offsets[i] + emittedVertices(n);
+        index_offsets[i + 1] = index_offsets[i] + emittedIndices(n);
+    }
+
+    return BufferSizes{vertex_offsets.back(), index_offsets.back()};
+}
+
+void Tessellator::write(const WingedEdgeKernel& kernel, float* vertices, uint32_t* indices) const {
+    if (source && source != &kernel) throw std::invalid_argument("Tessellator::write: not the kernel last updated");
+
+    parallelFor(face_ids.size(), resolveThreadCount(thread_count), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const FaceEntry& entry = entries[face_ids[i]];
+            if (entry.loop_size < 3) continue;
+
+            // The face as update() saw it, if it is still there
+            auto face = kernel.getFaceById(face_ids[i]);
+            if (face.get() != entry.face) face = nullptr;
+
+            const auto base = static_cast<uint32_t>(vertex_offsets[i]);
+            float* out = vertices + kFloatsPerVertex * vertex_offsets[i];
+            float* const out_end = out + kFloatsPerVertex * entry.loop_size;
+            float position[3] = {0, 0, 0};
+            auto emit = [&]() {
+                out[0] = position[0];
+                out[1] = position[1];
+                out[2] = position[2];
+                out[3] = entry.normal[0];
+                out[4] = entry.normal[1];
+                out[5] = entry.normal[2];
+                out += kFloatsPerVertex;
+            };
+            if (face) {
+                for (const auto& v : kernel.faceVertices(face)) {
+                    if (out == out_end) break;
+                    position[0] = static_cast<float>(v->coords.x);
+                    position[1] = static_cast<float>(v->coords.y);
+                    position[2] = static_cast<float>(v->coords.z);
+                    emit();
+                }
+            }
+            while (out != out_end) emit();
+
+            uint32_t* index = indices + index_offsets[i];
+            if (entry.fan) {
+                for (uint32_t k = 1; k + 1 < entry.loop_size; k++) {
+                    *index++ = base;
+                    *index++ = base + k;
+                    *index++ = base + k + 1;
+                }
+            } else {
+                for (uint32_t local : entry.triangles) *index++ = base + local;
+            }
+        }
+    }, 1024);
+}
+
+} // namespace SketchyKernel
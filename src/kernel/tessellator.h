@@ -0,0 +1,89 @@
+#ifndef SKETCHY_KERNEL_TESSELLATOR_H
+#define SKETCHY_KERNEL_TESSELLATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SketchyKernel {
+
+class WingedEdgeKernel;
+struct Face;
+
+/**
+ * Turns the polygon faces of a kernel into GPU-ready triangle buffers.
+ *
+ * update() triangulates the faces that changed since the previous call:
+ * a convex loop becomes a fan, anything else is ear-clipped in the plane of
+ * its Newell normal. Triangulations are cached per face and found stale
+ * through the kernel's change stamps (the face's own, or any of its
+ * vertices'). write() then fills caller-provided buffers in parallel, with
+ * per-face output offsets from a prefix sum over the loop sizes.
+ *
+ * Every face gets its own copy of its vertices, so normals are flat. The
+ * vertex buffer is interleaved: px py pz nx ny nz as floats.
+ *
+ * A Tessellator follows one kernel; switching kernels drops the cache.
+ */
+class Tessellator {
+public:
+    static constexpr size_t kFloatsPerVertex = 6;
+
+    struct BufferSizes {
+        size_t vertices = 0; // kFloatsPerVertex floats each
+        size_t indices = 0;  // three per triangle
+    };
+
+    /**
+     * Re-triangulate what changed and return the buffer sizes write() needs
+     * @throws std::logic_error if the kernel is frozen
+     */
+    BufferSizes update(const WingedEdgeKernel& kernel);
+
+    /**
+     * Fill the buffers for the faces seen by the last update(), in the
+     * getFaces() order of that call. Indices address the vertex buffer
+     * directly. Edits in between never write past the sizes update()
+     * returned: a face keeps its old vertex count, repeating its last
+     * vertex if its loop shrank, and a killed face is written as a point
+     * at the origin.
+     * @throws std::invalid_argument if kernel is not the one last updated
+     */
+    void write(const WingedEdgeKernel& kernel, float* vertices, uint32_t* indices) const;
+
+    /**
+     * Faces the last update() had to triangulate again
+     */
+    size_t getRetessellatedCount() const { return retessellated; }
+
+    /**
+     * @see WingedEdgeKernel::setThreadCount
+     */
+    void setThreadCount(size_t count) { thread_count = count; }
+
+private:
+    struct FaceEntry {
+        const Face* face = nullptr;  // detects a reused ID
+        uint64_t stamp = 0;
+        uint32_t loop_size = 0;
+        bool fan = true;             // triangles are implied: (0, i, i + 1)
+        float normal[3] = {0, 0, 0};
+        std::vector<uint32_t> triangles; // loop positions, when not a fan
+    };
+
+    const WingedEdgeKernel* source = nullptr;
+    std::vector<FaceEntry> entries;      // by face ID
+
+    // Per face in getFaces() order at the last update(): its ID, and
+    // first output vertex and index
+    std::vector<int> face_ids;
+    std::vector<size_t> vertex_offsets;
+    std::vector<size_t> index_offsets;
+
+    size_t retessellated = 0;
+    size_t thread_count = 0;
+};
+
+} // namespace SketchyKernel
+
+#endif // SKETCHY_KERNEL_TESSELLATOR_H
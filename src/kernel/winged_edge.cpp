@@ -1,19 +1,178 @@
 #include "winged_edge.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <unordered_set>
 
+#if SKETCHY_KERNEL_STATS
+#define SKETCHY_STAT_SCOPE(op) StatScope stat_scope(*this, KernelOp::op)
+#else
+#define SKETCHY_STAT_SCOPE(op)
+#endif
+
 namespace SketchyKernel {
 
+namespace {
+
+// Append an element and record its slot in the ID table
+template <typename T>
+void insertIndexed(std::vector<std::shared_ptr<T>>& list, std::vector<int>& slots,
+                   const std::shared_ptr<T>& element) {
+    if (element->id >= static_cast<int>(slots.size())) {
+        slots.resize(element->id + 1, -1);
+    }
+    slots[element->id] = static_cast<int>(list.size());
+    list.push_back(element);
+}
+
+// Remove an element in O(1) by moving the last element into its slot
+template <typename T>
+void eraseIndexed(std::vector<std::shared_ptr<T>>& list, std::vector<int>& slots,
+                  const std::shared_ptr<T>& element) {
+    if (element->id < 0 || element->id >= static_cast<int>(slots.size())) return;
+
+    int slot = slots[element->id];
+    if (slot < 0 || list[slot] != element) return;
+
+    if (slot != static_cast<int>(list.size()) - 1) {
+        list[slot] = std::move(list.back());
+        slots[list[slot]->id] = slot;
+    }
+    list.pop_back();
+    slots[element->id] = -1;
+}
+
+template <typename T>
+std::shared_ptr<T> lookupIndexed(const std::vector<std::shared_ptr<T>>& list,
+                                 const std::vector<int>& slots, int id) {
+    if (id < 0 || id >= static_cast<int>(slots.size())) return nullptr;
+
+    int slot = slots[id];
+    return slot < 0 ? nullptr : list[slot];
+}
+
+// Number the live elements 1..n in their old ID order and put the list in
+// that order; `changed` is set if any element got a different ID
+template <typename T>
+IdRemap<T> renumberIndexed(std::vector<std::shared_ptr<T>>& list, std::vector<int>& slots, bool& changed) {
+    IdRemap<T> remap;
+    remap.target.assign(slots.size(), -1);
+
+    std::vector<std::shared_ptr<T>> ordered;
+    ordered.reserve(list.size());
+    for (size_t id = 0; id < slots.size(); id++) {
+        if (slots[id] < 0) continue;
+        ordered.push_back(std::move(list[slots[id]]));
+        const int new_id = static_cast<int>(ordered.size());
+        remap.target[id] = new_id;
+        if (new_id != static_cast<int>(id)) changed = true;
+        ordered.back()->id = new_id;
+    }
+
+    std::vector<int> dense(ordered.size() + 1, -1);
+    for (size_t i = 0; i < ordered.size(); i++) dense[i + 1] = static_cast<int>(i);
+    list = std::move(ordered);
+    slots = std::move(dense);
+    return remap;
+}
+
+} // namespace
+
+// ==================== LIFETIME ====================
+
+WingedEdgeKernel::~WingedEdgeKernel() {
+    releaseElements();
+}
+
+WingedEdgeKernel& WingedEdgeKernel::operator=(WingedEdgeKernel&& other) noexcept {
+    if (this == &other) return *this;
+
+    releaseElements();
+
+    // Keep in sync with the member list in winged_edge.h
+    vertices = std::move(other.vertices);
+    edges = std::move(other.edges);
+    faces = std::move(other.faces);
+    next_v_id = other.next_v_id;
+    next_e_id = other.next_e_id;
+    next_f_id = other.next_f_id;
+    solid_count = other.solid_count;
+    ring_count = other.ring_count;
+    vertex_slots = std::move(other.vertex_slots);
+    edge_slots = std::move(other.edge_slots);
+    face_slots = std::move(other.face_slots);
+    id_generation = other.id_generation;
+    dirty_vertices = std::move(other.dirty_vertices);
+    dirty_edges = std::move(other.dirty_edges);
+    dirty_faces = std::move(other.dirty_faces);
+    arena = std::move(other.arena);
+    default_arena = other.default_arena;
+    frozen = std::move(other.frozen);
+    thread_count = other.thread_count;
+    std::atomic_store(&published, std::atomic_load(&other.published));
+    snapshot_tracking = other.snapshot_tracking;
+    snapshot_stale = other.snapshot_stale;
+    snapshot_vertices = std::move(other.snapshot_vertices);
+    snapshot_edges = std::move(other.snapshot_edges);
+    snapshot_faces = std::move(other.snapshot_faces);
+    batch = std::move(other.batch);
+    undo_limit = other.undo_limit;
+    undo_bytes = other.undo_bytes;
+    undo_steps = std::move(other.undo_steps);
+    redo_steps = std::move(other.redo_steps);
+    step_changes = ChangeSet();
+    recording = batch ? &batch->changes : nullptr;
+    change_stamp = other.change_stamp;
+    vertex_stamps = std::move(other.vertex_stamps);
+    face_stamps = std::move(other.face_stamps);
+    attributes_stamp = other.attributes_stamp;
+    adjacency_enabled = other.adjacency_enabled;
+    adjacency_rebuild = other.adjacency_rebuild;
+    adjacency_spans = std::move(other.adjacency_spans);
+    adjacency_pool = std::move(other.adjacency_pool);
+    adjacency_stale = std::move(other.adjacency_stale);
+    adjacency_garbage = other.adjacency_garbage;
+    adjacency_marks = std::move(other.adjacency_marks);
+    adjacency_generation = other.adjacency_generation;
+#if SKETCHY_KERNEL_STATS
+    stats_recorder = std::move(other.stats_recorder);
+#endif
+
+    return *this;
+}
+
+void WingedEdgeKernel::releaseElements() {
+    for (const auto& v : vertices) v->edge = nullptr;
+    for (const auto& f : faces) f->edge = nullptr;
+    for (const auto& e : edges) {
+        e->v1 = e->v2 = nullptr;
+        e->f1 = e->f2 = nullptr;
+        e->p1_f1 = e->n1_f1 = e->p2_f2 = e->n2_f2 = nullptr;
+    }
+
+    vertices.clear();
+    edges.clear();
+    faces.clear();
+}
+
 // ==================== EULER OPERATORS ====================
 
 std::shared_ptr<Vertex> WingedEdgeKernel::mvsf(const Point3D& coords) {
+    SKETCHY_STAT_SCOPE(Mvsf);
+    StepScope step(*this);
+
     // Create the first vertex
-    auto vertex = std::make_shared<Vertex>(next_v_id++, coords);
-    vertices.push_back(vertex);
+    auto vertex = makeElement<Vertex>(next_v_id++, coords);
+    journal(vertex);
+    insertIndexed(vertices, vertex_slots, vertex);
 
     // Create the initial face (unbounded, represents the "outside" or the first face)
-    auto face = std::make_shared<Face>(next_f_id++);
-    faces.push_back(face);
+    auto face = makeElement<Face>(next_f_id++);
+    journal(face);
+    insertIndexed(faces, face_slots, face);
+    solid_count++;
+    markDirty(vertex);
+    markDirty(face);
 
     // Note: No edges are created yet - the vertex is isolated
     // The face exists but has no boundary until edges are added via MEV
@@ -24,6 +183,8 @@ std::shared_ptr<Vertex> WingedEdgeKernel::mvsf(const Point3D& coords) {
 std::shared_ptr<Edge> WingedEdgeKernel::mev(std::shared_ptr<Vertex> from_vertex,
                                              const Point3D& to_coords,
                                              std::shared_ptr<Face> on_face) {
+    SKETCHY_STAT_SCOPE(Mev);
+
     if (!from_vertex) {
         throw std::invalid_argument("MEV: from_vertex cannot be null");
     }
@@ -31,18 +192,29 @@ std::shared_ptr<Edge> WingedEdgeKernel::mev(std::shared_ptr<Vertex> from_vertex,
         throw std::invalid_argument("MEV: on_face cannot be null");
     }
 
+    StepScope step(*this);
+
+    journal(from_vertex);
+    journal(from_vertex->edge);
+    journal(on_face);
+
     // Create the new vertex
-    auto new_vertex = std::make_shared<Vertex>(next_v_id++, to_coords);
-    vertices.push_back(new_vertex);
+    auto new_vertex = makeElement<Vertex>(next_v_id++, to_coords);
+    journal(new_vertex);
+    insertIndexed(vertices, vertex_slots, new_vertex);
 
     // Create the new edge connecting from_vertex to new_vertex
-    auto new_edge = std::make_shared<Edge>(next_e_id++);
+    auto new_edge = makeElement<Edge>(next_e_id++);
+    journal(new_edge);
     new_edge->v1 = from_vertex;
     new_edge->v2 = new_vertex;
     new_edge->f1 = on_face;
     new_edge->f2 = on_face; // Initially, both sides are the same face
 
-    edges.push_back(new_edge);
+    insertIndexed(edges, edge_slots, new_edge);
+
+    adjustValence(from_vertex, 1);
+    adjustValence(new_vertex, 1);
 
     // Update vertex edge references
     if (!from_vertex->edge) {
@@ -80,14 +252,22 @@ std::shared_ptr<Edge> WingedEdgeKernel::mev(std::shared_ptr<Vertex> from_vertex,
         // For v2 (new vertex), edge loops back to itself initially
         new_edge->p2_f2 = new_edge;
         new_edge->n2_f2 = new_edge;
+        markDirty(prev_edge);
     }
 
+    markDirty(from_vertex);
+    markDirty(new_vertex);
+    markDirty(new_edge);
+    markDirty(on_face);
+
     return new_edge;
 }
 
 std::shared_ptr<Edge> WingedEdgeKernel::mef(std::shared_ptr<Vertex> v1,
                                              std::shared_ptr<Vertex> v2,
                                              std::shared_ptr<Face> face) {
+    SKETCHY_STAT_SCOPE(Mef);
+
     if (!v1 || !v2 || !face) {
         throw std::invalid_argument("MEF: vertices and face cannot be null");
     }
@@ -95,20 +275,26 @@ std::shared_ptr<Edge> WingedEdgeKernel::mef(std::shared_ptr<Vertex> v1,
         throw std::invalid_argument("MEF: cannot create edge between same vertex");
     }
 
+    StepScope step(*this);
+
     // Create the new edge
-    auto new_edge = std::make_shared<Edge>(next_e_id++);
+    auto new_edge = makeElement<Edge>(next_e_id++);
     new_edge->v1 = v1;
     new_edge->v2 = v2;
 
     // Create the new face (splits the original face)
-    auto new_face = std::make_shared<Face>(next_f_id++);
+    auto new_face = makeElement<Face>(next_f_id++);
+    journal(new_edge);
+    journal(new_face);
 
     // Assign faces: old face on one side, new face on the other
     new_edge->f1 = face;
     new_edge->f2 = new_face;
 
-    edges.push_back(new_edge);
-    faces.push_back(new_face);
+    insertIndexed(edges, edge_slots, new_edge);
+    insertIndexed(faces, face_slots, new_face);
+    adjustValence(v1, 1);
+    adjustValence(v2, 1);
 
     // Update face edge references
     new_face->edge = new_edge;
@@ -131,13 +317,27 @@ std::shared_ptr<Edge> WingedEdgeKernel::mef(std::shared_ptr<Vertex> v1,
         new_edge->n2_f2 = v2_edge;
     }
 
+    markDirty(v1);
+    markDirty(v2);
+    markDirty(new_edge);
+    markDirty(face);
+    markDirty(new_face);
+
     return new_edge;
 }
 
 std::shared_ptr<Face> WingedEdgeKernel::kef(std::shared_ptr<Edge> edge) {
+    SKETCHY_STAT_SCOPE(Kef);
+
     if (!edge) {
         throw std::invalid_argument("KEF: edge cannot be null");
     }
+    if (edge->f1 && edge->f1 == edge->f2) {
+        // A strut from MEV has the same face on both sides; killing it would kill that face
+        throw std::invalid_argument("KEF: edge has the same face on both sides");
+    }
+
+    StepScope step(*this);
 
     // Case 1: Boundary edge (only one face) - Kill edge and face
     if (!edge->f1 || !edge->f2) {
@@ -149,9 +349,15 @@ std::shared_ptr<Face> WingedEdgeKernel::kef(std::shared_ptr<Edge> edge) {
 
         // Get all edges on the boundary of the face
         auto boundary_edges = getFaceBoundary(face_to_kill);
+        journal(edge);
+        journal(face_to_kill);
+        for (const auto& e : boundary_edges) journal(e);
 
         // Remove the edge from the edge list
-        edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+        eraseIndexed(edges, edge_slots, edge);
+        unlinkEdge(edge);
+        adjustValence(edge->v1, -1);
+        adjustValence(edge->v2, -1);
 
         // Update all remaining boundary edges to set their reference
         // to face_to_kill to nullptr
@@ -164,10 +370,18 @@ std::shared_ptr<Face> WingedEdgeKernel::kef(std::shared_ptr<Edge> edge) {
             if (e->f2 == face_to_kill) {
                 e->f2 = nullptr;
             }
+            markDirty(e);
         }
 
         // Remove the face from the face list
-        faces.erase(std::remove(faces.begin(), faces.end(), face_to_kill), faces.end());
+        eraseIndexed(faces, face_slots, face_to_kill);
+        markDirty(edge);
+        markDirty(face_to_kill);
+
+        // The killed edge is out of every loop; dropping its wings and the
+        // killed face's anchor breaks the cycles the kernel no longer owns
+        edge->p1_f1 = edge->n1_f1 = edge->p2_f2 = edge->n2_f2 = nullptr;
+        face_to_kill->edge = nullptr;
 
         // Return the killed face (as specified in task)
         return face_to_kill;
@@ -177,234 +391,1849 @@ std::shared_ptr<Face> WingedEdgeKernel::kef(std::shared_ptr<Edge> edge) {
     auto f1 = edge->f1;
     auto f2 = edge->f2;
 
-    // Remove the edge from the edge list
-    edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+    // Walk f2's loop while the killed edge is still wired into it
+    auto f2_boundary = getFaceBoundary(f2);
+    journal(edge);
+    journal(f1);
+    journal(f2);
+    for (const auto& e : f2_boundary) journal(e);
+
+    // Remove the edge from the edge list and splice its wings together
+    eraseIndexed(edges, edge_slots, edge);
+    unlinkEdge(edge);
+    adjustValence(edge->v1, -1);
+    adjustValence(edge->v2, -1);
 
     // Merge f2 into f1 (f1 survives, f2 is removed)
-    // Update all edges that reference f2 to reference f1
-    for (auto& e : edges) {
+    // Only edges on f2's boundary can reference f2, so the merge is O(|f2|)
+    for (auto& e : f2_boundary) {
+        if (e == edge) continue;
         if (e->f1 == f2) e->f1 = f1;
         if (e->f2 == f2) e->f2 = f1;
+        markDirty(e);
+    }
+
+    if (f1->edge == edge) {
+        f1->edge = nullptr;
+        for (const auto& candidate : {edge->n1_f1, edge->n2_f2, edge->p1_f1, edge->p2_f2}) {
+            if (candidate && candidate != edge && (candidate->f1 == f1 || candidate->f2 == f1)) {
+                f1->edge = candidate;
+                break;
+            }
+        }
     }
 
     // Remove f2 from the face list
-    faces.erase(std::remove(faces.begin(), faces.end(), f2), faces.end());
+    eraseIndexed(faces, face_slots, f2);
+    markDirty(f1);
+    markDirty(edge);
+    markDirty(f2);
 
-    // Rewire the edge connectivity around the removed edge
-    // Connect the previous and next edges that were connected to the killed edge
-    // (Implementation depends on specific connectivity pattern)
+    edge->p1_f1 = edge->n1_f1 = edge->p2_f2 = edge->n2_f2 = nullptr;
+    f2->edge = nullptr;
 
     // Return the surviving face
     return f1;
 }
 
+void WingedEdgeKernel::unlinkEdge(const std::shared_ptr<Edge>& edge) {
+    // Around the killed edge the loops read X -> edge -> Y on the f1 side and
+    // X' -> edge -> Y' on the f2 side. Once it is gone the merged loop runs
+    // X -> Y' ... X' -> Y, so each neighbor skips over to the other side.
+    auto x = edge->p1_f1;
+    auto x2 = edge->p2_f2;
+    auto y = edge->n1_f1;
+    auto y2 = edge->n2_f2;
+
+    for (const auto& neighbor : {x, y, x2, y2}) journal(neighbor);
+    journal(edge->v1);
+    journal(edge->v2);
+
+    auto other = [&](const std::shared_ptr<Edge>& preferred, const std::shared_ptr<Edge>& fallback) {
+        if (preferred && preferred != edge) return preferred;
+        return fallback != edge ? fallback : nullptr;
+    };
+
+    auto redirect_next = [&](const std::shared_ptr<Edge>& e, const std::shared_ptr<Edge>& to) {
+        if (!e || e == edge) return;
+        if (e->n1_f1 == edge) e->n1_f1 = to;
+        if (e->n2_f2 == edge) e->n2_f2 = to;
+    };
+
+    auto redirect_prev = [&](const std::shared_ptr<Edge>& e, const std::shared_ptr<Edge>& to) {
+        if (!e || e == edge) return;
+        if (e->p1_f1 == edge) e->p1_f1 = to;
+        if (e->p2_f2 == edge) e->p2_f2 = to;
+    };
+
+    redirect_next(x, other(y2, y));
+    redirect_next(x2, other(y, y2));
+    redirect_prev(y, other(x2, x));
+    redirect_prev(y2, other(x, x2));
+
+    for (const auto& neighbor : {x, y, x2, y2}) {
+        if (neighbor != edge) markDirty(neighbor);
+    }
+
+    // Re-anchor endpoints that used the killed edge as their incident edge
+    for (const auto& v : {edge->v1, edge->v2}) {
+        if (!v || v->edge != edge) continue;
+
+        v->edge = nullptr;
+        for (const auto& candidate : {x, y, x2, y2}) {
+            if (candidate && candidate != edge && (candidate->v1 == v || candidate->v2 == v)) {
+                v->edge = candidate;
+                break;
+            }
+        }
+        markDirty(v);
+    }
+}
+
 void WingedEdgeKernel::kfmrh(std::shared_ptr<Face> hole_face, std::shared_ptr<Face> outer_face) {
+    SKETCHY_STAT_SCOPE(Kfmrh);
+
     if (!hole_face || !outer_face) {
         throw std::invalid_argument("KFMRH: faces cannot be null");
     }
+    if (hole_face == outer_face) {
+        throw std::invalid_argument("KFMRH: hole and outer face must differ");
+    }
 
-    // Remove the hole face from the face list
-    faces.erase(std::remove(faces.begin(), faces.end(), hole_face), faces.end());
+    StepScope step(*this);
+
+    // Remove the hole face from the face list; its loop becomes a ring of outer_face
+    journal(hole_face);
+    eraseIndexed(faces, face_slots, hole_face);
+    ring_count++;
 
     // Update edges on the hole boundary to reference the outer face
     auto boundary = getFaceBoundary(hole_face);
     for (auto& edge : boundary) {
+        journal(edge);
         if (edge->f1 == hole_face) edge->f1 = outer_face;
         if (edge->f2 == hole_face) edge->f2 = outer_face;
+        markDirty(edge);
     }
+    markDirty(outer_face);
+    markDirty(hole_face);
 }
 
-// ==================== NAVIGATION & QUERY ====================
+// ==================== BATCHES ====================
 
-std::vector<std::shared_ptr<Edge>> WingedEdgeKernel::getIncidentEdges(std::shared_ptr<Vertex> v) const {
-    std::vector<std::shared_ptr<Edge>> result;
-    if (!v || !v->edge) return result;
-
-    auto start_edge = v->edge;
-    auto current_edge = start_edge;
-    std::unordered_set<int> visited;
+namespace {
 
-    do {
-        if (visited.count(current_edge->id)) break;
-        visited.insert(current_edge->id);
-        result.push_back(current_edge);
-
-        // Navigate to next edge around vertex
-        if (current_edge->v1 == v) {
-            current_edge = current_edge->n1_f1;
-        } else if (current_edge->v2 == v) {
-            current_edge = current_edge->n2_f2;
-        } else {
-            break;
+// Put each element back into its imaged state and membership
+template <typename T, typename Image>
+void applyImages(std::vector<std::shared_ptr<T>>& list, std::vector<int>& slots,
+                 const std::vector<Image>& images, bool newest_first) {
+    auto apply = [&](const Image& image) {
+        bool alive = lookupIndexed(list, slots, image.element->id) == image.element;
+        if (image.alive && !alive) {
+            insertIndexed(list, slots, image.element);
+        } else if (!image.alive && alive) {
+            eraseIndexed(list, slots, image.element);
         }
+        *image.element = image.state;
+    };
 
-        if (!current_edge || visited.size() > edges.size()) break;
+    if (newest_first) {
+        for (auto it = images.rbegin(); it != images.rend(); ++it) apply(*it);
+    } else {
+        for (const auto& image : images) apply(image);
+    }
+}
 
-    } while (current_edge != start_edge);
+} // namespace
 
-    return result;
+void WingedEdgeKernel::captureCounters(ChangeSet& changes) const {
+    changes.next_v_id = next_v_id;
+    changes.next_e_id = next_e_id;
+    changes.next_f_id = next_f_id;
+    changes.solid_count = solid_count;
+    changes.ring_count = ring_count;
 }
 
-std::vector<std::shared_ptr<Face>> WingedEdgeKernel::getIncidentFaces(std::shared_ptr<Vertex> v) const {
-    std::vector<std::shared_ptr<Face>> result;
-    std::unordered_set<int> seen_face_ids;
+void WingedEdgeKernel::applyChanges(const ChangeSet& changes, bool newest_first) {
+    applyImages(vertices, vertex_slots, changes.vertices, newest_first);
+    applyImages(edges, edge_slots, changes.edges, newest_first);
+    applyImages(faces, face_slots, changes.faces, newest_first);
+
+    next_v_id = changes.next_v_id;
+    next_e_id = changes.next_e_id;
+    next_f_id = changes.next_f_id;
+    solid_count = changes.solid_count;
+    ring_count = changes.ring_count;
+}
+
+void WingedEdgeKernel::beginBatch(size_t new_vertices, size_t new_edges, size_t new_faces) {
+    if (batch) {
+        throw std::logic_error("beginBatch: a batch is already open");
+    }
+    thaw();
+
+    batch = std::make_unique<BatchState>();
+    captureCounters(batch->changes);
+    recording = &batch->changes;
+
+    vertices.reserve(vertices.size() + new_vertices);
+    edges.reserve(edges.size() + new_edges);
+    faces.reserve(faces.size() + new_faces);
+    vertex_slots.reserve(next_v_id + new_vertices);
+    edge_slots.reserve(next_e_id + new_edges);
+    face_slots.reserve(next_f_id + new_faces);
+
+    // MEV records four elements and touches five
+    batch->changes.vertices.reserve(2 * new_vertices);
+    batch->changes.edges.reserve(2 * new_edges);
+    batch->changes.faces.reserve(new_faces);
+    batch->dirty_vertices.reserve(2 * new_vertices);
+    batch->dirty_edges.reserve(2 * new_edges);
+    batch->dirty_faces.reserve(new_faces);
+}
+
+void WingedEdgeKernel::commit() {
+    if (!batch) {
+        throw std::logic_error("commit: no batch is open");
+    }
+
+    auto state = std::move(batch);
+    recording = nullptr;
+
+    // Each element is hashed once here instead of once per operator
+    for (int id : state->dirty_vertices) {
+        dirty_vertices.insert(id);
+        noteSnapshotChange(snapshot_vertices, id);
+    }
+    for (int id : state->dirty_edges) {
+        dirty_edges.insert(id);
+        noteSnapshotChange(snapshot_edges, id);
+    }
+    for (int id : state->dirty_faces) {
+        dirty_faces.insert(id);
+        noteSnapshotChange(snapshot_faces, id);
+    }
+
+    if (undo_limit > 0 && !state->changes.empty()) pushUndoStep(std::move(state->changes));
+}
+
+void WingedEdgeKernel::rollback() {
+    if (!batch) {
+        throw std::logic_error("rollback: no batch is open");
+    }
+
+    auto state = std::move(batch);
+    recording = nullptr;
+
+    // Newest first, so each element ends at its oldest image
+    adjustValenceForImages(state->changes, -1);
+    applyChanges(state->changes, true);
+    adjustValenceForImages(state->changes, 1);
+
+    // Caches computed inside the batch describe the discarded geometry, and
+    // nothing was stamped to say so
+    for (const auto& image : state->changes.vertices) invalidateAround(image.element);
+    for (const auto& image : state->changes.faces) image.element->attributes_valid = false;
+    attributes_stamp = std::numeric_limits<uint64_t>::max();
+
+    // IDs handed out inside the batch are free again
+    vertex_slots.resize(std::min(vertex_slots.size(), static_cast<size_t>(next_v_id)));
+    edge_slots.resize(std::min(edge_slots.size(), static_cast<size_t>(next_e_id)));
+    face_slots.resize(std::min(face_slots.size(), static_cast<size_t>(next_f_id)));
+}
+
+// ==================== UNDO / REDO ====================
+
+namespace {
+
+// Keep the oldest image of every element, then image the current state of
+// the same elements
+template <typename T, typename Image>
+void splitImages(std::vector<Image>& before, std::vector<Image>& after,
+                 const std::vector<std::shared_ptr<T>>& list, const std::vector<int>& slots) {
+    std::unordered_set<const T*> seen;
+    seen.reserve(before.size());
+
+    size_t kept = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        if (seen.insert(before[i].element.get()).second) before[kept++] = std::move(before[i]);
+    }
+    before.erase(before.begin() + kept, before.end());
+
+    after.reserve(kept);
+    for (const auto& image : before) {
+        const auto& element = image.element;
+        after.push_back({element, *element, lookupIndexed(list, slots, element->id) == element});
+    }
+}
+
+template <typename Image>
+size_t imageBytes(const std::vector<Image>& images) {
+    return images.size() * sizeof(Image);
+}
+
+} // namespace
+
+void WingedEdgeKernel::pushUndoStep(ChangeSet&& before) {
+    UndoStep step;
+    step.before = std::move(before);
+    splitImages(step.before.vertices, step.after.vertices, vertices, vertex_slots);
+    splitImages(step.before.edges, step.after.edges, edges, edge_slots);
+    splitImages(step.before.faces, step.after.faces, faces, face_slots);
+    captureCounters(step.after);
+
+    step.bytes = sizeof(UndoStep) +
+                 imageBytes(step.before.vertices) + imageBytes(step.before.edges) + imageBytes(step.before.faces) +
+                 imageBytes(step.after.vertices) + imageBytes(step.after.edges) + imageBytes(step.after.faces);
+
+    // A new edit forks the history
+    for (const auto& undone : redo_steps) undo_bytes -= undone.bytes;
+    redo_steps.clear();
+
+    undo_bytes += step.bytes;
+    undo_steps.push_back(std::move(step));
+    while (undo_bytes > undo_limit && !undo_steps.empty()) {
+        undo_bytes -= undo_steps.front().bytes;
+        undo_steps.pop_front();
+    }
+}
+
+void WingedEdgeKernel::setUndoLimit(size_t bytes) {
+    undo_limit = bytes;
+    while (undo_bytes > undo_limit && !undo_steps.empty()) {
+        undo_bytes -= undo_steps.front().bytes;
+        undo_steps.pop_front();
+    }
+    if (undo_limit == 0) {
+        redo_steps.clear();
+        undo_bytes = 0;
+    }
+}
+
+bool WingedEdgeKernel::undo() {
+    if (batch) {
+        throw std::logic_error("undo: a batch is open");
+    }
+    if (undo_steps.empty()) return false;
+
+    UndoStep step = std::move(undo_steps.back());
+    undo_steps.pop_back();
+
+    adjustValenceForImages(step.before, -1);
+    applyChanges(step.before, false);
+    adjustValenceForImages(step.before, 1);
+    for (const auto& image : step.before.vertices) markDirty(image.element);
+    for (const auto& image : step.before.edges) markDirty(image.element);
+    for (const auto& image : step.before.faces) markDirty(image.element);
+
+    redo_steps.push_back(std::move(step));
+    return true;
+}
+
+bool WingedEdgeKernel::redo() {
+    if (batch) {
+        throw std::logic_error("redo: a batch is open");
+    }
+    if (redo_steps.empty()) return false;
+
+    UndoStep step = std::move(redo_steps.back());
+    redo_steps.pop_back();
+
+    adjustValenceForImages(step.after, -1);
+    applyChanges(step.after, false);
+    adjustValenceForImages(step.after, 1);
+    for (const auto& image : step.after.vertices) markDirty(image.element);
+    for (const auto& image : step.after.edges) markDirty(image.element);
+    for (const auto& image : step.after.faces) markDirty(image.element);
+
+    undo_steps.push_back(std::move(step));
+    return true;
+}
+
+// ==================== BULK CONSTRUCTION ====================
 
-    auto incident_edges = getIncidentEdges(v);
-    for (const auto& edge : incident_edges) {
-        if (edge->f1 && !seen_face_ids.count(edge->f1->id)) {
-            result.push_back(edge->f1);
-            seen_face_ids.insert(edge->f1->id);
+std::vector<std::shared_ptr<Face>> WingedEdgeKernel::buildFromIndexedMesh(
+    const std::vector<Point3D>& positions, const std::vector<uint32_t>& face_indices,
+    const std::vector<uint32_t>& face_sizes) {
+    constexpr uint32_t kNone = 0xFFFFFFFFu;
+    const size_t half_edge_count = face_indices.size();
+
+    if (half_edge_count >= kNone) {
+        throw std::invalid_argument("buildFromIndexedMesh: too many face indices");
+    }
+
+    // Half-edge h runs face_indices[h] -> face_indices[next_in_face[h]] on polygon face_of[h]
+    std::vector<uint32_t> face_of(half_edge_count);
+    std::vector<uint32_t> next_in_face(half_edge_count);
+    size_t offset = 0;
+    for (uint32_t f = 0; f < face_sizes.size(); f++) {
+        uint32_t size = face_sizes[f];
+        if (size < 3) {
+            throw std::invalid_argument("buildFromIndexedMesh: faces need at least 3 vertices");
+        }
+        if (offset + size > half_edge_count) {
+            throw std::invalid_argument("buildFromIndexedMesh: face_sizes exceed face_indices");
         }
-        if (edge->f2 && !seen_face_ids.count(edge->f2->id)) {
-            result.push_back(edge->f2);
-            seen_face_ids.insert(edge->f2->id);
+        for (uint32_t k = 0; k < size; k++) {
+            face_of[offset + k] = f;
+            next_in_face[offset + k] = static_cast<uint32_t>(k + 1 < size ? offset + k + 1 : offset);
         }
+        offset += size;
+    }
+    if (offset != half_edge_count) {
+        throw std::invalid_argument("buildFromIndexedMesh: face_sizes do not cover face_indices");
     }
 
-    return result;
-}
+    auto from = [&](uint32_t h) { return face_indices[h]; };
+    auto to = [&](uint32_t h) { return face_indices[next_in_face[h]]; };
 
-std::vector<std::shared_ptr<Edge>> WingedEdgeKernel::getFaceBoundary(std::shared_ptr<Face> f) const {
-    std::vector<std::shared_ptr<Edge>> result;
-    if (!f || !f->edge) return result;
+    for (uint32_t h = 0; h < half_edge_count; h++) {
+        if (from(h) >= positions.size()) {
+            throw std::invalid_argument("buildFromIndexedMesh: vertex index out of range");
+        }
+        if (from(h) == to(h)) {
+            throw std::invalid_argument("buildFromIndexedMesh: face repeats a vertex consecutively");
+        }
+    }
+
+    // Match twins with one sort over the undirected vertex pairs
+    std::vector<std::pair<uint64_t, uint32_t>> order(half_edge_count);
+    for (uint32_t h = 0; h < half_edge_count; h++) {
+        uint64_t a = from(h);
+        uint64_t b = to(h);
+        order[h] = {a < b ? (a << 32) | b : (b << 32) | a, h};
+    }
+    std::sort(order.begin(), order.end());
+
+    // Each edge takes v1 -> v2 from its first half-edge (the f2 side); the
+    // twin, if any, is the f1 side. Unmatched half-edges border a hole.
+    std::vector<uint32_t> edge_of(half_edge_count);
+    std::vector<uint8_t> on_f1(half_edge_count, 0);
+    std::vector<uint32_t> primary;
+    primary.reserve(half_edge_count / 2 + 1);
+    std::vector<uint32_t> boundary_ending_at(positions.size(), kNone);
+
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i + 1;
+        while (j < order.size() && order[j].first == order[i].first) j++;
+        if (j - i > 2) {
+            throw std::invalid_argument("buildFromIndexedMesh: edge shared by more than two faces");
+        }
 
-    auto start_edge = f->edge;
-    auto current_edge = start_edge;
-    std::unordered_set<int> visited;
+        uint32_t h = order[i].second;
+        edge_of[h] = static_cast<uint32_t>(primary.size());
 
-    do {
-        if (visited.count(current_edge->id)) break;
-        visited.insert(current_edge->id);
-        result.push_back(current_edge);
-
-        // Navigate to next edge on face boundary
-        if (current_edge->f1 == f) {
-            current_edge = current_edge->n1_f1;
-        } else if (current_edge->f2 == f) {
-            current_edge = current_edge->n2_f2;
+        if (j - i == 2) {
+            uint32_t twin = order[i + 1].second;
+            if (from(twin) == from(h)) {
+                throw std::invalid_argument("buildFromIndexedMesh: adjacent faces have opposite orientation");
+            }
+            edge_of[twin] = edge_of[h];
+            on_f1[twin] = 1;
         } else {
-            break;
+            if (boundary_ending_at[to(h)] != kNone) {
+                throw std::invalid_argument("buildFromIndexedMesh: non-manifold boundary vertex");
+            }
+            boundary_ending_at[to(h)] = h;
         }
 
-        if (!current_edge || visited.size() > edges.size()) break;
+        primary.push_back(h);
+        i = j;
+    }
+
+    // The face closing a hole runs its half-edges backwards: after h (a -> b,
+    // walked b -> a) comes the unmatched half-edge that ends at a
+    std::vector<uint32_t> boundary_loops;
+    std::vector<uint8_t> looped(half_edge_count, 0);
+    for (uint32_t h : primary) {
+        if (looped[h] || boundary_ending_at[to(h)] != h) continue;
+
+        boundary_loops.push_back(h);
+        uint32_t current = h;
+        do {
+            looped[current] = 1;
+            current = boundary_ending_at[from(current)];
+            if (current == kNone || (looped[current] && current != h)) {
+                throw std::invalid_argument("buildFromIndexedMesh: open boundary loop");
+            }
+        } while (current != h);
+    }
 
-    } while (current_edge != start_edge);
+    // Referenced positions become vertices; count solids with a union-find
+    std::vector<uint32_t> parent(positions.size(), kNone);
+    for (uint32_t h = 0; h < half_edge_count; h++) parent[from(h)] = from(h);
 
-    return result;
-}
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    for (uint32_t h : primary) {
+        uint32_t a = find(from(h));
+        uint32_t b = find(to(h));
+        if (a != b) parent[a] = b;
+    }
 
-std::vector<std::shared_ptr<Vertex>> WingedEdgeKernel::getFaceVertices(std::shared_ptr<Face> f) const {
-    std::vector<std::shared_ptr<Vertex>> result;
-    auto boundary = getFaceBoundary(f);
+    size_t vertex_count = 0;
+    size_t solids = 0;
+    for (uint32_t p = 0; p < positions.size(); p++) {
+        if (parent[p] == kNone) continue;
+        vertex_count++;
+        if (find(p) == p) solids++;
+    }
 
-    for (const auto& edge : boundary) {
-        if (edge->f1 == f) {
-            result.push_back(edge->v1);
+    // ---- The input is valid; create and wire everything ----
+
+    StepScope step(*this);
+
+    size_t face_count = face_sizes.size() + boundary_loops.size();
+    vertices.reserve(vertices.size() + vertex_count);
+    edges.reserve(edges.size() + primary.size());
+    faces.reserve(faces.size() + face_count);
+    vertex_slots.reserve(next_v_id + vertex_count);
+    edge_slots.reserve(next_e_id + primary.size());
+    face_slots.reserve(next_f_id + face_count);
+
+    std::vector<std::shared_ptr<Vertex>> vertex_of(positions.size());
+    for (uint32_t p = 0; p < positions.size(); p++) {
+        if (parent[p] == kNone) continue;
+        vertex_of[p] = makeElement<Vertex>(next_v_id++, positions[p]);
+        journal(vertex_of[p]);
+        insertIndexed(vertices, vertex_slots, vertex_of[p]);
+    }
+
+    std::vector<std::shared_ptr<Face>> polygon_faces(face_sizes.size());
+    for (auto& f : polygon_faces) {
+        f = makeElement<Face>(next_f_id++);
+        journal(f);
+        insertIndexed(faces, face_slots, f);
+    }
+
+    std::vector<std::shared_ptr<Edge>> edge_list(primary.size());
+    for (size_t i = 0; i < primary.size(); i++) {
+        uint32_t h = primary[i];
+        auto& e = edge_list[i];
+        e = makeElement<Edge>(next_e_id++);
+        journal(e);
+        e->v1 = vertex_of[from(h)];
+        e->v2 = vertex_of[to(h)];
+        e->f2 = polygon_faces[face_of[h]];
+        insertIndexed(edges, edge_slots, e);
+
+        if (!e->v1->edge) e->v1->edge = e;
+        if (!e->v2->edge) e->v2->edge = e;
+    }
+
+    // Polygon loops: each half-edge links to its successor on its own side
+    for (uint32_t h = 0; h < half_edge_count; h++) {
+        const auto& e = edge_list[edge_of[h]];
+        const auto& next = edge_list[edge_of[next_in_face[h]]];
+
+        if (on_f1[h]) {
+            e->f1 = polygon_faces[face_of[h]];
+            e->n1_f1 = next;
         } else {
-            result.push_back(edge->v2);
+            e->n2_f2 = next;
+        }
+        if (on_f1[next_in_face[h]]) {
+            next->p1_f1 = e;
+        } else {
+            next->p2_f2 = e;
         }
     }
 
-    return result;
+    size_t offset_of_face = 0;
+    for (uint32_t f = 0; f < face_sizes.size(); f++) {
+        polygon_faces[f]->edge = edge_list[edge_of[offset_of_face]];
+        offset_of_face += face_sizes[f];
+    }
+
+    // Hole loops run on the f1 side of their boundary edges
+    for (uint32_t start : boundary_loops) {
+        auto hole = makeElement<Face>(next_f_id++);
+        journal(hole);
+        insertIndexed(faces, face_slots, hole);
+        hole->edge = edge_list[edge_of[start]];
+
+        uint32_t current = start;
+        do {
+            uint32_t next = boundary_ending_at[from(current)];
+            const auto& e = edge_list[edge_of[current]];
+            const auto& n = edge_list[edge_of[next]];
+            e->f1 = hole;
+            e->n1_f1 = n;
+            n->p1_f1 = e;
+            current = next;
+        } while (current != start);
+    }
+
+    solid_count += solids;
+    if (snapshot_tracking) snapshot_stale = true;
+    invalidateAdjacency();
+
+    // One stamp covers everything the build created
+    ++change_stamp;
+    vertex_stamps.resize(next_v_id, change_stamp);
+    face_stamps.resize(next_f_id, change_stamp);
+    return polygon_faces;
 }
 
-bool WingedEdgeKernel::validate() const {
-    // Check all vertex edge references are valid
-    for (const auto& v : vertices) {
-        if (v->edge) {
-            bool found = false;
-            for (const auto& e : edges) {
-                if (e == v->edge) {
-                    found = true;
-                    break;
-                }
+// ==================== EXTRUSION ====================
+
+std::vector<std::shared_ptr<Face>> WingedEdgeKernel::extrudeFaces(
+    const std::vector<std::shared_ptr<Face>>& selection, const Vec3& offset, ExtrudeMode mode) {
+    constexpr uint32_t kNone = 0xFFFFFFFFu;
+    // Faces per task; each face walks its loop a couple of times
+    constexpr size_t kFacesPerChunk = 256;
+    const bool region = mode == ExtrudeMode::Region;
+    const size_t threads = resolveThreadCount(thread_count);
+
+    std::vector<uint8_t> selected(next_f_id, 0);
+    std::vector<std::shared_ptr<Face>> chosen;
+    chosen.reserve(selection.size());
+    for (const auto& f : selection) {
+        if (!isAlive(f)) {
+            throw std::invalid_argument("extrudeFaces: faces must be alive");
+        }
+        if (selected[f->id]) continue;
+        selected[f->id] = 1;
+        chosen.push_back(f);
+    }
+    const size_t face_count = chosen.size();
+
+    // ---- Plan in parallel; nothing is written until the selection checks out ----
+
+    // Loop lengths, turned into offsets into one flat half-edge list
+    std::vector<size_t> loop_offset(face_count + 1, 0);
+    parallelFor(face_count, threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) loop_offset[i + 1] = faceEdges(chosen[i]).size();
+    }, kFacesPerChunk);
+    for (size_t i = 0; i < face_count; i++) loop_offset[i + 1] += loop_offset[i];
+    const size_t half_count = loop_offset[face_count];
+    if (half_count >= kNone) {
+        throw std::invalid_argument("extrudeFaces: selection too large");
+    }
+
+    // Half-edge k runs from loop_start[k] along loop_edges[k], on its f1
+    // side when on_f1[k]; next_half / prev_half wrap around each loop
+    enum Problem : int { kFine, kEmpty, kOpen, kSelfBorder, kTouching };
+    std::atomic<int> problem{kFine};
+    auto report = [&](int p) {
+        int fine = kFine;
+        problem.compare_exchange_strong(fine, p, std::memory_order_relaxed);
+    };
+
+    std::vector<std::shared_ptr<Edge>> loop_edges(half_count);
+    std::vector<Vertex*> loop_start(half_count);
+    std::vector<uint32_t> next_half(half_count), prev_half(half_count);
+    std::vector<uint8_t> on_f1(half_count), boundary(half_count);
+    std::vector<uint32_t> boundary_offset(face_count + 1, 0);
+
+    parallelFor(face_count, threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Face* face = chosen[i].get();
+            const uint32_t first = static_cast<uint32_t>(loop_offset[i]);
+            const uint32_t last = static_cast<uint32_t>(loop_offset[i + 1]);
+            if (first == last) {
+                report(kEmpty);
+                continue;
             }
-            if (!found) return false;
 
-            // Vertex should be an endpoint of its edge
-            if (v->edge->v1 != v && v->edge->v2 != v) {
-                return false;
+            uint32_t k = first;
+            uint32_t walls = 0;
+            for (const auto& e : faceEdges(chosen[i])) {
+                if (k == last) break;
+                const bool f1_side = e->f1.get() == face;
+                if (e->f1 == e->f2) report(kSelfBorder);
+                const Face* other = f1_side ? e->f2.get() : e->f1.get();
+
+                loop_edges[k] = e;
+                loop_start[k] = (f1_side ? e->v2 : e->v1).get();
+                on_f1[k] = f1_side;
+                boundary[k] = !region || !other || !selected[other->id];
+                next_half[k] = k + 1 < last ? k + 1 : first;
+                prev_half[k] = k > first ? k - 1 : last - 1;
+                walls += boundary[k];
+                k++;
             }
+
+            // The walk stops at the first repeat; make sure that is the start
+            if (k != last) {
+                report(kOpen);
+                continue;
+            }
+            const Edge& tail = *loop_edges[last - 1];
+            if ((tail.f1.get() == face ? tail.n1_f1 : tail.n2_f2) != loop_edges[first]) report(kOpen);
+            boundary_offset[i + 1] = walls;
         }
+    }, kFacesPerChunk);
+    if (problem.load() == kFine) {
+        for (size_t i = 0; i < face_count; i++) boundary_offset[i + 1] += boundary_offset[i];
+    }
+    const uint32_t wall_count = problem.load() == kFine ? boundary_offset[face_count] : 0;
+
+    // Wall i stands on boundary half-edge boundary_half[i] and owns the
+    // corner at its start; next_corner[i] is the corner at its end
+    std::vector<uint32_t> boundary_half(wall_count);
+    std::vector<uint32_t> boundary_index(half_count, kNone);
+    std::vector<uint32_t> next_corner(wall_count);
+
+    // Region: wall + 1 leaving / reaching each vertex, 0 if none. A vertex
+    // the outline passes twice would need two raised copies.
+    std::vector<std::atomic<uint32_t>> out_of(region ? next_v_id : 0);
+    std::vector<std::atomic<uint32_t>> in_of(region ? next_v_id : 0);
+
+    if (problem.load() == kFine) {
+        parallelFor(face_count, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                uint32_t wall = boundary_offset[i];
+                for (size_t k = loop_offset[i]; k < loop_offset[i + 1]; k++) {
+                    if (!boundary[k]) continue;
+                    boundary_index[k] = wall;
+                    boundary_half[wall] = static_cast<uint32_t>(k);
+                    if (region) {
+                        uint32_t none = 0;
+                        if (!out_of[loop_start[k]->id].compare_exchange_strong(none, wall + 1)) report(kTouching);
+                        none = 0;
+                        if (!in_of[loop_start[next_half[k]]->id].compare_exchange_strong(none, wall + 1)) {
+                            report(kTouching);
+                        }
+                    }
+                    wall++;
+                }
+            }
+        }, kFacesPerChunk);
     }
 
-    // Check all edges have valid vertices and faces
-    for (const auto& e : edges) {
-        if (!e->v1 || !e->v2) return false;
+    if (problem.load() == kFine) {
+        parallelFor(wall_count, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                uint32_t k = boundary_half[i];
+                if (!region) {
+                    next_corner[i] = boundary_index[next_half[k]];
+                    continue;
+                }
+                uint32_t leaving = out_of[loop_start[next_half[k]]->id].load(std::memory_order_relaxed);
+                if (leaving == 0) {
+                    report(kOpen);
+                    leaving = 1;
+                }
+                next_corner[i] = leaving - 1;
+            }
+        });
+    }
 
-        // Check vertices exist in vertex list
-        bool v1_found = false, v2_found = false;
-        for (const auto& v : vertices) {
-            if (v == e->v1) v1_found = true;
-            if (v == e->v2) v2_found = true;
+    switch (problem.load()) {
+        case kEmpty: throw std::invalid_argument("extrudeFaces: face has no boundary loop");
+        case kOpen: throw std::invalid_argument("extrudeFaces: face loop does not close");
+        case kSelfBorder: throw std::invalid_argument("extrudeFaces: face borders itself");
+        case kTouching: throw std::invalid_argument("extrudeFaces: selection touches itself at a vertex");
+        default: break;
+    }
+
+    auto vertexOf = [&](const Vertex* v) -> const std::shared_ptr<Vertex>& { return vertices[vertex_slots[v->id]]; };
+
+    // Region: vertices inside the patch move with it, everything else stays
+    std::vector<Vertex*> movers;
+    if (region) {
+        std::vector<uint8_t> seen(next_v_id, 0);
+        for (Vertex* v : loop_start) {
+            if (seen[v->id]) continue;
+            seen[v->id] = 1;
+            if (out_of[v->id].load(std::memory_order_relaxed) == 0) movers.push_back(v);
         }
-        if (!v1_found || !v2_found) return false;
     }
 
-    // Check all faces have valid edge references
-    for (const auto& f : faces) {
-        if (f->edge) {
-            bool found = false;
-            for (const auto& e : edges) {
-                if (e == f->edge) {
-                    found = true;
-                    break;
+    // ---- Allocate in one reservation; the arena is not thread-safe ----
+
+    StepScope step(*this);
+
+    for (const auto& f : chosen) journal(f);
+    for (const auto& e : loop_edges) journal(e);
+    for (Vertex* v : movers) journal(vertexOf(v));
+    if (region) {
+        for (uint32_t k : boundary_half) journal(vertexOf(loop_start[k]));
+    }
+
+    vertices.reserve(vertices.size() + wall_count);
+    edges.reserve(edges.size() + 2 * size_t(wall_count));
+    faces.reserve(faces.size() + wall_count);
+    vertex_slots.reserve(next_v_id + wall_count);
+    edge_slots.reserve(next_e_id + 2 * size_t(wall_count));
+    face_slots.reserve(next_f_id + wall_count);
+
+    // Corner i: the raised vertex and the rail up to it from its base
+    std::vector<std::shared_ptr<Vertex>> raised(wall_count);
+    std::vector<std::shared_ptr<Edge>> rails(wall_count), tops(wall_count);
+    std::vector<std::shared_ptr<Face>> walls(wall_count);
+    for (uint32_t i = 0; i < wall_count; i++) {
+        const auto& base = vertexOf(loop_start[boundary_half[i]]);
+        raised[i] = makeElement<Vertex>(next_v_id++, base->coords + offset);
+        journal(raised[i]);
+        insertIndexed(vertices, vertex_slots, raised[i]);
+
+        rails[i] = makeElement<Edge>(next_e_id++);
+        journal(rails[i]);
+        rails[i]->v1 = base;
+        rails[i]->v2 = raised[i];
+        insertIndexed(edges, edge_slots, rails[i]);
+
+        raised[i]->edge = rails[i];
+        if (region) base->edge = rails[i];
+    }
+    for (auto& t : tops) {
+        t = makeElement<Edge>(next_e_id++);
+        journal(t);
+        insertIndexed(edges, edge_slots, t);
+    }
+    for (auto& w : walls) {
+        w = makeElement<Face>(next_f_id++);
+        journal(w);
+        insertIndexed(faces, face_slots, w);
+    }
+
+    // ---- Wire in parallel: each face writes only its own side of each edge ----
+
+    // What half-edge k becomes in the moved loop
+    auto image = [&](uint32_t k) -> const std::shared_ptr<Edge>& {
+        return boundary[k] ? tops[boundary_index[k]] : loop_edges[k];
+    };
+    auto lift = [&](std::shared_ptr<Vertex>& v) {
+        uint32_t corner = out_of[v->id].load(std::memory_order_relaxed);
+        if (corner) v = raised[corner - 1];
+    };
+
+    parallelFor(face_count, threads, [&](size_t begin, size_t end) {
+        for (size_t fi = begin; fi < end; fi++) {
+            const auto& face = chosen[fi];
+            for (uint32_t k = static_cast<uint32_t>(loop_offset[fi]); k < loop_offset[fi + 1]; k++) {
+                const auto& next = image(next_half[k]);
+                const auto& prev = image(prev_half[k]);
+                const auto& e = loop_edges[k];
+
+                if (!boundary[k]) {
+                    // Shared by two selected faces; the f2 side also lifts the endpoints
+                    if (on_f1[k]) {
+                        e->n1_f1 = next;
+                        e->p1_f1 = prev;
+                    } else {
+                        e->n2_f2 = next;
+                        e->p2_f2 = prev;
+                        lift(e->v1);
+                        lift(e->v2);
+                    }
+                    continue;
                 }
+
+                // Wall loop: e -> rail j (up) -> top (back) -> rail i (down)
+                const uint32_t i = boundary_index[k];
+                const uint32_t j = next_corner[i];
+                const auto& top = tops[i];
+                const auto& wall = walls[i];
+
+                top->v1 = raised[i];
+                top->v2 = raised[j];
+                top->f2 = face;
+                top->n2_f2 = next;
+                top->p2_f2 = prev;
+                top->f1 = wall;
+                top->n1_f1 = rails[i];
+                top->p1_f1 = rails[j];
+
+                if (on_f1[k]) {
+                    e->f1 = wall;
+                    e->n1_f1 = rails[j];
+                    e->p1_f1 = rails[i];
+                } else {
+                    e->f2 = wall;
+                    e->n2_f2 = rails[j];
+                    e->p2_f2 = rails[i];
+                }
+                wall->edge = e;
+
+                rails[i]->f1 = wall;
+                rails[i]->n1_f1 = e;
+                rails[i]->p1_f1 = top;
+                rails[j]->f2 = wall;
+                rails[j]->n2_f2 = top;
+                rails[j]->p2_f2 = e;
             }
-            if (!found) return false;
+            face->edge = image(static_cast<uint32_t>(loop_offset[fi]));
+        }
+    }, kFacesPerChunk);
 
-            // Face should be adjacent to its edge
-            if (f->edge->f1 != f && f->edge->f2 != f) {
-                return false;
+    parallelFor(movers.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) movers[i]->coords = movers[i]->coords + offset;
+    });
+
+    // ---- Bookkeeping ----
+
+    if (adjacency_enabled) {
+        for (uint32_t i = 0; i < wall_count; i++) {
+            adjustValence(vertexOf(loop_start[boundary_half[i]]), +1);
+            adjustValence(raised[i], +3); // Rail, top in and top out
+        }
+        for (uint32_t k = 0; region && k < half_count; k++) {
+            if (boundary[k] || on_f1[k]) continue;
+            for (const Vertex* v : {loop_start[k], loop_start[next_half[k]]}) {
+                uint32_t corner = out_of[v->id].load(std::memory_order_relaxed);
+                if (!corner) continue;
+                adjustValence(vertexOf(v), -1);
+                adjustValence(raised[corner - 1], +1);
             }
         }
     }
 
-    return true;
+    for (Vertex* v : movers) markDirty(vertexOf(v));
+    for (uint32_t i = 0; i < wall_count; i++) {
+        markDirty(vertexOf(loop_start[boundary_half[i]]));
+        markDirty(raised[i]);
+        markDirty(rails[i]);
+        markDirty(tops[i]);
+        markDirty(walls[i]);
+    }
+    for (const auto& e : loop_edges) markDirty(e);
+    for (const auto& f : chosen) markDirty(f);
+
+    return walls;
 }
 
-bool WingedEdgeKernel::isManifold() const {
-    // Check that each edge is adjacent to at most 2 faces
+// ==================== COMPONENTS ====================
+
+std::vector<WingedEdgeKernel> WingedEdgeKernel::splitComponents() const {
+    if (frozen) throw std::logic_error("splitComponents: kernel is frozen");
+    constexpr uint32_t kNone = 0xFFFFFFFFu;
+    const size_t vertex_count = vertices.size();
+
+    // Union the endpoints of every edge; slots stand in for the vertices
+    std::vector<uint32_t> parent(vertex_count);
+    for (uint32_t i = 0; i < vertex_count; i++) parent[i] = i;
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    auto slotOf = [&](const Vertex* v) { return static_cast<uint32_t>(vertex_slots[v->id]); };
+
+    std::vector<uint8_t> on_edge(vertex_count, 0);
     for (const auto& e : edges) {
-        if (e->f1 && e->f2 && e->f1 == e->f2) {
-            // Same face on both sides might be ok for some configurations
+        if (!e->v1 || !e->v2) continue;
+        uint32_t a = slotOf(e->v1.get());
+        uint32_t b = slotOf(e->v2.get());
+        on_edge[a] = on_edge[b] = 1;
+        a = find(a);
+        b = find(b);
+        if (a != b) parent[std::max(a, b)] = std::min(a, b);
+    }
+
+    // Number components by first vertex; remember the lone vertices for
+    // the edgeless faces
+    std::vector<uint32_t> vertex_part(vertex_count);
+    std::vector<uint32_t> root_part(vertex_count, kNone);
+    std::vector<uint32_t> lone_parts;
+    uint32_t part_count = 0;
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        uint32_t root = find(i);
+        if (root_part[root] == kNone) {
+            root_part[root] = part_count++;
+            if (!on_edge[i]) lone_parts.push_back(root_part[root]);
+        }
+        vertex_part[i] = root_part[root];
+    }
+
+    auto edgePart = [&](const Edge& e) {
+        const auto& v = e.v1 ? e.v1 : e.v2;
+        return v ? vertex_part[slotOf(v.get())] : kNone;
+    };
+
+    std::vector<uint32_t> edge_part(edges.size());
+    for (size_t i = 0; i < edges.size(); i++) {
+        edge_part[i] = edgePart(*edges[i]);
+        if (edge_part[i] == kNone) edge_part[i] = part_count++; // Edge without endpoints
+    }
+
+    std::vector<uint32_t> face_part(faces.size());
+    size_t next_lone = 0;
+    for (size_t i = 0; i < faces.size(); i++) {
+        const auto& edge = faces[i]->edge;
+        if (edge) {
+            face_part[i] = edge_part[edge_slots[edge->id]];
+        } else if (next_lone < lone_parts.size()) {
+            face_part[i] = lone_parts[next_lone++];
+        } else {
+            face_part[i] = part_count++;
+        }
+    }
+
+    // Elements of each part in kernel order; local index = position in the part
+    struct Members {
+        std::vector<uint32_t> vertices, edges, faces;
+    };
+    std::vector<Members> members(part_count);
+    std::vector<uint32_t> vertex_local(vertex_count), edge_local(edges.size()), face_local(faces.size());
+    auto distribute = [&](const std::vector<uint32_t>& part_of, std::vector<uint32_t>& local,
+                          std::vector<uint32_t> Members::*list) {
+        for (uint32_t i = 0; i < part_of.size(); i++) {
+            auto& l = members[part_of[i]].*list;
+            local[i] = static_cast<uint32_t>(l.size());
+            l.push_back(i);
+        }
+    };
+    distribute(vertex_part, vertex_local, &Members::vertices);
+    distribute(edge_part, edge_local, &Members::edges);
+    distribute(face_part, face_local, &Members::faces);
+
+    // ---- Fill the parts; each allocates only from its own arena ----
+
+    std::vector<WingedEdgeKernel> parts(part_count);
+    parallelFor(part_count, resolveThreadCount(thread_count), [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) {
+            WingedEdgeKernel& part = parts[p];
+            const Members& m = members[p];
+
+            auto fill_slots = [](std::vector<int>& slots, size_t count) {
+                slots.assign(count + 1, -1);
+                for (size_t i = 0; i < count; i++) slots[i + 1] = static_cast<int>(i);
+            };
+            fill_slots(part.vertex_slots, m.vertices.size());
+            fill_slots(part.edge_slots, m.edges.size());
+            fill_slots(part.face_slots, m.faces.size());
+
+            part.vertices.reserve(m.vertices.size());
+            for (uint32_t slot : m.vertices) {
+                int id = static_cast<int>(part.vertices.size() + 1);
+                part.vertices.push_back(part.makeElement<Vertex>(id, vertices[slot]->coords));
+            }
+            part.edges.reserve(m.edges.size());
+            for (size_t i = 0; i < m.edges.size(); i++) {
+                part.edges.push_back(part.makeElement<Edge>(static_cast<int>(i + 1)));
+            }
+            part.faces.reserve(m.faces.size());
+            for (size_t i = 0; i < m.faces.size(); i++) {
+                part.faces.push_back(part.makeElement<Face>(static_cast<int>(i + 1)));
+            }
+
+            // References into another part (broken loops) are dropped
+            auto v_of = [&](const std::shared_ptr<Vertex>& v) -> std::shared_ptr<Vertex> {
+                if (!v || vertex_part[vertex_slots[v->id]] != p) return nullptr;
+                return part.vertices[vertex_local[vertex_slots[v->id]]];
+            };
+            auto e_of = [&](const std::shared_ptr<Edge>& e) -> std::shared_ptr<Edge> {
+                if (!e || edge_part[edge_slots[e->id]] != p) return nullptr;
+                return part.edges[edge_local[edge_slots[e->id]]];
+            };
+            auto f_of = [&](const std::shared_ptr<Face>& f) -> std::shared_ptr<Face> {
+                if (!f || face_part[face_slots[f->id]] != p) return nullptr;
+                return part.faces[face_local[face_slots[f->id]]];
+            };
+
+            for (size_t i = 0; i < m.vertices.size(); i++) part.vertices[i]->edge = e_of(vertices[m.vertices[i]]->edge);
+            for (size_t i = 0; i < m.faces.size(); i++) part.faces[i]->edge = e_of(faces[m.faces[i]]->edge);
+            for (size_t i = 0; i < m.edges.size(); i++) {
+                const Edge& source = *edges[m.edges[i]];
+                Edge& e = *part.edges[i];
+                e.v1 = v_of(source.v1);
+                e.v2 = v_of(source.v2);
+                e.f1 = f_of(source.f1);
+                e.f2 = f_of(source.f2);
+                e.p1_f1 = e_of(source.p1_f1);
+                e.n1_f1 = e_of(source.n1_f1);
+                e.p2_f2 = e_of(source.p2_f2);
+                e.n2_f2 = e_of(source.n2_f2);
+            }
+
+            part.next_v_id = static_cast<int>(m.vertices.size() + 1);
+            part.next_e_id = static_cast<int>(m.edges.size() + 1);
+            part.next_f_id = static_cast<int>(m.faces.size() + 1);
+
+            // One solid; whatever the sum has beyond a sphere's 2 is rings
+            long long chi = static_cast<long long>(m.vertices.size()) - static_cast<long long>(m.edges.size()) +
+                            static_cast<long long>(m.faces.size());
+            part.solid_count = 1;
+            part.ring_count = chi > 2 ? static_cast<size_t>(chi - 2) : 0;
+            part.thread_count = thread_count;
+        }
+    }, 16);
+    return parts;
+}
+
+// ==================== FROZEN MODE ====================
+
+void WingedEdgeKernel::freeze(const FreezeOptions& options) {
+    if (batch) {
+        throw std::logic_error("freeze: a batch is open");
+    }
+    if (frozen) return;
+
+    auto model = std::make_unique<FrozenTopology>(FrozenTopology::encode(*this, options));
+
+    // Break the shared_ptr cycles, then let go of every per-element table
+    releaseElements();
+    std::vector<std::shared_ptr<Vertex>>().swap(vertices);
+    std::vector<std::shared_ptr<Edge>>().swap(edges);
+    std::vector<std::shared_ptr<Face>>().swap(faces);
+    std::vector<int>().swap(vertex_slots);
+    std::vector<int>().swap(edge_slots);
+    std::vector<int>().swap(face_slots);
+    dirty_vertices = {};
+    dirty_edges = {};
+    dirty_faces = {};
+    undo_steps.clear();
+    redo_steps = {};
+    undo_bytes = 0;
+    std::vector<uint64_t>().swap(vertex_stamps);
+    std::vector<uint64_t>().swap(face_stamps);
+    std::vector<int>().swap(snapshot_vertices);
+    std::vector<int>().swap(snapshot_edges);
+    std::vector<int>().swap(snapshot_faces);
+    if (snapshot_tracking) snapshot_stale = true;
+    std::vector<AdjacencySpan>().swap(adjacency_spans);
+    std::vector<const Face*>().swap(adjacency_pool);
+    std::vector<int>().swap(adjacency_stale);
+    std::vector<uint32_t>().swap(adjacency_marks);
+    adjacency_garbage = 0;
+    invalidateAdjacency();
+
+    // Our own pool resource holds on to freed blocks; elements still held
+    // elsewhere keep it alive through their control blocks
+    if (default_arena) {
+        arena.reset();
+        default_arena = false;
+    }
+    frozen = std::move(model);
+}
+
+void WingedEdgeKernel::thaw() {
+    if (!frozen) return;
+    std::unique_ptr<FrozenTopology> model = std::move(frozen);
+
+    const size_t vertex_count = model->getVertexCount();
+    const size_t edge_count = model->getEdgeCount();
+    const size_t face_count = model->getFaceCount();
+    vertices.reserve(vertex_count);
+    edges.reserve(edge_count);
+    faces.reserve(face_count);
+
+    // Create everything first, so references can be resolved by ID
+    std::vector<FrozenVertex> vertex_records(vertex_count);
+    for (size_t i = 0; i < vertex_count; i++) {
+        vertex_records[i] = model->vertexAt(i);
+        insertIndexed(vertices, vertex_slots, makeElement<Vertex>(vertex_records[i].id, vertex_records[i].coords));
+    }
+    std::vector<FrozenEdge> edge_records(edge_count);
+    for (size_t i = 0; i < edge_count; i++) {
+        edge_records[i] = model->edgeAt(i);
+        insertIndexed(edges, edge_slots, makeElement<Edge>(edge_records[i].id));
+    }
+    std::vector<FrozenFace> face_records(face_count);
+    for (size_t i = 0; i < face_count; i++) {
+        face_records[i] = model->faceAt(i);
+        insertIndexed(faces, face_slots, makeElement<Face>(face_records[i].id));
+    }
+
+    auto vertex = [&](int id) { return lookupIndexed(vertices, vertex_slots, id); };
+    auto edge = [&](int id) { return lookupIndexed(edges, edge_slots, id); };
+    auto face = [&](int id) { return lookupIndexed(faces, face_slots, id); };
+
+    for (size_t i = 0; i < vertex_count; i++) vertices[i]->edge = edge(vertex_records[i].edge);
+    for (size_t i = 0; i < face_count; i++) faces[i]->edge = edge(face_records[i].edge);
+    for (size_t i = 0; i < edge_count; i++) {
+        const FrozenEdge& r = edge_records[i];
+        Edge& e = *edges[i];
+        e.v1 = vertex(r.v1);
+        e.v2 = vertex(r.v2);
+        e.f1 = face(r.f1);
+        e.f2 = face(r.f2);
+        e.p1_f1 = edge(r.p1_f1);
+        e.n1_f1 = edge(r.n1_f1);
+        e.p2_f2 = edge(r.p2_f2);
+        e.n2_f2 = edge(r.n2_f2);
+    }
+
+    // Every element is new to stamp readers (BVH refits, attribute caches)
+    ++change_stamp;
+    vertex_stamps.assign(next_v_id, change_stamp);
+    face_stamps.assign(next_f_id, change_stamp);
+    invalidateAdjacency();
+}
+
+// ==================== GEOMETRY ====================
+
+void WingedEdgeKernel::transformVertices(const std::vector<std::shared_ptr<Vertex>>& selection,
+                                         const Mat4& transform) {
+    constexpr size_t kBlock = 256;
+    std::array<Point3D, kBlock> block;
+    StepScope step(*this);
+
+    for (size_t start = 0; start < selection.size(); start += kBlock) {
+        size_t count = std::min(kBlock, selection.size() - start);
+        for (size_t i = 0; i < count; i++) {
+            if (selection[start + i]) block[i] = selection[start + i]->coords;
+        }
+
+        transform.transformPoints(block.data(), block.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            if (!selection[start + i]) continue;
+            journal(selection[start + i]);
+            selection[start + i]->coords = block[i];
+            stamp(vertex_stamps, selection[start + i]->id);
+            invalidateAround(selection[start + i]);
+            noteSnapshotChange(snapshot_vertices, selection[start + i]->id);
+        }
+    }
+}
+
+// ==================== FACE ATTRIBUTES ====================
+
+namespace {
+
+void computeAttributes(Face& face, size_t limit, std::vector<Point3D>& loop) {
+    loop.clear();
+    FaceAttributes& out = face.attributes;
+    out.bounds = BoundingBox();
+    for (const auto& v : FaceVertexRange(FaceVertexPolicy{{&face}}, &face.edge, limit)) {
+        loop.push_back(v->coords);
+        out.bounds.expand(v->coords);
+    }
+
+    Vec3 area = polygonAreaVector(loop.data(), loop.size());
+    out.area = area.length();
+    out.normal = area.normalized();
+
+    // Fan from the first vertex; signed areas keep concave loops right
+    Point3D weighted(0, 0, 0), average(0, 0, 0);
+    double total = 0;
+    for (size_t i = 0; i < loop.size(); i++) average = average + loop[i];
+    for (size_t i = 1; i + 1 < loop.size(); i++) {
+        double w = (loop[i] - loop[0]).cross(loop[i + 1] - loop[0]).dot(out.normal);
+        weighted = weighted + (loop[0] + loop[i] + loop[i + 1]) * w;
+        total += w;
+    }
+    if (total > 0) {
+        out.centroid = weighted / (3 * total);
+    } else {
+        out.centroid = loop.empty() ? Point3D(0, 0, 0) : average / static_cast<double>(loop.size());
+    }
+    face.attributes_valid = true;
+}
+
+} // namespace
+
+void WingedEdgeKernel::invalidateAround(const std::shared_ptr<Vertex>& v) const {
+    for (const auto& e : vertexEdges(v)) {
+        if (e->f1) e->f1->attributes_valid = false;
+        if (e->f2) e->f2->attributes_valid = false;
+    }
+}
+
+const FaceAttributes& WingedEdgeKernel::getFaceAttributes(const std::shared_ptr<Face>& f) const {
+    if (!f) {
+        throw std::invalid_argument("getFaceAttributes: face cannot be null");
+    }
+    if (!f->attributes_valid) {
+        std::vector<Point3D> loop;
+        computeAttributes(*f, edges.size() + 1, loop);
+    }
+    return f->attributes;
+}
+
+size_t WingedEdgeKernel::updateFaceAttributes() {
+    if (attributes_stamp == change_stamp) return 0;
+
+    std::atomic<size_t> computed{0};
+    parallelFor(faces.size(), resolveThreadCount(thread_count), [&](size_t begin, size_t end) {
+        std::vector<Point3D> loop;
+        size_t local = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (faces[i]->attributes_valid) continue;
+            computeAttributes(*faces[i], edges.size() + 1, loop);
+            local++;
+        }
+        computed += local;
+    }, 1024);
+
+    attributes_stamp = change_stamp;
+    return computed.load();
+}
+
+// ==================== ADJACENCY CACHE ====================
+
+namespace {
+
+// Spare slots per face list, so a vertex gaining a face or two stays put
+constexpr uint32_t kAdjacencySlack = 2;
+
+} // namespace
+
+void WingedEdgeKernel::setAdjacencyCache(bool enabled) {
+    if (enabled == adjacency_enabled) return;
+
+    adjacency_enabled = enabled;
+    adjacency_spans = std::vector<AdjacencySpan>();
+    adjacency_pool = std::vector<const Face*>();
+    adjacency_stale = std::vector<int>();
+    adjacency_marks = std::vector<uint32_t>();
+    adjacency_garbage = 0;
+    adjacency_rebuild = enabled;
+    if (enabled) updateAdjacency();
+}
+
+void WingedEdgeKernel::invalidateAdjacency() {
+    if (!adjacency_enabled) return;
+    adjacency_rebuild = true;
+    adjacency_stale.clear();
+}
+
+void WingedEdgeKernel::adjustValenceForImages(const ChangeSet& changes, int delta) {
+    if (!adjacency_enabled || adjacency_rebuild) return;
+
+    // A batch can image the same edge several times; count each once
+    std::unordered_set<const Edge*> seen;
+    for (const auto& image : changes.edges) {
+        const auto& e = image.element;
+        if (!seen.insert(e.get()).second || !isAlive(e)) continue;
+        adjustValence(e->v1, delta);
+        adjustValence(e->v2, delta);
+        noteAdjacencyChange(e->v1);
+        noteAdjacencyChange(e->v2);
+    }
+    for (const auto& image : changes.vertices) noteAdjacencyChange(image.element);
+}
+
+void WingedEdgeKernel::refreshAdjacency(const std::shared_ptr<Vertex>& v, std::vector<const Face*>& scratch) {
+    // A fresh generation unmarks every face at once
+    if (++adjacency_generation == 0) {
+        std::fill(adjacency_marks.begin(), adjacency_marks.end(), 0);
+        adjacency_generation = 1;
+    }
+
+    // Same order as getIncidentFaces()
+    scratch.clear();
+    auto add = [&](const std::shared_ptr<Face>& f) {
+        if (!f) return;
+        uint32_t& mark = adjacency_marks[f->id];
+        if (mark == adjacency_generation) return;
+        mark = adjacency_generation;
+        scratch.push_back(f.get());
+    };
+    for (const auto& e : vertexEdges(v)) {
+        add(e->f1);
+        add(e->f2);
+    }
+
+    AdjacencySpan& span = adjacency_spans[v->id];
+    const auto count = static_cast<uint32_t>(scratch.size());
+    if (count > span.capacity) {
+        adjacency_garbage += span.capacity;
+        span.offset = static_cast<uint32_t>(adjacency_pool.size());
+        span.capacity = count + kAdjacencySlack;
+        adjacency_pool.resize(adjacency_pool.size() + span.capacity, nullptr);
+    }
+    std::copy(scratch.begin(), scratch.end(), adjacency_pool.begin() + span.offset);
+    span.count = count;
+    span.stale = false;
+}
+
+size_t WingedEdgeKernel::updateAdjacency() {
+    if (!adjacency_enabled) return 0;
+
+    adjacency_marks.resize(std::max(adjacency_marks.size(), static_cast<size_t>(next_f_id)), 0);
+    std::vector<const Face*> scratch;
+    size_t refreshed = 0;
+
+    if (adjacency_rebuild) {
+        adjacency_rebuild = false;
+        adjacency_spans.assign(next_v_id, AdjacencySpan());
+        adjacency_pool.clear();
+        adjacency_pool.reserve(2 * edges.size() + kAdjacencySlack * vertices.size());
+        adjacency_garbage = 0;
+        adjacency_stale.clear();
+
+        // Valences count edge endpoints, whatever the wing wiring says
+        for (const auto& e : edges) {
+            if (e->v1) adjacency_spans[e->v1->id].valence++;
+            if (e->v2) adjacency_spans[e->v2->id].valence++;
+        }
+        for (const auto& v : vertices) refreshAdjacency(v, scratch);
+        return vertices.size();
+    }
+
+    for (int id : adjacency_stale) {
+        auto v = lookupIndexed(vertices, vertex_slots, id);
+        if (!v) {
+            // Killed by undo or rollback: give the slots back
+            adjacency_garbage += adjacency_spans[id].capacity;
+            adjacency_spans[id] = AdjacencySpan();
             continue;
         }
+        refreshAdjacency(v, scratch);
+        refreshed++;
     }
+    adjacency_stale.clear();
+
+    // Repack once moved lists waste more than half the pool
+    if (adjacency_garbage > adjacency_pool.size() / 2) {
+        std::vector<const Face*> packed;
+        packed.reserve(adjacency_pool.size() - adjacency_garbage);
+        for (auto& span : adjacency_spans) {
+            if (span.capacity == 0) continue;
+            auto first = adjacency_pool.begin() + span.offset;
+            span.offset = static_cast<uint32_t>(packed.size());
+            packed.insert(packed.end(), first, first + span.count);
+            span.capacity = span.count + kAdjacencySlack;
+            packed.resize(packed.size() + kAdjacencySlack, nullptr);
+        }
+        adjacency_pool = std::move(packed);
+        adjacency_garbage = 0;
+    }
+    return refreshed;
+}
+
+size_t WingedEdgeKernel::getValence(const std::shared_ptr<Vertex>& v) const {
+    if (!v) {
+        throw std::invalid_argument("getValence: vertex cannot be null");
+    }
+    if (adjacency_enabled && !adjacency_rebuild && static_cast<size_t>(v->id) < adjacency_spans.size()) {
+        return adjacency_spans[v->id].valence;
+    }
+    return vertexEdges(v).size();
+}
+
+WingedEdgeKernel::AdjacentFaces WingedEdgeKernel::adjacentFaces(const std::shared_ptr<Vertex>& v) const {
+    if (!v) {
+        throw std::invalid_argument("adjacentFaces: vertex cannot be null");
+    }
+    if (!adjacency_enabled) {
+        throw std::logic_error("adjacentFaces: the adjacency cache is off");
+    }
+    if (adjacency_rebuild || static_cast<size_t>(v->id) >= adjacency_spans.size() ||
+        adjacency_spans[v->id].stale) {
+        throw std::logic_error("adjacentFaces: entry is stale; call updateAdjacency()");
+    }
+    const AdjacencySpan& span = adjacency_spans[v->id];
+    const Face* const* first = adjacency_pool.data() + span.offset;
+    return AdjacentFaces{first, first + span.count};
+}
+
+// ==================== INSTRUMENTATION ====================
+
+KernelStats WingedEdgeKernel::stats() const {
+#if SKETCHY_KERNEL_STATS
+    KernelStats result = stats_recorder.snapshot();
+    result.peak.vertices = std::max<uint64_t>(result.peak.vertices, vertices.size());
+    result.peak.edges = std::max<uint64_t>(result.peak.edges, edges.size());
+    result.peak.faces = std::max<uint64_t>(result.peak.faces, faces.size());
+    return result;
+#else
+    return KernelStats();
+#endif
+}
+
+void WingedEdgeKernel::resetStats() {
+#if SKETCHY_KERNEL_STATS
+    stats_recorder.reset();
+#endif
+}
 
-    // Check vertex manifold property - each vertex should have a consistent
-    // disk topology (fan of faces)
-    for (const auto& v : vertices) {
-        auto incident_edges = getIncidentEdges(v);
-        if (incident_edges.empty() && v->edge) {
-            return false; // Inconsistent
+// ==================== SNAPSHOTS ====================
+
+namespace {
+
+template <typename T>
+int idOf(const std::shared_ptr<T>& element) {
+    return element ? element->id : 0;
+}
+
+SnapshotVertex recordOf(const Vertex& v) {
+    return SnapshotVertex{v.id, v.coords, idOf(v.edge)};
+}
+
+SnapshotEdge recordOf(const Edge& e) {
+    return SnapshotEdge{e.id, idOf(e.v1), idOf(e.v2), idOf(e.f1), idOf(e.f2),
+                        idOf(e.p1_f1), idOf(e.n1_f1), idOf(e.p2_f2), idOf(e.n2_f2)};
+}
+
+SnapshotFace recordOf(const Face& f) {
+    return SnapshotFace{f.id, idOf(f.edge)};
+}
+
+// Re-record the changed IDs; killed ones are dropped from the column
+template <typename Record, typename T>
+void refreshColumn(PagedColumn<Record>& column, const std::vector<int>& changed,
+                   const std::vector<std::shared_ptr<T>>& list, const std::vector<int>& slots) {
+    std::vector<bool> owned;
+    for (int id : changed) {
+        auto element = lookupIndexed(list, slots, id);
+        column.store(id, element ? recordOf(*element) : Record{}, owned);
+    }
+}
+
+template <typename Record, typename T>
+void fillColumn(PagedColumn<Record>& column, const std::vector<std::shared_ptr<T>>& list) {
+    std::vector<bool> owned;
+    for (const auto& element : list) column.store(element->id, recordOf(*element), owned);
+}
+
+} // namespace
+
+std::shared_ptr<const KernelSnapshot> WingedEdgeKernel::snapshot() {
+    if (frozen) throw std::logic_error("snapshot: kernel is frozen");
+    auto previous = std::atomic_load(&published);
+    if (batch) return previous; // Readers never see half of a batch
+    bool unchanged = snapshot_vertices.empty() && snapshot_edges.empty() && snapshot_faces.empty();
+    if (previous && snapshot_tracking && !snapshot_stale && unchanged) return previous;
+
+    auto next = std::make_shared<KernelSnapshot>();
+    if (previous && snapshot_tracking && !snapshot_stale) {
+        // Start from the previous page tables; only touched pages get copied
+        *next = *previous;
+        refreshColumn(next->vertices, snapshot_vertices, vertices, vertex_slots);
+        refreshColumn(next->edges, snapshot_edges, edges, edge_slots);
+        refreshColumn(next->faces, snapshot_faces, faces, face_slots);
+    } else {
+        fillColumn(next->vertices, vertices);
+        fillColumn(next->edges, edges);
+        fillColumn(next->faces, faces);
+    }
+
+    next->vertex_count = vertices.size();
+    next->edge_count = edges.size();
+    next->face_count = faces.size();
+    next->solid_count = solid_count;
+    next->ring_count = ring_count;
+    next->version = previous ? previous->version + 1 : 1;
+
+    snapshot_tracking = true;
+    snapshot_stale = false;
+    snapshot_vertices.clear();
+    snapshot_edges.clear();
+    snapshot_faces.clear();
+
+    std::shared_ptr<const KernelSnapshot> result = std::move(next);
+    std::atomic_store(&published, result);
+    return result;
+}
+
+// ==================== NAVIGATION & QUERY ====================
+
+std::vector<std::shared_ptr<Edge>> WingedEdgeKernel::getIncidentEdges(std::shared_ptr<Vertex> v) const {
+    return collect(vertexEdges(v));
+}
+
+std::vector<std::shared_ptr<Face>> WingedEdgeKernel::getIncidentFaces(std::shared_ptr<Vertex> v) const {
+    std::vector<std::shared_ptr<Face>> result;
+
+    if (v && adjacency_enabled && !adjacency_rebuild && static_cast<size_t>(v->id) < adjacency_spans.size() &&
+        !adjacency_spans[v->id].stale) {
+        auto cached = adjacentFaces(v);
+        result.reserve(cached.size());
+        for (const Face* f : cached) result.push_back(faces[face_slots[f->id]]);
+        return result;
+    }
+
+    // Typical valences are small enough that a linear scan beats hashing;
+    // switch to a set once the fan gets large
+    constexpr size_t kLinearDedupLimit = 16;
+    std::unordered_set<const Face*> seen;
+
+    auto add = [&](const std::shared_ptr<Face>& f) {
+        if (!f) return;
+        if (seen.empty()) {
+            for (const auto& existing : result) {
+                if (existing == f) return;
+            }
+            result.push_back(f);
+            if (result.size() > kLinearDedupLimit) {
+                for (const auto& existing : result) seen.insert(existing.get());
+            }
+        } else if (seen.insert(f.get()).second) {
+            result.push_back(f);
         }
+    };
+
+    for (const auto& edge : vertexEdges(v)) {
+        add(edge->f1);
+        add(edge->f2);
     }
 
+    return result;
+}
+
+std::vector<std::shared_ptr<Edge>> WingedEdgeKernel::getFaceBoundary(std::shared_ptr<Face> f) const {
+    return collect(faceEdges(f));
+}
+
+std::vector<std::shared_ptr<Vertex>> WingedEdgeKernel::getFaceVertices(std::shared_ptr<Face> f) const {
+    return collect(faceVertices(f));
+}
+
+bool WingedEdgeKernel::checkVertex(const Vertex& v) const {
+    if (!v.edge) return true;
+    if (!isAlive(v.edge)) return false;
+
+    // Vertex should be an endpoint of its edge
+    return v.edge->v1.get() == &v || v.edge->v2.get() == &v;
+}
+
+bool WingedEdgeKernel::checkEdge(const Edge& e, ValidationLevel level) const {
+    if (!isAlive(e.v1) || !isAlive(e.v2)) return false;
+    if (level != ValidationLevel::Full) return true;
+
+    // No reference may point at a killed element
+    if ((e.f1 && !isAlive(e.f1)) || (e.f2 && !isAlive(e.f2))) return false;
+    for (const auto* wing : {&e.p1_f1, &e.n1_f1, &e.p2_f2, &e.n2_f2}) {
+        if (*wing && !isAlive(*wing)) return false;
+    }
     return true;
 }
 
+bool WingedEdgeKernel::checkFace(const Face& f, ValidationLevel level, size_t& budget) const {
+    if (!f.edge) return true;
+    if (!isAlive(f.edge)) return false;
+
+    // Face should be adjacent to its edge
+    if (f.edge->f1.get() != &f && f.edge->f2.get() != &f) return false;
+    if (level == ValidationLevel::References) return true;
+
+    // The face loop must return to its anchor edge within the step budget
+    const Edge* current = f.edge.get();
+    do {
+        if (budget-- == 0) return false;
+
+        if (current->f1.get() == &f) {
+            current = current->n1_f1.get();
+        } else if (current->f2.get() == &f) {
+            current = current->n2_f2.get();
+        } else {
+            return false;
+        }
+        if (!current) return false;
+    } while (current != f.edge.get());
+
+    return true;
+}
+
+bool WingedEdgeKernel::checkEulerPoincare() const {
+    // V - E + F - R = 2(S - H) with integer H >= 0
+    long long chi = static_cast<long long>(vertices.size()) - static_cast<long long>(edges.size()) +
+                    static_cast<long long>(faces.size()) - static_cast<long long>(ring_count);
+    long long twice_genus = 2 * static_cast<long long>(solid_count) - chi;
+    return twice_genus >= 0 && twice_genus % 2 == 0;
+}
+
+bool WingedEdgeKernel::validate(ValidationLevel level) const {
+    if (frozen) throw std::logic_error("validate: kernel is frozen");
+    if (!checkEulerPoincare()) return false;
+
+    // Every check is read-only, so the element lists are split across workers
+    const size_t threads = resolveThreadCount(thread_count);
+
+    auto vertices_ok = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (!checkVertex(*vertices[i])) return false;
+        }
+        return true;
+    };
+    auto edges_ok = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (!checkEdge(*edges[i], level)) return false;
+        }
+        return true;
+    };
+
+    // A well-formed model puts each edge on at most two loops, so the face
+    // walks of one chunk share a 2E budget
+    auto faces_ok = [&](size_t begin, size_t end) {
+        size_t budget = 2 * edges.size();
+        for (size_t i = begin; i < end; i++) {
+            if (!checkFace(*faces[i], level, budget)) return false;
+        }
+        return true;
+    };
+
+    return parallelAll(vertices.size(), threads, vertices_ok) &&
+           parallelAll(edges.size(), threads, edges_ok) &&
+           parallelAll(faces.size(), threads, faces_ok);
+}
+
+bool WingedEdgeKernel::validateDirty(ValidationLevel level) {
+    bool valid = checkEulerPoincare();
+
+    for (int id : dirty_vertices) {
+        auto v = lookupIndexed(vertices, vertex_slots, id);
+        if (valid && v) valid = checkVertex(*v);
+    }
+    for (int id : dirty_edges) {
+        auto e = lookupIndexed(edges, edge_slots, id);
+        if (valid && e) valid = checkEdge(*e, level);
+    }
+    for (int id : dirty_faces) {
+        auto f = lookupIndexed(faces, face_slots, id);
+        size_t budget = edges.size() + 1;
+        if (valid && f) valid = checkFace(*f, level, budget);
+    }
+
+    dirty_vertices.clear();
+    dirty_edges.clear();
+    dirty_faces.clear();
+    return valid;
+}
+
+bool WingedEdgeKernel::isManifold() const {
+    if (frozen) throw std::logic_error("isManifold: kernel is frozen");
+
+    // A current adjacency cache already holds every valence; otherwise one
+    // pass over the edges counts them
+    const bool cached = adjacencyCurrent();
+    std::vector<uint32_t> degrees;
+    if (!cached) {
+        degrees.assign(next_v_id, 0);
+        for (const auto& e : edges) {
+            if (e->v1) degrees[e->v1->id]++;
+            if (e->v2 && e->v2 != e->v1) degrees[e->v2->id]++;
+        }
+    }
+
+    // Each vertex's edges must form a single disk fan: the walk around the
+    // vertex returns to its anchor edge after visiting every incident edge once
+    auto fans_ok = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Vertex& v = *vertices[i];
+            if (!v.edge) continue;
+
+            const size_t degree = cached ? adjacency_spans[v.id].valence : degrees[v.id];
+            const Edge* current = v.edge.get();
+            size_t steps = 0;
+            do {
+                if (++steps > degree) return false;
+
+                if (current->v1.get() == &v) {
+                    current = current->n1_f1.get();
+                } else if (current->v2.get() == &v) {
+                    current = current->n2_f2.get();
+                } else {
+                    return false;
+                }
+                if (!current) return false;
+            } while (current != v.edge.get());
+
+            if (steps != degree) return false;
+        }
+        return true;
+    };
+
+    return parallelAll(vertices.size(), resolveThreadCount(thread_count), fans_ok);
+}
+
 // ==================== ACCESSORS ====================
 
-std::shared_ptr<Vertex> WingedEdgeKernel::getVertexById(int id) const {
-    for (const auto& v : vertices) {
-        if (v->id == id) return v;
+bool WingedEdgeKernel::isAlive(const std::shared_ptr<Vertex>& v) const {
+    return v && lookupIndexed(vertices, vertex_slots, v->id) == v;
+}
+
+bool WingedEdgeKernel::isAlive(const std::shared_ptr<Edge>& e) const {
+    return e && lookupIndexed(edges, edge_slots, e->id) == e;
+}
+
+bool WingedEdgeKernel::isAlive(const std::shared_ptr<Face>& f) const {
+    return f && lookupIndexed(faces, face_slots, f->id) == f;
+}
+
+VertexHandle WingedEdgeKernel::getHandle(const std::shared_ptr<Vertex>& v) const {
+    return isAlive(v) ? VertexHandle(v->id, id_generation) : VertexHandle();
+}
+
+EdgeHandle WingedEdgeKernel::getHandle(const std::shared_ptr<Edge>& e) const {
+    return isAlive(e) ? EdgeHandle(e->id, id_generation) : EdgeHandle();
+}
+
+FaceHandle WingedEdgeKernel::getHandle(const std::shared_ptr<Face>& f) const {
+    return isAlive(f) ? FaceHandle(f->id, id_generation) : FaceHandle();
+}
+
+std::shared_ptr<Vertex> WingedEdgeKernel::resolve(VertexHandle h) const {
+    return h.generation == id_generation ? lookupIndexed(vertices, vertex_slots, h.id) : nullptr;
+}
+
+std::shared_ptr<Edge> WingedEdgeKernel::resolve(EdgeHandle h) const {
+    return h.generation == id_generation ? lookupIndexed(edges, edge_slots, h.id) : nullptr;
+}
+
+std::shared_ptr<Face> WingedEdgeKernel::resolve(FaceHandle h) const {
+    return h.generation == id_generation ? lookupIndexed(faces, face_slots, h.id) : nullptr;
+}
+
+WingedEdgeKernel::CompactionMap WingedEdgeKernel::compact() {
+    if (batch) {
+        throw std::logic_error("compact: a batch is open");
+    }
+    if (frozen) {
+        throw std::logic_error("compact: the kernel is frozen");
+    }
+
+    bool renumbered = false;
+    CompactionMap map;
+    map.vertices = renumberIndexed(vertices, vertex_slots, renumbered);
+    map.edges = renumberIndexed(edges, edge_slots, renumbered);
+    map.faces = renumberIndexed(faces, face_slots, renumbered);
+    next_v_id = static_cast<int>(vertices.size() + 1);
+    next_e_id = static_cast<int>(edges.size() + 1);
+    next_f_id = static_cast<int>(faces.size() + 1);
+
+    map.vertices.old_generation = map.edges.old_generation = map.faces.old_generation = id_generation;
+    if (renumbered) {
+        ++id_generation;
+
+        auto remapIds = [](std::unordered_set<int>& ids, const auto& remap) {
+            std::unordered_set<int> moved;
+            for (int id : ids) {
+                if (remap[id] >= 0) moved.insert(remap[id]);
+            }
+            ids.swap(moved);
+        };
+        remapIds(dirty_vertices, map.vertices);
+        remapIds(dirty_edges, map.edges);
+        remapIds(dirty_faces, map.faces);
+
+        // The history and the per-ID tables all speak old IDs
+        undo_steps.clear();
+        redo_steps = {};
+        undo_bytes = 0;
+        std::vector<int>().swap(snapshot_vertices);
+        std::vector<int>().swap(snapshot_edges);
+        std::vector<int>().swap(snapshot_faces);
+        if (snapshot_tracking) snapshot_stale = true;
+        std::vector<AdjacencySpan>().swap(adjacency_spans);
+        std::vector<const Face*>().swap(adjacency_pool);
+        std::vector<int>().swap(adjacency_stale);
+        std::vector<uint32_t>().swap(adjacency_marks);
+        adjacency_garbage = 0;
+        invalidateAdjacency();
+
+        // Every element is new to stamp readers under its new ID
+        ++change_stamp;
+        std::vector<uint64_t>(next_v_id, change_stamp).swap(vertex_stamps);
+        std::vector<uint64_t>(next_f_id, change_stamp).swap(face_stamps);
     }
-    return nullptr;
+    map.vertices.new_generation = map.edges.new_generation = map.faces.new_generation = id_generation;
+    return map;
+}
+
+std::shared_ptr<Vertex> WingedEdgeKernel::getVertexById(int id) const {
+    return lookupIndexed(vertices, vertex_slots, id);
 }
 
 std::shared_ptr<Edge> WingedEdgeKernel::getEdgeById(int id) const {
-    for (const auto& e : edges) {
-        if (e->id == id) return e;
-    }
-    return nullptr;
+    return lookupIndexed(edges, edge_slots, id);
 }
 
 std::shared_ptr<Face> WingedEdgeKernel::getFaceById(int id) const {
-    for (const auto& f : faces) {
-        if (f->id == id) return f;
-    }
-    return nullptr;
+    return lookupIndexed(faces, face_slots, id);
 }
 
 } // namespace SketchyKernel
@@ -1,11 +1,21 @@
 #ifndef SKETCHY_KERNEL_WINGED_EDGE_H
 #define SKETCHY_KERNEL_WINGED_EDGE_H
 
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <unordered_set>
 #include "geometry.h"
+#include "circulator.h"
+#include "element_arena.h"
+#include "frozen_topology.h"
+#include "kernel_stats.h"
+#include "parallel.h"
+#include "snapshot.h"
 
 namespace SketchyKernel {
 
@@ -41,14 +51,154 @@ struct Edge {
                    p1_f1(nullptr), n1_f1(nullptr), p2_f2(nullptr), n2_f2(nullptr) {}
 };
 
+// Geometry derived from a face loop, cached on the face
+struct FaceAttributes {
+    Vec3 normal{0, 0, 0};      // Unit Newell normal; zero for degenerate loops
+    double area = 0;
+    Point3D centroid{0, 0, 0}; // Area-weighted; the vertex average when the area is zero
+    BoundingBox bounds;
+};
+
 // Represents a Face in the Winged-Edge structure
 struct Face {
     int id;
     std::shared_ptr<Edge> edge; // Pointer to one edge on its boundary
 
+    // See WingedEdgeKernel::getFaceAttributes
+    FaceAttributes attributes;
+    bool attributes_valid = false;
+
     Face(int id) : id(id), edge(nullptr) {}
 };
 
+// ==================== CIRCULATOR POLICIES ====================
+// Cursors point at the shared_ptr field that holds the current edge, so a
+// walk never copies a shared_ptr (no refcount traffic) and never allocates.
+
+// Walks a face loop: n1_f1 on the f1 side, n2_f2 on the f2 side
+struct FaceLoopPolicy {
+    using Cursor = const std::shared_ptr<Edge>*;
+
+    const Face* face;
+
+    bool valid(Cursor c) const { return c && *c; }
+    bool same(Cursor a, Cursor b) const { return a->get() == b->get(); }
+    Cursor next(Cursor c) const {
+        const Edge& e = **c;
+        if (e.f1.get() == face) return &e.n1_f1;
+        if (e.f2.get() == face) return &e.n2_f2;
+        return nullptr;
+    }
+    const std::shared_ptr<Edge>& deref(Cursor c) const { return *c; }
+};
+
+// Same walk as FaceLoopPolicy, yielding for each edge the vertex it shares
+// with the next edge of the walk
+struct FaceVertexPolicy : FaceLoopPolicy {
+    const std::shared_ptr<Vertex>& deref(Cursor c) const {
+        const Edge& e = **c;
+        return e.f1.get() == face ? e.v1 : e.v2;
+    }
+};
+
+// Walks the edges around a vertex: n1_f1 at v1, n2_f2 at v2
+struct VertexLoopPolicy {
+    using Cursor = const std::shared_ptr<Edge>*;
+
+    const Vertex* vertex;
+
+    bool valid(Cursor c) const { return c && *c; }
+    bool same(Cursor a, Cursor b) const { return a->get() == b->get(); }
+    Cursor next(Cursor c) const {
+        const Edge& e = **c;
+        if (e.v1.get() == vertex) return &e.n1_f1;
+        if (e.v2.get() == vertex) return &e.n2_f2;
+        return nullptr;
+    }
+    const std::shared_ptr<Edge>& deref(Cursor c) const { return *c; }
+};
+
+/**
+ * How much work validate() does
+ *   References: element references, endpoints and the Euler-Poincare formula,
+ *               for models whose face loops are still being wired up
+ *   Basic:      References, plus closure of every face loop (the default,
+ *               still O(E))
+ *   Full:       Basic, plus dangling-reference checks on every wing and face
+ *               reference
+ */
+enum class ValidationLevel {
+    References,
+    Basic,
+    Full
+};
+
+/**
+ * How extrudeFaces() treats selected faces that share an edge
+ *   Region:     the selection moves as one patch; shared edges stay inside
+ *               it and walls are built only along the outline
+ *   Individual: every face moves on its own and gets a wall on each edge
+ */
+enum class ExtrudeMode {
+    Region,
+    Individual
+};
+
+/**
+ * An element ID together with the ID generation it was taken in.
+ *
+ * IDs are never reused between compactions: killing an element tombstones
+ * its ID, which then resolves to nothing. compact() renumbers the live
+ * elements and starts a new generation, so a handle kept across it stops
+ * resolving instead of naming whichever element now has its ID.
+ */
+template <typename T>
+struct ElementHandle {
+    int id = -1;
+    uint32_t generation = 0;
+
+    constexpr ElementHandle() = default;
+    constexpr ElementHandle(int id, uint32_t generation) : id(id), generation(generation) {}
+
+    constexpr bool valid() const { return id >= 0; }
+    constexpr explicit operator bool() const { return valid(); }
+
+    constexpr bool operator==(const ElementHandle& other) const {
+        return id == other.id && generation == other.generation;
+    }
+    constexpr bool operator!=(const ElementHandle& other) const { return !(*this == other); }
+};
+
+using VertexHandle = ElementHandle<Vertex>;
+using EdgeHandle = ElementHandle<Edge>;
+using FaceHandle = ElementHandle<Face>;
+
+/**
+ * Old ID -> new ID table produced by WingedEdgeKernel::compact()
+ */
+template <typename T>
+struct IdRemap {
+    uint32_t old_generation = 0;
+    uint32_t new_generation = 0;
+    std::vector<int> target; // by old ID; -1 where no live element had it
+
+    int operator[](int old_id) const {
+        return old_id >= 0 && static_cast<size_t>(old_id) < target.size() ? target[old_id] : -1;
+    }
+
+    /**
+     * Translate a pre-compaction handle; stale handles map to an invalid one
+     */
+    ElementHandle<T> operator[](ElementHandle<T> old) const {
+        if (old.generation != old_generation || (*this)[old.id] < 0) return ElementHandle<T>();
+        return ElementHandle<T>((*this)[old.id], new_generation);
+    }
+};
+
+using FaceEdgeRange = LoopRange<FaceLoopPolicy>;
+using FaceVertexRange = LoopRange<FaceVertexPolicy>;
+using VertexEdgeRange = LoopRange<VertexLoopPolicy>;
+
 /**
  * The main class for topological operations using Euler Operators
  *
@@ -58,6 +208,9 @@ struct Face {
  */
 class WingedEdgeKernel {
 private:
+    // Loads files straight into the element lists
+    friend class KernelFile;
+
     std::vector<std::shared_ptr<Vertex>> vertices;
     std::vector<std::shared_ptr<Edge>> edges;
     std::vector<std::shared_ptr<Face>> faces;
@@ -65,9 +218,280 @@ private:
     int next_e_id = 1;
     int next_f_id = 1;
 
+    // Euler-Poincare bookkeeping: solids made by MVSF, rings made by KFMRH
+    size_t solid_count = 0;
+    size_t ring_count = 0;
+
+    // Dense ID -> slot tables (index into vertices/edges/faces, -1 once killed).
+    // IDs are handed out sequentially, so the tables stay dense. Kills move
+    // the last element into the freed slot, so element order is not stable.
+    // A killed ID stays a -1 tombstone until compact() renumbers the IDs and
+    // bumps id_generation.
+    std::vector<int> vertex_slots;
+    std::vector<int> edge_slots;
+    std::vector<int> face_slots;
+    uint32_t id_generation = 0;
+
+    // Detach a killed edge: splice its neighbors' wings past it and move
+    // vertex references that pointed at it onto a surviving edge
+    void unlinkEdge(const std::shared_ptr<Edge>& edge);
+
+    // IDs of the elements touched by Euler operators since the last
+    // validateDirty(); killed elements simply drop out on lookup
+    std::unordered_set<int> dirty_vertices;
+    std::unordered_set<int> dirty_edges;
+    std::unordered_set<int> dirty_faces;
+
+    // Per-element invariants shared by validate() and validateDirty()
+    bool checkVertex(const Vertex& v) const;
+    bool checkEdge(const Edge& e, ValidationLevel level) const;
+    bool checkFace(const Face& f, ValidationLevel level, size_t& budget) const;
+    bool checkEulerPoincare() const;
+
+    // Every Vertex, Edge and Face (and its control block) is carved from here
+    ElementArena arena;
+    bool default_arena = false; // Created by makeElement(), so freeze() may drop it
+
+    // Set while frozen: the element lists are then empty
+    std::unique_ptr<FrozenTopology> frozen;
+
+    // Workers used by validate() and isManifold(); 0 = hardware threads
+    size_t thread_count = 0;
+
+    // Last snapshot published to readers; read and written atomically
+    std::shared_ptr<const KernelSnapshot> published;
+
+    // IDs changed since the last snapshot(), recorded once the first one is
+    // taken. When a full rebuild is cheaper, snapshot_stale is set instead.
+    bool snapshot_tracking = false;
+    bool snapshot_stale = false;
+    std::vector<int> snapshot_vertices;
+    std::vector<int> snapshot_edges;
+    std::vector<int> snapshot_faces;
+
+    // State of one element at some point: its fields and whether it
+    // belonged to the kernel. Applying an image puts both back.
+    template <typename T>
+    struct ElementImage {
+        std::shared_ptr<T> element;
+        T state;
+        bool alive;
+    };
+
+    // Images of the elements one edit touched, plus the kernel counters
+    struct ChangeSet {
+        std::vector<ElementImage<Vertex>> vertices;
+        std::vector<ElementImage<Edge>> edges;
+        std::vector<ElementImage<Face>> faces;
+
+        int next_v_id = 1, next_e_id = 1, next_f_id = 1;
+        size_t solid_count = 0, ring_count = 0;
+
+        bool empty() const { return vertices.empty() && edges.empty() && faces.empty(); }
+    };
+
+    // Everything an open batch needs to commit or roll back
+    struct BatchState {
+        ChangeSet changes;
+
+        // markDirty() calls deferred to commit()
+        std::vector<int> dirty_vertices;
+        std::vector<int> dirty_edges;
+        std::vector<int> dirty_faces;
+    };
+    std::unique_ptr<BatchState> batch;
+
+    // One undoable edit: the touched elements before and after it
+    struct UndoStep {
+        ChangeSet before;
+        ChangeSet after;
+        size_t bytes = 0;
+    };
+
+    // Bounded history; the oldest steps go first once undo_limit is reached
+    size_t undo_limit = 0;
+    size_t undo_bytes = 0;
+    std::deque<UndoStep> undo_steps;
+    std::vector<UndoStep> redo_steps;
+    ChangeSet step_changes;
+
+    // Where journal() records to: the open batch, the current undo step, or
+    // nowhere when neither is active
+    ChangeSet* recording = nullptr;
+
+    // Record an element ahead of a change. Repeated records are harmless:
+    // rollback replays them newest first, undo steps keep the oldest.
+    void journal(const std::shared_ptr<Vertex>& v) {
+        if (recording && v) recording->vertices.push_back({v, *v, isAlive(v)});
+    }
+    void journal(const std::shared_ptr<Edge>& e) {
+        if (recording && e) recording->edges.push_back({e, *e, isAlive(e)});
+    }
+    void journal(const std::shared_ptr<Face>& f) {
+        if (recording && f) recording->faces.push_back({f, *f, isAlive(f)});
+    }
+
+    void captureCounters(ChangeSet& changes) const;
+    void applyChanges(const ChangeSet& changes, bool newest_first);
+    void pushUndoStep(ChangeSet&& before);
+
+    // Turns one public operator into one undo step, unless a batch (which
+    // becomes a single step on commit) is already recording
+    class StepScope {
+    public:
+        explicit StepScope(WingedEdgeKernel& kernel) : kernel(kernel) {
+            kernel.thaw();
+            if (kernel.recording || kernel.undo_limit == 0) return;
+
+            kernel.step_changes = ChangeSet();
+            kernel.captureCounters(kernel.step_changes);
+            kernel.recording = &kernel.step_changes;
+            owner = true;
+        }
+
+        ~StepScope() {
+            if (!owner) return;
+
+            kernel.recording = nullptr;
+            if (!kernel.step_changes.empty()) kernel.pushUndoStep(std::move(kernel.step_changes));
+        }
+
+        StepScope(const StepScope&) = delete;
+        StepScope& operator=(const StepScope&) = delete;
+
+    private:
+        WingedEdgeKernel& kernel;
+        bool owner = false;
+    };
+
+    // Change stamps by vertex / face ID, from a kernel-wide counter
+    uint64_t change_stamp = 0;
+    std::vector<uint64_t> vertex_stamps;
+    std::vector<uint64_t> face_stamps;
+
+    void stamp(std::vector<uint64_t>& stamps, int id) {
+        if (id < 0) return;
+        if (static_cast<size_t>(id) >= stamps.size()) stamps.resize(static_cast<size_t>(id) + 1, 0);
+        stamps[id] = ++change_stamp;
+    }
+
+    // change_stamp when updateFaceAttributes() last left no face stale
+    uint64_t attributes_stamp = std::numeric_limits<uint64_t>::max();
+
+    // Adjacency cache: valence and incident faces per vertex ID, the face
+    // lists packed into one pool with slack so refreshes rarely move them
+    struct AdjacencySpan {
+        uint32_t offset = 0;
+        uint32_t count = 0;
+        uint32_t capacity = 0;
+        uint32_t valence = 0;
+        bool stale = false;
+    };
+    bool adjacency_enabled = false;
+    bool adjacency_rebuild = false;   // every span is stale, valences included
+    std::vector<AdjacencySpan> adjacency_spans;
+    std::vector<const Face*> adjacency_pool;
+    std::vector<int> adjacency_stale; // vertex IDs whose face list is out of date
+    size_t adjacency_garbage = 0;     // pool slots no span owns any more
+    std::vector<uint32_t> adjacency_marks; // by face ID, dedupes face lists without hashing
+    uint32_t adjacency_generation = 0;
+
+    AdjacencySpan& adjacencySpan(int vertex_id) {
+        if (static_cast<size_t>(vertex_id) >= adjacency_spans.size()) adjacency_spans.resize(vertex_id + 1);
+        return adjacency_spans[vertex_id];
+    }
+    void noteAdjacencyChange(const std::shared_ptr<Vertex>& v) {
+        if (!adjacency_enabled || !v || adjacency_rebuild) return;
+        AdjacencySpan& span = adjacencySpan(v->id);
+        if (span.stale) return;
+        span.stale = true;
+        adjacency_stale.push_back(v->id);
+    }
+    void adjustValence(const std::shared_ptr<Vertex>& v, int delta) {
+        if (!adjacency_enabled || !v || adjacency_rebuild) return;
+        adjacencySpan(v->id).valence += delta;
+    }
+    void adjustValenceForImages(const ChangeSet& changes, int delta);
+    void refreshAdjacency(const std::shared_ptr<Vertex>& v, std::vector<const Face*>& scratch);
+
+    void invalidateAround(const std::shared_ptr<Vertex>& v) const;
+
+    void noteSnapshotChange(std::vector<int>& pending, int id) {
+        if (!snapshot_tracking || snapshot_stale) return;
+
+        pending.push_back(id);
+        if (pending.size() > vertices.size() + edges.size() + faces.size()) {
+            snapshot_stale = true;
+            snapshot_vertices.clear();
+            snapshot_edges.clear();
+            snapshot_faces.clear();
+        }
+    }
+
+    template <typename T, typename... Args>
+    std::shared_ptr<T> makeElement(Args&&... args) {
+        if (!arena) {
+            arena = makeDefaultArena();
+            default_arena = true;
+        }
+#if SKETCHY_KERNEL_STATS
+        uint64_t* counter = &stats_recorder.allocated(elementKind(static_cast<T*>(nullptr)));
+        return std::allocate_shared<T>(CountingArenaAllocator<T>(arena, counter), std::forward<Args>(args)...);
+#else
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+#endif
+    }
+
+#if SKETCHY_KERNEL_STATS
+    StatsRecorder stats_recorder;
+
+    static int elementKind(const Vertex*) { return 0; }
+    static int elementKind(const Edge*) { return 1; }
+    static int elementKind(const Face*) { return 2; }
+
+    // Times one operator call, failed ones included
+    class StatScope {
+    public:
+        StatScope(WingedEdgeKernel& kernel, KernelOp op) : kernel(kernel), op(op), start(StatsRecorder::now()) {}
+
+        ~StatScope() {
+            kernel.stats_recorder.record(op, start, StatsRecorder::now());
+            kernel.stats_recorder.notePeak(kernel.vertices.size(), kernel.edges.size(), kernel.faces.size());
+        }
+
+        StatScope(const StatScope&) = delete;
+        StatScope& operator=(const StatScope&) = delete;
+
+    private:
+        WingedEdgeKernel& kernel;
+        KernelOp op;
+        uint64_t start;
+    };
+#endif
+
+    // Clear every reference held by a live element. The wings form
+    // shared_ptr cycles, so this is what lets the arena drain.
+    void releaseElements();
+
 public:
     WingedEdgeKernel() = default;
 
+    /**
+     * Allocate topology elements from a caller-supplied memory resource
+     */
+    explicit WingedEdgeKernel(ElementArena arena) : arena(std::move(arena)) {}
+
+    /**
+     * Destroying the kernel releases all of its elements in bulk.
+     * Elements the caller still holds stay allocated but lose their references.
+     */
+    ~WingedEdgeKernel();
+
+    WingedEdgeKernel(const WingedEdgeKernel&) = delete;
+    WingedEdgeKernel& operator=(const WingedEdgeKernel&) = delete;
+    WingedEdgeKernel(WingedEdgeKernel&&) noexcept = default;
+    WingedEdgeKernel& operator=(WingedEdgeKernel&& other) noexcept;
+
     // ==================== EULER OPERATORS ====================
 
     /**
@@ -116,6 +540,8 @@ public:
      *
      * @param edge The edge to remove
      * @return Pointer to the remaining face
+     * @throws std::invalid_argument if the edge has the same face on both
+     *         sides (a strut or wire edge from MEV)
      */
     std::shared_ptr<Face> kef(std::shared_ptr<Edge> edge);
 
@@ -126,11 +552,197 @@ public:
      *
      * @param hole_face The face to remove (creates a hole)
      * @param outer_face The face that will contain the hole
+     * @throws std::invalid_argument if hole_face and outer_face are the same face
      */
     void kfmrh(std::shared_ptr<Face> hole_face, std::shared_ptr<Face> outer_face);
 
+    // ==================== BATCHES ====================
+
+    /**
+     * Open a transaction around a sequence of Euler operations.
+     *
+     * Until commit() the operators only append to a change log: each element
+     * is recorded before its first change, and dirty marking and snapshot
+     * bookkeeping are deferred and done once at commit. Storage for the
+     * expected number of new elements is reserved up front.
+     *
+     * Topology is still edited in place, so later operators in the batch see
+     * the earlier ones. snapshot() keeps returning the pre-batch snapshot.
+     *
+     * @throws std::logic_error if a batch is already open
+     */
+    void beginBatch(size_t new_vertices = 0, size_t new_edges = 0, size_t new_faces = 0);
+
+    /**
+     * Keep the batch's edits: mark what it touched dirty and drop the log
+     * @throws std::logic_error if no batch is open
+     */
+    void commit();
+
+    /**
+     * Undo every edit made since beginBatch() in O(edits): recorded elements
+     * get their old fields back, killed ones return, created ones are removed
+     * @throws std::logic_error if no batch is open
+     */
+    void rollback();
+
+    bool inBatch() const { return batch != nullptr; }
+
+    // ==================== UNDO / REDO ====================
+
+    /**
+     * Keep an undo history of at most `bytes` bytes of element images;
+     * 0 (the default) turns recording off and clears the history.
+     *
+     * Every operator (or committed batch) becomes one step holding the
+     * elements it touched, as they were before and after it. Undo and redo
+     * only rewrite those elements, so they cost O(edit), not O(model).
+     * Once the limit is reached the oldest steps are dropped.
+     */
+    void setUndoLimit(size_t bytes);
+    size_t getUndoLimit() const { return undo_limit; }
+
+    /**
+     * Revert the latest step; returns false when there is nothing to undo
+     * @throws std::logic_error while a batch is open
+     */
+    bool undo();
+
+    /**
+     * Re-apply the latest undone step; any new edit clears the redo list
+     * @throws std::logic_error while a batch is open
+     */
+    bool redo();
+
+    size_t getUndoCount() const { return undo_steps.size(); }
+    size_t getRedoCount() const { return redo_steps.size(); }
+    size_t getUndoMemory() const { return undo_bytes; }
+
+    // ==================== BULK CONSTRUCTION ====================
+
+    /**
+     * Build solids from an indexed polygon list in one pass, without going
+     * through the Euler operators one element at a time.
+     *
+     * Face i uses the face_sizes[i] entries of face_indices that follow those
+     * of face i - 1, listed counter-clockwise. Twin edges are matched with a
+     * single sort, and every boundary loop is closed with an extra face, so
+     * the result is a closed model whose face and vertex loops all close.
+     * The edge's f2 runs v1 -> v2, and its f1 runs v2 -> v1.
+     * Positions that no face references are skipped.
+     *
+     * The new elements are not marked dirty; call validate() if needed.
+     *
+     * @return The faces created for the input polygons, in input order
+     * @throws std::invalid_argument on malformed input or non-manifold edges
+     */
+    std::vector<std::shared_ptr<Face>> buildFromIndexedMesh(const std::vector<Point3D>& positions,
+                                                            const std::vector<uint32_t>& face_indices,
+                                                            const std::vector<uint32_t>& face_sizes);
+
+    // ==================== EXTRUSION ====================
+
+    /**
+     * Push-pull a set of faces along offset in one pass. The faces keep
+     * their IDs and move with their loops; each boundary edge of the
+     * selection gets a quad wall joining it to its raised copy. V, E and F
+     * grow by B, 2B and B for B walls, so the Euler-Poincare sum holds.
+     *
+     * Loops are planned and rewired in parallel with getThreadCount()
+     * threads; every edge side and vertex is written by exactly one task,
+     * so no locks are taken. Elements are allocated in one serial pass
+     * between the two. Duplicate faces in the selection are ignored.
+     *
+     * @return The wall faces, in selection and loop order
+     * @throws std::invalid_argument for killed faces, loops that do not
+     *         close, faces that border themselves, or (Region) selections
+     *         that touch themselves at a single vertex; the kernel is left
+     *         unchanged
+     */
+    std::vector<std::shared_ptr<Face>> extrudeFaces(const std::vector<std::shared_ptr<Face>>& selection,
+                                                    const Vec3& offset,
+                                                    ExtrudeMode mode = ExtrudeMode::Region);
+
+    // ==================== COMPONENTS ====================
+
+    /**
+     * Copy every connected component into a kernel of its own, ordered by
+     * each component's first vertex in getVertices(). Each part gets its own
+     * arena and renumbered IDs (from 1, in this kernel's element order), one
+     * solid, and the rings its Euler-Poincare sum implies. Edgeless faces,
+     * as left by mvsf, pair up in order with vertices that no edge uses.
+     *
+     * Parts are filled in parallel with getThreadCount() threads; this
+     * kernel is only read. Undo history and caches are not copied.
+     * @throws std::logic_error if the kernel is frozen
+     */
+    std::vector<WingedEdgeKernel> splitComponents() const;
+
+    // ==================== FROZEN MODE ====================
+
+    /**
+     * Swap the element graph for a compressed, read-only FrozenTopology,
+     * for models that stay loaded but idle. Every element is released, along
+     * with the undo history, dirty sets and caches; handles held elsewhere
+     * go stale. Counts, IDs and getFrozen() navigation keep working, while
+     * the element lists stay empty until the kernel thaws. KernelFile and
+     * the mesh exporters read the frozen form directly; passes that need
+     * the element graph (validate(), isManifold(), splitComponents(),
+     * snapshot(), Tessellator, FaceBvh, FaceIntersector, IndexedKernel)
+     * throw std::logic_error rather than see an empty model.
+     *
+     * Any operator or beginBatch() thaws the kernel first, so the first edit
+     * just works; fetch handles again after thaw(). Does nothing if already
+     * frozen.
+     *
+     * @throws std::logic_error while a batch is open
+     * @throws std::invalid_argument for options out of range
+     */
+    void freeze(const FreezeOptions& options = {});
+
+    /**
+     * Rebuild the editable elements from the frozen form, keeping their
+     * IDs; lists come back in ID order. Topology is exact; positions are off
+     * by at most half the quantization step per axis. Every element gets a
+     * new change stamp. Does nothing if not frozen.
+     */
+    void thaw();
+
+    bool isFrozen() const { return frozen != nullptr; }
+
+    /**
+     * The frozen form, or nullptr while editable
+     */
+    const FrozenTopology* getFrozen() const { return frozen.get(); }
+
+    // ==================== GEOMETRY ====================
+
+    /**
+     * Apply a transform to the coordinates of every vertex in the selection.
+     * Coordinates are gathered into fixed-size blocks and sent through
+     * Mat4::transformPoints, so the SIMD path is picked once per block.
+     */
+    void transformVertices(const std::vector<std::shared_ptr<Vertex>>& selection, const Mat4& transform);
+
     // ==================== NAVIGATION & QUERY ====================
 
+    /**
+     * Lazy circulators over the wing pointers; no allocation, no refcounting.
+     *   for (const auto& e : kernel.faceEdges(f)) { ... }
+     * The element must outlive the range.
+     */
+    FaceEdgeRange faceEdges(const std::shared_ptr<Face>& f) const {
+        return FaceEdgeRange(FaceLoopPolicy{f.get()}, f ? &f->edge : nullptr, edges.size() + 1);
+    }
+
+    FaceVertexRange faceVertices(const std::shared_ptr<Face>& f) const {
+        return FaceVertexRange(FaceVertexPolicy{{f.get()}}, f ? &f->edge : nullptr, edges.size() + 1);
+    }
+
+    VertexEdgeRange vertexEdges(const std::shared_ptr<Vertex>& v) const {
+        return VertexEdgeRange(VertexLoopPolicy{v.get()}, v ? &v->edge : nullptr, edges.size() + 1);
+    }
+
     /**
      * Get all edges incident to a vertex
      */
@@ -154,37 +766,286 @@ public:
     /**
      * Validate the topological consistency of the entire data structure
      * Checks all Euler-Poincare relationships and connectivity invariants
+     * in O(V + E + F): membership is answered by the ID -> slot tables.
+     *
+     * The Euler-Poincare check requires V - E + F - R = 2(S - H) to yield a
+     * non-negative integer genus H.
+     * @throws std::logic_error if the kernel is frozen
+     */
+    bool validate(ValidationLevel level = ValidationLevel::Basic) const;
+
+    /**
+     * Re-check only the elements touched since the last call and clear the
+     * dirty set. Runs the same per-element checks as validate(level), so the
+     * cost is proportional to the edits rather than the model.
      */
-    bool validate() const;
+    bool validateDirty(ValidationLevel level = ValidationLevel::Basic);
+
+    /**
+     * Flag an element for the next validateDirty(), e.g. after editing its
+     * references by hand. The Euler operators mark what they touch.
+     */
+    void markDirty(const std::shared_ptr<Vertex>& v) {
+        if (!v) return;
+        stamp(vertex_stamps, v->id);
+        invalidateAround(v);
+        noteAdjacencyChange(v);
+        if (batch) {
+            batch->dirty_vertices.push_back(v->id);
+            return;
+        }
+        dirty_vertices.insert(v->id);
+        noteSnapshotChange(snapshot_vertices, v->id);
+    }
+    void markDirty(const std::shared_ptr<Edge>& e) {
+        if (!e) return;
+        noteAdjacencyChange(e->v1);
+        noteAdjacencyChange(e->v2);
+        if (batch) {
+            batch->dirty_edges.push_back(e->id);
+            return;
+        }
+        dirty_edges.insert(e->id);
+        noteSnapshotChange(snapshot_edges, e->id);
+    }
+    void markDirty(const std::shared_ptr<Face>& f) {
+        if (!f) return;
+        stamp(face_stamps, f->id);
+        f->attributes_valid = false;
+        if (batch) {
+            batch->dirty_faces.push_back(f->id);
+            return;
+        }
+        dirty_faces.insert(f->id);
+        noteSnapshotChange(snapshot_faces, f->id);
+    }
+
+    size_t getDirtyCount() const { return dirty_vertices.size() + dirty_edges.size() + dirty_faces.size(); }
+
+    /**
+     * Change stamps: markDirty() and transformVertices() give the vertex or
+     * face a stamp larger than any handed out before. Caches such as
+     * Tessellator compare stamps to find what changed since they last
+     * looked; 0 means never stamped. Unlike the dirty set, stamps are never
+     * cleared.
+     */
+    uint64_t getVertexStamp(int id) const {
+        return id >= 0 && static_cast<size_t>(id) < vertex_stamps.size() ? vertex_stamps[id] : 0;
+    }
+    uint64_t getFaceStamp(int id) const {
+        return id >= 0 && static_cast<size_t>(id) < face_stamps.size() ? face_stamps[id] : 0;
+    }
+    uint64_t getChangeStamp() const { return change_stamp; } // Largest stamp handed out
+
+    /**
+     * Normal, area, centroid and bounds of a face, computed on first use and
+     * kept until an operator or a vertex move touches the face: markDirty()
+     * drops the face's own cache, and the caches of the faces around a
+     * vertex. Computing on demand writes to the face, so concurrent readers
+     * should call updateFaceAttributes() first.
+     */
+    const FaceAttributes& getFaceAttributes(const std::shared_ptr<Face>& f) const;
+
+    /**
+     * Recompute every stale face cache, in parallel. Returns at once when
+     * nothing was edited since the last call.
+     * @return Faces recomputed
+     */
+    size_t updateFaceAttributes();
 
     /**
      * Check if the model is a valid 2-manifold
-     * Every edge should be adjacent to exactly 2 faces (or 1 for boundary edges)
+     * Every vertex's edges must form a single disk fan: the walk around the
+     * vertex closes after visiting each incident edge exactly once. O(V + E);
+     * valences come from the adjacency cache when it is current.
+     * @throws std::logic_error if the kernel is frozen
      */
     bool isManifold() const;
 
+    /**
+     * Number of worker threads for validate() and isManifold().
+     * 0 (the default) uses every hardware thread; small models are always
+     * checked on the calling thread.
+     */
+    void setThreadCount(size_t count) { thread_count = count; }
+    size_t getThreadCount() const { return thread_count; }
+
+    // ==================== SNAPSHOTS ====================
+
+    /**
+     * Publish an immutable snapshot of the current model and return it.
+     *
+     * Only the pages holding elements changed since the previous snapshot
+     * are copied; the rest are shared with it, so the cost follows the edits
+     * rather than the model. Returns the previous snapshot when nothing
+     * changed. Call from the thread that edits the kernel; elements edited
+     * by hand must be flagged with markDirty() to show up.
+     * @throws std::logic_error if the kernel is frozen
+     */
+    std::shared_ptr<const KernelSnapshot> snapshot();
+
+    /**
+     * The most recently published snapshot, or nullptr before the first.
+     * Safe to call from any thread, concurrently with edits.
+     */
+    std::shared_ptr<const KernelSnapshot> latestSnapshot() const { return std::atomic_load(&published); }
+
+    // ==================== ADJACENCY CACHE ====================
+
+    /**
+     * Keep a per-vertex valence count and incident-face list alongside the
+     * model. The Euler operators keep valences exact and flag the vertices
+     * whose face list changed; updateAdjacency() refreshes only those.
+     * Enabling builds the cache over the whole model; disabling frees it.
+     * Off by default.
+     */
+    void setAdjacencyCache(bool enabled);
+    bool hasAdjacencyCache() const { return adjacency_enabled; }
+
+    /**
+     * Refresh the face lists of the vertices flagged since the last call.
+     * Elements edited by hand are covered once flagged with markDirty();
+     * after adding or removing edges by hand, call invalidateAdjacency().
+     * @return Number of vertices refreshed
+     */
+    size_t updateAdjacency();
+
+    /**
+     * Drop the whole cache; the next updateAdjacency() rebuilds it
+     */
+    void invalidateAdjacency();
+
+    /**
+     * True when the cache is on and updateAdjacency() has nothing to do
+     */
+    bool adjacencyCurrent() const { return adjacency_enabled && !adjacency_rebuild && adjacency_stale.empty(); }
+
+    /**
+     * Number of edges at the vertex: O(1) from the cache when it is on,
+     * otherwise a walk around the vertex
+     */
+    size_t getValence(const std::shared_ptr<Vertex>& v) const;
+
+    // View into the adjacency pool
+    struct AdjacentFaces {
+        const Face* const* first = nullptr;
+        const Face* const* last = nullptr;
+        const Face* const* begin() const { return first; }
+        const Face* const* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    /**
+     * The cached faces around a vertex, in getIncidentFaces() order, without
+     * allocating. Invalidated by the next edit.
+     * @throws std::logic_error if the cache is off or the vertex's entry is
+     *         stale (call updateAdjacency() first)
+     */
+    AdjacentFaces adjacentFaces(const std::shared_ptr<Vertex>& v) const;
+
+    // ==================== INSTRUMENTATION ====================
+
+    /**
+     * Operator counts and latencies, loop walk counts, allocated bytes, peak
+     * element counts and the recent operator trace, since construction or
+     * the last resetStats(). Only populated in builds with
+     * SKETCHY_KERNEL_STATS; otherwise enabled is false and the rest is zero.
+     * @see writeChromeTrace
+     */
+    KernelStats stats() const;
+    void resetStats();
+
     // ==================== ACCESSORS ====================
 
-    size_t getVertexCount() const { return vertices.size(); }
-    size_t getEdgeCount() const { return edges.size(); }
-    size_t getFaceCount() const { return faces.size(); }
+    // Frozen kernels report the counts of their frozen form
+    size_t getVertexCount() const { return frozen ? frozen->getVertexCount() : vertices.size(); }
+    size_t getEdgeCount() const { return frozen ? frozen->getEdgeCount() : edges.size(); }
+    size_t getFaceCount() const { return frozen ? frozen->getFaceCount() : faces.size(); }
+    size_t getSolidCount() const { return solid_count; }
+    size_t getRingCount() const { return ring_count; }
 
     const std::vector<std::shared_ptr<Vertex>>& getVertices() const { return vertices; }
     const std::vector<std::shared_ptr<Edge>>& getEdges() const { return edges; }
     const std::vector<std::shared_ptr<Face>>& getFaces() const { return faces; }
 
     /**
-     * Get vertex by ID (for debugging)
+     * True while the element belongs to this kernel; false once it was killed
+     */
+    bool isAlive(const std::shared_ptr<Vertex>& v) const;
+    bool isAlive(const std::shared_ptr<Edge>& e) const;
+    bool isAlive(const std::shared_ptr<Face>& f) const;
+
+    /**
+     * The element's ID in the current ID generation; an invalid handle if
+     * the element is not part of this kernel
+     */
+    VertexHandle getHandle(const std::shared_ptr<Vertex>& v) const;
+    EdgeHandle getHandle(const std::shared_ptr<Edge>& e) const;
+    FaceHandle getHandle(const std::shared_ptr<Face>& f) const;
+
+    /**
+     * Element a handle names in O(1); nullptr once it was killed, or when
+     * the handle is from an earlier ID generation
+     */
+    std::shared_ptr<Vertex> resolve(VertexHandle h) const;
+    std::shared_ptr<Edge> resolve(EdgeHandle h) const;
+    std::shared_ptr<Face> resolve(FaceHandle h) const;
+
+    /**
+     * Bumped by every compact() that renumbers an ID
+     */
+    uint32_t getIdGeneration() const { return id_generation; }
+
+    struct CompactionMap {
+        IdRemap<Vertex> vertices;
+        IdRemap<Edge> edges;
+        IdRemap<Face> faces;
+    };
+
+    /**
+     * Reclaim the tombstones killed elements leave in the ID space.
+     *
+     * Live elements are renumbered 1..n in their old ID order and the
+     * element lists are put in that order. Every table indexed by ID (slots,
+     * change stamps, the adjacency cache) shrinks to the live count, and the
+     * ID generation moves on if any ID changed. The undo history, which
+     * restores elements under their old IDs, is dropped, and every element
+     * reads as changed to stamp readers, so derived structures rebuild.
+     *
+     * @return Old ID -> new ID for each element kind
+     * @throws std::logic_error if a batch is open or the kernel is frozen
+     */
+    CompactionMap compact();
+
+    /**
+     * Size of each ID table: the highest ID handed out since the last
+     * compaction, plus one. Killed IDs stay in it as tombstones.
+     */
+    size_t getVertexIdCapacity() const { return vertex_slots.size(); }
+    size_t getEdgeIdCapacity() const { return edge_slots.size(); }
+    size_t getFaceIdCapacity() const { return face_slots.size(); }
+
+    /**
+     * Position of a vertex in getVertices() in O(1); -1 for unknown or
+     * killed IDs. Positions change when elements are killed.
+     */
+    int getVertexSlot(int id) const {
+        return id >= 0 && id < static_cast<int>(vertex_slots.size()) ? vertex_slots[id] : -1;
+    }
+
+    /**
+     * Get vertex by ID in O(1); returns nullptr for unknown or killed IDs
      */
     std::shared_ptr<Vertex> getVertexById(int id) const;
 
     /**
-     * Get edge by ID (for debugging)
+     * Get edge by ID in O(1); returns nullptr for unknown or killed IDs
      */
     std::shared_ptr<Edge> getEdgeById(int id) const;
 
     /**
-     * Get face by ID (for debugging)
+     * Get face by ID in O(1); returns nullptr for unknown or killed IDs
      */
     std::shared_ptr<Face> getFaceById(int id) const;
 };
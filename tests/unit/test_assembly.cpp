@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "kernel/assembly.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for multi-solid assemblies
+class AssemblyTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory = std::filesystem::temp_directory_path() / (std::string("sketchy_assembly_") + info->name());
+        std::filesystem::remove_all(directory);
+    }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+};
+
+TEST_F(AssemblyTest, FromComponentsGivesEachPartItsOwnKernel) {
+    WingedEdgeKernel model;
+    buildCubeRow(model, 3);
+    model.mvsf(Point3D(10, 0, 0));
+    ASSERT_TRUE(model.validate(ValidationLevel::Full));
+
+    Assembly assembly = Assembly::fromComponents(model);
+
+    ASSERT_EQ(assembly.getSolidCount(), 4);
+    EXPECT_EQ(assembly.getVertexCount(), model.getVertexCount());
+    EXPECT_EQ(assembly.getEdgeCount(), model.getEdgeCount());
+    EXPECT_EQ(assembly.getFaceCount(), model.getFaceCount());
+    EXPECT_TRUE(assembly.validate(ValidationLevel::Full));
+
+    for (int i = 0; i < 3; i++) {
+        const WingedEdgeKernel& part = assembly.getSolids()[i]->kernel;
+        EXPECT_EQ(part.getVertexCount(), 8);
+        EXPECT_EQ(part.getEdgeCount(), 12);
+        EXPECT_EQ(part.getFaceCount(), 6);
+        EXPECT_EQ(part.getSolidCount(), 1);
+        EXPECT_TRUE(part.isManifold());
+        // IDs start over in every part
+        EXPECT_TRUE(part.getVertexById(1));
+        EXPECT_DOUBLE_EQ(part.getVertexById(1)->coords.x, 2.0 * i);
+    }
+    const WingedEdgeKernel& lone = assembly.getSolids()[3]->kernel;
+    EXPECT_EQ(lone.getVertexCount(), 1);
+    EXPECT_EQ(lone.getFaceCount(), 1);
+    EXPECT_TRUE(lone.validate());
+}
+
+TEST_F(AssemblyTest, SolidsAreEditedIndependently) {
+    WingedEdgeKernel model;
+    buildCubeRow(model, 64);
+    Assembly assembly = Assembly::fromComponents(model);
+    assembly.setThreadCount(4);
+
+    // Every worker edits its own solid: raise each cube's top face
+    assembly.forEachSolid([](Solid& solid) {
+        auto top = solid.kernel.getFaces()[1];
+        solid.kernel.extrudeFaces({top}, Vec3(0, 0, 1));
+    });
+
+    EXPECT_TRUE(assembly.validate(ValidationLevel::Full));
+    EXPECT_EQ(assembly.getVertexCount(), 64 * 12);
+    for (const auto& solid : assembly.getSolids()) {
+        EXPECT_EQ(solid->kernel.getFaceCount(), 10);
+        EXPECT_EQ(solid->kernel.getThreadCount(), 1);
+    }
+
+    // Removing one solid leaves the others addressable by ID
+    const int removed = assembly.getSolids()[5]->id;
+    EXPECT_TRUE(assembly.removeSolid(removed));
+    EXPECT_FALSE(assembly.removeSolid(removed));
+    EXPECT_EQ(assembly.getSolid(removed), nullptr);
+    EXPECT_EQ(assembly.getSolidCount(), 63);
+    for (const auto& solid : assembly.getSolids()) EXPECT_EQ(assembly.getSolid(solid->id), solid.get());
+
+    Solid& added = assembly.addSolid("bracket");
+    added.kernel.mvsf(Point3D(0, 0, 0));
+    EXPECT_EQ(assembly.getSolid(added.id)->name, "bracket");
+    EXPECT_GT(added.id, removed);
+    EXPECT_THROW(assembly.addSolid("two\nlines"), std::invalid_argument);
+}
+
+TEST_F(AssemblyTest, ForEachSolidRethrowsFirstFailure) {
+    Assembly assembly;
+    for (int i = 0; i < 8; i++) assembly.addSolid().kernel.mvsf(Point3D(i, 0, 0));
+    assembly.setThreadCount(4);
+
+    EXPECT_THROW(assembly.forEachSolid([](Solid& solid) {
+        if (solid.id == 3) solid.kernel.kef(nullptr);
+    }), std::invalid_argument);
+
+    // A broken solid fails the whole assembly
+    EXPECT_TRUE(assembly.validate());
+    assembly.getSolid(6)->kernel.getVertices()[0]->edge = std::make_shared<Edge>(99);
+    EXPECT_FALSE(assembly.validate());
+}
+
+TEST_F(AssemblyTest, SaveAndLoadRoundTrip) {
+    WingedEdgeKernel model;
+    buildCubeRow(model, 5);
+    Assembly assembly = Assembly::fromComponents(model);
+    assembly.getSolids()[0]->name = "base plate";
+    assembly.removeSolid(assembly.getSolids()[2]->id);
+    assembly.setThreadCount(3);
+
+    assembly.save(directory.string());
+    Assembly loaded = Assembly::load(directory.string(), 3);
+
+    ASSERT_EQ(loaded.getSolidCount(), assembly.getSolidCount());
+    EXPECT_TRUE(loaded.validate(ValidationLevel::Full));
+    for (const auto& solid : assembly.getSolids()) {
+        const Solid* copy = loaded.getSolid(solid->id);
+        ASSERT_NE(copy, nullptr);
+        EXPECT_EQ(copy->name, solid->name);
+        EXPECT_EQ(copy->kernel.getEdgeCount(), solid->kernel.getEdgeCount());
+        EXPECT_EQ(copy->kernel.getSolidCount(), 1);
+    }
+    EXPECT_GT(loaded.addSolid().id, 5);
+
+    EXPECT_THROW(Assembly::load((directory / "missing").string()), std::runtime_error);
+    std::filesystem::remove(directory / "solid_1.skk");
+    EXPECT_THROW(Assembly::load(directory.string()), std::runtime_error);
+}
+
+TEST_F(AssemblyTest, LoadRejectsOutOfRangeManifestIds) {
+    Assembly assembly;
+    assembly.addSolid("one").kernel.mvsf(Point3D(0, 0, 0));
+    assembly.save(directory.string());
+
+    // Saving leaves only finished files behind
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        EXPECT_NE(entry.path().extension(), ".part") << entry.path();
+    }
+
+    for (const char* line : {"2147483647\tx", "16777217\tx", "99999999999\tx", "0\tx", "1x\tx"}) {
+        std::ofstream(directory / "assembly.txt") << "SKETCHY_ASSEMBLY 1\n" << line << '\n';
+        EXPECT_THROW(Assembly::load(directory.string()), std::runtime_error) << line;
+    }
+    std::ofstream(directory / "assembly.txt") << "SKETCHY_ASSEMBLY 1\n1\tone\n";
+    EXPECT_EQ(Assembly::load(directory.string()).getSolid(1)->name, "one");
+}
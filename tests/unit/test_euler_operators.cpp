@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include "kernel/parallel.h"
 #include "kernel/winged_edge.h"
+#include "test_models.h"
 
 using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
 
 // Test fixture for Euler Operator tests
 class EulerOperatorTest : public ::testing::Test {
@@ -170,10 +176,61 @@ TEST_F(EulerOperatorTest, KEF_RemovesEdgeAndMergesFaces) {
     EXPECT_EQ(kernel.getEdgeCount(), initial_edges - 1);
 }
 
+TEST_F(EulerOperatorTest, KEF_SplicesWingsAroundKilledEdge) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(0.5, 1, 0), face);
+    auto e3 = kernel.mef(e2->v2, v1, face);
+    auto inner_face = e3->f2;
+
+    // MEV wired e1 into e2; put e2 between the two faces and kill it
+    ASSERT_EQ(e1->n2_f2, e2);
+    e2->f2 = inner_face;
+
+    auto survivor = kernel.kef(e2);
+
+    EXPECT_EQ(survivor, face);
+    EXPECT_FALSE(kernel.isAlive(inner_face));
+
+    // The wing neighbor that pointed at e2 now skips over it
+    EXPECT_NE(e1->p1_f1, e2);
+    EXPECT_NE(e1->n1_f1, e2);
+    EXPECT_NE(e1->p2_f2, e2);
+    EXPECT_NE(e1->n2_f2, e2);
+    for (const auto& v : kernel.getVertices()) {
+        EXPECT_NE(v->edge, e2);
+    }
+    EXPECT_TRUE(kernel.validate());
+}
+
 TEST_F(EulerOperatorTest, KEF_ThrowsOnNullEdge) {
     EXPECT_THROW(kernel.kef(nullptr), std::invalid_argument);
 }
 
+TEST_F(EulerOperatorTest, KEF_ThrowsOnStrutEdge) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto strut = kernel.mev(v1, Point3D(1, 0, 0), face);
+
+    // The face on both sides is the only face; killing it would leave no face
+    EXPECT_THROW(kernel.kef(strut), std::invalid_argument);
+    EXPECT_TRUE(kernel.isAlive(strut));
+    EXPECT_TRUE(kernel.isAlive(face));
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    EXPECT_TRUE(kernel.validate());
+}
+
+TEST_F(EulerOperatorTest, KFMRH_ThrowsWhenHoleIsOuterFace) {
+    kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+
+    EXPECT_THROW(kernel.kfmrh(face, face), std::invalid_argument);
+    EXPECT_TRUE(kernel.isAlive(face));
+    EXPECT_EQ(kernel.getRingCount(), 0);
+}
+
 // ==================== KEF Boundary Edge Tests (P1-T1-SUB6) ====================
 
 TEST_F(EulerOperatorTest, KEF_BoundaryEdge_RemovesEdgeAndFace) {
@@ -306,6 +363,53 @@ TEST_F(EulerOperatorTest, GetFaceVertices) {
     EXPECT_GE(verts.size(), 0);
 }
 
+TEST_F(EulerOperatorTest, FaceEdges_CirculatorMatchesBoundary) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    kernel.mev(v1, Point3D(0, 1, 0), face);
+
+    for (const auto& f : kernel.getFaces()) {
+        auto boundary = kernel.getFaceBoundary(f);
+        auto range = kernel.faceEdges(f);
+        ASSERT_EQ(range.size(), boundary.size());
+
+        size_t i = 0;
+        for (const auto& e : range) {
+            EXPECT_EQ(e, boundary[i++]);
+        }
+    }
+}
+
+TEST_F(EulerOperatorTest, FaceEdges_StopsBeforeRepeatOnOpenLoop) {
+    // Hand-wire a loop e1 -> e2 -> e3 -> e2 that never returns to e1
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(2, 0, 0), face);
+    auto e3 = kernel.mev(e2->v2, Point3D(3, 0, 0), face);
+    e1->n1_f1 = e2;
+    e2->n1_f1 = e3;
+    e3->n1_f1 = e2;
+
+    auto range = kernel.faceEdges(face);
+    std::vector<std::shared_ptr<Edge>> walked(range.begin(), range.end());
+
+    ASSERT_EQ(walked.size(), 3);
+    EXPECT_EQ(walked[0], e1);
+    EXPECT_EQ(walked[1], e2);
+    EXPECT_EQ(walked[2], e3);
+}
+
+TEST_F(EulerOperatorTest, VertexEdges_EmptyForIsolatedVertex) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+
+    EXPECT_TRUE(kernel.vertexEdges(v).empty());
+    EXPECT_TRUE(kernel.faceVertices(kernel.getFaces()[0]).empty());
+    EXPECT_TRUE(kernel.faceEdges(nullptr).empty());
+}
+
 // ==================== Validation Tests ====================
 
 TEST_F(EulerOperatorTest, Validate_EmptyKernel) {
@@ -338,7 +442,177 @@ TEST_F(EulerOperatorTest, Validate_AfterComplexOperations) {
 
     kernel.mef(v3, v1, face);
 
+    // MEF leaves the split loops open, so only the references hold
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+    EXPECT_FALSE(kernel.validate());
+}
+
+TEST_F(EulerOperatorTest, Validate_EulerPoincareAfterKFMRH) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto outer = kernel.getFaces()[0];
+    kernel.mev(v1, Point3D(1, 0, 0), outer);
+
+    auto hole_vertex = kernel.mvsf(Point3D(0.5, 0.5, 0));
+    auto hole = kernel.getFaces()[1];
+    kernel.mev(hole_vertex, Point3D(0.6, 0.5, 0), hole);
+
+    kernel.kfmrh(hole, outer);
+
+    // Merging the second solid's face into a ring keeps V - E + F - R = 2(S - H)
+    EXPECT_EQ(kernel.getSolidCount(), 2);
+    EXPECT_EQ(kernel.getRingCount(), 1);
+    EXPECT_TRUE(kernel.validate());
+}
+
+// Hand-wire a triangle whose two face loops close properly
+static void wireClosedTriangle(WingedEdgeKernel& kernel, std::shared_ptr<Edge> edges[3]) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto inner = kernel.getFaces()[0];
+    edges[0] = kernel.mev(v1, Point3D(1, 0, 0), inner);
+    edges[1] = kernel.mev(edges[0]->v2, Point3D(0, 1, 0), inner);
+    edges[2] = kernel.mef(edges[1]->v2, v1, inner);
+    auto outer = kernel.getFaces()[1];
+
+    for (int i = 0; i < 3; i++) {
+        edges[i]->v1 = kernel.getVertices()[i];
+        edges[i]->v2 = kernel.getVertices()[(i + 1) % 3];
+        edges[i]->f1 = inner;
+        edges[i]->f2 = outer;
+        edges[i]->n1_f1 = edges[(i + 1) % 3];
+        edges[i]->p1_f1 = edges[(i + 2) % 3];
+        edges[i]->n2_f2 = edges[(i + 2) % 3];
+        edges[i]->p2_f2 = edges[(i + 1) % 3];
+        edges[i]->v1->edge = edges[i];
+    }
+    inner->edge = edges[0];
+    outer->edge = edges[0];
+}
+
+TEST_F(EulerOperatorTest, ValidateFull_AcceptsClosedLoops) {
+    std::shared_ptr<Edge> edges[3];
+    wireClosedTriangle(kernel, edges);
+
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+}
+
+TEST_F(EulerOperatorTest, Validate_RejectsOpenLoop) {
+    std::shared_ptr<Edge> edges[3];
+    wireClosedTriangle(kernel, edges);
+
+    edges[1]->n1_f1 = nullptr;
+
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+    EXPECT_FALSE(kernel.validate());
+    EXPECT_FALSE(kernel.validate(ValidationLevel::Full));
+}
+
+TEST_F(EulerOperatorTest, ValidateFull_RejectsDanglingWing) {
+    std::shared_ptr<Edge> edges[3];
+    wireClosedTriangle(kernel, edges);
+
+    edges[0]->p2_f2 = std::make_shared<Edge>(999);
+
+    EXPECT_TRUE(kernel.validate());
+    EXPECT_FALSE(kernel.validate(ValidationLevel::Full));
+}
+
+TEST_F(EulerOperatorTest, ValidateDirty_ChecksAndClearsTouchedElements) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    auto e3 = kernel.mef(e2->v2, v1, face);
+
+    EXPECT_GT(kernel.getDirtyCount(), 0);
+    EXPECT_TRUE(kernel.validateDirty(ValidationLevel::References));
+    EXPECT_EQ(kernel.getDirtyCount(), 0);
+
+    kernel.kef(e3);
+    EXPECT_TRUE(kernel.validateDirty());
+    EXPECT_EQ(kernel.getDirtyCount(), 0);
+}
+
+TEST_F(EulerOperatorTest, ValidateDirty_OnlyRechecksMarkedElements) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    EXPECT_TRUE(kernel.validateDirty());
+
+    // Corrupt a vertex anchor behind the kernel's back
+    e2->v2->edge = e1;
+    EXPECT_TRUE(kernel.validateDirty());
+    EXPECT_FALSE(kernel.validate());
+
+    kernel.markDirty(e2->v2);
+    EXPECT_FALSE(kernel.validateDirty());
+}
+
+// ==================== Allocation Tests ====================
+
+// Counts the bytes outstanding in an upstream resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t outstanding = 0;
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        outstanding += bytes;
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_F(EulerOperatorTest, Arena_SuppliedResourceBacksAllElements) {
+    auto resource = std::make_shared<CountingResource>();
+    {
+        WingedEdgeKernel arena_kernel(resource);
+        auto v1 = arena_kernel.mvsf(Point3D(0, 0, 0));
+        auto face = arena_kernel.getFaces()[0];
+        auto e1 = arena_kernel.mev(v1, Point3D(1, 0, 0), face);
+        arena_kernel.mef(e1->v2, v1, face);
+
+        EXPECT_EQ(resource->allocations, 6);
+        EXPECT_GT(resource->outstanding, 0);
+    }
+
+    // Destroying the kernel breaks the wing cycles, so nothing leaks
+    EXPECT_EQ(resource->outstanding, 0);
+}
+
+TEST_F(EulerOperatorTest, Arena_ElementsOutliveKernel) {
+    std::shared_ptr<Vertex> survivor;
+    {
+        WingedEdgeKernel scoped;
+        auto v1 = scoped.mvsf(Point3D(0, 0, 0));
+        scoped.mev(v1, Point3D(1, 0, 0), scoped.getFaces()[0]);
+        survivor = v1;
+    }
+
+    // The default pool stays alive until the last element is released
+    EXPECT_EQ(survivor->coords.x, 0.0);
+    EXPECT_EQ(survivor->edge, nullptr);
+}
+
+TEST_F(EulerOperatorTest, Arena_MoveAssignmentKeepsModel) {
+    WingedEdgeKernel source;
+    auto v1 = source.mvsf(Point3D(0, 0, 0));
+    source.mev(v1, Point3D(1, 0, 0), source.getFaces()[0]);
+
+    kernel = std::move(source);
+
+    EXPECT_EQ(kernel.getVertexCount(), 2);
+    EXPECT_EQ(kernel.getEdgeCount(), 1);
     EXPECT_TRUE(kernel.validate());
+    EXPECT_NE(kernel.getVertexById(v1->id), nullptr);
 }
 
 // ==================== Manifold Tests ====================
@@ -353,6 +627,16 @@ TEST_F(EulerOperatorTest, IsManifold_SimpleConfiguration) {
     EXPECT_TRUE(kernel.isManifold());
 }
 
+TEST_F(EulerOperatorTest, IsManifold_RejectsTwoFansAtOneVertex) {
+    buildBowtie(kernel);
+
+    EXPECT_EQ(kernel.getFaceCount(), 8);
+    EXPECT_FALSE(kernel.isManifold());
+    kernel.setAdjacencyCache(true);
+    kernel.updateAdjacency();
+    EXPECT_FALSE(kernel.isManifold());
+}
+
 // ==================== ID Lookup Tests ====================
 
 TEST_F(EulerOperatorTest, GetVertexById) {
@@ -392,6 +676,81 @@ TEST_F(EulerOperatorTest, GetFaceById) {
     EXPECT_EQ(not_found, nullptr);
 }
 
+TEST_F(EulerOperatorTest, GetById_AfterKill) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(0.5, 1, 0), face);
+    auto split_edge = kernel.mef(e2->v2, v1, face);
+    auto new_face = split_edge->f2;
+
+    // A later element, so killing split_edge shifts its slot
+    auto e4 = kernel.mev(e2->v2, Point3D(0, 2, 0), face);
+
+    kernel.kef(split_edge);
+
+    EXPECT_EQ(kernel.getEdgeById(split_edge->id), nullptr);
+    EXPECT_EQ(kernel.getFaceById(new_face->id), nullptr);
+    EXPECT_EQ(kernel.getEdgeById(e1->id), e1);
+    EXPECT_EQ(kernel.getEdgeById(e4->id), e4);
+    EXPECT_EQ(kernel.getFaceById(face->id), face);
+    EXPECT_EQ(kernel.getVertexById(e4->v2->id), e4->v2);
+
+    EXPECT_FALSE(kernel.isAlive(split_edge));
+    EXPECT_FALSE(kernel.isAlive(new_face));
+    EXPECT_TRUE(kernel.isAlive(e4));
+}
+
+TEST_F(EulerOperatorTest, Compact_RenumbersIdsAndStalesOldHandles) {
+    auto faces = buildCube(kernel);
+    auto top = faces[1];
+    auto corners = kernel.getFaceVertices(top);
+    auto kept = kernel.getEdges()[3];
+    const EdgeHandle kept_handle = kernel.getHandle(kept);
+
+    // Churn the top face: every split and merge leaves a tombstoned edge and face ID
+    EdgeHandle killed_handle;
+    for (int i = 0; i < 50; i++) {
+        auto diagonal = kernel.mef(corners[0], corners[2], top);
+        killed_handle = kernel.getHandle(diagonal);
+        kernel.kef(diagonal);
+    }
+    // A second box lands above the tombstones, so compaction has to move it down
+    auto moved = buildBox(kernel, Point3D(2, 0, 0), Point3D(3, 1, 1))[0];
+    EXPECT_FALSE(kernel.resolve(killed_handle));
+    EXPECT_EQ(kernel.resolve(kept_handle), kept);
+    EXPECT_EQ(kernel.getEdgeIdCapacity(), 12 + 50 + 12 + 1);
+
+    auto map = kernel.compact();
+
+    // Dense IDs in the old order, lists in ID order, tables trimmed
+    EXPECT_EQ(kernel.getEdgeIdCapacity(), kernel.getEdgeCount() + 1);
+    EXPECT_EQ(kernel.getFaceIdCapacity(), kernel.getFaceCount() + 1);
+    for (size_t i = 0; i < kernel.getEdgeCount(); i++) EXPECT_EQ(kernel.getEdges()[i]->id, static_cast<int>(i) + 1);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_EQ(kernel.getIdGeneration(), 1u);
+
+    // Old handles no longer resolve; the map translates the live ones
+    EXPECT_EQ(moved->id, 7);
+    EXPECT_FALSE(kernel.resolve(kept_handle));
+    EXPECT_EQ(kernel.resolve(map.edges[kept_handle]), kept);
+    EXPECT_EQ(map.edges[killed_handle.id], -1);
+    EXPECT_FALSE(map.edges[killed_handle]);
+    EXPECT_EQ(kernel.getFaceById(map.faces[top->id]), top);
+
+    // New elements continue after the live IDs; a dense kernel keeps its generation
+    auto e = kernel.mev(corners[0], Point3D(0, 0, 2), top);
+    EXPECT_EQ(e->id, static_cast<int>(kernel.getEdgeCount()));
+    kernel.compact();
+    EXPECT_EQ(kernel.getIdGeneration(), 1u);
+
+    kernel.beginBatch();
+    EXPECT_THROW(kernel.compact(), std::logic_error);
+    kernel.rollback();
+    kernel.freeze();
+    EXPECT_THROW(kernel.compact(), std::logic_error);
+}
+
 // ==================== Edge Case Tests ====================
 
 TEST_F(EulerOperatorTest, BuildTriangle) {
@@ -413,7 +772,7 @@ TEST_F(EulerOperatorTest, BuildTriangle) {
     EXPECT_EQ(kernel.getVertexCount(), 3);
     EXPECT_EQ(kernel.getEdgeCount(), 3);
     EXPECT_EQ(kernel.getFaceCount(), 2); // Original + interior face
-    EXPECT_TRUE(kernel.validate());
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References)); // MEF leaves the split loops open
 }
 
 TEST_F(EulerOperatorTest, BuildQuad) {
@@ -434,5 +793,635 @@ TEST_F(EulerOperatorTest, BuildQuad) {
 
     EXPECT_EQ(kernel.getVertexCount(), 4);
     EXPECT_EQ(kernel.getEdgeCount(), 4);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References)); // MEF leaves the split loops open
+}
+
+// ==================== Bulk Construction Tests ====================
+
+TEST_F(EulerOperatorTest, BuildFromIndexedMesh_ClosedCube) {
+    std::vector<Point3D> positions = {
+        {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+        {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+    std::vector<uint32_t> indices = {
+        0, 3, 2, 1,   4, 5, 6, 7,   0, 1, 5, 4,
+        1, 2, 6, 5,   2, 3, 7, 6,   3, 0, 4, 7};
+    std::vector<uint32_t> sizes(6, 4);
+
+    auto faces = kernel.buildFromIndexedMesh(positions, indices, sizes);
+
+    ASSERT_EQ(faces.size(), 6);
+    EXPECT_EQ(kernel.getVertexCount(), 8);
+    EXPECT_EQ(kernel.getEdgeCount(), 12);
+    EXPECT_EQ(kernel.getFaceCount(), 6);
+    EXPECT_EQ(kernel.getSolidCount(), 1);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_TRUE(kernel.isManifold());
+
+    for (const auto& f : faces) {
+        EXPECT_EQ(kernel.faceEdges(f).size(), 4);
+    }
+    for (const auto& v : kernel.getVertices()) {
+        EXPECT_EQ(kernel.vertexEdges(v).size(), 3);
+        EXPECT_EQ(kernel.getIncidentFaces(v).size(), 3);
+    }
+
+    // Face vertices follow the input winding
+    auto bottom = kernel.getFaceVertices(faces[0]);
+    ASSERT_EQ(bottom.size(), 4);
+    std::vector<int> ids;
+    for (const auto& v : bottom) ids.push_back(v->id);
+    auto first = std::find(ids.begin(), ids.end(), 1);
+    ASSERT_NE(first, ids.end());
+    std::rotate(ids.begin(), first, ids.end());
+    EXPECT_EQ(ids, (std::vector<int>{1, 4, 3, 2}));
+}
+
+TEST_F(EulerOperatorTest, BuildFromIndexedMesh_ClosesBoundaryLoops) {
+    // Two triangles forming an open quad
+    std::vector<Point3D> positions = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {5, 5, 5}};
+    std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3};
+    std::vector<uint32_t> sizes = {3, 3};
+
+    auto faces = kernel.buildFromIndexedMesh(positions, indices, sizes);
+
+    EXPECT_EQ(faces.size(), 2);
+    EXPECT_EQ(kernel.getVertexCount(), 4); // Unreferenced position skipped
+    EXPECT_EQ(kernel.getEdgeCount(), 5);
+    EXPECT_EQ(kernel.getFaceCount(), 3);    // Plus the face closing the hole
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+
+    for (const auto& e : kernel.getEdges()) {
+        EXPECT_NE(e->f1, nullptr);
+        EXPECT_NE(e->f2, nullptr);
+    }
+}
+
+TEST_F(EulerOperatorTest, BuildFromIndexedMesh_RejectsMalformedInput) {
+    std::vector<Point3D> positions = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+
+    EXPECT_THROW(kernel.buildFromIndexedMesh(positions, {0, 1, 7}, {3}), std::invalid_argument);
+    EXPECT_THROW(kernel.buildFromIndexedMesh(positions, {0, 1}, {2}), std::invalid_argument);
+    EXPECT_THROW(kernel.buildFromIndexedMesh(positions, {0, 1, 2}, {4}), std::invalid_argument);
+
+    // Three triangles on one edge
+    EXPECT_THROW(kernel.buildFromIndexedMesh(positions, {0, 1, 2, 1, 0, 3, 0, 1, 3}, {3, 3, 3}),
+                 std::invalid_argument);
+
+    // Nothing was created by the failed calls
+    EXPECT_EQ(kernel.getVertexCount(), 0);
+    EXPECT_EQ(kernel.getEdgeCount(), 0);
+}
+
+TEST_F(EulerOperatorTest, Validate_ParallelMatchesSerial) {
+    // 160 x 160 quad grid is large enough to be split across workers
+    buildGrid(kernel, 160);
+
+    for (size_t threads : {size_t(1), size_t(4), size_t(0)}) {
+        kernel.setThreadCount(threads);
+        EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+        EXPECT_TRUE(kernel.isManifold());
+    }
+
+    // Break a loop near the end of the edge list, far from the first chunk
+    auto& e = kernel.getEdges()[kernel.getEdgeCount() - 10];
+    auto saved = e->n1_f1;
+    e->n1_f1 = nullptr;
+
+    for (size_t threads : {size_t(1), size_t(4)}) {
+        kernel.setThreadCount(threads);
+        EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+        EXPECT_FALSE(kernel.validate());
+        EXPECT_FALSE(kernel.validate(ValidationLevel::Full));
+    }
+    e->n1_f1 = saved;
+
+    // A vertex anchored on an edge it does not bound
+    auto& v = kernel.getVertices()[kernel.getVertexCount() - 1];
+    v->edge = kernel.getEdges()[0];
+    kernel.setThreadCount(4);
+    EXPECT_FALSE(kernel.validate());
+}
+
+TEST_F(EulerOperatorTest, ParallelAll_RethrowsWorkerExceptions) {
+    // A throw in a chunk off the calling thread reaches the caller instead
+    // of std::terminate
+    auto throwing = [](size_t begin, size_t) {
+        if (begin > 0) throw std::runtime_error("chunk failed");
+        return true;
+    };
+    EXPECT_THROW(parallelAll(64 * 1024, 4, throwing, 1024), std::runtime_error);
+
+    // Still throws when the range runs on the calling thread
+    EXPECT_THROW(parallelAll(10, 4, [](size_t, size_t) -> bool { throw std::runtime_error("serial"); }),
+                 std::runtime_error);
+    EXPECT_TRUE(parallelAll(64 * 1024, 4, [](size_t, size_t) { return true; }, 1024));
+}
+
+// ==================== Batch Tests ====================
+
+TEST_F(EulerOperatorTest, Batch_CommitKeepsEditsAndDefersDirtyMarking) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    kernel.validateDirty();
+
+    kernel.beginBatch(3, 4, 1);
+    EXPECT_TRUE(kernel.inBatch());
+    EXPECT_THROW(kernel.beginBatch(), std::logic_error);
+
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    auto e3 = kernel.mev(e2->v2, Point3D(0, 1, 0), face);
+    kernel.mef(e3->v2, v1, face);
+    EXPECT_EQ(kernel.getDirtyCount(), 0);
+
+    kernel.commit();
+    EXPECT_FALSE(kernel.inBatch());
+    EXPECT_EQ(kernel.getEdgeCount(), 4);
+    EXPECT_EQ(kernel.getFaceCount(), 2);
+    EXPECT_GT(kernel.getDirtyCount(), 0);
+    EXPECT_TRUE(kernel.validateDirty(ValidationLevel::References));
+
+    EXPECT_THROW(kernel.commit(), std::logic_error);
+    EXPECT_THROW(kernel.rollback(), std::logic_error);
+}
+
+TEST_F(EulerOperatorTest, Batch_RollbackRestoresModel) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    auto closing = kernel.mef(e2->v2, v1, face);
+    auto second_face = closing->f2;
+
+    auto edges_before = kernel.getEdges();
+    std::vector<Edge> wings_before;
+    for (const auto& e : edges_before) wings_before.push_back(*e);
+
+    kernel.beginBatch();
+    auto e3 = kernel.mev(e2->v2, Point3D(0, 1, 0), face);
+    kernel.kef(closing);
+    kernel.transformVertices({v1}, Mat4::translation(0, 0, 1));
+    kernel.mvsf(Point3D(9, 9, 9));
+    kernel.rollback();
+
+    EXPECT_FALSE(kernel.inBatch());
+    EXPECT_FALSE(kernel.isAlive(e3));
+    EXPECT_EQ(e3->v1, nullptr);
+    EXPECT_TRUE(kernel.isAlive(closing));
+    EXPECT_TRUE(kernel.isAlive(second_face));
+    EXPECT_EQ(second_face->edge, closing);
+    EXPECT_EQ(v1->coords.z, 0.0);
+
+    EXPECT_EQ(kernel.getVertexCount(), 3);
+    EXPECT_EQ(kernel.getEdgeCount(), 3);
+    EXPECT_EQ(kernel.getFaceCount(), 2);
+    EXPECT_EQ(kernel.getSolidCount(), 1);
+    for (size_t i = 0; i < edges_before.size(); i++) {
+        const auto& e = edges_before[i];
+        EXPECT_EQ(e->f1, wings_before[i].f1);
+        EXPECT_EQ(e->f2, wings_before[i].f2);
+        EXPECT_EQ(e->n1_f1, wings_before[i].n1_f1);
+        EXPECT_EQ(e->p1_f1, wings_before[i].p1_f1);
+        EXPECT_EQ(e->n2_f2, wings_before[i].n2_f2);
+        EXPECT_EQ(e->p2_f2, wings_before[i].p2_f2);
+    }
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+
+    // IDs from the rolled-back batch are handed out again
+    auto e4 = kernel.mev(e2->v2, Point3D(0, 1, 0), face);
+    EXPECT_EQ(e4->id, e3->id);
+    EXPECT_EQ(kernel.getEdgeById(e4->id), e4);
+}
+
+// ==================== Undo Tests ====================
+
+TEST_F(EulerOperatorTest, Undo_RevertsOperatorsOneStepAtATime) {
+    kernel.setUndoLimit(1 << 20);
+
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    auto closing = kernel.mef(e2->v2, v1, face);
+    kernel.kef(closing);
+    EXPECT_EQ(kernel.getUndoCount(), 5);
+
+    // Undo the KEF: the edge and the face it merged come back
+    ASSERT_TRUE(kernel.undo());
+    EXPECT_TRUE(kernel.isAlive(closing));
+    EXPECT_TRUE(kernel.isAlive(closing->f2));
+    EXPECT_EQ(kernel.getFaceCount(), 2);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+
+    // Undo the MEF and the second MEV
+    ASSERT_TRUE(kernel.undo());
+    ASSERT_TRUE(kernel.undo());
+    EXPECT_FALSE(kernel.isAlive(e2));
+    EXPECT_EQ(kernel.getEdgeCount(), 1);
+    EXPECT_EQ(kernel.getVertexCount(), 2);
+    EXPECT_EQ(e1->n2_f2, e1);
+    EXPECT_EQ(kernel.getRedoCount(), 3);
+    EXPECT_TRUE(kernel.validate());
+
+    // Redo replays them in order
+    ASSERT_TRUE(kernel.redo());
+    ASSERT_TRUE(kernel.redo());
+    EXPECT_TRUE(kernel.isAlive(e2));
+    EXPECT_TRUE(kernel.isAlive(closing));
+    EXPECT_EQ(kernel.getFaceCount(), 2);
+    EXPECT_EQ(e1->n2_f2, e2);
+
+    // A new edit drops what is left to redo
+    kernel.mev(v1, Point3D(-1, 0, 0), face);
+    EXPECT_EQ(kernel.getRedoCount(), 0);
+    EXPECT_FALSE(kernel.redo());
+
+    while (kernel.undo()) {}
+    EXPECT_EQ(kernel.getVertexCount(), 0);
+    EXPECT_EQ(kernel.getFaceCount(), 0);
+    EXPECT_EQ(kernel.getSolidCount(), 0);
+}
+
+TEST_F(EulerOperatorTest, Undo_CommittedBatchIsOneStep) {
+    kernel.setUndoLimit(1 << 20);
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+
+    kernel.beginBatch();
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    kernel.transformVertices({v1}, Mat4::translation(0, 0, 2));
+    EXPECT_THROW(kernel.undo(), std::logic_error);
+    kernel.commit();
+
+    EXPECT_EQ(kernel.getUndoCount(), 2);
+    ASSERT_TRUE(kernel.undo());
+    EXPECT_EQ(kernel.getEdgeCount(), 0);
+    EXPECT_EQ(v1->coords.z, 0.0);
+    EXPECT_EQ(v1->edge, nullptr);
+
+    ASSERT_TRUE(kernel.redo());
+    EXPECT_EQ(kernel.getEdgeCount(), 2);
+    EXPECT_EQ(v1->coords.z, 2.0);
+    EXPECT_TRUE(kernel.isAlive(e2));
+
+    // Rolled-back batches leave no step behind
+    kernel.beginBatch();
+    kernel.mev(v1, Point3D(5, 5, 5), face);
+    kernel.rollback();
+    EXPECT_EQ(kernel.getUndoCount(), 2);
+}
+
+TEST_F(EulerOperatorTest, Undo_MemoryLimitDropsOldestSteps) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    EXPECT_EQ(kernel.getUndoCount(), 0); // Recording is off by default
+
+    kernel.setUndoLimit(4096);
+    for (int i = 0; i < 200; i++) {
+        v = kernel.mev(v, Point3D(i, 0, 0), face)->v2;
+    }
+
+    EXPECT_GT(kernel.getUndoCount(), 0);
+    EXPECT_LT(kernel.getUndoCount(), 200);
+    EXPECT_LE(kernel.getUndoMemory(), 4096);
+
+    // Undoing everything that was kept stops at the oldest retained step
+    size_t kept = kernel.getUndoCount();
+    while (kernel.undo()) {}
+    EXPECT_EQ(kernel.getVertexCount(), 201 - kept);
     EXPECT_TRUE(kernel.validate());
+
+    kernel.setUndoLimit(0);
+    EXPECT_EQ(kernel.getUndoMemory(), 0);
+    EXPECT_EQ(kernel.getRedoCount(), 0);
+}
+
+// ==================== Geometry Tests ====================
+
+TEST_F(EulerOperatorTest, TransformVertices_MovesOnlySelection) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+
+    kernel.transformVertices({v1, e2->v2}, Mat4::translation(0, 0, 5));
+
+    EXPECT_EQ(v1->coords.z, 5.0);
+    EXPECT_EQ(e2->v2->coords.z, 5.0);
+    EXPECT_EQ(e1->v2->coords.z, 0.0);
+    EXPECT_EQ(e2->v2->coords.y, 1.0);
+}
+
+TEST_F(EulerOperatorTest, FaceAttributes_CachedUntilTouched) {
+    auto faces = buildBox(kernel, Point3D(0, 0, 0), Point3D(2, 2, 1));
+
+    EXPECT_EQ(kernel.updateFaceAttributes(), 6);
+    EXPECT_EQ(kernel.updateFaceAttributes(), 0);
+
+    const FaceAttributes& top = kernel.getFaceAttributes(faces[1]);
+    EXPECT_NEAR(top.normal.z, 1.0, 1e-12);
+    EXPECT_NEAR(top.area, 4.0, 1e-12);
+    EXPECT_NEAR(top.centroid.x, 1.0, 1e-12);
+    EXPECT_NEAR(top.centroid.z, 1.0, 1e-12);
+    EXPECT_EQ(top.bounds.max.y, 2.0);
+    EXPECT_NEAR(kernel.getFaceAttributes(faces[0]).normal.z, -1.0, 1e-12);
+
+    // Vertex 6 touches the top and two walls only
+    kernel.transformVertices({kernel.getVertices()[6]}, Mat4::translation(0, 0, 1));
+    EXPECT_FALSE(faces[1]->attributes_valid);
+    EXPECT_TRUE(faces[0]->attributes_valid);
+    EXPECT_EQ(kernel.updateFaceAttributes(), 3);
+    EXPECT_GT(kernel.getFaceAttributes(faces[1]).area, 4.0);
+    EXPECT_EQ(kernel.getFaceAttributes(faces[1]).bounds.max.z, 2.0);
+
+    // Splitting a face invalidates both halves, which share its area, and
+    // the four walls around the diagonal's endpoints
+    auto loop = kernel.getFaceVertices(faces[0]);
+    kernel.mef(loop[0], loop[2], faces[0]);
+    EXPECT_EQ(kernel.updateFaceAttributes(), 6);
+    double halves = 0;
+    for (const auto& f : kernel.getFaces()) {
+        const FaceAttributes& a = kernel.getFaceAttributes(f);
+        if (a.normal.z < -0.5) halves += a.area;
+    }
+    EXPECT_NEAR(halves, 4.0, 1e-12);
+}
+
+TEST_F(EulerOperatorTest, FaceAttributes_RollbackDropsCachesFromBatch) {
+    kernel.buildFromIndexedMesh({{0, 0, 0}, {1, 0, 0}, {1, 1, 0}}, {0, 1, 2}, {3});
+    auto face = kernel.getFaces()[0];
+    auto corner = kernel.getVertices()[2];
+    kernel.updateFaceAttributes();
+    const double area = kernel.getFaceAttributes(face).area;
+    EXPECT_NEAR(area, 0.5, 1e-12);
+
+    kernel.beginBatch();
+    kernel.transformVertices({corner}, Mat4::translation(0, 1, 0));
+    EXPECT_NEAR(kernel.getFaceAttributes(face).area, 1.0, 1e-12);
+    kernel.updateFaceAttributes();
+    kernel.rollback();
+
+    EXPECT_GT(kernel.updateFaceAttributes(), 0);
+    EXPECT_NEAR(kernel.getFaceAttributes(face).area, area, 1e-12);
+}
+
+TEST_F(EulerOperatorTest, Adjacency_CachedFanMatchesWalk) {
+    // 64 triangles around a hub, as on the pole of a revolved solid
+    const uint32_t n = 64;
+    std::vector<Point3D> positions{{0, 0, 1}};
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < n; i++) {
+        double angle = 2 * 3.14159265358979 * i / n;
+        positions.emplace_back(std::cos(angle), std::sin(angle), 0);
+        indices.insert(indices.end(), {0, 1 + i, 1 + (i + 1) % n});
+    }
+    kernel.buildFromIndexedMesh(positions, indices, std::vector<uint32_t>(n, 3));
+    auto hub = kernel.getVertices()[0];
+    auto rim = kernel.getVertices()[5];
+    auto walked_hub = kernel.getIncidentFaces(hub);
+    auto walked_rim = kernel.getIncidentFaces(rim);
+    EXPECT_THROW(kernel.adjacentFaces(hub), std::logic_error);
+
+    kernel.setAdjacencyCache(true);
+    EXPECT_TRUE(kernel.adjacencyCurrent());
+    EXPECT_EQ(kernel.getValence(hub), n);
+    EXPECT_EQ(kernel.getValence(rim), 3);
+
+    auto cached = kernel.adjacentFaces(hub);
+    ASSERT_EQ(cached.size(), walked_hub.size());
+    EXPECT_EQ(cached.size(), n);
+    for (size_t i = 0; i < walked_hub.size(); i++) EXPECT_EQ(cached.begin()[i], walked_hub[i].get());
+    EXPECT_EQ(kernel.getIncidentFaces(rim), walked_rim); // Rim faces plus the cap
+    EXPECT_TRUE(kernel.isManifold());
+
+    // Moving vertices leaves adjacency alone
+    kernel.transformVertices({hub}, Mat4::translation(0, 0, 1));
+    EXPECT_TRUE(kernel.adjacencyCurrent());
+    EXPECT_EQ(kernel.updateAdjacency(), 0);
+
+    kernel.setAdjacencyCache(false);
+    EXPECT_EQ(kernel.getValence(hub), n);
+    EXPECT_THROW(kernel.adjacentFaces(hub), std::logic_error);
+}
+
+TEST_F(EulerOperatorTest, Adjacency_OperatorsKeepValenceAndFaces) {
+    kernel.setUndoLimit(1 << 20);
+    kernel.setAdjacencyCache(true);
+
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(0.5, 1, 0), face);
+    EXPECT_EQ(kernel.getValence(v1), 1);
+    EXPECT_EQ(kernel.getValence(e1->v2), 2);
+    EXPECT_FALSE(kernel.adjacencyCurrent());
+    EXPECT_THROW(kernel.adjacentFaces(v1), std::logic_error);
+    EXPECT_EQ(kernel.updateAdjacency(), 3);
+
+    auto e3 = kernel.mef(e2->v2, v1, face);
+    EXPECT_EQ(kernel.getValence(v1), 2);
+    EXPECT_EQ(kernel.getValence(e2->v2), 2);
+    EXPECT_GT(kernel.updateAdjacency(), 0);
+    for (const auto& v : kernel.getVertices()) {
+        auto cached = kernel.getIncidentFaces(v);
+        kernel.invalidateAdjacency(); // Falls back to the walk until updated
+        EXPECT_EQ(cached, kernel.getIncidentFaces(v)) << "vertex " << v->id;
+        kernel.updateAdjacency();
+    }
+
+    kernel.kef(e3);
+    EXPECT_EQ(kernel.getValence(v1), 1);
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    kernel.updateAdjacency();
+    for (const Face* f : kernel.adjacentFaces(v1)) EXPECT_TRUE(kernel.getFaceById(f->id));
+
+    // Undo brings the edge back; rollback drops the batch's edges again
+    ASSERT_TRUE(kernel.undo());
+    EXPECT_EQ(kernel.getValence(v1), 2);
+    kernel.beginBatch();
+    kernel.mev(v1, Point3D(-1, 0, 0), face);
+    EXPECT_EQ(kernel.getValence(v1), 3);
+    kernel.rollback();
+    EXPECT_EQ(kernel.getValence(v1), 2);
+    kernel.updateAdjacency();
+    EXPECT_TRUE(kernel.adjacencyCurrent());
+    for (const auto& v : kernel.getVertices()) {
+        size_t degree = 0;
+        for (const auto& e : kernel.getEdges()) degree += (e->v1 == v) + (e->v2 == v);
+        EXPECT_EQ(kernel.getValence(v), degree) << "vertex " << v->id;
+    }
+}
+
+// ==================== Extrusion Tests ====================
+
+namespace {
+
+bool eulerPoincareHolds(const WingedEdgeKernel& kernel) {
+    auto sum = static_cast<long>(kernel.getVertexCount()) - static_cast<long>(kernel.getEdgeCount()) +
+               static_cast<long>(kernel.getFaceCount());
+    return sum == 2 * static_cast<long>(kernel.getSolidCount());
+}
+
+} // namespace
+
+TEST_F(EulerOperatorTest, Extrude_RegionRaisesCubeTop) {
+    auto faces = buildCube(kernel);
+    auto top = faces[1];
+
+    auto walls = kernel.extrudeFaces({top, top}, Vec3(0, 0, 2));
+
+    ASSERT_EQ(walls.size(), 4);
+    EXPECT_EQ(kernel.getVertexCount(), 12);
+    EXPECT_EQ(kernel.getEdgeCount(), 20);
+    EXPECT_EQ(kernel.getFaceCount(), 10);
+    EXPECT_TRUE(eulerPoincareHolds(kernel));
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_TRUE(kernel.isManifold());
+
+    ASSERT_EQ(kernel.faceEdges(top).size(), 4);
+    for (const auto& v : kernel.getFaceVertices(top)) EXPECT_DOUBLE_EQ(v->coords.z, 3.0);
+    for (const auto& w : walls) {
+        EXPECT_EQ(kernel.faceEdges(w).size(), 4);
+        double low = 10, high = -10;
+        for (const auto& v : kernel.getFaceVertices(w)) {
+            low = std::min(low, v->coords.z);
+            high = std::max(high, v->coords.z);
+        }
+        EXPECT_DOUBLE_EQ(low, 1.0);
+        EXPECT_DOUBLE_EQ(high, 3.0);
+    }
+    // The sides below keep their vertices
+    for (size_t i = 2; i < faces.size(); i++) {
+        for (const auto& v : kernel.getFaceVertices(faces[i])) EXPECT_LE(v->coords.z, 1.0);
+    }
+}
+
+TEST_F(EulerOperatorTest, Extrude_RegionKeepsSharedEdgesInside) {
+    kernel.setAdjacencyCache(true);
+    auto quads = buildGrid(kernel, 2);
+    kernel.updateAdjacency();
+    auto center = kernel.getVertices()[4];
+    ASSERT_DOUBLE_EQ(center->coords.x, 1.0);
+    ASSERT_DOUBLE_EQ(center->coords.y, 1.0);
+
+    auto walls = kernel.extrudeFaces(quads, Vec3(0, 0, 1));
+
+    EXPECT_EQ(walls.size(), 8); // One per outline edge
+    EXPECT_EQ(kernel.getVertexCount(), 17);
+    EXPECT_EQ(kernel.getEdgeCount(), 28);
+    EXPECT_EQ(kernel.getFaceCount(), 13);
+    EXPECT_TRUE(eulerPoincareHolds(kernel));
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_TRUE(kernel.isManifold());
+
+    // The inner vertex rides along instead of getting a copy
+    EXPECT_DOUBLE_EQ(center->coords.z, 1.0);
+    EXPECT_EQ(kernel.vertexEdges(center).size(), 4);
+    for (const auto& q : quads) {
+        for (const auto& v : kernel.getFaceVertices(q)) EXPECT_DOUBLE_EQ(v->coords.z, 1.0);
+    }
+
+    size_t shared = 0;
+    for (const auto& e : kernel.getEdges()) {
+        bool inside = std::count(quads.begin(), quads.end(), e->f1) && std::count(quads.begin(), quads.end(), e->f2);
+        shared += inside;
+    }
+    EXPECT_EQ(shared, 4);
+
+    for (const auto& v : kernel.getVertices()) {
+        EXPECT_EQ(kernel.getValence(v), kernel.vertexEdges(v).size()) << "vertex " << v->id;
+    }
+    kernel.updateAdjacency();
+    EXPECT_TRUE(kernel.isManifold());
+}
+
+TEST_F(EulerOperatorTest, Extrude_IndividualWallsEveryEdge) {
+    auto quads = buildGrid(kernel, 2);
+    auto center = kernel.getVertices()[4];
+
+    auto walls = kernel.extrudeFaces(quads, Vec3(0, 0, 1), ExtrudeMode::Individual);
+
+    EXPECT_EQ(walls.size(), 16);
+    EXPECT_EQ(kernel.getVertexCount(), 25);
+    EXPECT_EQ(kernel.getEdgeCount(), 44);
+    EXPECT_EQ(kernel.getFaceCount(), 21);
+    EXPECT_TRUE(eulerPoincareHolds(kernel));
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_DOUBLE_EQ(center->coords.z, 0.0);
+    for (const auto& q : quads) {
+        ASSERT_EQ(kernel.faceEdges(q).size(), 4);
+        for (const auto& v : kernel.getFaceVertices(q)) EXPECT_DOUBLE_EQ(v->coords.z, 1.0);
+    }
+}
+
+TEST_F(EulerOperatorTest, Extrude_ParallelMatchesSerial) {
+    // Enough faces to be split across workers
+    const uint32_t n = 60;
+    WingedEdgeKernel serial;
+    auto serial_quads = buildGrid(serial, n);
+    auto parallel_quads = buildGrid(kernel, n);
+    serial.setThreadCount(1);
+    kernel.setThreadCount(4);
+
+    for (ExtrudeMode mode : {ExtrudeMode::Region, ExtrudeMode::Individual}) {
+        auto a = serial.extrudeFaces(serial_quads, Vec3(0, 0, 1), mode);
+        auto b = kernel.extrudeFaces(parallel_quads, Vec3(0, 0, 1), mode);
+        ASSERT_EQ(a.size(), b.size());
+        EXPECT_EQ(a.size(), mode == ExtrudeMode::Region ? 4 * n : 4 * n * n);
+        ASSERT_EQ(serial.getEdgeCount(), kernel.getEdgeCount());
+        EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+        EXPECT_TRUE(eulerPoincareHolds(kernel));
+
+        for (size_t i = 0; i < a.size(); i++) {
+            auto va = serial.getFaceVertices(a[i]);
+            auto vb = kernel.getFaceVertices(b[i]);
+            ASSERT_EQ(va.size(), vb.size());
+            for (size_t k = 0; k < va.size(); k++) ASSERT_EQ(va[k]->id, vb[k]->id);
+        }
+    }
+}
+
+TEST_F(EulerOperatorTest, Extrude_UndoRestoresModel) {
+    kernel.setUndoLimit(1 << 20);
+    auto faces = buildCube(kernel);
+    auto top = faces[1];
+    auto corner = kernel.getFaceVertices(top)[0];
+
+    kernel.extrudeFaces({top}, Vec3(0, 0, 1));
+    EXPECT_EQ(kernel.getFaceCount(), 10);
+
+    ASSERT_TRUE(kernel.undo());
+    EXPECT_EQ(kernel.getVertexCount(), 8);
+    EXPECT_EQ(kernel.getEdgeCount(), 12);
+    EXPECT_EQ(kernel.getFaceCount(), 6);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_EQ(kernel.getFaceVertices(top)[0], corner);
+
+    ASSERT_TRUE(kernel.redo());
+    EXPECT_EQ(kernel.getFaceCount(), 10);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    for (const auto& v : kernel.getFaceVertices(top)) EXPECT_DOUBLE_EQ(v->coords.z, 2.0);
+}
+
+TEST_F(EulerOperatorTest, Extrude_RejectsInvalidSelection) {
+    auto quads = buildGrid(kernel, 2);
+    const size_t edges = kernel.getEdgeCount();
+
+    EXPECT_THROW(kernel.extrudeFaces({nullptr}, Vec3(0, 0, 1)), std::invalid_argument);
+    EXPECT_THROW(kernel.extrudeFaces({std::make_shared<Face>(999)}, Vec3(0, 0, 1)), std::invalid_argument);
+
+    // Diagonal quads meet only at the center vertex
+    EXPECT_THROW(kernel.extrudeFaces({quads[0], quads[3]}, Vec3(0, 0, 1)), std::invalid_argument);
+    EXPECT_EQ(kernel.getEdgeCount(), edges);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_EQ(kernel.extrudeFaces({quads[0], quads[3]}, Vec3(0, 0, 1), ExtrudeMode::Individual).size(), 8);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+
+    // A wire edge has the same face on both sides
+    WingedEdgeKernel wire;
+    auto v = wire.mvsf(Point3D(0, 0, 0));
+    wire.mev(v, Point3D(1, 0, 0), wire.getFaces()[0]);
+    EXPECT_THROW(wire.extrudeFaces(wire.getFaces(), Vec3(0, 0, 1)), std::invalid_argument);
+    EXPECT_EQ(wire.getEdgeCount(), 1);
 }
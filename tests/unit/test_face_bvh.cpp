@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "kernel/face_bvh.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for face BVH construction, refit and queries
+class FaceBvhTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+    FaceBvh bvh;
+
+    // n x n cells of two triangles each over a bumpy height field. The
+    // boundary stays at z = 0, so the face closing it is flat and below.
+    void buildTerrain(uint32_t n) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> height(0.1, 0.5);
+        std::vector<Point3D> positions;
+        for (uint32_t y = 0; y <= n; y++) {
+            for (uint32_t x = 0; x <= n; x++) {
+                bool boundary = x == 0 || y == 0 || x == n || y == n;
+                positions.emplace_back(x, y, boundary ? 0.0 : height(rng));
+            }
+        }
+        std::vector<uint32_t> loops;
+        for (uint32_t y = 0; y < n; y++) {
+            for (uint32_t x = 0; x < n; x++) {
+                uint32_t a = y * (n + 1) + x;
+                loops.insert(loops.end(), {a, a + 1, a + n + 2, a, a + n + 2, a + n + 1});
+            }
+        }
+        kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(2 * n * n, 3));
+    }
+
+    // Moller-Trumbore against every triangle, independent of the hierarchy
+    bool bruteRaycast(const Ray& ray, FaceHit& hit) {
+        for (const auto& f : kernel.getFaces()) {
+            if (kernel.faceVertices(f).size() != 3) continue;
+            auto loop = kernel.getFaceVertices(f);
+            Vec3 a = loop[0]->coords, b = loop[1]->coords, c = loop[2]->coords;
+            Vec3 e1 = b - a, e2 = c - a, p = ray.direction.cross(e2);
+            double det = e1.dot(p);
+            if (std::abs(det) < 1e-12) continue;
+            Vec3 s = ray.origin - a, q = s.cross(e1);
+            double u = s.dot(p) / det, v = ray.direction.dot(q) / det, t = e2.dot(q) / det;
+            if (u < 0 || v < 0 || u + v > 1 || t < 0 || t >= hit.distance) continue;
+            hit.face_id = f->id;
+            hit.distance = t;
+        }
+        return hit.face_id >= 0;
+    }
+};
+
+TEST_F(FaceBvhTest, RaycastHitsNearestCubeFace) {
+    buildCube(kernel);
+    bvh.build(kernel);
+    EXPECT_EQ(bvh.getFaceCount(), 6);
+
+    FaceHit hit;
+    ASSERT_TRUE(bvh.raycast(Ray{{0.25, 0.5, 5}, {0, 0, -1}}, hit));
+    EXPECT_NEAR(hit.distance, 4.0, 1e-12);
+    EXPECT_NEAR(hit.point.z, 1.0, 1e-12);
+    EXPECT_EQ(hit.face_id, kernel.getFaces()[1]->id); // The z = 1 loop
+
+    FaceHit miss;
+    EXPECT_FALSE(bvh.raycast(Ray{{2, 2, 5}, {0, 0, -1}}, miss));
+    EXPECT_FALSE(bvh.raycast(Ray{{0.5, 0.5, 5}, {0, 0, -1}}, miss, 3.0));
+
+    FaceHit inside;
+    ASSERT_TRUE(bvh.raycast(Ray{{0.5, 0.5, 0.5}, {1, 0, 0}}, inside));
+    EXPECT_NEAR(inside.distance, 0.5, 1e-12);
+}
+
+TEST_F(FaceBvhTest, QueriesMatchBruteForceOnTerrain) {
+    buildTerrain(70); // Large enough for the parallel top-level split
+    bvh.setThreadCount(4);
+    bvh.build(kernel);
+    ASSERT_EQ(bvh.getFaceCount(), kernel.getFaceCount());
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> coord(-2.0, 72.0);
+    std::uniform_real_distribution<double> tilt(-0.3, 0.3);
+    for (int i = 0; i < 200; i++) {
+        Ray ray{{coord(rng), coord(rng), 3.0}, {tilt(rng), tilt(rng), -1.0}};
+        FaceHit expected, actual;
+        bool found = bruteRaycast(ray, expected);
+        ASSERT_EQ(bvh.raycast(ray, actual), found) << "ray " << i;
+        if (found) {
+            EXPECT_NEAR(actual.distance, expected.distance, 1e-9) << "ray " << i;
+        }
+    }
+
+    BoundingBox region;
+    region.expand(Point3D(10.2, 20.7, -1));
+    region.expand(Point3D(14.9, 23.1, 1));
+    std::vector<int> found;
+    bvh.queryBox(region, found);
+
+    size_t expected_count = 0;
+    for (const auto& f : kernel.getFaces()) {
+        BoundingBox box;
+        for (const auto& v : kernel.faceVertices(f)) box.expand(v->coords);
+        bool hit = box.min.x <= region.max.x && region.min.x <= box.max.x &&
+                   box.min.y <= region.max.y && region.min.y <= box.max.y;
+        expected_count += hit;
+    }
+    EXPECT_EQ(found.size(), expected_count);
+
+    // Straight above a mesh point, the nearest distance is at most the height
+    for (int i = 0; i < 50; i++) {
+        double x = 1 + 68 * (i / 50.0), y = 30.5;
+        FaceHit below;
+        ASSERT_TRUE(bvh.raycast(Ray{{x, y, 3.0}, {0, 0, -1}}, below));
+        FaceHit closest;
+        ASSERT_TRUE(bvh.nearest(Point3D(x, y, 3.0), closest));
+        EXPECT_LE(closest.distance, below.distance + 1e-12);
+        EXPECT_GT(closest.distance, 2.0);
+        EXPECT_NEAR((closest.point - Point3D(x, y, 3.0)).length(), closest.distance, 1e-9);
+    }
+}
+
+TEST_F(FaceBvhTest, RefitFollowsMovedVertexWithoutRebuild) {
+    buildTerrain(20);
+    bvh.build(kernel);
+
+    // Vertex (10, 10) is shared by six triangles
+    auto vertex = kernel.getVertices()[10 * 21 + 10];
+    kernel.transformVertices({vertex}, Mat4::translation(0, 0, 5));
+
+    auto stats = bvh.refit(kernel);
+    EXPECT_FALSE(stats.rebuilt);
+    EXPECT_EQ(stats.refit, 6);
+    EXPECT_EQ(stats.inserted, 0);
+    EXPECT_EQ(stats.removed, 0);
+    EXPECT_GE(bvh.getBounds().max.z, 5.0);
+
+    FaceHit hit;
+    ASSERT_TRUE(bvh.raycast(Ray{{10.1, 10.05, 10}, {0, 0, -1}}, hit));
+    EXPECT_GT(hit.point.z, 4.0);
+
+    EXPECT_EQ(bvh.refit(kernel).refit, 0);
+}
+
+TEST_F(FaceBvhTest, RefitInsertsAndRemovesFacesFromEulerOperators) {
+    buildCube(kernel);
+    bvh.build(kernel);
+
+    auto face = kernel.getFaces()[0];
+    auto loop = kernel.getFaceVertices(face);
+    auto diagonal = kernel.mef(loop[0], loop[2], face);
+    ASSERT_EQ(kernel.getFaceCount(), 7);
+
+    auto stats = bvh.refit(kernel);
+    EXPECT_FALSE(stats.rebuilt);
+    EXPECT_EQ(stats.inserted, 1);
+    EXPECT_EQ(stats.removed, 0);
+    EXPECT_EQ(bvh.getFaceCount(), 7);
+
+    // Both halves of the split bottom face are found
+    std::vector<int> bottom;
+    BoundingBox slab;
+    slab.expand(Point3D(-1, -1, -0.1));
+    slab.expand(Point3D(2, 2, 0.1));
+    bvh.queryBox(slab, bottom);
+    EXPECT_EQ(bottom.size(), 6); // Two halves and four walls touching z = 0
+
+    kernel.kef(diagonal);
+    stats = bvh.refit(kernel);
+    EXPECT_FALSE(stats.rebuilt);
+    EXPECT_EQ(stats.removed, 1);
+    EXPECT_EQ(bvh.getFaceCount(), 6);
+
+    FaceHit hit;
+    ASSERT_TRUE(bvh.raycast(Ray{{0.3, 0.6, -1}, {0, 0, 1}}, hit));
+    EXPECT_NEAR(hit.distance, 1.0, 1e-12);
+    EXPECT_NE(kernel.getFaceById(hit.face_id), nullptr);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include "kernel/face_intersection.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+namespace {
+
+// One polygon; the mesh builder closes it with a back face
+void buildPolygon(WingedEdgeKernel& kernel, const std::vector<Point3D>& loop) {
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < loop.size(); i++) indices.push_back(i);
+    kernel.buildFromIndexedMesh(loop, indices, {static_cast<uint32_t>(loop.size())});
+}
+
+double length(const IntersectionSegment& s) {
+    return (s.end.point - s.start.point).length();
+}
+
+double distanceToEdge(const WingedEdgeKernel& kernel, int edge_id, const Point3D& p) {
+    auto e = kernel.getEdgeById(edge_id);
+    if (!e) return INFINITY;
+    const Vec3 d = e->v2->coords - e->v1->coords;
+    const double t = std::clamp((p - e->v1->coords).dot(d) / d.dot(d), 0.0, 1.0);
+    return (e->v1->coords + d * t - p).length();
+}
+
+} // namespace
+
+// Test fixture for face-face intersection between two solids
+class FaceIntersectionTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel a;
+    WingedEdgeKernel b;
+    FaceIntersector intersector;
+
+    // Every end lies on its edge, and that edge bounds the face it came from
+    void expectEndsOnTheirEdges(const std::vector<IntersectionSegment>& segments) {
+        for (const auto& s : segments) {
+            for (const SegmentEnd* end : {&s.start, &s.end}) {
+                const WingedEdgeKernel& owner = end->edge_of == Operand::A ? a : b;
+                const int face = end->edge_of == Operand::A ? s.face_a : s.face_b;
+                auto e = owner.getEdgeById(end->edge_id);
+                ASSERT_TRUE(e);
+                EXPECT_TRUE((e->f1 && e->f1->id == face) || (e->f2 && e->f2->id == face));
+                EXPECT_LT(distanceToEdge(owner, end->edge_id, end->point), 1e-12);
+            }
+        }
+    }
+};
+
+TEST_F(FaceIntersectionTest, OverlappingBoxesMeetInAClosedLoop) {
+    buildBox(a, Point3D(0, 0, 0), Point3D(1, 1, 1));
+    buildBox(b, Point3D(0.5, 0.5, 0.5), Point3D(1.5, 1.5, 1.5));
+
+    auto segments = intersector.intersect(a, b);
+
+    // Three faces of each box cut through the other: a loop of six edges
+    ASSERT_EQ(segments.size(), 6);
+    for (const auto& s : segments) EXPECT_NEAR(length(s), 0.5, 1e-12);
+    expectEndsOnTheirEdges(segments);
+
+    // Each corner of the loop ends exactly two segments
+    std::map<std::tuple<double, double, double>, int> corners;
+    for (const auto& s : segments) {
+        for (const Point3D& p : {s.start.point, s.end.point}) corners[{p.x, p.y, p.z}]++;
+    }
+    EXPECT_EQ(corners.size(), 6);
+    for (const auto& [corner, count] : corners) EXPECT_EQ(count, 2);
+
+    const auto& stats = intersector.getLastStats();
+    EXPECT_EQ(stats.segments, 6);
+    EXPECT_LE(stats.candidate_pairs, 36);
+    EXPECT_GE(stats.candidate_pairs - stats.plane_rejects, 6);
+}
+
+TEST_F(FaceIntersectionTest, ResultDoesNotDependOnThreadCount) {
+    // 40 x 40 grid at z = 0, cut by a vertical quad at x = 10.5
+    buildGrid(a, 40);
+    buildPolygon(b, {Point3D(10.5, -1, -1), Point3D(10.5, 41, -1), Point3D(10.5, 41, 1), Point3D(10.5, -1, 1)});
+
+    intersector.setThreadCount(1);
+    auto serial = intersector.intersect(a, b);
+    const size_t candidates = intersector.getLastStats().candidate_pairs;
+    intersector.setThreadCount(4);
+    auto parallel = intersector.intersect(a, b);
+
+    // Column x in [10, 11] on both sides of each operand, plus the grid's
+    // outline face where it spans the whole cut
+    double total = 0;
+    for (const auto& s : serial) total += length(s);
+    EXPECT_NEAR(total, 2 * (40 + 40), 1e-9);
+    EXPECT_LT(candidates, 200);
+    expectEndsOnTheirEdges(serial);
+
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); i++) {
+        EXPECT_EQ(parallel[i].face_a, serial[i].face_a);
+        EXPECT_EQ(parallel[i].face_b, serial[i].face_b);
+        EXPECT_EQ(parallel[i].start.edge_id, serial[i].start.edge_id);
+        EXPECT_EQ(parallel[i].end.point.y, serial[i].end.point.y);
+    }
+}
+
+TEST_F(FaceIntersectionTest, NonConvexFacesGiveOneSegmentPerInterval) {
+    // A U-shaped face at z = 0 and a triangle standing across both arms
+    buildPolygon(a, {Point3D(0, 0, 0), Point3D(3, 0, 0), Point3D(3, 3, 0), Point3D(2, 3, 0),
+                     Point3D(2, 1, 0), Point3D(1, 1, 0), Point3D(1, 3, 0), Point3D(0, 3, 0)});
+    buildPolygon(b, {Point3D(-1, 2, -1), Point3D(5, 2, -1), Point3D(2, 2, 5)});
+
+    auto segments = intersector.intersect(a, b);
+
+    // Two arms, for each of the two faces on either operand
+    ASSERT_EQ(segments.size(), 8);
+    for (const auto& s : segments) {
+        EXPECT_NEAR(length(s), 1.0, 1e-12);
+        EXPECT_EQ(s.start.edge_of, Operand::A);
+        EXPECT_EQ(s.end.edge_of, Operand::A);
+        const double left = std::min(s.start.point.x, s.end.point.x);
+        EXPECT_TRUE(std::abs(left) < 1e-12 || std::abs(left - 2) < 1e-12) << left;
+        EXPECT_NEAR(s.start.point.y, 2.0, 1e-12);
+    }
+    expectEndsOnTheirEdges(segments);
+}
+
+TEST_F(FaceIntersectionTest, StrutsAndTwoEdgeLoopsGiveNothing) {
+    // Euler operators on a lone face leave a strut loop and a two-edge loop,
+    // standing across a box; neither spans a plane to cut
+    auto v1 = a.mvsf(Point3D(-1, 0.5, -1));
+    auto e1 = a.mev(v1, Point3D(2, 0.5, -1), a.getFaces()[0]);
+    auto e2 = a.mev(e1->v2, Point3D(0.5, 0.5, 2), a.getFaces()[0]);
+    a.mef(e2->v2, v1, a.getFaces()[0]);
+    buildBox(b, Point3D(0, 0, 0), Point3D(1, 1, 1));
+
+    ASSERT_EQ(a.getFaces().size(), 2);
+    EXPECT_TRUE(intersector.intersect(a, b).empty());
+    EXPECT_TRUE(intersector.intersect(b, a).empty());
+}
+
+TEST_F(FaceIntersectionTest, SeparateAndTouchingSolidsGiveNothing) {
+    buildBox(a, Point3D(0, 0, 0), Point3D(1, 1, 1));
+    buildBox(b, Point3D(3, 0, 0), Point3D(4, 1, 1));
+    EXPECT_TRUE(intersector.intersect(a, b).empty());
+    EXPECT_EQ(intersector.getLastStats().candidate_pairs, 0);
+
+    // Face to face contact: boxes overlap but nothing crosses
+    b.transformVertices(b.getVertices(), Mat4::translation(-2, 0, 0));
+    EXPECT_TRUE(intersector.intersect(a, b).empty());
+    EXPECT_GT(intersector.getLastStats().candidate_pairs, 0);
+
+    // The tree over B follows its edits
+    b.transformVertices(b.getVertices(), Mat4::translation(-0.5, 0.25, 0.25));
+    EXPECT_FALSE(intersector.intersect(a, b).empty());
+
+    EXPECT_THROW(intersector.intersect(a, a), std::invalid_argument);
+    EXPECT_THROW(intersector.setTolerance(-1), std::invalid_argument);
+    EXPECT_THROW(intersector.setTolerance(NAN), std::invalid_argument);
+}
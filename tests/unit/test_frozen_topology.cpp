@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include "kernel/assembly.h"
+#include "kernel/face_bvh.h"
+#include "kernel/face_intersection.h"
+#include "kernel/frozen_topology.h"
+#include "kernel/indexed_kernel.h"
+#include "kernel/kernel_file.h"
+#include "kernel/mesh_export.h"
+#include "kernel/tessellator.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for the compressed, read-only kernel form
+class FrozenTopologyTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+
+    // n x n quads with slightly irregular heights
+    void buildGrid(uint32_t n) { TestModels::buildGrid(kernel, n, 1.0, 0.01); }
+
+    static std::vector<int> ids(const std::vector<std::shared_ptr<Vertex>>& list) {
+        std::vector<int> result;
+        for (const auto& v : list) result.push_back(v->id);
+        return result;
+    }
+    static std::vector<int> ids(const std::vector<std::shared_ptr<Edge>>& list) {
+        std::vector<int> result;
+        for (const auto& e : list) result.push_back(e->id);
+        return result;
+    }
+    static std::vector<int> ids(const std::vector<std::shared_ptr<Face>>& list) {
+        std::vector<int> result;
+        for (const auto& f : list) result.push_back(f->id);
+        return result;
+    }
+};
+
+TEST_F(FrozenTopologyTest, NavigationWorksOnTheFrozenForm) {
+    buildGrid(40);
+    // Kills leave gaps in the IDs and shuffle the element lists
+    for (int i = 0; i < 20; i++) kernel.kef(kernel.getEdges()[37 * i + 5]);
+    ASSERT_TRUE(kernel.validate(ValidationLevel::Full));
+
+    std::map<int, std::vector<int>> face_loops, face_corners, vertex_stars, vertex_faces;
+    std::map<int, Point3D> positions;
+    for (const auto& f : kernel.getFaces()) {
+        face_loops[f->id] = ids(kernel.getFaceBoundary(f));
+        face_corners[f->id] = ids(kernel.getFaceVertices(f));
+    }
+    for (const auto& v : kernel.getVertices()) {
+        vertex_stars[v->id] = ids(kernel.getIncidentEdges(v));
+        vertex_faces[v->id] = ids(kernel.getIncidentFaces(v));
+        positions[v->id] = v->coords;
+    }
+    const size_t vertex_count = kernel.getVertexCount();
+    const size_t edge_count = kernel.getEdgeCount();
+    const size_t face_count = kernel.getFaceCount();
+
+    kernel.freeze();
+
+    ASSERT_TRUE(kernel.isFrozen());
+    EXPECT_TRUE(kernel.getVertices().empty());
+    EXPECT_EQ(kernel.getVertexCount(), vertex_count);
+    EXPECT_EQ(kernel.getEdgeCount(), edge_count);
+    EXPECT_EQ(kernel.getFaceCount(), face_count);
+
+    const FrozenTopology& frozen = *kernel.getFrozen();
+    for (const auto& [id, loop] : face_loops) {
+        EXPECT_EQ(frozen.faceEdges(id), loop) << "face " << id;
+        EXPECT_EQ(frozen.faceVertices(id), face_corners[id]) << "face " << id;
+    }
+    const double tolerance = frozen.getCoordinateStep();
+    for (const auto& [id, star] : vertex_stars) {
+        EXPECT_EQ(frozen.vertexEdges(id), star) << "vertex " << id;
+        EXPECT_EQ(frozen.incidentFaces(id), vertex_faces[id]) << "vertex " << id;
+        Point3D p = frozen.getVertex(id).coords;
+        EXPECT_NEAR(p.x, positions[id].x, tolerance);
+        EXPECT_NEAR(p.z, positions[id].z, tolerance);
+    }
+
+    EXPECT_EQ(frozen.vertexIndex(999999), -1);
+    EXPECT_THROW(frozen.getEdge(999999), std::invalid_argument);
+}
+
+TEST_F(FrozenTopologyTest, UsesAFractionOfTheElementGraph) {
+    buildGrid(100);
+    const size_t graph_bytes = kernel.getVertexCount() * (sizeof(Vertex) + sizeof(std::shared_ptr<Vertex>)) +
+                               kernel.getEdgeCount() * (sizeof(Edge) + sizeof(std::shared_ptr<Edge>)) +
+                               kernel.getFaceCount() * (sizeof(Face) + sizeof(std::shared_ptr<Face>));
+
+    kernel.freeze();
+
+    // Control blocks and slot tables are not even counted on the graph side
+    const size_t frozen_bytes = kernel.getFrozen()->byteSize();
+    EXPECT_LT(frozen_bytes * 5, graph_bytes) << frozen_bytes << " vs " << graph_bytes;
+    EXPECT_LT(frozen_bytes, kernel.getEdgeCount() * 24);
+}
+
+TEST_F(FrozenTopologyTest, ThawRestoresTheEditableModel) {
+    kernel.setUndoLimit(1 << 20);
+    buildGrid(12);
+    kernel.kef(kernel.getEdges()[10]);
+    std::map<int, std::vector<int>> face_corners;
+    for (const auto& f : kernel.getFaces()) face_corners[f->id] = ids(kernel.getFaceVertices(f));
+    auto stale = kernel.getVertices()[0];
+    const int stale_id = stale->id;
+    const Point3D stale_coords = stale->coords;
+    const size_t solids = kernel.getSolidCount();
+
+    kernel.freeze(FreezeOptions{16});
+    EXPECT_EQ(kernel.getUndoCount(), 0);
+    EXPECT_FALSE(kernel.isAlive(stale));
+    kernel.thaw();
+
+    ASSERT_FALSE(kernel.isFrozen());
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_EQ(kernel.getSolidCount(), solids);
+    for (const auto& [id, corners] : face_corners) {
+        auto f = kernel.getFaceById(id);
+        ASSERT_TRUE(f) << "face " << id;
+        EXPECT_EQ(ids(kernel.getFaceVertices(f)), corners);
+    }
+    auto v = kernel.getVertexById(stale_id);
+    ASSERT_TRUE(v);
+    EXPECT_NE(v, stale);
+    EXPECT_NEAR(v->coords.x, stale_coords.x, 12.0 / 65535);
+    EXPECT_NEAR(v->coords.z, stale_coords.z, 0.04 / 65535);
+
+    // The thawed kernel carries on handing out fresh IDs
+    auto added = kernel.mvsf(Point3D(0, 0, 1));
+    EXPECT_GT(added->id, kernel.getVertices().front()->id);
+    EXPECT_EQ(kernel.getVertexById(added->id), added);
+}
+
+TEST_F(FrozenTopologyTest, FirstEditThawsAutomatically) {
+    buildGrid(4);
+    const size_t faces = kernel.getFaceCount();
+
+    EXPECT_THROW(kernel.freeze(FreezeOptions{4}), std::invalid_argument);
+    EXPECT_FALSE(kernel.isFrozen());
+
+    kernel.beginBatch();
+    EXPECT_THROW(kernel.freeze(), std::logic_error);
+    kernel.commit();
+
+    kernel.freeze();
+    kernel.freeze(); // Already frozen
+    kernel.mvsf(Point3D(9, 9, 9));
+    EXPECT_FALSE(kernel.isFrozen());
+    EXPECT_EQ(kernel.getFaceCount(), faces + 1);
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+
+    kernel.freeze();
+    kernel.beginBatch();
+    EXPECT_FALSE(kernel.isFrozen());
+    auto f = kernel.getFaces()[0];
+    kernel.mev(kernel.getFaceVertices(f)[0], Point3D(-1, -1, 0), f);
+    kernel.rollback();
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+}
+
+TEST_F(FrozenTopologyTest, SavesWithoutThawing) {
+    buildGrid(8);
+    const size_t edges = kernel.getEdgeCount();
+    kernel.freeze();
+
+    const auto path = (std::filesystem::temp_directory_path() / "sketchy_frozen_save.skk").string();
+    KernelFile::save(kernel, path);
+    EXPECT_TRUE(kernel.isFrozen());
+
+    WingedEdgeKernel loaded = KernelFile::load(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.getEdgeCount(), edges);
+    EXPECT_EQ(loaded.getSolidCount(), kernel.getSolidCount());
+    EXPECT_TRUE(loaded.validate(ValidationLevel::Full));
+}
+
+TEST_F(FrozenTopologyTest, ExportsFromTheFrozenForm) {
+    auto capture = [](std::string& bytes) {
+        return [&bytes](const char* data, size_t size) { bytes.append(data, size); };
+    };
+
+    // A fresh cube lists its elements in ID order and sits on the
+    // quantization grid, so the frozen export matches byte for byte
+    buildCube(kernel);
+    std::string obj, ply, frozen_obj, frozen_ply;
+    exportObj(kernel, capture(obj));
+    exportPly(kernel, capture(ply));
+    kernel.freeze();
+    ExportStats stats = exportObj(kernel, capture(frozen_obj));
+    exportPly(kernel, capture(frozen_ply));
+    EXPECT_TRUE(kernel.isFrozen());
+    EXPECT_EQ(stats.vertices, 8);
+    EXPECT_EQ(stats.faces, 6);
+    EXPECT_EQ(frozen_obj, obj);
+    EXPECT_EQ(frozen_ply, ply);
+
+    // After kills the order differs, but the PLY body still holds every
+    // vertex and loop the header announces
+    kernel = WingedEdgeKernel();
+    buildGrid(10);
+    for (int i = 0; i < 5; i++) kernel.kef(kernel.getEdges()[17 * i + 3]);
+    std::string live;
+    ExportStats live_stats = exportPly(kernel, capture(live));
+    kernel.freeze();
+    std::string frozen;
+    ExportStats frozen_stats = exportPly(kernel, capture(frozen));
+    EXPECT_EQ(frozen_stats.vertices, live_stats.vertices);
+    EXPECT_EQ(frozen_stats.faces, live_stats.faces);
+    EXPECT_EQ(frozen.size(), live.size());
+}
+
+TEST_F(FrozenTopologyTest, PassesOverTheElementGraphRefuseFrozenKernels) {
+    buildCube(kernel);
+    kernel.freeze();
+
+    EXPECT_THROW(kernel.validate(), std::logic_error);
+    EXPECT_THROW(kernel.isManifold(), std::logic_error);
+    EXPECT_THROW(kernel.snapshot(), std::logic_error);
+    EXPECT_THROW(kernel.splitComponents(), std::logic_error);
+    EXPECT_THROW(Assembly::fromComponents(kernel), std::logic_error);
+    EXPECT_THROW(IndexedKernel::fromKernel(kernel), std::logic_error);
+
+    Tessellator tessellator;
+    EXPECT_THROW(tessellator.update(kernel), std::logic_error);
+    FaceBvh bvh;
+    EXPECT_THROW(bvh.build(kernel), std::logic_error);
+    EXPECT_THROW(bvh.refit(kernel), std::logic_error);
+    WingedEdgeKernel other;
+    buildCube(other);
+    FaceIntersector intersector;
+    EXPECT_THROW(intersector.intersect(other, kernel), std::logic_error);
+    EXPECT_THROW(intersector.intersect(kernel, other), std::logic_error);
+    EXPECT_TRUE(kernel.isFrozen());
+
+    // Thawed, the same passes see the whole model again
+    kernel.thaw();
+    EXPECT_TRUE(kernel.validate(ValidationLevel::Full));
+    EXPECT_EQ(kernel.snapshot()->getFaceCount(), 6);
+    EXPECT_EQ(tessellator.update(kernel).indices, 36);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "kernel/geometry.h"
 #include <cmath>
+#include <vector>
 
 using namespace SketchyKernel;
 
@@ -149,6 +150,152 @@ TEST_F(GeometryTest, Mat4Multiplication) {
     EXPECT_TRUE(vec_approx_equal(result, Vec3(3.0, 2.0, 2.0)));
 }
 
+TEST_F(GeometryTest, Mat4IsAffine) {
+    EXPECT_TRUE(Mat4().isAffine());
+    EXPECT_TRUE((Mat4::translation(1, 2, 3) * Mat4::rotation(Vec3(0, 1, 0), 0.3)).isAffine());
+
+    Mat4 perspective;
+    perspective.m[3][2] = -1.0;
+    EXPECT_FALSE(perspective.isAffine());
+}
+
+TEST_F(GeometryTest, Mat4TransformPointsMatchesTransform) {
+    Mat4 affine = Mat4::translation(1, -2, 3) * Mat4::rotation(Vec3(1, 1, 0), 0.7) * Mat4::scale(2, 3, 4);
+    Mat4 projective = affine;
+    projective.m[3][0] = 0.1;
+    projective.m[3][2] = -0.5;
+
+    std::vector<Vec3> points;
+    for (int i = 0; i < 37; i++) {
+        points.emplace_back(i * 0.5, 1.0 - i, i * i * 0.01);
+    }
+    points.emplace_back(0.0, 0.0, 2.0); // w == 0 for the projective matrix: no divide
+
+    for (const Mat4* mat : {&affine, &projective}) {
+        std::vector<Vec3> out(points.size());
+        mat->transformPoints(points.data(), out.data(), points.size());
+
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_TRUE(vec_approx_equal(out[i], mat->transform(points[i])));
+        }
+    }
+}
+
+TEST_F(GeometryTest, Mat4TransformPointsInPlace) {
+    std::vector<Vec3> points = {Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1)};
+    Mat4 trans = Mat4::translation(1.0, 2.0, 3.0);
+
+    trans.transformPoints(points.data(), points.data(), points.size());
+
+    EXPECT_TRUE(vec_approx_equal(points[0], Vec3(2, 2, 3)));
+    EXPECT_TRUE(vec_approx_equal(points[1], Vec3(1, 3, 3)));
+    EXPECT_TRUE(vec_approx_equal(points[2], Vec3(1, 2, 4)));
+}
+
+TEST_F(GeometryTest, Mat4TransformPointsColumnsMatchesTransform) {
+    Mat4 projective = Mat4::rotation(Vec3(0, 0, 1), 0.4);
+    projective.m[3][1] = 0.25;
+
+    std::vector<double> x, y, z;
+    for (int i = 0; i < 11; i++) {
+        x.push_back(i);
+        y.push_back(2.0 - i);
+        z.push_back(0.5 * i);
+    }
+    std::vector<double> ox(x.size()), oy(x.size()), oz(x.size());
+    projective.transformPoints(x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), x.size());
+
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_TRUE(vec_approx_equal(Vec3(ox[i], oy[i], oz[i]), projective.transform(Vec3(x[i], y[i], z[i]))));
+    }
+}
+
+TEST_F(GeometryTest, BoundingBoxExpand) {
+    BoundingBox box;
+    EXPECT_TRUE(box.empty());
+
+    box.expand(Vec3(1, -2, 3));
+    box.expand(Vec3(-1, 4, 0));
+    EXPECT_FALSE(box.empty());
+    EXPECT_TRUE(vec_approx_equal(box.min, Vec3(-1, -2, 0)));
+    EXPECT_TRUE(vec_approx_equal(box.max, Vec3(1, 4, 3)));
+}
+
+TEST_F(GeometryTest, FloatPrecisionTypes) {
+    static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must pack for vertex buffers");
+
+    Vec3 exact(1.0 / 3.0, 2.0, -4.5);
+    Vec3f display(exact);
+    EXPECT_FLOAT_EQ(display.x, 1.0f / 3.0f);
+    EXPECT_FLOAT_EQ(display.length(), static_cast<float>(exact.length()));
+
+    Mat4f rot(Mat4::rotation(Vec3(0, 0, 1), M_PI / 2.0));
+    Vec3f turned = rot.transform(Vec3f(1, 0, 0));
+    EXPECT_NEAR(turned.x, 0.0f, 1e-6f);
+    EXPECT_NEAR(turned.y, 1.0f, 1e-6f);
+
+    // Float columns take the eight-wide kernel plus its scalar tail
+    std::vector<float> x(19), y(19), z(19);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = static_cast<float>(i);
+        y[i] = 1.0f;
+        z[i] = -static_cast<float>(i);
+    }
+    Mat4f move = Mat4f::translation(1.0f, 2.0f, 3.0f);
+    move.transformPoints(x.data(), y.data(), z.data(), x.data(), y.data(), z.data(), x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_FLOAT_EQ(x[i], static_cast<float>(i) + 1.0f);
+        EXPECT_FLOAT_EQ(y[i], 3.0f);
+        EXPECT_FLOAT_EQ(z[i], 3.0f - static_cast<float>(i));
+    }
+}
+
+// Affine3 Tests
+TEST_F(GeometryTest, Affine3FoldsAtCompileTime) {
+    constexpr Affine3 move = Affine3::translate(1.0, 2.0, 3.0) * Affine3::scale(2.0, 2.0, 2.0);
+    constexpr Vec3 p = move.transform(Vec3(1.0, 1.0, 1.0));
+    static_assert(p.x == 3.0 && p.y == 4.0 && p.z == 5.0, "Affine3 must be usable in constant expressions");
+
+    constexpr Affine3 back = move.inverse();
+    static_assert(back.transform(p).x == 1.0, "Affine3::inverse must be constexpr");
+
+    EXPECT_TRUE(vec_approx_equal(p, Vec3(3.0, 4.0, 5.0)));
+}
+
+TEST_F(GeometryTest, Affine3MatchesMat4) {
+    Mat4 a = Mat4::translation(1, -2, 0.5) * Mat4::rotation(Vec3(1, 2, 3), 0.8);
+    Mat4 b = Mat4::scale(2, 3, 0.5) * Mat4::rotation(Vec3(0, 1, 0), -0.3);
+
+    Affine3 composed = Affine3(a) * Affine3(b);
+    Vec3 point(0.3, -1.2, 2.5);
+    EXPECT_TRUE(vec_approx_equal(composed.transform(point), (a * b).transform(point)));
+
+    // The inverse undoes the transform
+    EXPECT_TRUE(vec_approx_equal(composed.inverse().transform(composed.transform(point)), point));
+
+    // Directions ignore the translation
+    EXPECT_TRUE(vec_approx_equal(Affine3::translate(5, 5, 5).transformVector(point), point));
+}
+
+TEST_F(GeometryTest, Affine3RejectsProjectiveAndSingular) {
+    Mat4 perspective;
+    perspective.m[3][2] = -1.0;
+    EXPECT_THROW(Affine3{perspective}, std::invalid_argument);
+    EXPECT_THROW(Affine3::scale(1.0, 0.0, 1.0).inverse(), std::invalid_argument);
+}
+
+TEST_F(GeometryTest, Mat4MultiplicationProjective) {
+    Mat4 perspective;
+    perspective.m[3][2] = -1.0;
+    perspective.m[3][3] = 0.0;
+    Mat4 product = perspective * Mat4::translation(0, 0, 2);
+
+    // Row 3 of the product is (0, 0, -1, -2)
+    EXPECT_EQ(product.m[3][2], -1.0);
+    EXPECT_EQ(product.m[3][3], -2.0);
+    EXPECT_EQ(product.m[2][3], 2.0);
+}
+
 // Point3D alias test
 TEST_F(GeometryTest, Point3DAliasWorks) {
     Point3D p(1.0, 2.0, 3.0);
@@ -0,0 +1,411 @@
+#include <gtest/gtest.h>
+#include "kernel/indexed_kernel.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for the index-based storage mode
+class IndexedKernelTest : public ::testing::Test {
+protected:
+    IndexedKernel kernel;
+
+    // Builds the same quad as EulerOperatorTest.BuildQuad
+    void buildQuad(VertexId& v1, FaceId& face, EdgeId& closing_edge) {
+        v1 = kernel.mvsf(Point3D(0, 0, 0));
+        face = kernel.getFaces()[0];
+
+        auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+        auto e2 = kernel.mev(kernel.v2(e1), Point3D(1, 1, 0), face);
+        auto e3 = kernel.mev(kernel.v2(e2), Point3D(0, 1, 0), face);
+        closing_edge = kernel.mef(kernel.v2(e3), v1, face);
+    }
+};
+
+// ==================== Euler Operator Tests ====================
+
+TEST_F(IndexedKernelTest, MVSF_CreatesVertexAndFace) {
+    auto v = kernel.mvsf(Point3D(1.0, 2.0, 3.0));
+
+    ASSERT_TRUE(v.valid());
+    EXPECT_EQ(kernel.coords(v).x, 1.0);
+    EXPECT_EQ(kernel.coords(v).y, 2.0);
+    EXPECT_EQ(kernel.coords(v).z, 3.0);
+
+    EXPECT_EQ(kernel.getVertexCount(), 1);
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    EXPECT_EQ(kernel.getEdgeCount(), 0);
+}
+
+TEST_F(IndexedKernelTest, MEV_CreatesEdgeAndVertex) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+
+    auto edge = kernel.mev(v1, Point3D(1, 0, 0), face);
+
+    ASSERT_TRUE(edge.valid());
+    EXPECT_EQ(kernel.getVertexCount(), 2);
+    EXPECT_EQ(kernel.getEdgeCount(), 1);
+    EXPECT_EQ(kernel.v1(edge), v1);
+    EXPECT_EQ(kernel.coords(kernel.v2(edge)).x, 1.0);
+    EXPECT_EQ(kernel.f1(edge), face);
+    EXPECT_EQ(kernel.f2(edge), face);
+}
+
+TEST_F(IndexedKernelTest, MEF_SplitsFace) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    EXPECT_EQ(kernel.getVertexCount(), 4);
+    EXPECT_EQ(kernel.getEdgeCount(), 4);
+    EXPECT_EQ(kernel.getFaceCount(), 2);
+    EXPECT_EQ(kernel.v2(closing_edge), v1);
+    EXPECT_NE(kernel.f1(closing_edge), kernel.f2(closing_edge));
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+}
+
+TEST_F(IndexedKernelTest, KEF_MergesFacesAndKeepsHandlesStable) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    auto edges_before = kernel.getEdges();
+    auto merged = kernel.kef(closing_edge);
+
+    EXPECT_EQ(merged, face);
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    EXPECT_EQ(kernel.getEdgeCount(), 3);
+    EXPECT_FALSE(kernel.isAlive(closing_edge));
+
+    // Surviving edges keep their handles
+    for (EdgeId e : edges_before) {
+        if (e == closing_edge) continue;
+        EXPECT_TRUE(kernel.isAlive(e));
+        EXPECT_EQ(kernel.f1(e), face);
+    }
+    EXPECT_TRUE(kernel.validate());
+}
+
+TEST_F(IndexedKernelTest, KEF_BoundaryEdge_RemovesEdgeAndFace) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto edge = kernel.mev(v, Point3D(1, 0, 0), face);
+
+    kernel.setEdgeFaces(edge, face, FaceId());
+
+    auto killed = kernel.kef(edge);
+
+    EXPECT_EQ(killed, face);
+    EXPECT_EQ(kernel.getEdgeCount(), 0);
+    EXPECT_EQ(kernel.getFaceCount(), 0);
+}
+
+TEST_F(IndexedKernelTest, KFMRH_RetagsHoleBoundary) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    auto hole = kernel.f2(closing_edge);
+    kernel.kfmrh(hole, face);
+
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    EXPECT_FALSE(kernel.isAlive(hole));
+    EXPECT_EQ(kernel.f2(closing_edge), face);
+    EXPECT_EQ(kernel.getRingCount(), 1);
+    EXPECT_TRUE(kernel.validate());
+}
+
+TEST_F(IndexedKernelTest, Validate_RejectsOpenLoop) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    // MEF leaves the split loops open, which every level but References walks
+    EXPECT_TRUE(kernel.validate(ValidationLevel::References));
+    EXPECT_FALSE(kernel.validate());
+    EXPECT_FALSE(kernel.validate(ValidationLevel::Full));
+}
+
+TEST_F(IndexedKernelTest, ThrowsOnInvalidHandles) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+
+    EXPECT_THROW(kernel.mev(VertexId(), Point3D(1, 0, 0), face), std::invalid_argument);
+    EXPECT_THROW(kernel.mev(v, Point3D(1, 0, 0), FaceId(42)), std::invalid_argument);
+    EXPECT_THROW(kernel.mef(v, v, face), std::invalid_argument);
+    EXPECT_THROW(kernel.kef(EdgeId()), std::invalid_argument);
+    EXPECT_THROW(kernel.kfmrh(FaceId(), face), std::invalid_argument);
+}
+
+TEST_F(IndexedKernelTest, RejectsSameFaceOnBothSides) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto strut = kernel.mev(v, Point3D(1, 0, 0), face);
+
+    EXPECT_THROW(kernel.kef(strut), std::invalid_argument);
+    EXPECT_THROW(kernel.kfmrh(face, face), std::invalid_argument);
+    EXPECT_TRUE(kernel.isAlive(strut));
+    EXPECT_EQ(kernel.getFaceCount(), 1);
+    EXPECT_EQ(kernel.getRingCount(), 0);
+    EXPECT_TRUE(kernel.validate());
+}
+
+TEST_F(IndexedKernelTest, CirculatorsMatchVectorQueries) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    for (FaceId f : kernel.getFaces()) {
+        auto boundary = kernel.getFaceBoundary(f);
+        auto vertices = kernel.getFaceVertices(f);
+        ASSERT_EQ(kernel.faceEdges(f).size(), boundary.size());
+
+        size_t i = 0;
+        for (EdgeId e : kernel.faceEdges(f)) EXPECT_EQ(e, boundary[i++]);
+        i = 0;
+        for (VertexId v : kernel.faceVertices(f)) EXPECT_EQ(v, vertices[i++]);
+    }
+
+    size_t count = 0;
+    for (EdgeId e : kernel.vertexEdges(v1)) {
+        EXPECT_TRUE(kernel.v1(e) == v1 || kernel.v2(e) == v1);
+        count++;
+    }
+    EXPECT_EQ(count, kernel.getIncidentEdges(v1).size());
+}
+
+// ==================== Tombstone Tests ====================
+
+TEST_F(IndexedKernelTest, KilledSlotsAreReusedWithNewGeneration) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    auto killed_face = kernel.f2(closing_edge);
+    kernel.kef(closing_edge);
+    size_t edge_slots = kernel.edgeSlotCount();
+
+    // MEF reuses the tombstoned edge and face slots
+    auto v3 = kernel.v2(kernel.getEdges()[1]);
+    auto new_edge = kernel.mef(v3, v1, face);
+
+    EXPECT_EQ(kernel.edgeSlotCount(), edge_slots);
+    EXPECT_EQ(new_edge.index, closing_edge.index);
+    EXPECT_NE(new_edge.generation, closing_edge.generation);
+
+    // Stale handles stay detectable after their slot is reused
+    EXPECT_FALSE(kernel.isAlive(closing_edge));
+    EXPECT_FALSE(kernel.isAlive(killed_face));
+    EXPECT_TRUE(kernel.isAlive(new_edge));
+    EXPECT_TRUE(kernel.isAlive(kernel.f2(new_edge)));
+}
+
+TEST_F(IndexedKernelTest, CompactDropsTombstonesAndRemapsHandles) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(kernel.v2(e1), Point3D(0.5, 1, 0), face);
+    auto split_edge = kernel.mef(kernel.v2(e2), v1, face);
+    auto e4 = kernel.mev(kernel.v2(e2), Point3D(0, 2, 0), face);
+
+    auto v3 = kernel.v2(e2);
+
+    kernel.kef(split_edge);
+    ASSERT_EQ(kernel.edgeSlotCount(), 4);
+
+    auto map = kernel.compact();
+
+    EXPECT_EQ(kernel.edgeSlotCount(), 3);
+    EXPECT_EQ(kernel.faceSlotCount(), 1);
+    EXPECT_EQ(kernel.getEdgeCount(), 3);
+
+    // Old handles are stale; translated handles address the moved elements
+    EXPECT_FALSE(kernel.isAlive(e4));
+    EXPECT_FALSE(map.edges[split_edge].valid());
+
+    auto moved = map.edges[e4];
+    ASSERT_TRUE(kernel.isAlive(moved));
+    EXPECT_EQ(moved.index, 2u);
+    EXPECT_EQ(kernel.coords(kernel.v2(moved)).y, 2.0);
+    EXPECT_EQ(kernel.v1(moved), map.vertices[v3]);
+    EXPECT_EQ(kernel.f1(moved), map.faces[face]);
+    EXPECT_TRUE(kernel.validate());
+}
+
+TEST_F(IndexedKernelTest, TransformVerticesSkipsStaleHandles) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    VertexId stale(v1.index, v1.generation + 1);
+    kernel.transformVertices({v1, stale, kernel.v1(closing_edge)}, Mat4::scale(2, 2, 2));
+
+    EXPECT_EQ(kernel.coords(v1).x, 0.0);
+    EXPECT_EQ(kernel.coords(kernel.v1(closing_edge)).x, 0.0);
+    EXPECT_EQ(kernel.coords(kernel.v1(closing_edge)).y, 2.0);
+}
+
+TEST_F(IndexedKernelTest, PositionColumnsAreAlignedAndContiguous) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(kernel.positionsX()) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(kernel.positionsY()) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(kernel.positionsZ()) % 64, 0u);
+
+    for (VertexId v : kernel.getVertices()) {
+        EXPECT_EQ(kernel.positionsX()[v.index], kernel.coords(v).x);
+        EXPECT_EQ(kernel.positionsY()[v.index], kernel.coords(v).y);
+    }
+}
+
+TEST_F(IndexedKernelTest, BoundingBoxAndTransformAll) {
+    EXPECT_TRUE(kernel.boundingBox().empty());
+
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    // Nine extra points exercise the SIMD tail
+    for (int i = 0; i < 9; i++) kernel.mev(v1, Point3D(0.5, 0.5, 0.1 * i), face);
+
+    kernel.transformAll(Mat4::translation(10, 0, 0) * Mat4::scale(2, 2, 2));
+    auto box = kernel.boundingBox();
+
+    EXPECT_DOUBLE_EQ(box.min.x, 10.0);
+    EXPECT_DOUBLE_EQ(box.max.x, 12.0);
+    EXPECT_DOUBLE_EQ(box.max.y, 2.0);
+    EXPECT_DOUBLE_EQ(box.max.z, 1.6);
+    EXPECT_DOUBLE_EQ(kernel.coords(v1).x, 10.0);
+}
+
+TEST_F(IndexedKernelTest, DisplayPositionsFollowEdits) {
+    VertexId v1;
+    FaceId face;
+    EdgeId closing_edge;
+    buildQuad(v1, face, closing_edge);
+
+    VertexId v4 = kernel.v1(closing_edge);
+    EXPECT_FLOAT_EQ(kernel.displayPositions()[v4.index].y, 1.0f);
+
+    kernel.setCoords(v4, Point3D(0.25, 3.0, 0.0));
+    EXPECT_FLOAT_EQ(kernel.displayPositions()[v4.index].x, 0.25f);
+
+    kernel.transformAll(Mat4::translation(0, 0, 2));
+    EXPECT_FLOAT_EQ(kernel.displayPositions()[v1.index].z, 2.0f);
+}
+
+// ==================== Equivalence with WingedEdgeKernel ====================
+
+TEST_F(IndexedKernelTest, NavigationMatchesPointerKernel) {
+    WingedEdgeKernel pointer_kernel;
+    auto pv1 = pointer_kernel.mvsf(Point3D(0, 0, 0));
+    auto pface = pointer_kernel.getFaces()[0];
+    auto pe1 = pointer_kernel.mev(pv1, Point3D(1, 0, 0), pface);
+    auto pe2 = pointer_kernel.mev(pe1->v2, Point3D(1, 1, 0), pface);
+    pointer_kernel.mev(pv1, Point3D(0, 1, 0), pface);
+    pointer_kernel.mef(pe2->v2, pv1, pface);
+
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(kernel.v2(e1), Point3D(1, 1, 0), face);
+    kernel.mev(v1, Point3D(0, 1, 0), face);
+    kernel.mef(kernel.v2(e2), v1, face);
+
+    const auto& pvertices = pointer_kernel.getVertices();
+    auto vertices = kernel.getVertices();
+    ASSERT_EQ(pvertices.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(pointer_kernel.getIncidentEdges(pvertices[i]).size(),
+                  kernel.getIncidentEdges(vertices[i]).size());
+        EXPECT_EQ(pointer_kernel.getIncidentFaces(pvertices[i]).size(),
+                  kernel.getIncidentFaces(vertices[i]).size());
+    }
+
+    const auto& pfaces = pointer_kernel.getFaces();
+    auto faces = kernel.getFaces();
+    ASSERT_EQ(pfaces.size(), faces.size());
+    for (size_t i = 0; i < faces.size(); i++) {
+        EXPECT_EQ(pointer_kernel.getFaceBoundary(pfaces[i]).size(),
+                  kernel.getFaceBoundary(faces[i]).size());
+    }
+}
+
+TEST_F(IndexedKernelTest, IncidentFacesOfLargeFanAreUnique) {
+    // 64 triangles around a hub, past the linear dedup limit
+    const uint32_t n = 64;
+    std::vector<Point3D> positions{{0, 0, 1}};
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < n; i++) {
+        positions.emplace_back(static_cast<double>(i), 1.0, 0.0);
+        indices.insert(indices.end(), {0, 1 + i, 1 + (i + 1) % n});
+    }
+    WingedEdgeKernel pointer_kernel;
+    pointer_kernel.buildFromIndexedMesh(positions, indices, std::vector<uint32_t>(n, 3));
+    IndexedKernel fan = IndexedKernel::fromKernel(pointer_kernel);
+
+    auto vertices = fan.getVertices();
+    auto hub_faces = fan.getIncidentFaces(vertices[0]);
+    auto rim_faces = fan.getIncidentFaces(vertices[5]);
+    EXPECT_EQ(hub_faces.size(), n);
+    EXPECT_EQ(rim_faces.size(), 3); // Two triangles plus the cap
+    for (size_t i = 0; i < hub_faces.size(); i++) {
+        for (size_t j = i + 1; j < hub_faces.size(); j++) EXPECT_NE(hub_faces[i], hub_faces[j]);
+    }
+}
+
+TEST_F(IndexedKernelTest, IsManifoldRejectsTwoFansAtOneVertex) {
+    WingedEdgeKernel pointer_kernel;
+    buildBowtie(pointer_kernel);
+
+    IndexedKernel bowtie = IndexedKernel::fromKernel(pointer_kernel);
+    EXPECT_EQ(bowtie.getFaceCount(), 8);
+    EXPECT_FALSE(bowtie.isManifold());
+}
+
+TEST_F(IndexedKernelTest, ParallelValidateOnLargeGrid) {
+    WingedEdgeKernel pointer_kernel;
+    buildGrid(pointer_kernel, 160);
+
+    IndexedKernel grid = IndexedKernel::fromKernel(pointer_kernel);
+    for (size_t threads : {size_t(1), size_t(4)}) {
+        grid.setThreadCount(threads);
+        EXPECT_EQ(grid.getThreadCount(), threads);
+        EXPECT_TRUE(grid.validate(ValidationLevel::Full));
+        EXPECT_TRUE(grid.isManifold());
+    }
+}
+
+TEST_F(IndexedKernelTest, FromKernelCopiesConnectivity) {
+    WingedEdgeKernel pointer_kernel;
+    auto v1 = pointer_kernel.mvsf(Point3D(0, 0, 0));
+    auto face = pointer_kernel.getFaces()[0];
+    auto e1 = pointer_kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = pointer_kernel.mev(e1->v2, Point3D(0.5, 1, 0), face);
+    pointer_kernel.mef(e2->v2, v1, face);
+
+    auto indexed = IndexedKernel::fromKernel(pointer_kernel);
+
+    EXPECT_EQ(indexed.getVertexCount(), 3);
+    EXPECT_EQ(indexed.getEdgeCount(), 3);
+    EXPECT_EQ(indexed.getFaceCount(), 2);
+    EXPECT_TRUE(indexed.validate(ValidationLevel::References));
+
+    auto edges = indexed.getEdges();
+    EXPECT_EQ(indexed.v2(edges[0]), indexed.v1(edges[1]));
+    EXPECT_EQ(indexed.coords(indexed.v2(edges[1])).y, 1.0);
+    EXPECT_EQ(indexed.f2(edges[2]), indexed.getFaces()[1]);
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "kernel/kernel_file.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for the binary kernel file format
+class KernelFileTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+    std::string path;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = (std::filesystem::temp_directory_path() / (std::string("sketchy_") + info->name() + ".skk")).string();
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".part").c_str());
+    }
+
+    void flipByte(size_t offset) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char c = 0;
+        file.read(&c, 1);
+        c ^= 0x5A;
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(&c, 1);
+    }
+};
+
+TEST_F(KernelFileTest, MappedViewReadsRecordsInPlace) {
+    buildCube(kernel);
+    KernelFile::save(kernel, path);
+
+    MappedKernelFile file(path);
+    EXPECT_TRUE(file.verifyChecksum());
+    EXPECT_EQ(file.getVertexCount(), 8);
+    EXPECT_EQ(file.getEdgeCount(), 12);
+    EXPECT_EQ(file.getFaceCount(), 6);
+    EXPECT_EQ(file.getSolidCount(), 1);
+
+    const auto& vertices = kernel.getVertices();
+    for (uint32_t v = 0; v < vertices.size(); v++) {
+        EXPECT_EQ(file.position(v).x, vertices[v]->coords.x);
+        EXPECT_EQ(file.position(v).z, vertices[v]->coords.z);
+    }
+
+    // Records point at the same elements, by list position
+    const auto& edges = kernel.getEdges();
+    for (uint32_t e = 0; e < edges.size(); e++) {
+        const KernelFileEdge& record = file.edges()[e];
+        EXPECT_EQ(vertices[record.v1], edges[e]->v1);
+        EXPECT_EQ(edges[record.n1_f1], edges[e]->n1_f1);
+        EXPECT_EQ(kernel.getFaces()[record.f2], edges[e]->f2);
+    }
+}
+
+TEST_F(KernelFileTest, LoadRebuildsEditableKernel) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    auto e3 = kernel.mev(e2->v2, Point3D(0, 1, 0), face);
+    auto closing = kernel.mef(e3->v2, v1, face);
+    auto spare = kernel.mef(e2->v2, v1, closing->f2);
+    kernel.kef(spare); // Leaves a gap in the IDs
+
+    KernelFile::save(kernel, path);
+    WingedEdgeKernel loaded = KernelFile::load(path);
+
+    EXPECT_EQ(loaded.getVertexCount(), kernel.getVertexCount());
+    EXPECT_EQ(loaded.getEdgeCount(), kernel.getEdgeCount());
+    EXPECT_EQ(loaded.getFaceCount(), kernel.getFaceCount());
+    EXPECT_EQ(loaded.getSolidCount(), kernel.getSolidCount());
+    EXPECT_EQ(loaded.validate(), kernel.validate());
+
+    for (size_t i = 0; i < kernel.getFaceCount(); i++) {
+        EXPECT_EQ(loaded.faceEdges(loaded.getFaces()[i]).size(), kernel.faceEdges(kernel.getFaces()[i]).size());
+    }
+    for (size_t i = 0; i < kernel.getEdgeCount(); i++) {
+        const auto& a = kernel.getEdges()[i];
+        const auto& b = loaded.getEdges()[i];
+        EXPECT_EQ(b->v1->coords.x, a->v1->coords.x);
+        EXPECT_EQ(b->v2->coords.y, a->v2->coords.y);
+        EXPECT_EQ(b->n2_f2 != nullptr, a->n2_f2 != nullptr);
+    }
+
+    // The loaded kernel keeps editing with fresh IDs
+    auto v = loaded.getVertices()[0];
+    auto e = loaded.mev(v, Point3D(5, 5, 5), loaded.getFaces()[0]);
+    EXPECT_EQ(e->id, static_cast<int>(kernel.getEdgeCount()) + 1);
+    EXPECT_EQ(loaded.getEdgeById(e->id), e);
+}
+
+TEST_F(KernelFileTest, RejectsCorruptFiles) {
+    buildCube(kernel);
+    KernelFile::save(kernel, path);
+
+    // Payload damage is caught by the checksum
+    flipByte(sizeof(KernelFileHeader) + 5);
+    MappedKernelFile file(path);
+    EXPECT_FALSE(file.verifyChecksum());
+    EXPECT_THROW(KernelFile::load(file), std::runtime_error);
+
+    // Header damage is caught on open
+    flipByte(0);
+    EXPECT_THROW(MappedKernelFile{path}, std::runtime_error);
+    EXPECT_THROW(MappedKernelFile{path + ".missing"}, std::runtime_error);
+}
+
+TEST_F(KernelFileTest, FailedSaveKeepsTheOldFile) {
+    buildCube(kernel);
+    KernelFile::save(kernel, path);
+    EXPECT_FALSE(std::filesystem::exists(path + ".part"));
+
+    // A directory in the way of <path>.part makes the next save fail
+    kernel.mev(kernel.getVertices()[0], Point3D(5, 5, 5), kernel.getFaces()[0]);
+    std::filesystem::create_directory(path + ".part");
+    EXPECT_THROW(KernelFile::save(kernel, path), std::runtime_error);
+    std::filesystem::remove(path + ".part");
+
+    EXPECT_EQ(KernelFile::load(path).getVertexCount(), 8);
+}
+
+TEST_F(KernelFileTest, LoadAsyncMatchesLoad) {
+    buildGrid(kernel, 200);
+    KernelFile::save(kernel, path);
+    WingedEdgeKernel expected = KernelFile::load(path);
+
+    std::vector<double> reported;
+    FileTaskOptions options;
+    options.thread_count = 4;
+    options.on_progress = [&](double fraction) { reported.push_back(fraction); };
+    auto task = KernelFile::loadAsync(path, options);
+    WingedEdgeKernel loaded = task.get();
+
+    EXPECT_EQ(task.progress(), 1.0);
+    ASSERT_FALSE(reported.empty());
+    EXPECT_TRUE(std::is_sorted(reported.begin(), reported.end()));
+    EXPECT_EQ(reported.back(), 1.0);
+    EXPECT_THROW(task.get(), std::logic_error);
+
+    ASSERT_EQ(loaded.getEdgeCount(), expected.getEdgeCount());
+    EXPECT_EQ(loaded.getSolidCount(), expected.getSolidCount());
+    EXPECT_TRUE(loaded.validate(ValidationLevel::Full));
+    for (size_t i = 0; i < expected.getEdgeCount(); i += 97) {
+        const auto& a = expected.getEdges()[i];
+        const auto& b = loaded.getEdges()[i];
+        EXPECT_EQ(b->id, a->id);
+        EXPECT_EQ(b->v1->id, a->v1->id);
+        EXPECT_EQ(b->f2 ? b->f2->id : 0, a->f2 ? a->f2->id : 0);
+        EXPECT_EQ(b->n1_f1->id, a->n1_f1->id);
+    }
+}
+
+TEST_F(KernelFileTest, LoadAsyncReportsBadFiles) {
+    EXPECT_THROW(KernelFile::loadAsync(path + ".missing").get(), std::runtime_error);
+
+    buildCube(kernel);
+    KernelFile::save(kernel, path);
+    flipByte(sizeof(KernelFileHeader) + 5);
+    EXPECT_THROW(KernelFile::loadAsync(path).get(), std::runtime_error);
+    flipByte(0);
+    EXPECT_THROW(KernelFile::loadAsync(path).get(), std::runtime_error);
+}
+
+TEST_F(KernelFileTest, SaveAsyncWritesTheSnapshotWhileEditingContinues) {
+    buildGrid(kernel, 60);
+    const size_t faces = kernel.getFaceCount();
+    const size_t edges = kernel.getEdgeCount();
+
+    auto task = KernelFile::saveAsync(kernel, path);
+    // Edits after the call do not reach the file
+    for (int i = 0; i < 50; i++) kernel.mvsf(Point3D(i, -1, 0));
+    kernel.kef(kernel.getEdges()[3]);
+    task.get();
+
+    EXPECT_FALSE(std::filesystem::exists(path + ".part"));
+    WingedEdgeKernel loaded = KernelFile::load(path);
+    EXPECT_EQ(loaded.getFaceCount(), faces);
+    EXPECT_EQ(loaded.getEdgeCount(), edges);
+    EXPECT_TRUE(loaded.validate(ValidationLevel::Full));
+
+    // A frozen kernel is saved from a copy of its frozen form
+    kernel.freeze();
+    auto frozen_save = KernelFile::saveAsync(kernel, path);
+    kernel.mvsf(Point3D(0, 0, 9));
+    frozen_save.get();
+    EXPECT_EQ(KernelFile::load(path).getFaceCount(), kernel.getFaceCount() - 1);
+
+    EXPECT_THROW(KernelFile::saveAsync(std::shared_ptr<const KernelSnapshot>(), path), std::invalid_argument);
+    WingedEdgeKernel fresh;
+    fresh.beginBatch();
+    EXPECT_THROW(KernelFile::saveAsync(fresh, path), std::logic_error);
+    fresh.rollback();
+}
+
+TEST_F(KernelFileTest, CancelStopsTasksAndKeepsTheOldFile) {
+    buildCube(kernel);
+    KernelFile::save(kernel, path);
+
+    // Cancels from the first progress report, once the handle is known
+    std::atomic<FileTask<void>*> save_handle{nullptr};
+    FileTaskOptions save_options;
+    save_options.on_progress = [&](double) {
+        while (!save_handle.load()) std::this_thread::yield();
+        save_handle.load()->cancel();
+    };
+
+    kernel = WingedEdgeKernel();
+    buildGrid(kernel, 260); // More than one chunk of output
+    auto save = KernelFile::saveAsync(kernel, path, save_options);
+    save_handle.store(&save);
+    EXPECT_THROW(save.get(), FileTaskCancelled);
+    EXPECT_FALSE(std::filesystem::exists(path + ".part"));
+    EXPECT_EQ(KernelFile::load(path).getFaceCount(), 6);
+
+    KernelFile::save(kernel, path);
+    std::atomic<FileTask<WingedEdgeKernel>*> load_handle{nullptr};
+    FileTaskOptions load_options;
+    load_options.on_progress = [&](double) {
+        while (!load_handle.load()) std::this_thread::yield();
+        load_handle.load()->cancel();
+    };
+    auto load = KernelFile::loadAsync(path, load_options);
+    load_handle.store(&load);
+    EXPECT_THROW(load.get(), FileTaskCancelled);
+    EXPECT_LT(load.progress(), 1.0);
+
+    // Dropping a running task cancels and joins it
+    { auto dropped = KernelFile::loadAsync(path); }
+}
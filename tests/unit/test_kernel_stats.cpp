@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include "kernel/kernel_stats.h"
+#include "kernel/winged_edge.h"
+
+using namespace SketchyKernel;
+
+// Test fixture for the compile-time operator instrumentation
+class KernelStatsTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+
+    // Triangle from the operators, so every call is counted
+    void buildTriangle() {
+        auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+        auto face = kernel.getFaces()[0];
+        auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+        auto e2 = kernel.mev(e1->v2, Point3D(0.5, 1, 0), face);
+        kernel.mef(e2->v2, v1, face);
+    }
+};
+
+TEST_F(KernelStatsTest, CountsOperatorCallsAndAllocations) {
+    buildTriangle();
+    KernelStats stats = kernel.stats();
+    if (!stats.enabled) {
+        EXPECT_EQ(stats.op(KernelOp::Mev).calls, 0);
+        GTEST_SKIP() << "built without SKETCHY_KERNEL_STATS";
+    }
+
+    EXPECT_EQ(stats.op(KernelOp::Mvsf).calls, 1);
+    EXPECT_EQ(stats.op(KernelOp::Mev).calls, 2);
+    EXPECT_EQ(stats.op(KernelOp::Mef).calls, 1);
+    EXPECT_EQ(stats.op(KernelOp::Kef).calls, 0);
+
+    const OpStats& mev = stats.op(KernelOp::Mev);
+    uint64_t histogram = 0;
+    for (uint64_t n : mev.latency) histogram += n;
+    EXPECT_EQ(histogram, 2);
+    EXPECT_LE(mev.quantileNs(0.5), mev.max_ns);
+    EXPECT_GE(mev.total_ns, mev.max_ns);
+
+    EXPECT_GE(stats.bytes_allocated.vertices, 3 * sizeof(Vertex));
+    EXPECT_GE(stats.bytes_allocated.edges, 3 * sizeof(Edge));
+    EXPECT_GE(stats.bytes_allocated.faces, 2 * sizeof(Face));
+    EXPECT_EQ(stats.peak.vertices, 3);
+    EXPECT_EQ(stats.peak.faces, 2);
+
+    ASSERT_EQ(stats.trace.size(), 4);
+    EXPECT_EQ(stats.trace[0].op, KernelOp::Mvsf);
+    EXPECT_EQ(stats.trace[3].op, KernelOp::Mef);
+    EXPECT_LE(stats.trace[0].start_ns, stats.trace[3].start_ns);
+
+    // Failed calls are timed too
+    EXPECT_THROW(kernel.kef(nullptr), std::invalid_argument);
+    EXPECT_EQ(kernel.stats().op(KernelOp::Kef).calls, 1);
+
+    kernel.resetStats();
+    stats = kernel.stats();
+    EXPECT_EQ(stats.op(KernelOp::Mvsf).calls, 0);
+    EXPECT_TRUE(stats.trace.empty());
+    EXPECT_EQ(stats.peak.vertices, 3); // Still holds the live elements
+}
+
+TEST_F(KernelStatsTest, CountsLoopWalks) {
+    buildTriangle();
+    kernel.resetStats();
+    if (!kernel.stats().enabled) GTEST_SKIP() << "built without SKETCHY_KERNEL_STATS";
+
+    size_t yielded = 0;
+    for (const auto& f : kernel.getFaces()) {
+        for (const auto& e : kernel.faceEdges(f)) yielded += e != nullptr;
+    }
+    KernelStats stats = kernel.stats();
+    EXPECT_GE(stats.loop_ranges, kernel.getFaceCount());
+    EXPECT_GE(stats.loop_steps, yielded);
+}
+
+TEST_F(KernelStatsTest, TraceRingKeepsNewestCalls) {
+    if (!kernel.stats().enabled) GTEST_SKIP() << "built without SKETCHY_KERNEL_STATS";
+
+    const size_t calls = kTraceCapacity + 10;
+    for (size_t i = 0; i < calls; i++) kernel.mvsf(Point3D(static_cast<double>(i), 0, 0));
+    KernelStats stats = kernel.stats();
+    EXPECT_EQ(stats.op(KernelOp::Mvsf).calls, calls);
+    EXPECT_EQ(stats.trace.size(), kTraceCapacity);
+    EXPECT_EQ(stats.trace_dropped, 10);
+    for (size_t i = 1; i < stats.trace.size(); i++) {
+        ASSERT_LE(stats.trace[i - 1].start_ns, stats.trace[i].start_ns);
+    }
+}
+
+TEST_F(KernelStatsTest, ChromeTraceIsWellFormed) {
+    KernelStats stats;
+    stats.enabled = true;
+    stats.trace.push_back(TraceEvent{KernelOp::Mev, 1500, 250});
+    stats.trace.push_back(TraceEvent{KernelOp::Kef, 2000, 1000000});
+    stats.ops[static_cast<size_t>(KernelOp::Mev)].calls = 1;
+
+    std::ostringstream out;
+    writeChromeTrace(stats, out);
+    const std::string json = out.str();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"mev\",\"cat\":\"euler\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":1.500,\"dur\":0.250}"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"ts\":2.000,\"dur\":1000.000"), std::string::npos);
+    EXPECT_NE(json.find("\"mev_calls\":1"), std::string::npos);
+    EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+
+    EXPECT_THROW(writeChromeTrace(stats, std::string("/nonexistent/dir/trace.json")), std::runtime_error);
+}
+
+TEST(OpStatsTest, QuantilesFollowHistogram) {
+    OpStats op;
+    EXPECT_EQ(op.quantileNs(0.5), 0);
+    op.calls = 4;
+    op.max_ns = 900;
+    op.latency[3] = 3; // [8, 16) ns
+    op.latency[9] = 1; // [512, 1024) ns
+    EXPECT_EQ(op.quantileNs(0.0), 16);
+    EXPECT_EQ(op.quantileNs(0.5), 16);
+    EXPECT_EQ(op.quantileNs(1.0), 900);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "kernel/mesh_export.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for streaming OBJ / PLY export
+class MeshExportTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+
+    // Unit cube with one top corner raised, so not every face is a square
+    void buildRaisedCube() {
+        Corners corners = boxCorners();
+        corners[7].z = 1.5;
+        buildHexahedron(kernel, corners);
+    }
+
+    // Collects the stream and the size of every chunk handed to the sink
+    struct Capture {
+        std::string data;
+        std::vector<size_t> chunks;
+
+        ExportSink sink() {
+            return [this](const char* bytes, size_t size) {
+                data.append(bytes, size);
+                chunks.push_back(size);
+            };
+        }
+    };
+};
+
+TEST_F(MeshExportTest, ObjListsVerticesAndFaceLoops) {
+    buildRaisedCube();
+    Capture capture;
+    auto stats = exportObj(kernel, capture.sink());
+
+    EXPECT_EQ(stats.vertices, 8);
+    EXPECT_EQ(stats.faces, 6);
+    EXPECT_EQ(stats.skipped_faces, 0);
+    EXPECT_EQ(stats.bytes, capture.data.size());
+    EXPECT_EQ(capture.chunks.size(), 1);
+
+    std::istringstream lines(capture.data);
+    std::string line;
+    size_t v_lines = 0, f_lines = 0;
+    while (std::getline(lines, line)) {
+        if (line.rfind("v ", 0) == 0) v_lines++;
+        if (line.rfind("f ", 0) == 0) {
+            f_lines++;
+            std::istringstream tokens(line.substr(2));
+            int index, count = 0;
+            while (tokens >> index) {
+                EXPECT_GE(index, 1);
+                EXPECT_LE(index, 8);
+                count++;
+            }
+            EXPECT_EQ(count, 4);
+        }
+    }
+    EXPECT_EQ(v_lines, 8);
+    EXPECT_EQ(f_lines, 6);
+    EXPECT_NE(capture.data.find("v 0 1 1.5\n"), std::string::npos);
+}
+
+TEST_F(MeshExportTest, SmallBufferStreamsSameBytesInBoundedChunks) {
+    buildGrid(kernel, 10, 0.1);
+
+    Capture whole, chunked;
+    exportObj(kernel, whole.sink());
+    exportObj(kernel, chunked.sink(), 300);
+
+    EXPECT_EQ(chunked.data, whole.data);
+    EXPECT_GT(chunked.chunks.size(), 1);
+    for (size_t size : chunked.chunks) EXPECT_LE(size, 300u);
+}
+
+TEST_F(MeshExportTest, PlyHeaderMatchesBinaryBody) {
+    buildRaisedCube();
+    kernel.mvsf(Point3D(9, 9, 9)); // Face without a loop is skipped
+
+    Capture capture;
+    auto stats = exportPly(kernel, capture.sink(), 256);
+    EXPECT_EQ(stats.faces, 6);
+    EXPECT_EQ(stats.skipped_faces, 1);
+    EXPECT_EQ(stats.vertices, 9);
+
+    const std::string end = "end_header\n";
+    size_t body = capture.data.find(end);
+    ASSERT_NE(body, std::string::npos);
+    body += end.size();
+
+    std::string header = capture.data.substr(0, body);
+    EXPECT_NE(header.find("element vertex 9\n"), std::string::npos);
+    EXPECT_NE(header.find("element face 6\n"), std::string::npos);
+
+    // 9 vertices of 3 doubles, 6 quads of a count and 4 indices
+    EXPECT_EQ(capture.data.size() - body, 9 * 24 + 6 * (4 + 4 * 4));
+
+    double z;
+    std::memcpy(&z, capture.data.data() + body + 7 * 24 + 16, sizeof(z));
+    EXPECT_EQ(z, 1.5);
+
+    uint32_t first_count;
+    std::memcpy(&first_count, capture.data.data() + body + 9 * 24, sizeof(first_count));
+    EXPECT_EQ(first_count, 4u);
+}
+
+TEST_F(MeshExportTest, FileDescriptorSinkWritesFile) {
+    buildRaisedCube();
+    std::string path = (std::filesystem::temp_directory_path() / "sketchy_export_test.obj").string();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    exportObj(kernel, makeFileDescriptorSink(fd), 512);
+    ::close(fd);
+
+    Capture capture;
+    exportObj(kernel, capture.sink());
+
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), capture.data);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(exportObj(kernel, makeFileDescriptorSink(-1)), std::runtime_error);
+}
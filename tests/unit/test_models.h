@@ -0,0 +1,105 @@
+#ifndef SKETCHY_TESTS_TEST_MODELS_H
+#define SKETCHY_TESTS_TEST_MODELS_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "kernel/winged_edge.h"
+
+namespace SketchyKernel {
+namespace TestModels {
+
+/**
+ * Small models shared by the unit tests. All of them go through
+ * buildFromIndexedMesh and return the faces it made, in input order.
+ */
+
+// Corners 0-3 go around the bottom, 4-7 around the top above them
+using Corners = std::array<Point3D, 8>;
+
+inline Corners boxCorners(const Point3D& lo = Point3D(0, 0, 0), const Point3D& hi = Point3D(1, 1, 1)) {
+    Corners corners;
+    for (int c = 0; c < 8; c++) {
+        corners[c] = Point3D((c == 1 || c == 2 || c == 5 || c == 6) ? hi.x : lo.x,
+                             (c == 2 || c == 3 || c == 6 || c == 7) ? hi.y : lo.y, c >= 4 ? hi.z : lo.z);
+    }
+    return corners;
+}
+
+/**
+ * Add the six quads over eight corners, facing out when the corners are a
+ * box's; bottom, top, then the four sides
+ */
+inline void appendHexahedron(std::vector<Point3D>& positions, std::vector<uint32_t>& loops, const Corners& corners) {
+    static const uint32_t quads[24] = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4,
+                                       1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    const auto base = static_cast<uint32_t>(positions.size());
+    positions.insert(positions.end(), corners.begin(), corners.end());
+    for (uint32_t index : quads) loops.push_back(base + index);
+}
+
+inline std::vector<std::shared_ptr<Face>> buildHexahedron(WingedEdgeKernel& kernel, const Corners& corners) {
+    std::vector<Point3D> positions;
+    std::vector<uint32_t> loops;
+    appendHexahedron(positions, loops, corners);
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(6, 4));
+}
+
+// Axis-aligned box from lo to hi, as one closed solid
+inline std::vector<std::shared_ptr<Face>> buildBox(WingedEdgeKernel& kernel, const Point3D& lo, const Point3D& hi) {
+    return buildHexahedron(kernel, boxCorners(lo, hi));
+}
+
+// The unit cube [0, 1]^3
+inline std::vector<std::shared_ptr<Face>> buildCube(WingedEdgeKernel& kernel) {
+    return buildHexahedron(kernel, boxCorners());
+}
+
+// n disjoint unit cubes along x, two apart, built in one call so they
+// share one kernel
+inline std::vector<std::shared_ptr<Face>> buildCubeRow(WingedEdgeKernel& kernel, uint32_t n) {
+    std::vector<Point3D> positions;
+    std::vector<uint32_t> loops;
+    for (uint32_t c = 0; c < n; c++) {
+        appendHexahedron(positions, loops, boxCorners(Point3D(2.0 * c, 0, 0), Point3D(2.0 * c + 1, 1, 1)));
+    }
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(6 * n, 4));
+}
+
+// Two tetrahedra touching at vertex 0 (the origin), so the edges around
+// vertex 0 form two separate fans
+inline std::vector<std::shared_ptr<Face>> buildBowtie(WingedEdgeKernel& kernel) {
+    std::vector<Point3D> positions = {
+        {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {-1, 0, 0}, {0, -1, 0}, {0, 0, -1}};
+    std::vector<uint32_t> loops = {0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3,
+                                   0, 5, 4, 0, 4, 6, 0, 6, 5, 4, 5, 6};
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(8, 3));
+}
+
+/**
+ * n x n quads of side `spacing` in the z = 0 plane, row by row from the
+ * origin; the mesh builder closes the outline with one more face. A
+ * non-zero bump lifts each vertex to bump * ((7x + 3y) mod 5), so the
+ * quads are no longer planar.
+ */
+inline std::vector<std::shared_ptr<Face>> buildGrid(WingedEdgeKernel& kernel, uint32_t n, double spacing = 1.0,
+                                                    double bump = 0.0) {
+    std::vector<Point3D> positions;
+    for (uint32_t y = 0; y <= n; y++) {
+        for (uint32_t x = 0; x <= n; x++) positions.emplace_back(x * spacing, y * spacing, bump * ((x * 7 + y * 3) % 5));
+    }
+    std::vector<uint32_t> loops;
+    for (uint32_t y = 0; y < n; y++) {
+        for (uint32_t x = 0; x < n; x++) {
+            uint32_t a = y * (n + 1) + x;
+            loops.insert(loops.end(), {a, a + 1, a + n + 2, a + n + 1});
+        }
+    }
+    return kernel.buildFromIndexedMesh(positions, loops, std::vector<uint32_t>(n * n, 4));
+}
+
+} // namespace TestModels
+} // namespace SketchyKernel
+
+#endif // SKETCHY_TESTS_TEST_MODELS_H
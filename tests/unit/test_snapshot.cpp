@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for copy-on-write kernel snapshots
+class SnapshotTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+};
+
+TEST_F(SnapshotTest, CopiesModelState) {
+    EXPECT_EQ(kernel.latestSnapshot(), nullptr);
+    buildCube(kernel);
+
+    auto snap = kernel.snapshot();
+    ASSERT_NE(snap, nullptr);
+    EXPECT_EQ(kernel.latestSnapshot(), snap);
+    EXPECT_EQ(snap->getVersion(), 1u);
+    EXPECT_EQ(snap->getVertexCount(), 8);
+    EXPECT_EQ(snap->getEdgeCount(), 12);
+    EXPECT_EQ(snap->getFaceCount(), 6);
+    EXPECT_EQ(snap->getSolidCount(), 1);
+
+    // Loops walk the same way as on the kernel
+    for (const auto& f : kernel.getFaces()) {
+        EXPECT_EQ(snap->faceEdges(f->id).size(), kernel.faceEdges(f).size());
+
+        std::vector<int> expected;
+        for (const auto& v : kernel.faceVertices(f)) expected.push_back(v->id);
+        EXPECT_EQ(collect(snap->faceVertices(f->id)), expected);
+    }
+    for (const auto& v : kernel.getVertices()) {
+        EXPECT_EQ(snap->vertexEdges(v->id).size(), 3);
+        EXPECT_EQ(snap->vertex(v->id)->coords.z, v->coords.z);
+    }
+
+    size_t edges_seen = 0;
+    snap->forEachEdge([&](const SnapshotEdge& e) {
+        EXPECT_NE(snap->vertex(e.v1), nullptr);
+        EXPECT_NE(snap->face(e.f2), nullptr);
+        edges_seen++;
+    });
+    EXPECT_EQ(edges_seen, 12);
+
+    // Nothing changed, so the same snapshot comes back
+    EXPECT_EQ(kernel.snapshot(), snap);
+}
+
+TEST_F(SnapshotTest, EditsDoNotReachEarlierSnapshots) {
+    auto v1 = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    auto e1 = kernel.mev(v1, Point3D(1, 0, 0), face);
+    auto before = kernel.snapshot();
+
+    auto e2 = kernel.mev(e1->v2, Point3D(1, 1, 0), face);
+    kernel.transformVertices({v1}, Mat4::translation(0, 0, 3));
+    auto after = kernel.snapshot();
+
+    EXPECT_EQ(after->getVersion(), before->getVersion() + 1);
+    EXPECT_EQ(before->getEdgeCount(), 1);
+    EXPECT_EQ(before->edge(e2->id), nullptr);
+    EXPECT_EQ(before->vertex(v1->id)->coords.z, 0.0);
+
+    EXPECT_EQ(after->getEdgeCount(), 2);
+    ASSERT_NE(after->edge(e2->id), nullptr);
+    EXPECT_EQ(after->edge(e2->id)->v1, e1->v2->id);
+    EXPECT_EQ(after->vertex(v1->id)->coords.z, 3.0);
+
+    // Killed elements drop out of the next snapshot only
+    auto closing = kernel.mef(e2->v2, v1, face);
+    auto with_face = kernel.snapshot();
+    kernel.kef(closing);
+    auto merged = kernel.snapshot();
+
+    EXPECT_NE(with_face->edge(closing->id), nullptr);
+    EXPECT_EQ(merged->edge(closing->id), nullptr);
+    EXPECT_EQ(merged->getFaceCount(), kernel.getFaceCount());
+}
+
+TEST_F(SnapshotTest, SharesUntouchedPages) {
+    // Enough faces to span several pages of every column
+    buildGrid(kernel, 40);
+
+    auto before = kernel.snapshot();
+    auto v = kernel.getVertexById(1);
+    kernel.transformVertices({v}, Mat4::translation(0, 0, 1));
+    auto after = kernel.snapshot();
+
+    const auto& old_column = before->vertexColumn();
+    const auto& new_column = after->vertexColumn();
+    ASSERT_GT(new_column.pageCount(), 2u);
+    EXPECT_FALSE(new_column.sharesPage(old_column, 0));
+    for (size_t page = 1; page < new_column.pageCount(); page++) {
+        EXPECT_TRUE(new_column.sharesPage(old_column, page));
+    }
+    EXPECT_TRUE(after->edgeColumn().sharesPage(before->edgeColumn(), 0));
+}
+
+TEST_F(SnapshotTest, ReadersTraverseWhileWriterEdits) {
+    auto v = kernel.mvsf(Point3D(0, 0, 0));
+    auto face = kernel.getFaces()[0];
+    kernel.snapshot();
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::thread reader([&]() {
+        while (!done.load()) {
+            auto snap = kernel.latestSnapshot();
+
+            // MVSF followed by MEVs builds a tree: V = E + 1
+            size_t vertices = 0;
+            snap->forEachVertex([&](const SnapshotVertex&) { vertices++; });
+            snap->forEachEdge([&](const SnapshotEdge& e) {
+                if (!snap->vertex(e.v1) || !snap->vertex(e.v2)) consistent = false;
+            });
+            if (vertices != snap->getEdgeCount() + 1 || vertices != snap->getVertexCount()) {
+                consistent = false;
+            }
+        }
+    });
+
+    for (int i = 0; i < 2000; i++) {
+        auto e = kernel.mev(v, Point3D(i, 1, 0), face);
+        v = e->v2;
+        kernel.snapshot();
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_TRUE(consistent.load());
+    EXPECT_EQ(kernel.latestSnapshot()->getVertexCount(), 2001);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "kernel/tessellator.h"
+#include "kernel/winged_edge.h"
+#include "test_models.h"
+
+using namespace SketchyKernel;
+using namespace SketchyKernel::TestModels;
+
+// Test fixture for incremental triangulation into flat buffers
+class TessellatorTest : public ::testing::Test {
+protected:
+    WingedEdgeKernel kernel;
+    Tessellator tessellator;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    Tessellator::BufferSizes run() {
+        auto sizes = tessellator.update(kernel);
+        vertices.assign(sizes.vertices * Tessellator::kFloatsPerVertex, 0.0f);
+        indices.assign(sizes.indices, 0);
+        tessellator.write(kernel, vertices.data(), indices.data());
+        return sizes;
+    }
+
+    // Area-weighted normal of triangle t from the written buffers
+    Vec3 triangleNormal(size_t t) const {
+        auto at = [&](size_t k) {
+            const float* p = &vertices[indices[3 * t + k] * Tessellator::kFloatsPerVertex];
+            return Vec3(p[0], p[1], p[2]);
+        };
+        Vec3 a = at(0), b = at(1), c = at(2);
+        Vec3 u(b.x - a.x, b.y - a.y, b.z - a.z), w(c.x - a.x, c.y - a.y, c.z - a.z);
+        return Vec3(u.y * w.z - u.z * w.y, u.z * w.x - u.x * w.z, u.x * w.y - u.y * w.x);
+    }
+};
+
+TEST_F(TessellatorTest, CubeBecomesTwelveOutwardTriangles) {
+    buildCube(kernel);
+    auto sizes = run();
+
+    EXPECT_EQ(sizes.vertices, 24);
+    EXPECT_EQ(sizes.indices, 36);
+    EXPECT_EQ(tessellator.getRetessellatedCount(), 6);
+
+    for (size_t t = 0; t < 12; t++) {
+        Vec3 n = triangleNormal(t);
+        const float* stored = &vertices[indices[3 * t] * Tessellator::kFloatsPerVertex + 3];
+        EXPECT_NEAR(std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z), 1.0, 1e-6);
+
+        // Winding agrees with the stored face normal, which is a unit axis
+        EXPECT_NEAR(n.x * stored[0] + n.y * stored[1] + n.z * stored[2], 1.0, 1e-6);
+        EXPECT_NEAR(std::abs(stored[0]) + std::abs(stored[1]) + std::abs(stored[2]), 1.0, 1e-6);
+    }
+    for (uint32_t index : indices) EXPECT_LT(index, sizes.vertices);
+}
+
+TEST_F(TessellatorTest, ConcaveLoopIsEarClipped) {
+    // L-shaped hexagon in the XZ plane; a fan from vertex 0 would leave it
+    std::vector<Point3D> positions = {{2, 0, 2}, {0, 0, 2}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {2, 0, 1}};
+    std::vector<uint32_t> loop = {0, 1, 2, 3, 4, 5};
+    kernel.buildFromIndexedMesh(positions, loop, {6});
+
+    // The open loop is closed off by a back face, which is just as concave
+    auto sizes = run();
+    ASSERT_EQ(kernel.getFaceCount(), 2);
+    ASSERT_EQ(sizes.indices, 24);
+
+    // Non-overlapping triangles covering the L add up to its area, 3
+    const float face_y = vertices[4]; // Normal of the first output vertex
+    EXPECT_NEAR(std::abs(face_y), 1.0, 1e-6);
+
+    double area = 0;
+    for (size_t t = 0; t < 4; t++) {
+        Vec3 n = triangleNormal(t);
+        EXPECT_GT(n.y * face_y, 0) << "triangle " << t << " is inverted";
+        area += 0.5 * std::abs(n.y);
+    }
+    EXPECT_NEAR(area, 3.0, 1e-6);
+}
+
+TEST_F(TessellatorTest, OnlyTouchedFacesAreRetessellated) {
+    buildCube(kernel);
+    run();
+    EXPECT_EQ(tessellator.getRetessellatedCount(), 6);
+
+    run();
+    EXPECT_EQ(tessellator.getRetessellatedCount(), 0);
+
+    auto corner = kernel.getVertices()[6];
+    kernel.transformVertices({corner}, Mat4::translation(0.25, 0.25, 0.25));
+    run();
+    EXPECT_EQ(tessellator.getRetessellatedCount(), 3);
+
+    bool moved = false;
+    for (size_t i = 0; i < vertices.size(); i += Tessellator::kFloatsPerVertex) {
+        moved |= vertices[i] == 1.25f && vertices[i + 1] == 1.25f && vertices[i + 2] == 1.25f;
+    }
+    EXPECT_TRUE(moved);
+}
+
+TEST_F(TessellatorTest, WriteStaysInsideUpdatedSizesAfterEdits) {
+    buildCube(kernel);
+    auto sizes = tessellator.update(kernel);
+
+    // Grow one loop, merge two faces and add a face with a new ID
+    auto face = kernel.getFaces()[0];
+    kernel.mev(kernel.getFaceVertices(face)[0], Point3D(0.5, 0.5, -1), face);
+    kernel.kef(kernel.getFaceBoundary(kernel.getFaces()[3])[0]);
+    kernel.mvsf(Point3D(5, 5, 5));
+
+    // Guard values past the end must survive
+    const size_t guard = 64;
+    vertices.assign(sizes.vertices * Tessellator::kFloatsPerVertex + guard, -7.0f);
+    indices.assign(sizes.indices + guard, 12345);
+    tessellator.write(kernel, vertices.data(), indices.data());
+
+    for (size_t i = 0; i < guard; i++) {
+        EXPECT_EQ(vertices[sizes.vertices * Tessellator::kFloatsPerVertex + i], -7.0f);
+        EXPECT_EQ(indices[sizes.indices + i], 12345u);
+    }
+    for (size_t i = 0; i < sizes.indices; i++) EXPECT_LT(indices[i], sizes.vertices);
+
+    WingedEdgeKernel other;
+    EXPECT_THROW(tessellator.write(other, vertices.data(), indices.data()), std::invalid_argument);
+}